@@ -234,6 +234,27 @@ public:
     *ptr = data;
   }
 
+  /**
+   * Load @p n_array_elements from memory into the calling class, starting at
+   * the given address and with given offsets, each entry from the offset
+   * providing one element of the vectorized array.
+   *
+   * This operation corresponds to the following code (but uses a more
+   * efficient implementation in case the hardware allows for that):
+   * @code
+   * for (unsigned int v=0; v<VectorizedArray<Number>::n_array_elements; ++v)
+   *   this->operator[](v) = base_ptr[offsets[v]];
+   * @endcode
+   *
+   * The offsets are interpreted as signed 32-bit integers by the gather
+   * instructions, so they must be smaller than 2^31.
+   */
+  void gather (const Number       *base_ptr,
+               const unsigned int *offsets)
+  {
+    data = base_ptr[offsets[0]];
+  }
+
   /**
    * Actual data field. Since this class represents a POD data type, it is
    * declared public.
@@ -549,6 +570,28 @@ public:
     _mm512_storeu_pd (ptr, data);
   }
 
+  /**
+   * Load @p n_array_elements from memory into the calling class, starting at
+   * the given address and with given offsets, each entry from the offset
+   * providing one element of the vectorized array.
+   *
+   * This operation corresponds to the following code (but uses a more
+   * efficient implementation in case the hardware allows for that):
+   * @code
+   * for (unsigned int v=0; v<VectorizedArray<Number>::n_array_elements; ++v)
+   *   this->operator[](v) = base_ptr[offsets[v]];
+   * @endcode
+   *
+   * The offsets are interpreted as signed 32-bit integers by the gather
+   * instructions, so they must be smaller than 2^31.
+   */
+  void gather (const double       *base_ptr,
+               const unsigned int *offsets)
+  {
+    const __m256i index = _mm256_loadu_si256((const __m256i *)offsets);
+    data = _mm512_i32gather_pd(index, base_ptr, 8);
+  }
+
   /**
    * Actual data field. Since this class represents a POD data type, it
    * remains public.
@@ -748,6 +791,28 @@ public:
     _mm512_storeu_ps (ptr, data);
   }
 
+  /**
+   * Load @p n_array_elements from memory into the calling class, starting at
+   * the given address and with given offsets, each entry from the offset
+   * providing one element of the vectorized array.
+   *
+   * This operation corresponds to the following code (but uses a more
+   * efficient implementation in case the hardware allows for that):
+   * @code
+   * for (unsigned int v=0; v<VectorizedArray<Number>::n_array_elements; ++v)
+   *   this->operator[](v) = base_ptr[offsets[v]];
+   * @endcode
+   *
+   * The offsets are interpreted as signed 32-bit integers by the gather
+   * instructions, so they must be smaller than 2^31.
+   */
+  void gather (const float        *base_ptr,
+               const unsigned int *offsets)
+  {
+    const __m512i index = _mm512_loadu_si512((const void *)offsets);
+    data = _mm512_i32gather_ps(index, base_ptr, 4);
+  }
+
   /**
    * Actual data field. Since this class represents a POD data type, it
    * remains public.
@@ -950,6 +1015,33 @@ public:
     _mm256_storeu_pd (ptr, data);
   }
 
+  /**
+   * Load @p n_array_elements from memory into the calling class, starting at
+   * the given address and with given offsets, each entry from the offset
+   * providing one element of the vectorized array.
+   *
+   * This operation corresponds to the following code (but uses a more
+   * efficient implementation in case the hardware allows for that):
+   * @code
+   * for (unsigned int v=0; v<VectorizedArray<Number>::n_array_elements; ++v)
+   *   this->operator[](v) = base_ptr[offsets[v]];
+   * @endcode
+   *
+   * The offsets are interpreted as signed 32-bit integers by the gather
+   * instructions, so they must be smaller than 2^31.
+   */
+  void gather (const double       *base_ptr,
+               const unsigned int *offsets)
+  {
+#ifdef __AVX2__
+    const __m128i index = _mm_loadu_si128((const __m128i *)offsets);
+    data = _mm256_i32gather_pd(base_ptr, index, 8);
+#else
+    for (unsigned int i=0; i<4; ++i)
+      *(reinterpret_cast<double *>(&data)+i) = base_ptr[offsets[i]];
+#endif
+  }
+
   /**
    * Actual data field. Since this class represents a POD data type, it
    * remains public.
@@ -1263,6 +1355,33 @@ public:
     _mm256_storeu_ps (ptr, data);
   }
 
+  /**
+   * Load @p n_array_elements from memory into the calling class, starting at
+   * the given address and with given offsets, each entry from the offset
+   * providing one element of the vectorized array.
+   *
+   * This operation corresponds to the following code (but uses a more
+   * efficient implementation in case the hardware allows for that):
+   * @code
+   * for (unsigned int v=0; v<VectorizedArray<Number>::n_array_elements; ++v)
+   *   this->operator[](v) = base_ptr[offsets[v]];
+   * @endcode
+   *
+   * The offsets are interpreted as signed 32-bit integers by the gather
+   * instructions, so they must be smaller than 2^31.
+   */
+  void gather (const float        *base_ptr,
+               const unsigned int *offsets)
+  {
+#ifdef __AVX2__
+    const __m256i index = _mm256_loadu_si256((const __m256i *)offsets);
+    data = _mm256_i32gather_ps(base_ptr, index, 4);
+#else
+    for (unsigned int i=0; i<8; ++i)
+      *(reinterpret_cast<float *>(&data)+i) = base_ptr[offsets[i]];
+#endif
+  }
+
   /**
    * Actual data field. Since this class represents a POD data type, it
    * remains public.
@@ -1625,6 +1744,28 @@ public:
     _mm_storeu_pd (ptr, data);
   }
 
+  /**
+   * Load @p n_array_elements from memory into the calling class, starting at
+   * the given address and with given offsets, each entry from the offset
+   * providing one element of the vectorized array.
+   *
+   * This operation corresponds to the following code (but uses a more
+   * efficient implementation in case the hardware allows for that):
+   * @code
+   * for (unsigned int v=0; v<VectorizedArray<Number>::n_array_elements; ++v)
+   *   this->operator[](v) = base_ptr[offsets[v]];
+   * @endcode
+   *
+   * The offsets are interpreted as signed 32-bit integers by the gather
+   * instructions, so they must be smaller than 2^31.
+   */
+  void gather (const double       *base_ptr,
+               const unsigned int *offsets)
+  {
+    for (unsigned int i=0; i<2; ++i)
+      *(reinterpret_cast<double *>(&data)+i) = base_ptr[offsets[i]];
+  }
+
   /**
    * Actual data field. Since this class represents a POD data type, it
    * remains public.
@@ -1895,6 +2036,28 @@ public:
     _mm_storeu_ps (ptr, data);
   }
 
+  /**
+   * Load @p n_array_elements from memory into the calling class, starting at
+   * the given address and with given offsets, each entry from the offset
+   * providing one element of the vectorized array.
+   *
+   * This operation corresponds to the following code (but uses a more
+   * efficient implementation in case the hardware allows for that):
+   * @code
+   * for (unsigned int v=0; v<VectorizedArray<Number>::n_array_elements; ++v)
+   *   this->operator[](v) = base_ptr[offsets[v]];
+   * @endcode
+   *
+   * The offsets are interpreted as signed 32-bit integers by the gather
+   * instructions, so they must be smaller than 2^31.
+   */
+  void gather (const float        *base_ptr,
+               const unsigned int *offsets)
+  {
+    for (unsigned int i=0; i<4; ++i)
+      *(reinterpret_cast<float *>(&data)+i) = base_ptr[offsets[i]];
+  }
+
   /**
    * Actual data field. Since this class represents a POD data type, it
    * remains public.
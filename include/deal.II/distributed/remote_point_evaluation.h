@@ -0,0 +1,273 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__distributed_remote_point_evaluation_h
+#define dealii__distributed_remote_point_evaluation_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/point.h>
+#include <deal.II/base/smartpointer.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/fe/mapping_q1.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/lac/vector.h>
+
+#include <utility>
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+namespace parallel
+{
+  /**
+   * A class that evaluates a finite element field at arbitrary points, where
+   * the points given on one processor may lie in cells owned by any other
+   * processor. This is the situation one faces when evaluating a solution
+   * computed on a parallel::distributed::Triangulation at a set of probe
+   * points, or when interpolating it onto a mesh that is partitioned
+   * differently. Functions::FEFieldFunction and VectorTools::point_value(),
+   * on the other hand, can only evaluate the solution in locally owned
+   * cells.
+   *
+   * The work is split into two phases. The collective function reinit()
+   * determines, for each of the points given on the current processor, the
+   * processor that owns the cell around it, as well as the cell and the
+   * coordinates of the point in its reference cell. To this end, every
+   * processor computes a bounding box around its locally owned cells, these
+   * boxes are exchanged among all processors, and each point is sent to
+   * those processors whose box contains it. The receiving processors locate
+   * the points in their locally owned cells using a CellBoundingBoxTree. If
+   * a point lies on the interface between several processors, it is
+   * assigned to the one with the smallest rank. The result of this phase is
+   * a communication pattern that is stored in this object.
+   *
+   * The collective function evaluate() then computes the values of a finite
+   * element field at all the points that the current processor is
+   * responsible for, and sends them back to the processors that asked for
+   * them. Since only the values have to be exchanged, this is cheap and can
+   * be done many times, e.g., once per time step, as long as the mesh and
+   * the points do not change.
+   *
+   * Points that are not inside any locally owned cell of any processor are
+   * reported by point_found(); their values are set to zero.
+   *
+   * If the triangulation is not derived from parallel::Triangulation, all
+   * cells are considered locally owned and no communication takes place.
+   *
+   * As an example, the following code interpolates a solution on a mesh
+   * onto the support points of another finite element space on a mesh that
+   * is partitioned differently:
+   * @code
+   *   std::vector<Point<dim> > support_points;
+   *   std::vector<types::global_dof_index> dof_indices;
+   *   ... collect the support points and the indices of the locally owned
+   *       degrees of freedom of dof_handler_2 ...
+   *
+   *   parallel::RemotePointEvaluation<dim> evaluator;
+   *   evaluator.reinit (support_points, triangulation_1, mapping);
+   *
+   *   std::vector<Vector<double> > values;
+   *   evaluator.evaluate (dof_handler_1, solution_1, values);
+   *   for (unsigned int i=0; i<dof_indices.size(); ++i)
+   *     solution_2(dof_indices[i]) = values[i](0);
+   * @endcode
+   *
+   * @ingroup distributed
+   */
+  template <int dim, int spacedim=dim>
+  class RemotePointEvaluation : public Subscriptor
+  {
+  public:
+    /**
+     * Constructor. Points at a distance of up to @p tolerance (measured in
+     * the coordinates of the reference cell) outside of a locally owned
+     * cell are still considered to be inside of it.
+     */
+    RemotePointEvaluation (const double tolerance = 1e-10);
+
+    /**
+     * Destructor.
+     */
+    ~RemotePointEvaluation ();
+
+    /**
+     * Set up the communication pattern for the evaluation at the given @p
+     * points. This function must be called on all processors that share the
+     * triangulation, each with its own set of points, which may be empty.
+     * The triangulation and the mapping are stored by reference and must
+     * live at least as long as this object, or until clear() or reinit() is
+     * called. The mapping must be the same on all processors.
+     */
+    void reinit (const std::vector<Point<spacedim> >       &points,
+                 const dealii::Triangulation<dim,spacedim> &triangulation,
+                 const Mapping<dim,spacedim>               &mapping = StaticMappingQ1<dim,spacedim>::mapping);
+
+    /**
+     * Release all memory and the references to the triangulation and the
+     * mapping.
+     */
+    void clear ();
+
+    /**
+     * Evaluate the finite element field given by @p dof_handler and @p
+     * vector at the points passed to reinit() on this processor. On return,
+     * @p values has one element per point, with one entry per vector
+     * component of the finite element. This function must be called on all
+     * processors at the same time.
+     *
+     * The @p dof_handler must be built on the triangulation passed to
+     * reinit(). For parallel vectors, @p vector must provide access to the
+     * degrees of freedom of all locally owned cells, i.e., it must include
+     * ghost entries.
+     */
+    template <typename DoFHandlerType, typename VectorType>
+    void evaluate (const DoFHandlerType                                  &dof_handler,
+                   const VectorType                                      &vector,
+                   std::vector<Vector<typename VectorType::value_type> > &values) const;
+
+    /**
+     * Return the number of points passed to reinit() on this processor.
+     */
+    unsigned int n_points () const;
+
+    /**
+     * Return whether the point with index @p i has been found in a locally
+     * owned cell of any processor.
+     */
+    bool point_found (const unsigned int i) const;
+
+    /**
+     * Return whether all points passed to reinit() on this processor have
+     * been found.
+     */
+    bool all_points_found () const;
+
+    /**
+     * Return the rank of the processor that evaluates the field at the point
+     * with index @p i, or numbers::invalid_unsigned_int if the point has not
+     * been found.
+     */
+    unsigned int get_point_owner (const unsigned int i) const;
+
+    /**
+     * Return the number of points, from all processors, at which this
+     * processor evaluates the field.
+     */
+    unsigned int n_evaluation_points () const;
+
+    /**
+     * Determine an estimate for the memory consumption (in bytes) of this
+     * object.
+     */
+    std::size_t memory_consumption () const;
+
+  private:
+    /**
+     * Copy constructor. Not implemented.
+     */
+    RemotePointEvaluation (const RemotePointEvaluation &);
+
+    /**
+     * Copy operator. Not implemented.
+     */
+    RemotePointEvaluation &operator = (const RemotePointEvaluation &);
+
+    /**
+     * Evaluate the field on the evaluation cells with indices in the range
+     * [begin,end), and write the values into the respective entries of @p
+     * send_buffer. The entries of @p mapping_independent_values state, for
+     * each element of the finite element collection, whether the values of
+     * the shape functions can be computed without the mapping.
+     */
+    template <typename DoFHandlerType, typename VectorType>
+    void evaluate_on_cells (const DoFHandlerType                           *dof_handler,
+                            const VectorType                               *vector,
+                            const std::vector<bool>                        *mapping_independent_values,
+                            std::vector<typename VectorType::value_type>   *send_buffer,
+                            const unsigned int                              begin,
+                            const unsigned int                              end) const;
+
+    /**
+     * The tolerance for points outside of cells.
+     */
+    const double tolerance;
+
+    /**
+     * The triangulation.
+     */
+    SmartPointer<const dealii::Triangulation<dim,spacedim>,RemotePointEvaluation<dim,spacedim> > tria;
+
+    /**
+     * The mapping.
+     */
+    SmartPointer<const Mapping<dim,spacedim>,RemotePointEvaluation<dim,spacedim> > mapping;
+
+    /**
+     * The communicator of the triangulation, or MPI_COMM_SELF for serial
+     * triangulations.
+     */
+    MPI_Comm communicator;
+
+    /**
+     * For each point passed to reinit(), the rank of the processor that
+     * evaluates the field there.
+     */
+    std::vector<unsigned int> point_owners;
+
+    /**
+     * The ranks of the processors from which this processor receives values,
+     * in ascending order, and the offsets of their values in the receive
+     * buffer. The latter vector has one more element than the former.
+     */
+    std::vector<unsigned int> recv_ranks;
+    std::vector<unsigned int> recv_offsets;
+
+    /**
+     * For each entry of the receive buffer, the index of the point it
+     * belongs to.
+     */
+    std::vector<unsigned int> recv_point_indices;
+
+    /**
+     * The ranks of the processors to which this processor sends values, in
+     * ascending order, and the offsets of their values in the send buffer.
+     * The latter vector has one more element than the former.
+     */
+    std::vector<unsigned int> send_ranks;
+    std::vector<unsigned int> send_offsets;
+
+    /**
+     * The level and index of the locally owned cells that contain points to
+     * be evaluated on this processor, sorted by level and index, and the
+     * offsets of the points of each cell in the following two arrays. The
+     * latter vector has one more element than the former.
+     */
+    std::vector<std::pair<int,int> > evaluation_cells;
+    std::vector<unsigned int>        evaluation_cell_offsets;
+
+    /**
+     * The coordinates in the reference cell of the points evaluated on this
+     * processor, grouped by cell, and their positions in the send buffer.
+     */
+    std::vector<Point<dim> >  evaluation_reference_points;
+    std::vector<unsigned int> evaluation_buffer_indices;
+  };
+}
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -140,10 +140,11 @@ namespace parallel
 
       /**
        * A vector containing subdomain IDs of cells obtained by partitioning
-       * using METIS. In case allow_artificial_cells is false, this vector is
-       * consistent with IDs stored in cell->subdomain_id() of the
-       * triangulation class. When allow_artificial_cells is true, cells which
-       * are artificial will have cell->subdomain_id() == numbers::artificial;
+       * using GridTools::partition_triangulation(). In case
+       * allow_artificial_cells is false, this vector is consistent with IDs
+       * stored in cell->subdomain_id() of the triangulation class. When
+       * allow_artificial_cells is true, cells which are artificial will have
+       * cell->subdomain_id() == numbers::artificial;
        *
        * The original parition information is stored to allow using sequential
        * DoF distribution and partitioning functions with semi-artificial
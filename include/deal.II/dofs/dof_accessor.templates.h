@@ -2906,16 +2906,17 @@ namespace internal
         Assert (accessor.dof_handler->n_dofs() == global_destination.size(),
                 typename BaseClass::ExcVectorDoesNotMatch());
 
-        const unsigned int n_dofs = local_source_end - local_source_begin;
+        Assert (!accessor.has_children(),
+                ExcMessage ("Cell must be active"));
 
-//TODO[WB/MK]: This function could me made more efficient because it allocates memory, which could be avoided by passing in another argument as a scratch array. This should be fixed eventually. another option would be to let the surrounding class have a (static, mutable) scratch array that is thread-local
+        const unsigned int n_dofs = local_source_end - local_source_begin;
 
-        // get indices of dofs
-        std::vector<types::global_dof_index> dofs (n_dofs);
-        accessor.get_dof_indices (dofs);
+        const types::global_dof_index *dofs
+          = accessor.dof_handler->levels[accessor.level()]
+            ->get_cell_cache_start (accessor.present_index, n_dofs);
 
         // distribute cell vector
-        global_destination.add (n_dofs, dofs.begin(), local_source_begin);
+        global_destination.add(n_dofs, dofs, local_source_begin);
       }
 
 
@@ -2969,17 +2970,18 @@ namespace internal
         Assert (accessor.dof_handler->n_dofs() == global_destination.size(),
                 typename BaseClass::ExcVectorDoesNotMatch());
 
-        const unsigned int n_dofs = local_source_end - local_source_begin;
+        Assert (!accessor.has_children(),
+                ExcMessage ("Cell must be active."));
 
-//TODO[WB/MK]: This function could me made more efficient because it allocates memory, which could be avoided by passing in another argument as a scratch array. This should be fixed eventually
+        const unsigned int n_dofs = local_source_end - local_source_begin;
 
-        // get indices of dofs
-        std::vector<types::global_dof_index> dofs (n_dofs);
-        accessor.get_dof_indices (dofs);
+        const types::global_dof_index *dofs
+          = accessor.dof_handler->levels[accessor.level()]
+            ->get_cell_cache_start (accessor.present_index, n_dofs);
 
         // distribute cell vector
         constraints.distribute_local_to_global (local_source_begin, local_source_end,
-                                                dofs.begin(), global_destination);
+                                                dofs, global_destination);
       }
 
 
@@ -3038,16 +3040,19 @@ namespace internal
         Assert (accessor.dof_handler->n_dofs() == global_destination.n(),
                 typename BaseClass::ExcMatrixDoesNotMatch());
 
-        const unsigned int n_dofs = local_source.size();
+        Assert (!accessor.has_children(),
+                ExcMessage ("Cell must be active."));
 
-//TODO[WB/MK]: This function could me made more efficient because it allocates memory, which could be avoided by passing in another argument as a scratch array.
+        const unsigned int n_dofs = local_source.m();
 
-        // get indices of dofs
-        std::vector<types::global_dof_index> dofs (n_dofs);
-        accessor.get_dof_indices (dofs);
+        const types::global_dof_index *dofs
+          = accessor.dof_handler->levels[accessor.level()]
+            ->get_cell_cache_start (accessor.present_index, n_dofs);
 
         // distribute cell matrix
-        global_destination.add(dofs,local_source);
+        for (unsigned int i=0; i<n_dofs; ++i)
+          global_destination.add(dofs[i], n_dofs, dofs,
+                                 &local_source(i,0));
       }
 
 
@@ -3085,12 +3090,10 @@ namespace internal
         types::global_dof_index *dofs = &accessor.dof_handler->levels[accessor.level()]
                                         ->cell_dof_indices_cache[accessor.present_index *n_dofs];
 
-        // distribute cell matrices
+        // distribute cell matrix and vector
         for (unsigned int i=0; i<n_dofs; ++i)
-          {
-            global_matrix.add(dofs[i], n_dofs, dofs, &local_matrix(i,0));
-            global_vector(dofs[i]) += local_vector(i);
-          }
+          global_matrix.add(dofs[i], n_dofs, dofs, &local_matrix(i,0));
+        global_vector.add(n_dofs, dofs, local_vector.begin());
       }
 
 
@@ -3121,20 +3124,19 @@ namespace internal
         Assert (accessor.dof_handler->n_dofs() == global_vector.size(),
                 typename BaseClass::ExcVectorDoesNotMatch());
 
-        const unsigned int n_dofs = local_matrix.size();
+        Assert (!accessor.has_children(),
+                ExcMessage ("Cell must be active."));
 
-//TODO[WB/MK]: This function could me made more efficient because it
-//allocates memory, which could be avoided by passing in another
-//argument as a scratch array. Comment(GK) Do not bother and leave this
-//to ConstraintMatrix or MeshWorker::Assembler
+        const unsigned int n_dofs = local_matrix.m();
 
-        // get indices of dofs
-        std::vector<types::global_dof_index> dofs (n_dofs);
-        accessor.get_dof_indices (dofs);
+        const types::global_dof_index *dofs
+          = accessor.dof_handler->levels[accessor.level()]
+            ->get_cell_cache_start (accessor.present_index, n_dofs);
 
         // distribute cell matrix and vector
-        global_matrix.add(dofs,local_matrix);
-        global_vector.add(dofs,local_vector);
+        for (unsigned int i=0; i<n_dofs; ++i)
+          global_matrix.add(dofs[i], n_dofs, dofs, &local_matrix(i,0));
+        global_vector.add(n_dofs, dofs, local_vector.begin());
       }
     };
   }
@@ -3301,13 +3303,16 @@ DoFCellAccessor<DoFHandlerType,level_dof_access>::get_dof_indices
   Assert (this->active(), ExcMessage ("get_dof_indices() only works on active cells."));
   Assert (this->is_artificial() == false,
           ExcMessage ("Can't ask for DoF indices on artificial cells."));
-  AssertDimension (dof_indices.size(), this->get_fe().dofs_per_cell);
+  const unsigned int dofs_per_cell = this->get_fe().dofs_per_cell;
+  AssertDimension (dof_indices.size(), dofs_per_cell);
 
+  // for hp::DoFHandler objects, get_fe() needs to look up the active fe
+  // index, so only query it once rather than in every iteration of the
+  // loop
   const types::global_dof_index *cache
     = this->dof_handler->levels[this->present_level]
-      ->get_cell_cache_start (this->present_index, this->get_fe().dofs_per_cell);
-  for (unsigned int i=0; i<this->get_fe().dofs_per_cell; ++i, ++cache)
-    dof_indices[i] = *cache;
+      ->get_cell_cache_start (this->present_index, dofs_per_cell);
+  std::copy (cache, cache+dofs_per_cell, dof_indices.begin());
 }
 
 
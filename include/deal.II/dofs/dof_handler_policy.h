@@ -101,6 +101,13 @@ namespace internal
       /**
        * This class implements the default policy for sequential operations,
        * i.e. for the case where all cells get degrees of freedom.
+       *
+       * If more than one thread is available, degrees of freedom are
+       * distributed by working on chunks of cells in parallel. This yields
+       * exactly the same numbering as a sequential loop over all cells, and
+       * is also used by the other policies for numbering the locally owned
+       * cells. Likewise, renumbering works on chunks of the arrays of dof
+       * indices in parallel.
        */
       template <int dim, int spacedim>
       class Sequential : public PolicyBase<dim,spacedim>
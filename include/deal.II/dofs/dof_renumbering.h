@@ -21,12 +21,15 @@
 #include <deal.II/base/exceptions.h>
 #include <deal.II/base/point.h>
 #include <deal.II/dofs/dof_handler.h>
+#include <deal.II/grid/grid_tools.h>
 #include <deal.II/hp/dof_handler.h>
 
 #include <vector>
 
 DEAL_II_NAMESPACE_OPEN
 
+template <int dim, typename Number> class MatrixFree;
+
 /**
  * Implementation of a number of renumbering algorithms for the degrees of
  * freedom on a triangulation.
@@ -737,6 +740,84 @@ namespace DoFRenumbering
   void
   hierarchical (DoFHandler<dim> &dof_handler);
 
+  /**
+   * Renumber the degrees of freedom cell by cell, visiting the locally owned
+   * active cells in the order of their centers along a space-filling curve
+   * as computed by GridTools::compute_space_filling_curve_order(). Degrees of
+   * freedom shared between cells are numbered when they are encountered
+   * first, and degrees of freedom first encountered on the same cell retain
+   * their relative order, as in cell_wise().
+   *
+   * In contrast to hierarchical(), which follows the refinement tree and
+   * therefore only yields a local numbering if the coarse cells are ordered
+   * well, this function orders the cells by their location. Loops over cells
+   * then access vectors and matrices almost sequentially also on
+   * unstructured coarse meshes. Unlike Cuthill_McKee(), it needs no sparsity
+   * pattern and is cheap to compute.
+   *
+   * For parallel triangulations, only the locally owned degrees of freedom
+   * are renumbered, and they stay on their processor.
+   */
+  template <typename DoFHandlerType>
+  void
+  space_filling_curve (DoFHandlerType                   &dof_handler,
+                       const GridTools::SpaceFillingCurve curve = GridTools::hilbert_curve);
+
+  /**
+   * Compute the renumbering vector needed by the space_filling_curve()
+   * function. Does not perform the renumbering on the DoFHandler dofs but
+   * returns the renumbering vector, indexed by the position of each locally
+   * owned degree of freedom in the set of locally owned degrees of freedom.
+   */
+  template <typename DoFHandlerType>
+  void
+  compute_space_filling_curve (std::vector<types::global_dof_index> &new_dof_indices,
+                               const DoFHandlerType                 &dof_handler,
+                               const GridTools::SpaceFillingCurve    curve = GridTools::hilbert_curve);
+
+  /**
+   * Renumber the degrees of freedom in the order in which the cell loops of
+   * @p matrix_free first access them: batch of cells by batch of cells in
+   * the order of MatrixFree::cell_loop(), and within each batch the cells in
+   * the order of the vectorization lanes. Degrees of freedom first
+   * encountered on the same cell retain their relative order.
+   *
+   * MatrixFree groups cells into batches and reorders them to allow for
+   * vectorization and parallelism, so its cells are generally not visited in
+   * the order of the triangulation. With this numbering, the degrees of
+   * freedom read by FEEvaluation::read_dof_values() for consecutive batches
+   * are consecutive in memory, except for the ones shared with previously
+   * visited cells, which makes the access to the vector entries nearly
+   * streaming.
+   *
+   * The @p matrix_free object must have been initialized with @p
+   * dof_handler on the active cells. Since the renumbering invalidates its
+   * index data, it must be initialized again afterwards, together with any
+   * ConstraintMatrix and vector depending on the numbering. The batches of
+   * cells only depend on the mesh and on how the cells are coupled, not on
+   * the numbering of the degrees of freedom, so the new MatrixFree object
+   * visits the cells in the same order and benefits from the new numbering.
+   *
+   * For parallel triangulations, only the locally owned degrees of freedom
+   * are renumbered, and they stay on their processor.
+   */
+  template <int dim, typename Number>
+  void
+  matrix_free_data_locality (DoFHandler<dim>               &dof_handler,
+                             const MatrixFree<dim,Number>  &matrix_free);
+
+  /**
+   * Compute the renumbering vector needed by the matrix_free_data_locality()
+   * function. Does not perform the renumbering on the DoFHandler dofs but
+   * returns the renumbering vector, indexed by the position of each locally
+   * owned degree of freedom in the set of locally owned degrees of freedom.
+   */
+  template <int dim, typename Number>
+  void
+  compute_matrix_free_data_locality (std::vector<types::global_dof_index> &new_dof_indices,
+                                     const DoFHandler<dim>                &dof_handler,
+                                     const MatrixFree<dim,Number>         &matrix_free);
+
   /**
    * Renumber degrees of freedom by cell. The function takes a vector of cell
    * iterators (which needs to list <i>all</i> active cells of the DoF handler
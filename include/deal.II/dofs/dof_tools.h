@@ -448,6 +448,11 @@ namespace DoFTools
    * need to remember using SparsityPattern::compress() after generating the
    * pattern.
    *
+   * @note If the sparsity pattern is a DynamicSparsityPattern and more than
+   * one thread is available, the cells are split into chunks, each of which
+   * fills a sparsity pattern of its own on a separate thread. These are then
+   * merged into @p sparsity_pattern, see DynamicSparsityPattern::merge().
+   *
    * @ingroup constraints
    */
   template <typename DoFHandlerType, typename SparsityPatternType>
@@ -458,6 +463,33 @@ namespace DoFTools
                          const bool                 keep_constrained_dofs = true,
                          const types::subdomain_id  subdomain_id          = numbers::invalid_subdomain_id);
 
+  /**
+   * Like the previous function, but build a SparsityPattern directly instead
+   * of first creating a DynamicSparsityPattern and copying it into a
+   * SparsityPattern. @p sparsity_pattern is re-initialized with the exact
+   * number of entries in each row (plus the diagonal) and compressed
+   * afterwards, so it can be used for a SparseMatrix right away. The meaning
+   * of the other arguments is the same as for the previous function.
+   *
+   * Internally, the cells are split into chunks that fill small dynamic
+   * sparsity patterns that only store the rows touched by their cells. This
+   * is done in parallel if more than one thread is available. Since every
+   * row is stored only by the chunks whose cells couple to it, the chunk
+   * patterns together store about as many rows as there are degrees of
+   * freedom, plus the rows on the interfaces between chunks, and peak memory
+   * consumption is typically lower than when going through a
+   * DynamicSparsityPattern for all rows.
+   *
+   * @ingroup constraints
+   */
+  template <typename DoFHandlerType>
+  void
+  make_and_compress_sparsity_pattern (const DoFHandlerType      &dof_handler,
+                                      SparsityPattern           &sparsity_pattern,
+                                      const ConstraintMatrix    &constraints           = ConstraintMatrix(),
+                                      const bool                 keep_constrained_dofs = true,
+                                      const types::subdomain_id  subdomain_id          = numbers::invalid_subdomain_id);
+
   /**
    * Compute which entries of a matrix built on the given @p dof_handler may
    * possibly be nonzero, and create a sparsity pattern object that represents
@@ -52,6 +52,11 @@ template <int dim, int spacedim=dim> class FEValuesBase;
 
 namespace internal
 {
+  namespace FEValues
+  {
+    template <int dim, int spacedim> class TensorProductEvaluation;
+  }
+
   /**
    * A class whose specialization is used to define what type the curl of a
    * vector valued function corresponds to.
@@ -2695,6 +2700,18 @@ protected:
    */
   dealii::internal::FEValues::FiniteElementRelatedData<dim, spacedim> finite_element_output;
 
+  /**
+   * If the finite element is a scalar tensor product element such as FE_Q or
+   * FE_DGQ and the quadrature formula is a tensor product formula such as
+   * QGauss, an object that evaluates finite element functions by sum
+   * factorization in get_function_values(), get_function_gradients() and
+   * get_function_hessians() for scalar elements. This reduces the cost from
+   * O(p^(2 dim)) to O(p^(dim+1)) operations per cell for polynomial degree
+   * p. A null pointer otherwise, in which case these functions use the shape
+   * function values and derivatives in finite_element_output.
+   */
+  std_cxx11::unique_ptr<const dealii::internal::FEValues::TensorProductEvaluation<dim,spacedim> > tensor_product_evaluation;
+
 
   /**
    * Original update flags handed to the constructor of FEValues.
@@ -2722,10 +2739,38 @@ protected:
    * A function that checks whether the new cell is similar to the one
    * previously used. Then, a significant amount of the data can be reused,
    * e.g. the derivatives of the basis functions in real space, shape_grad.
+   *
+   * When using more than one thread, the data that is reused must not depend
+   * on which cells a thread happened to visit before, or results would
+   * differ between runs in round-off. In this case, a cell is only
+   * considered a translation if the data currently stored were computed on
+   * the first child of its parent, and the cell is a translation of that
+   * child. See get_similarity_reference_cell().
    */
   void
   check_cell_similarity (const typename Triangulation<dim,spacedim>::cell_iterator &cell);
 
+  /**
+   * Return the cell whose mapping and finite element data may be reused on
+   * @p cell when using more than one thread. This is the first child of the
+   * parent of @p cell if that child is active and @p cell is a translation
+   * of it, and @p cell itself otherwise. Since this cell only depends on the
+   * mesh, the data computed on a cell is independent of the order in which
+   * the threads visit cells.
+   */
+  static
+  typename Triangulation<dim,spacedim>::cell_iterator
+  get_similarity_reference_cell (const typename Triangulation<dim,spacedim>::cell_iterator &cell);
+
+  /**
+   * When using more than one thread, the cell on which the mapping and
+   * finite element data currently stored were computed without reusing the
+   * data of a previous cell. The data can then be reused on all cells for
+   * which get_similarity_reference_cell() returns this cell. An invalid
+   * iterator if the data can not be reused.
+   */
+  typename Triangulation<dim,spacedim>::cell_iterator similarity_reference_cell;
+
 private:
   /**
    * Copy constructor. Since objects of this class are not copyable, we make
@@ -2856,6 +2901,15 @@ private:
    */
   void initialize (const UpdateFlags update_flags);
 
+  /**
+   * When using more than one thread and check_cell_similarity() could not
+   * identify @p cell as a translation because the data of its reference
+   * cell are not stored, compute these data first, so that they can be
+   * reused on @p cell. Return whether this was done.
+   */
+  bool
+  reinit_similarity_reference_cell (const typename Triangulation<dim,spacedim>::cell_iterator &cell);
+
   /**
    * The reinit() functions do only that part of the work that requires
    * knowledge of the type of iterator. After setting present_cell(), they
@@ -0,0 +1,414 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__fe_values_vectorized_h
+#define dealii__fe_values_vectorized_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/smartpointer.h>
+#include <deal.II/base/quadrature.h>
+#include <deal.II/base/point.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/table.h>
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/base/vectorization.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe.h>
+#include <deal.II/fe/fe_update_flags.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/constraint_matrix.h>
+
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+/**
+ * A variant of the FEValues class that evaluates shape functions, their
+ * gradients, and the Jacobian determinants times quadrature weights on
+ * several cells at once, namely as many as fit into the lanes of one
+ * VectorizedArray<Number>. All quantities that differ between cells are
+ * returned as VectorizedArray objects (or tensors and points with
+ * VectorizedArray entries), with one cell per lane, so that the arithmetic
+ * of an assembly loop written in terms of them is executed with SIMD
+ * instructions for all cells of a batch at once:
+ * @code
+ *   const unsigned int n_lanes = VectorizedArray<double>::n_array_elements;
+ *   FEValuesVectorized<dim> fe_values (fe, quadrature,
+ *                                      update_gradients | update_JxW_values);
+ *   Table<2,VectorizedArray<double> > cell_matrix (dofs_per_cell, dofs_per_cell);
+ *
+ *   std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+ *   for (typename DoFHandler<dim>::active_cell_iterator
+ *        cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+ *     {
+ *       cells.push_back (cell);
+ *       if (cells.size() == n_lanes ||
+ *           cell->active_cell_index() == triangulation.n_active_cells()-1)
+ *         {
+ *           fe_values.reinit (cells);
+ *           cell_matrix.reset_values ();
+ *           for (unsigned int q=0; q<n_q_points; ++q)
+ *             for (unsigned int i=0; i<dofs_per_cell; ++i)
+ *               for (unsigned int j=0; j<dofs_per_cell; ++j)
+ *                 cell_matrix(i,j) += (fe_values.shape_grad(i,q) *
+ *                                      fe_values.shape_grad(j,q) *
+ *                                      fe_values.JxW(q));
+ *           fe_values.distribute_local_to_global (cell_matrix, constraints,
+ *                                                 system_matrix);
+ *           cells.clear ();
+ *         }
+ *     }
+ * @endcode
+ * The last batch may contain fewer cells than there are lanes. The unused
+ * lanes then repeat the data of the last cell, and their results are
+ * ignored.
+ *
+ * The class only supports what a typical matrix-based assembly of
+ * second-order problems needs: values and gradients of the shape functions
+ * of a primitive finite element, quadrature points, and the products of
+ * Jacobian determinants and quadrature weights (i.e. the flags
+ * update_values, update_gradients, update_quadrature_points and
+ * update_JxW_values). The geometry of each cell is described by the
+ * $d$-linear map between the reference cell and the vertices of the cell,
+ * as in MappingQ1; curved boundaries are not taken into account. Since the
+ * values of the shape functions on the reference cell are the same for all
+ * cells, shape_value() returns a single number.
+ *
+ * @ingroup feaccess
+ */
+template <int dim, typename Number=double>
+class FEValuesVectorized : public Subscriptor
+{
+public:
+  /**
+   * The number of cells that are evaluated at once.
+   */
+  static const unsigned int n_lanes = VectorizedArray<Number>::n_array_elements;
+
+  /**
+   * Number of quadrature points.
+   */
+  const unsigned int n_quadrature_points;
+
+  /**
+   * Number of shape functions per cell.
+   */
+  const unsigned int dofs_per_cell;
+
+  /**
+   * Constructor. Compute the values and gradients of the shape functions of
+   * @p fe on the reference cell at the points of @p quadrature. The
+   * finite element needs to be primitive.
+   */
+  FEValuesVectorized (const FiniteElement<dim> &fe,
+                      const Quadrature<dim>    &quadrature,
+                      const UpdateFlags         update_flags);
+
+  /**
+   * Compute the data on the given cells, which need to be between one and
+   * #n_lanes many. The cell <code>cells[l]</code> is associated with lane
+   * @p l of all VectorizedArray objects returned by this class.
+   */
+  void reinit (const std::vector<typename DoFHandler<dim>::active_cell_iterator> &cells);
+
+  /**
+   * Return the number of lanes that hold data of one of the cells passed to
+   * the last call of reinit().
+   */
+  unsigned int n_active_lanes () const;
+
+  /**
+   * Return the cell associated with the given lane.
+   */
+  const typename DoFHandler<dim>::active_cell_iterator &
+  get_cell (const unsigned int lane) const;
+
+  /**
+   * Return the value of shape function @p i at quadrature point @p q. This
+   * is the same on all cells.
+   */
+  Number shape_value (const unsigned int i,
+                      const unsigned int q) const;
+
+  /**
+   * Return the gradients of shape function @p i at quadrature point @p q on
+   * the cells of the present batch.
+   */
+  const Tensor<1,dim,VectorizedArray<Number> > &
+  shape_grad (const unsigned int i,
+              const unsigned int q) const;
+
+  /**
+   * Return the product of the Jacobian determinant and the quadrature weight
+   * at quadrature point @p q on the cells of the present batch.
+   */
+  const VectorizedArray<Number> &
+  JxW (const unsigned int q) const;
+
+  /**
+   * Return the location of quadrature point @p q in real space on the cells
+   * of the present batch.
+   */
+  const Point<dim,VectorizedArray<Number> > &
+  quadrature_point (const unsigned int q) const;
+
+  /**
+   * For each cell of the present batch, copy the entries of the cell matrix
+   * in the corresponding lane of @p local_matrix into a FullMatrix and add
+   * them to @p global_matrix using
+   * ConstraintMatrix::distribute_local_to_global().
+   */
+  template <typename MatrixType>
+  void
+  distribute_local_to_global (const Table<2,VectorizedArray<Number> > &local_matrix,
+                              const ConstraintMatrix                  &constraints,
+                              MatrixType                              &global_matrix) const;
+
+  /**
+   * Like the previous function, but also add the entries of the cell vectors
+   * stored in the lanes of @p local_vector to @p global_vector.
+   */
+  template <typename MatrixType, typename VectorType>
+  void
+  distribute_local_to_global (const Table<2,VectorizedArray<Number> > &local_matrix,
+                              const AlignedVector<VectorizedArray<Number> > &local_vector,
+                              const ConstraintMatrix                  &constraints,
+                              MatrixType                              &global_matrix,
+                              VectorType                              &global_vector) const;
+
+  /**
+   * Determine an estimate for the memory consumption (in bytes) of this
+   * object.
+   */
+  std::size_t memory_consumption () const;
+
+  /**
+   * Exception
+   */
+  DeclException2 (ExcInvalidNumberOfCells,
+                  unsigned int, unsigned int,
+                  << "You passed " << arg1 << " cells, but this class can only "
+                  << "work on between one and " << arg2 << " cells at a time.");
+
+private:
+  /**
+   * The finite element whose shape functions we evaluate.
+   */
+  const SmartPointer<const FiniteElement<dim>,FEValuesVectorized<dim,Number> > fe;
+
+  /**
+   * The quadrature formula.
+   */
+  const Quadrature<dim> quadrature;
+
+  /**
+   * The update flags given to the constructor.
+   */
+  const UpdateFlags update_flags;
+
+  /**
+   * The cells of the present batch.
+   */
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+
+  /**
+   * Values of the shape functions on the reference cell, indexed by shape
+   * function and quadrature point.
+   */
+  Table<2,Number> shape_values;
+
+  /**
+   * Gradients of the shape functions on the reference cell, indexed by
+   * shape function and quadrature point.
+   */
+  Table<2,Tensor<1,dim,Number> > reference_shape_gradients;
+
+  /**
+   * Values and gradients of the $d$-linear functions associated with the
+   * vertices of the reference cell, indexed by vertex and quadrature point.
+   */
+  Table<2,Number>                vertex_shape_values;
+  Table<2,Tensor<1,dim,Number> > vertex_shape_gradients;
+
+  /**
+   * Gradients of the shape functions on the cells of the present batch.
+   */
+  Table<2,Tensor<1,dim,VectorizedArray<Number> > > shape_gradients;
+
+  /**
+   * JxW values on the cells of the present batch.
+   */
+  AlignedVector<VectorizedArray<Number> > JxW_values;
+
+  /**
+   * Quadrature points on the cells of the present batch.
+   */
+  AlignedVector<Point<dim,VectorizedArray<Number> > > quadrature_points;
+};
+
+
+/*---------------------- Inline functions -----------------------------------*/
+
+#ifndef DOXYGEN
+
+template <int dim, typename Number>
+inline
+unsigned int
+FEValuesVectorized<dim,Number>::n_active_lanes () const
+{
+  return cells.size();
+}
+
+
+
+template <int dim, typename Number>
+inline
+const typename DoFHandler<dim>::active_cell_iterator &
+FEValuesVectorized<dim,Number>::get_cell (const unsigned int lane) const
+{
+  AssertIndexRange (lane, cells.size());
+  return cells[lane];
+}
+
+
+
+template <int dim, typename Number>
+inline
+Number
+FEValuesVectorized<dim,Number>::shape_value (const unsigned int i,
+                                             const unsigned int q) const
+{
+  Assert (update_flags & update_values,
+          ExcMessage ("You need to pass update_values to the constructor."));
+  return shape_values(i,q);
+}
+
+
+
+template <int dim, typename Number>
+inline
+const Tensor<1,dim,VectorizedArray<Number> > &
+FEValuesVectorized<dim,Number>::shape_grad (const unsigned int i,
+                                            const unsigned int q) const
+{
+  Assert (update_flags & update_gradients,
+          ExcMessage ("You need to pass update_gradients to the constructor."));
+  return shape_gradients(i,q);
+}
+
+
+
+template <int dim, typename Number>
+inline
+const VectorizedArray<Number> &
+FEValuesVectorized<dim,Number>::JxW (const unsigned int q) const
+{
+  Assert (update_flags & update_JxW_values,
+          ExcMessage ("You need to pass update_JxW_values to the constructor."));
+  AssertIndexRange (q, JxW_values.size());
+  return JxW_values[q];
+}
+
+
+
+template <int dim, typename Number>
+inline
+const Point<dim,VectorizedArray<Number> > &
+FEValuesVectorized<dim,Number>::quadrature_point (const unsigned int q) const
+{
+  Assert (update_flags & update_quadrature_points,
+          ExcMessage ("You need to pass update_quadrature_points to the constructor."));
+  AssertIndexRange (q, quadrature_points.size());
+  return quadrature_points[q];
+}
+
+
+
+template <int dim, typename Number>
+template <typename MatrixType>
+void
+FEValuesVectorized<dim,Number>::
+distribute_local_to_global (const Table<2,VectorizedArray<Number> > &local_matrix,
+                            const ConstraintMatrix                  &constraints,
+                            MatrixType                              &global_matrix) const
+{
+  Assert (local_matrix.size(0) == dofs_per_cell,
+          ExcDimensionMismatch (local_matrix.size(0), dofs_per_cell));
+  Assert (local_matrix.size(1) == dofs_per_cell,
+          ExcDimensionMismatch (local_matrix.size(1), dofs_per_cell));
+
+  FullMatrix<double> cell_matrix (dofs_per_cell, dofs_per_cell);
+  std::vector<types::global_dof_index> local_dof_indices (dofs_per_cell);
+  for (unsigned int lane=0; lane<cells.size(); ++lane)
+    {
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        for (unsigned int j=0; j<dofs_per_cell; ++j)
+          cell_matrix(i,j) = local_matrix(i,j)[lane];
+
+      cells[lane]->get_dof_indices (local_dof_indices);
+      constraints.distribute_local_to_global (cell_matrix, local_dof_indices,
+                                              global_matrix);
+    }
+}
+
+
+
+template <int dim, typename Number>
+template <typename MatrixType, typename VectorType>
+void
+FEValuesVectorized<dim,Number>::
+distribute_local_to_global (const Table<2,VectorizedArray<Number> >       &local_matrix,
+                            const AlignedVector<VectorizedArray<Number> > &local_vector,
+                            const ConstraintMatrix                        &constraints,
+                            MatrixType                                    &global_matrix,
+                            VectorType                                    &global_vector) const
+{
+  Assert (local_matrix.size(0) == dofs_per_cell,
+          ExcDimensionMismatch (local_matrix.size(0), dofs_per_cell));
+  Assert (local_matrix.size(1) == dofs_per_cell,
+          ExcDimensionMismatch (local_matrix.size(1), dofs_per_cell));
+  Assert (local_vector.size() == dofs_per_cell,
+          ExcDimensionMismatch (local_vector.size(), dofs_per_cell));
+
+  FullMatrix<double> cell_matrix (dofs_per_cell, dofs_per_cell);
+  Vector<double>     cell_vector (dofs_per_cell);
+  std::vector<types::global_dof_index> local_dof_indices (dofs_per_cell);
+  for (unsigned int lane=0; lane<cells.size(); ++lane)
+    {
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        {
+          for (unsigned int j=0; j<dofs_per_cell; ++j)
+            cell_matrix(i,j) = local_matrix(i,j)[lane];
+          cell_vector(i) = local_vector[i][lane];
+        }
+
+      cells[lane]->get_dof_indices (local_dof_indices);
+      constraints.distribute_local_to_global (cell_matrix, cell_vector,
+                                              local_dof_indices,
+                                              global_matrix, global_vector);
+    }
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
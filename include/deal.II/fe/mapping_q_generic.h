@@ -21,6 +21,8 @@
 #include <deal.II/base/derivative_form.h>
 #include <deal.II/base/table.h>
 #include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/smartpointer.h>
+#include <deal.II/grid/tria.h>
 #include <deal.II/grid/tria_iterator.h>
 #include <deal.II/fe/mapping.h>
 #include <deal.II/fe/fe_q.h>
@@ -96,10 +98,16 @@ public:
   MappingQGeneric (const unsigned int polynomial_degree);
 
   /**
-   * Copy constructor.
+   * Copy constructor. The cache of mapping support points set up by
+   * cache_support_points() is not copied.
    */
   MappingQGeneric (const MappingQGeneric<dim,spacedim> &mapping);
 
+  /**
+   * Destructor.
+   */
+  virtual ~MappingQGeneric ();
+
   // for documentation, see the Mapping base class
   virtual
   Mapping<dim,spacedim> *clone () const;
@@ -134,6 +142,92 @@ public:
   transform_real_to_unit_cell (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
                                const Point<spacedim>                            &p) const;
 
+  /**
+   * Map each of the points in @p real_points on @p cell to the reference
+   * cell and store the result in the corresponding entry of @p unit_points.
+   * The result is the same, up to the tolerance of the Newton iteration, as
+   * calling transform_real_to_unit_cell() for each point, but the work that
+   * only depends on the cell is done once for all points: the mapping
+   * support points are obtained only once (from the cache set up by
+   * cache_support_points() if available) and the affine approximation of
+   * the mapping that provides the initial guess of the Newton iteration is
+   * set up only once. For <tt>dim==spacedim</tt>, the Newton iteration then
+   * works on batches of VectorizedArray::n_array_elements points at a time.
+   * Points for which this iteration does not converge are passed on to
+   * transform_real_to_unit_cell().
+   *
+   * Unlike transform_real_to_unit_cell(), this function does not throw an
+   * exception of type Mapping::ExcTransformationFailed if the inversion of
+   * the mapping fails for some of the points. Instead, the first coordinate
+   * of the corresponding entries of @p unit_points is set to
+   * <tt>std::numeric_limits<double>::infinity()</tt>, so that the points
+   * for which the transformation succeeded remain usable.
+   *
+   * @p unit_points must have the same size as @p real_points.
+   */
+  void
+  transform_points_real_to_unit_cell (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+                                      const ArrayView<const Point<spacedim> >                   &real_points,
+                                      const ArrayView<Point<dim> >                              &unit_points) const;
+
+  /**
+   * @}
+   */
+
+  /**
+   * @name Caching of mapping support points
+   * @{
+   */
+
+  /**
+   * Compute the mapping support points of all active cells of @p
+   * triangulation and keep them until the triangulation changes. Computing
+   * the support points of a cell involves querying the Manifold objects of
+   * the cell, its faces and its edges, which for higher order mappings is
+   * typically the dominant cost of FEValues::reinit(). With the cache in
+   * place, fill_fe_values() and the transformations between unit and real
+   * cell merely copy the support points of active cells of @p triangulation
+   * from a table, which pays off in situations where the same mesh is
+   * used for many assembly or postprocessing passes, such as in time
+   * dependent problems.
+   *
+   * The cache is filled with as many cells as fit into @p memory_budget
+   * bytes, in the order of their active_cell_index(). The support points of
+   * the remaining cells, of cells of other triangulations and of non-active
+   * cells are computed on the fly as before.
+   *
+   * The cache is released automatically whenever the triangulation signals
+   * a change through Triangulation::Signals::any_change, e.g., upon
+   * refinement. Changes that are not signaled, such as moving vertices
+   * with GridTools::transform(), require calling this function again. The
+   * triangulation is stored by reference and must live as long as the cache
+   * is in place, i.e., until this object is destroyed or
+   * clear_support_point_cache() is called.
+   *
+   * Derived classes that compute support points from data other than the
+   * triangulation, such as MappingQEulerian, must not use the cache while
+   * that data changes.
+   */
+  void
+  cache_support_points (const Triangulation<dim,spacedim> &triangulation,
+                        const std::size_t memory_budget = static_cast<std::size_t>(-1));
+
+  /**
+   * Release the memory of the cache set up by cache_support_points() and
+   * the reference to the triangulation.
+   */
+  void
+  clear_support_point_cache ();
+
+  /**
+   * Return the number of cells whose mapping support points are currently
+   * held by the cache set up by cache_support_points(). This is zero if the
+   * cache was not set up or has been invalidated by a change of the
+   * triangulation.
+   */
+  unsigned int
+  n_cells_with_cached_support_points () const;
+
   /**
    * @}
    */
@@ -570,6 +664,15 @@ protected:
   std::vector<Point<spacedim> >
   compute_mapping_support_points (const typename Triangulation<dim,spacedim>::cell_iterator &cell) const;
 
+  /**
+   * Fill @p support_points with the mapping support points of @p cell,
+   * either from the cache set up by cache_support_points() or, if the cell
+   * is not in the cache, by calling compute_mapping_support_points().
+   */
+  void
+  get_mapping_support_points (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+                              std::vector<Point<spacedim> > &support_points) const;
+
   /**
    * Transforms the point @p p on the real cell to the corresponding point on
    * the unit cell @p cell by a Newton iteration.
@@ -617,6 +720,51 @@ protected:
   add_quad_support_points(const typename Triangulation<dim,spacedim>::cell_iterator &cell,
                           std::vector<Point<spacedim> > &a) const;
 
+private:
+  /**
+   * The triangulation whose support points are held by
+   * cached_support_points, or a null pointer if cache_support_points() has
+   * not been called.
+   */
+  SmartPointer<const Triangulation<dim,spacedim>,MappingQGeneric<dim,spacedim> > cached_triangulation;
+
+  /**
+   * The mapping support points of the first n_cached_cells active cells of
+   * cached_triangulation, with the points of one cell stored contiguously
+   * in the order returned by compute_mapping_support_points().
+   */
+  std::vector<Point<spacedim> > cached_support_points;
+
+  /**
+   * The number of active cells whose support points are held by
+   * cached_support_points.
+   */
+  unsigned int n_cached_cells;
+
+  /**
+   * The connection to the Triangulation::Signals::any_change signal of
+   * cached_triangulation.
+   */
+  boost::signals2::connection tria_listener;
+
+  /**
+   * Invalidate the cached support points. Called when the triangulation
+   * changes.
+   */
+  void tria_change_listener ();
+
+  /**
+   * Compute the support points of the cells with active_cell_index() in the
+   * half-open range [@p begin, @p end) and write them into
+   * cached_support_points. @p cells holds the iterators to all cells that
+   * are to be cached, indexed by their active_cell_index().
+   */
+  void
+  fill_support_point_cache
+  (const std::vector<typename Triangulation<dim,spacedim>::active_cell_iterator> &cells,
+   const unsigned int begin,
+   const unsigned int end);
+
   /**
    * Make MappingQ a friend since it needs to call the fill_fe_values()
    * functions on its MappingQGeneric(1) sub-object.
@@ -0,0 +1,385 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__cell_bounding_box_tree_h
+#define dealii__cell_bounding_box_tree_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/point.h>
+#include <deal.II/base/smartpointer.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/fe/mapping_q1.h>
+#include <deal.II/grid/tria.h>
+
+#include <boost/signals2.hpp>
+
+#include <utility>
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+/*!@addtogroup grid */
+/*@{*/
+
+/**
+ * A bounding volume hierarchy over the active cells of a triangulation that
+ * allows to find the cell around a given point in a time that grows only
+ * logarithmically with the number of cells. In contrast,
+ * GridTools::find_active_cell_around_point() starts from the vertex closest
+ * to the point, which requires a search over all vertices for every point.
+ * This class is therefore meant for applications that locate many points
+ * on the same mesh, such as particle tracking or the evaluation of a
+ * solution at many probe points.
+ *
+ * The tree stores an axis-parallel bounding box for each active cell and
+ * arranges the cells in a binary tree in which each node stores the
+ * bounding box of all cells below it. The boxes are computed with the given
+ * mapping: for the (bi-, tri-)linear mappings MappingQ1, MappingQ1Eulerian,
+ * and MappingQ of degree one, the box of the mapped vertices contains the
+ * whole cell. For all other mappings, the cell is sampled at a lattice of
+ * points in the reference cell and the resulting box is enlarged by a
+ * fraction of its size; should a point inside the box around the whole
+ * mesh not be found among the cells whose boxes contain it, the search
+ * falls back to GridTools::find_active_cell_around_point().
+ *
+ * Among the cells that contain a point, the cell is selected by the same
+ * criterion as in GridTools::find_active_cell_around_point(): the point
+ * must be closest to the reference cell and, among cells with the same
+ * distance, the cell on the finest level is chosen. Remaining ties are
+ * broken in favor of the cell with the smaller index.
+ *
+ * The object connects to the Triangulation::Signals::any_change signal of
+ * the triangulation, so that the tree is rebuilt on the next query after
+ * the mesh has been refined, coarsened, or otherwise changed. Moving the
+ * vertices of the triangulation does not trigger a signal; call
+ * initialize() again in that case. All query functions may be called
+ * concurrently from several threads. The function
+ * find_active_cells_around_points() locates a whole batch of points and
+ * uses several threads itself.
+ *
+ * Cells of a DoFHandler or hp::DoFHandler built on the triangulation can be
+ * obtained with the overload of find_active_cell_around_point() that takes
+ * the DoF handler as first argument.
+ *
+ * @ingroup grid
+ */
+template <int dim, int spacedim=dim>
+class CellBoundingBoxTree : public Subscriptor
+{
+public:
+  /**
+   * Typedef for the iterators to the active cells of the triangulation.
+   */
+  typedef typename Triangulation<dim,spacedim>::active_cell_iterator active_cell_iterator;
+
+  /**
+   * Maximal number of cells stored in a leaf of the tree.
+   */
+  static const unsigned int max_cells_per_leaf = 8;
+
+  /**
+   * Constructor. Creates an empty object that must be initialized with
+   * initialize() before use.
+   */
+  CellBoundingBoxTree ();
+
+  /**
+   * Constructor. Builds the tree for the active cells of @p triangulation
+   * as mapped by @p mapping.
+   */
+  CellBoundingBoxTree (const Triangulation<dim,spacedim> &triangulation,
+                       const Mapping<dim,spacedim>       &mapping = StaticMappingQ1<dim,spacedim>::mapping);
+
+  /**
+   * Destructor.
+   */
+  ~CellBoundingBoxTree ();
+
+  /**
+   * Build the tree for the active cells of @p triangulation as mapped by @p
+   * mapping. Both objects are stored by reference and must live at least as
+   * long as this object, or until clear() is called.
+   */
+  void initialize (const Triangulation<dim,spacedim> &triangulation,
+                   const Mapping<dim,spacedim>       &mapping = StaticMappingQ1<dim,spacedim>::mapping);
+
+  /**
+   * Release all memory and the references to the triangulation and the
+   * mapping.
+   */
+  void clear ();
+
+  /**
+   * Find the active cell around the point @p p. The return value has the
+   * same meaning as the one of GridTools::find_active_cell_around_point():
+   * the first element is an iterator to the cell, the second one the
+   * coordinates of the point in the reference cell of that cell.
+   *
+   * If the point is not inside any cell of the mesh, an exception of type
+   * GridTools::ExcPointNotFound is thrown.
+   */
+  std::pair<active_cell_iterator, Point<dim> >
+  find_active_cell_around_point (const Point<spacedim> &p) const;
+
+  /**
+   * Same as above, but return an iterator into the DoF handler @p mesh,
+   * which must be a DoFHandler or hp::DoFHandler built on the triangulation
+   * of this object.
+   */
+  template <typename MeshType>
+  std::pair<typename MeshType::active_cell_iterator, Point<dim> >
+  find_active_cell_around_point (const MeshType        &mesh,
+                                 const Point<spacedim> &p) const;
+
+  /**
+   * Find the active cells around all the given @p points and the
+   * coordinates of the points in the reference cells of these cells. The
+   * points are processed in parallel. For points that are not inside any
+   * cell of the mesh, the iterator in @p cells is set to the end iterator of
+   * the triangulation and the reference point is undefined; no exception is
+   * thrown in this case.
+   *
+   * The output vectors are resized to the number of points.
+   */
+  void
+  find_active_cells_around_points (const std::vector<Point<spacedim> > &points,
+                                   std::vector<active_cell_iterator>   &cells,
+                                   std::vector<Point<dim> >            &reference_points) const;
+
+  /**
+   * Return a list of all active cells whose bounding box contains the point
+   * @p p, in the order in which they are stored in the tree. Note that the
+   * point need not lie inside these cells.
+   */
+  std::vector<active_cell_iterator>
+  find_cells_with_bounding_box_around_point (const Point<spacedim> &p) const;
+
+  /**
+   * Return the lower and upper corner of the bounding box that the tree uses
+   * for the active cell @p cell. The mapped cell is guaranteed to lie
+   * inside this box only for the mappings listed in the general
+   * documentation of this class.
+   */
+  std::pair<Point<spacedim>,Point<spacedim> >
+  get_cell_bounding_box (const active_cell_iterator &cell) const;
+
+  /**
+   * Return the triangulation this object is built on.
+   */
+  const Triangulation<dim,spacedim> &get_triangulation () const;
+
+  /**
+   * Determine an estimate for the memory consumption (in bytes) of this
+   * object.
+   */
+  std::size_t memory_consumption () const;
+
+private:
+  /**
+   * A node of the tree. The node contains the cells with positions
+   * <tt>begin</tt> to <tt>end</tt> in the array #cells. Inner nodes have
+   * two children, the first one of which is stored right after the node
+   * itself and the second one at position <tt>second_child</tt>. For leaves,
+   * <tt>second_child</tt> is numbers::invalid_unsigned_int.
+   */
+  struct Node
+  {
+    Point<spacedim> lower_corner;
+    Point<spacedim> upper_corner;
+    unsigned int    begin;
+    unsigned int    end;
+    unsigned int    second_child;
+  };
+
+  /**
+   * Copy constructor. Not implemented.
+   */
+  CellBoundingBoxTree (const CellBoundingBoxTree &);
+
+  /**
+   * Copy operator. Not implemented.
+   */
+  CellBoundingBoxTree &operator = (const CellBoundingBoxTree &);
+
+  /**
+   * Build the tree if it has been invalidated by a change of the
+   * triangulation.
+   */
+  void build_if_necessary () const;
+
+  /**
+   * Build the tree.
+   */
+  void build () const;
+
+  /**
+   * Compute the bounding boxes of the cells with positions in the range
+   * [begin,end) of #cells.
+   */
+  void compute_cell_boxes (const unsigned int begin,
+                           const unsigned int end) const;
+
+  /**
+   * Compute the bounding box of a single cell. If the boxes are not exact,
+   * the cell is sampled at the #unit_points.
+   */
+  void compute_cell_box (const active_cell_iterator &cell,
+                         Point<spacedim>            &lower_corner,
+                         Point<spacedim>            &upper_corner) const;
+
+  /**
+   * Set up the node with the given index for the cells with positions
+   * <tt>order[begin]</tt> to <tt>order[end-1]</tt> in #cells, and
+   * recursively its children. The entries of @p order in this range are
+   * reordered such that the cells of each child are contiguous.
+   */
+  void build_node (const unsigned int         node,
+                   const unsigned int         begin,
+                   const unsigned int         end,
+                   std::vector<unsigned int> &order) const;
+
+  /**
+   * Look for the cell around the point. Return false if the point is not in
+   * any of the cells whose bounding boxes contain it.
+   */
+  bool find_cell_in_tree (const Point<spacedim>                       &p,
+                          std::pair<active_cell_iterator, Point<dim> > &result) const;
+
+  /**
+   * Return whether a point that has not been found in the tree may still be
+   * inside a cell that bulges out of its bounding box, and has to be
+   * searched for with GridTools::find_active_cell_around_point(). This is
+   * the case if the boxes are not exact and the point is inside the box
+   * around the whole mesh.
+   */
+  bool fallback_is_necessary (const Point<spacedim> &p) const;
+
+  /**
+   * Find the cells around the points with indices in the range
+   * [begin,end).
+   */
+  void find_cells_on_subrange (const std::vector<Point<spacedim> > *points,
+                               std::vector<active_cell_iterator>   *cells,
+                               std::vector<Point<dim> >            *reference_points,
+                               const unsigned int                   begin,
+                               const unsigned int                   end) const;
+
+  /**
+   * Function connected to the Triangulation::Signals::any_change signal.
+   */
+  void tria_change_listener ();
+
+  /**
+   * The triangulation.
+   */
+  SmartPointer<const Triangulation<dim,spacedim>,CellBoundingBoxTree<dim,spacedim> > tria;
+
+  /**
+   * The mapping used to compute the bounding boxes and to locate points
+   * inside cells.
+   */
+  SmartPointer<const Mapping<dim,spacedim>,CellBoundingBoxTree<dim,spacedim> > mapping;
+
+  /**
+   * Whether the bounding boxes are guaranteed to contain the mapped cells.
+   * If not, searches that do not find a cell in the tree fall back to
+   * GridTools::find_active_cell_around_point().
+   */
+  mutable bool boxes_are_exact;
+
+  /**
+   * The points in the reference cell at which the cells are sampled if the
+   * bounding boxes are not exact.
+   */
+  mutable std::vector<Point<dim> > unit_points;
+
+  /**
+   * Whether the tree is up to date with the triangulation.
+   */
+  mutable bool is_built;
+
+  /**
+   * The level and index of the active cells, in the order in which they
+   * appear in the leaves of the tree.
+   */
+  mutable std::vector<std::pair<int,int> > cells;
+
+  /**
+   * The lower and upper corners of the bounding boxes of the cells, in the
+   * same order as #cells.
+   */
+  mutable std::vector<std::pair<Point<spacedim>,Point<spacedim> > > cell_boxes;
+
+  /**
+   * The nodes of the tree, with the root node first.
+   */
+  mutable std::vector<Node> nodes;
+
+  /**
+   * A mutex that guards the lazy rebuild of the tree.
+   */
+  mutable Threads::Mutex mutex;
+
+  /**
+   * The connection to the Triangulation::Signals::any_change signal of the
+   * triangulation.
+   */
+  boost::signals2::connection tria_listener;
+};
+
+/*@}*/
+
+#ifndef DOXYGEN
+/*---------------------- Inline functions -----------------------------------*/
+
+
+template <int dim, int spacedim>
+inline
+const Triangulation<dim,spacedim> &
+CellBoundingBoxTree<dim,spacedim>::get_triangulation () const
+{
+  Assert (tria != 0, ExcNotInitialized());
+  return *tria;
+}
+
+
+
+template <int dim, int spacedim>
+template <typename MeshType>
+inline
+std::pair<typename MeshType::active_cell_iterator, Point<dim> >
+CellBoundingBoxTree<dim,spacedim>::
+find_active_cell_around_point (const MeshType        &mesh,
+                               const Point<spacedim> &p) const
+{
+  Assert (&mesh.get_triangulation() == &get_triangulation(),
+          ExcMessage ("The DoF handler must be built on the triangulation "
+                      "of this object."));
+  const std::pair<active_cell_iterator, Point<dim> > result
+    = find_active_cell_around_point (p);
+  return std::make_pair (typename MeshType::active_cell_iterator (&mesh.get_triangulation(),
+                                                                  result.first->level(),
+                                                                  result.first->index(),
+                                                                  &mesh),
+                         result.second);
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
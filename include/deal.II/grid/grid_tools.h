@@ -219,6 +219,63 @@ namespace GridTools
                                    std::vector<unsigned int>   &considered_vertices,
                                    const double                 tol=1e-12);
 
+  /**
+   * The space-filling curves along which compute_space_filling_curve_order()
+   * sorts points.
+   */
+  enum SpaceFillingCurve
+  {
+    /**
+     * The Hilbert curve. Points that are consecutive along this curve are
+     * always in neighboring subdivisions of the bounding box, so this curve
+     * gives the best locality.
+     */
+    hilbert_curve,
+    /**
+     * The Morton curve, also known as Z-order. It is slightly cheaper to
+     * compute than the Hilbert curve, but jumps between distant parts of the
+     * domain at the transitions between subdivisions.
+     */
+    morton_curve
+  };
+
+  /**
+   * Return the indices of the given @p points in the order in which they are
+   * visited by the space-filling @p curve through the bounding box of all
+   * points. To this end, the bounding box is subdivided into
+   * 2<sup>b</sup> intervals in each coordinate direction, with b=32 in 1d
+   * and 2d and b=21 in 3d, and the points are sorted by the position of
+   * their subdivision along the curve. Points within the same subdivision
+   * keep their relative order.
+   *
+   * Points that are close along the curve are also close in space. Working
+   * on objects in this order therefore improves the reuse of data in
+   * caches.
+   */
+  template <int spacedim>
+  std::vector<unsigned int>
+  compute_space_filling_curve_order (const std::vector<Point<spacedim> > &points,
+                                     const SpaceFillingCurve              curve = hilbert_curve);
+
+  /**
+   * Reorder the @p cells along a space-filling curve through their centers,
+   * i.e., the averages of their vertices in @p all_vertices. The vertices
+   * within each cell are not changed.
+   *
+   * The coarse cells of a Triangulation are numbered in the order in which
+   * they are passed to Triangulation::create_triangulation(), and all loops
+   * over cells, on all levels, visit the children of a coarse cell before
+   * those of the next one. Calling this function before creating a
+   * triangulation from a coarse mesh whose cells are numbered with little
+   * regard to their location, as is often the case for meshes generated by
+   * external programs, therefore makes cells that are consecutive in these
+   * loops also close in space.
+   */
+  template <int dim, int spacedim>
+  void reorder_cells_along_space_filling_curve (const std::vector<Point<spacedim> > &all_vertices,
+                                                std::vector<CellData<dim> >         &cells,
+                                                const SpaceFillingCurve              curve = hilbert_curve);
+
   /*@}*/
   /**
    * @name Rotating, stretching and otherwise transforming meshes
@@ -827,16 +884,34 @@ namespace GridTools
    * n_partitions-1. You can access the subdomain id of a cell by using
    * <tt>cell-@>subdomain_id()</tt>.
    *
-   * This function will generate an error if METIS is not installed unless @p
-   * n_partitions is one. I.e., you can write a program so that it runs in the
-   * single-processor single-partition case without METIS installed, and only
-   * requires METIS when multiple partitions are required.
+   * If deal.II was not configured with METIS, the partitioning is computed
+   * by SparsityTools::partition_multilevel() instead. Since that function
+   * is deterministic, this is also the case for the partitions computed
+   * here.
    */
   template <int dim, int spacedim>
   void
   partition_triangulation (const unsigned int  n_partitions,
                            Triangulation<dim, spacedim> &triangulation);
 
+  /**
+   * Like the previous function, but take into account that cells may
+   * represent different amounts of work, for example because they use finite
+   * elements of different polynomial degrees, or because some of them carry
+   * particles. The partitioning then attempts to make the sum of the @p
+   * cell_weights of the cells in each subdomain about equal, rather than
+   * their number, while still cutting few connections between cells.
+   *
+   * @p cell_weights is indexed by the <code>cell-@>active_cell_index()</code>
+   * of cells and needs to have as many entries as there are active cells in
+   * the triangulation. If it is empty, all cells have weight one.
+   */
+  template <int dim, int spacedim>
+  void
+  partition_triangulation (const unsigned int               n_partitions,
+                           const std::vector<unsigned int> &cell_weights,
+                           Triangulation<dim, spacedim>    &triangulation);
+
   /**
    * This function does the same as the previous one, i.e. it partitions a
    * triangulation using METIS into a number of subdomains identified by the
@@ -885,6 +960,17 @@ namespace GridTools
                            const SparsityPattern &cell_connection_graph,
                            Triangulation<dim,spacedim>    &triangulation);
 
+  /**
+   * Like the previous function, but with weights for the cells, as explained
+   * in the documentation of the second function of this name.
+   */
+  template <int dim, int spacedim>
+  void
+  partition_triangulation (const unsigned int               n_partitions,
+                           const std::vector<unsigned int> &cell_weights,
+                           const SparsityPattern           &cell_connection_graph,
+                           Triangulation<dim,spacedim>     &triangulation);
+
   /**
    * For each active cell, return in the output array to which subdomain (as
    * given by the <tt>cell->subdomain_id()</tt> function) it belongs. The
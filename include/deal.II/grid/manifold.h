@@ -239,6 +239,21 @@ namespace Manifolds
  * approximate the limit process, and derived classes should do so.
  *
  *
+ * <h3>Thread safety</h3>
+ *
+ * When a three-dimensional Triangulation is refined, the new vertices at
+ * the centers of lines, quads and hexes are computed on several threads
+ * concurrently, i.e., the <code>get_new_point*</code> functions of the
+ * same manifold object may be called from different threads at the same
+ * time. Implementations of these functions in derived classes therefore
+ * need to be thread-safe: they must not modify member variables (for
+ * example to cache intermediate results) unless such accesses are
+ * protected, e.g., by a Threads::Mutex. All manifolds provided by the
+ * library satisfy this requirement, provided that the Function objects
+ * given to a FunctionManifold do so as well. If a manifold can not be made
+ * thread-safe, the number of threads can be limited to one by calling
+ * MultithreadInfo::set_thread_limit(1) before refining the mesh.
+ *
  * @ingroup manifold
  * @author Luca Heltai, Wolfgang Bangerth, 2014, 2016
  */
@@ -3023,7 +3023,7 @@ CellAccessor<dim,spacedim>::neighbor_index (const unsigned int i) const
 {
   AssertIndexRange (i,GeometryInfo<dim>::faces_per_cell);
   return this->tria->levels[this->present_level]->
-         neighbors[this->present_index*GeometryInfo<dim>::faces_per_cell+i].second;
+         neighbor_indices[this->present_index*GeometryInfo<dim>::faces_per_cell+i];
 }
 
 
@@ -3034,8 +3034,8 @@ int
 CellAccessor<dim,spacedim>::neighbor_level (const unsigned int i) const
 {
   AssertIndexRange (i, GeometryInfo<dim>::faces_per_cell);
-  return this->tria->levels[this->present_level]->
-         neighbors[this->present_index*GeometryInfo<dim>::faces_per_cell+i].first;
+  return static_cast<int>(this->tria->levels[this->present_level]->
+                          neighbor_levels[this->present_index*GeometryInfo<dim>::faces_per_cell+i]) - 1;
 }
 
 
@@ -69,6 +69,10 @@ DEAL_II_NAMESPACE_OPEN
  * boundary indicators and the like, as well as all other information provided
  * by these objects.
  *
+ * In 3d, the functions computing new points are called from several threads
+ * concurrently and therefore need to be thread-safe; see the section on
+ * thread safety in the documentation of the Manifold base class.
+ *
  * There are specializations, StraightBoundary, which places the new point
  * right into the middle of the given points, and HyperBallBoundary creating a
  * hyperball with given radius around a given center point.
@@ -79,19 +79,17 @@ namespace internal
       std::vector<unsigned int> active_cell_indices;
 
       /**
-       * Levels and indices of the neighbors of the cells. Convention is, that
-       * the neighbors of the cell with index @p i are stored in the fields
+       * Indices of the neighbors of the cells. Convention is, that the
+       * neighbors of the cell with index @p i are stored in the fields
        * following $i*(2*real\_space\_dimension)$, e.g. in one spatial
        * dimension, the neighbors of cell 0 are stored in
-       * <tt>neighbors[0]</tt> and <tt>neighbors[1]</tt>, the neighbors of
-       * cell 1 are stored in <tt>neighbors[2]</tt> and <tt>neighbors[3]</tt>,
-       * and so on.
+       * <tt>neighbor_indices[0]</tt> and <tt>neighbor_indices[1]</tt>, the
+       * neighbors of cell 1 are stored in <tt>neighbor_indices[2]</tt> and
+       * <tt>neighbor_indices[3]</tt>, and so on. The levels of the neighbors
+       * are stored in the same order in #neighbor_levels.
        *
-       * In neighbors, <tt>neighbors[i].first</tt> is the level, while
-       * <tt>neighbors[i].first</tt> is the index of the neighbor.
-       *
-       * If a neighbor does not exist (cell is at the boundary),
-       * <tt>level=index=-1</tt> is set.
+       * If a neighbor does not exist (cell is at the boundary), the index -1
+       * is set.
        *
        * <em>Conventions:</em> The @p ith neighbor of a cell is the one which
        * shares the @p ith face (@p Line in 2D, @p Quad in 3D) of this cell.
@@ -111,7 +109,21 @@ namespace internal
        * level down (in which case its neighbor pointer points to the mother
        * cell of this cell).
        */
-      std::vector<std::pair<int,int> > neighbors;
+      std::vector<int> neighbor_indices;
+
+      /**
+       * Levels of the neighbors of the cells, in the same order as
+       * #neighbor_indices. In order to reduce the memory needed for the
+       * neighbor information, we do not store the level as an integer next
+       * to the index, but store the level plus one in a separate array of
+       * two-byte integers, with zero denoting a non-existing neighbor. Note
+       * that accessing both the level and the index of a neighbor thus
+       * touches two arrays. The number of levels is limited to 65535, which
+       * is checked when neighbors are set and is far beyond the about 1000
+       * levels after which cells are too small to be represented in double
+       * precision.
+       */
+      std::vector<unsigned short> neighbor_levels;
 
       /**
        * One integer per cell to store which subdomain it belongs to. This
@@ -219,7 +231,8 @@ namespace internal
       std::vector<unsigned char> refine_flags;
       std::vector<bool> coarsen_flags;
       std::vector<unsigned int> active_cell_indices;
-      std::vector<std::pair<int,int> > neighbors;
+      std::vector<int> neighbor_indices;
+      std::vector<unsigned short> neighbor_levels;
       std::vector<types::subdomain_id> subdomain_ids;
       std::vector<types::subdomain_id> level_subdomain_ids;
       std::vector<int> parents;
@@ -268,6 +281,41 @@ namespace internal
 
 
 
+    /**
+     * Write or read the neighbor levels and indices in the format used before
+     * they were stored in separate arrays, i.e., as one vector of pairs of
+     * level and index, so that previously written archives can still be read.
+     */
+    template <class Archive>
+    void serialize_neighbors (Archive                     &ar,
+                              std::vector<int>            &neighbor_indices,
+                              std::vector<unsigned short> &neighbor_levels)
+    {
+      std::vector<std::pair<int,int> > neighbors;
+      if (Archive::is_saving::value)
+        {
+          neighbors.resize (neighbor_indices.size());
+          for (unsigned int i=0; i<neighbors.size(); ++i)
+            neighbors[i] = std::make_pair (static_cast<int>(neighbor_levels[i]) - 1,
+                                           neighbor_indices[i]);
+        }
+
+      ar &neighbors;
+
+      if (Archive::is_loading::value)
+        {
+          neighbor_indices.resize (neighbors.size());
+          neighbor_levels.resize (neighbors.size());
+          for (unsigned int i=0; i<neighbors.size(); ++i)
+            {
+              neighbor_levels[i] = neighbors[i].first + 1;
+              neighbor_indices[i] = neighbors[i].second;
+            }
+        }
+    }
+
+
+
     template <int dim>
     template <class Archive>
     void TriaLevel<dim>::serialize(Archive &ar,
@@ -279,7 +327,7 @@ namespace internal
       // to the stream and re-reading them again later, we just rebuild them
       // in Triangulation::load()
 
-      ar &neighbors;
+      serialize_neighbors (ar, neighbor_indices, neighbor_levels);
       ar &subdomain_ids;
       ar &level_subdomain_ids;
       ar &parents;
@@ -299,7 +347,7 @@ namespace internal
       // to the stream and re-reading them again later, we just rebuild them
       // in Triangulation::load()
 
-      ar &neighbors;
+      serialize_neighbors (ar, neighbor_indices, neighbor_levels);
       ar &subdomain_ids;
       ar &level_subdomain_ids;
       ar &parents;
@@ -273,6 +273,21 @@ namespace internal
       template <int dim, int spacedim>
       void uncompress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection);
 
+      /**
+       * Return whether the @p n_dofs entries of the dof_indices array
+       * starting at @p offset are numbered consecutively and can therefore be
+       * stored in compressed form.
+       */
+      bool is_compressible (const offset_type  offset,
+                            const unsigned int n_dofs) const;
+
+      /**
+       * Remove the marks that indicate compressed storage from the
+       * active_fe_indices array. This is necessary whenever the dof_indices
+       * array is set up anew without the compressed data it corresponded to.
+       */
+      void normalize_active_fe_indices ();
+
       /**
        * Make hp::DoFHandler and its auxiliary class a friend since it is the
        * class that needs to create these data structures.
@@ -304,7 +319,7 @@ namespace internal
                           "information for an object on which no such "
                           "information is available"));
 
-      Assert (fe_index == active_fe_indices[obj_index],
+      Assert (fe_index == active_fe_index(obj_index),
               ExcMessage ("FE index does not match that of the present cell"));
 
       // see if the dof_indices array has been compressed for this
@@ -380,7 +395,10 @@ namespace internal
       Assert (obj_index < active_fe_indices.size(),
               ExcIndexRange (obj_index, 0, active_fe_indices.size()));
 
-      active_fe_indices[obj_index] = fe_index;
+      // do not destroy the information that the dof indices of this cell
+      // are stored in compressed form if the index does not actually change
+      if (active_fe_index(obj_index) != fe_index)
+        active_fe_indices[obj_index] = fe_index;
     }
 
 
@@ -418,6 +418,20 @@ public:
    */
   void symmetrize ();
 
+  /**
+   * Add all entries of the sparsity patterns pointed to by the elements of
+   * the argument to the current object. All of these objects need to have
+   * the same number of rows and columns as the current one, but they may
+   * store different sets of rows. As in add(), entries in rows that the
+   * current object does not store are ignored.
+   *
+   * Since rows do not depend on each other, they are merged on several
+   * threads if these are available. This function is therefore the final
+   * step of building a sparsity pattern concurrently by letting several
+   * threads fill separate objects, see DoFTools::make_sparsity_pattern().
+   */
+  void merge (const std::vector<const DynamicSparsityPattern *> &sparsity_patterns);
+
   /**
    * Print the sparsity pattern. The output consists of one line per row of
    * the format <tt>[i,j1,j2,j3,...]</tt>. <i>i</i> is the row number and
@@ -559,6 +573,15 @@ public:
   size_type memory_consumption () const;
 
 private:
+  /**
+   * Merge the rows with local indices between @p begin and @p end of the
+   * given sparsity patterns into the current object. Helper function for
+   * merge().
+   */
+  void merge_rows (const size_type                                    begin,
+                   const size_type                                    end,
+                   const std::vector<const DynamicSparsityPattern *> &sparsity_patterns);
+
   /**
    * A flag that stores whether any entries have been added so far.
    */
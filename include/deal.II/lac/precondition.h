@@ -499,6 +499,17 @@ public:
    */
   template<class VectorType>
   void Tstep (VectorType &x, const VectorType &rhs) const;
+
+  /**
+   * Apply the preconditioner to a single vector entry with global index @p
+   * index, i.e., return @p value times the relaxation parameter divided by
+   * the diagonal entry of the matrix in row @p index. SolverCG detects this
+   * function and applies the preconditioner in the same sweep through the
+   * vectors as its vector updates.
+   */
+  template <typename Number>
+  Number apply (const types::global_dof_index index,
+                const Number                  value) const;
 };
 
 
@@ -805,6 +816,23 @@ private:
  * This class is useful e.g. in multigrid smoother objects, since it is
  * trivially %parallel (assuming that matrix-vector products are %parallel).
  *
+ * If the matrix provides a function <tt>void vmult (VectorType &dst, const
+ * VectorType &src, const std_cxx11::function<void(const unsigned int, const
+ * unsigned int)> &operation_before_matrix_vector_product, const
+ * std_cxx11::function<void(const unsigned int, const unsigned int)>
+ * &operation_after_matrix_vector_product) const</tt>, this class uses it to
+ * merge the vector updates of the Chebyshev iteration into the
+ * matrix-vector product. The matrix must compute <tt>dst = A src</tt> and
+ * call the two operations on ranges <tt>[begin,end)</tt> of locally owned
+ * vector entries before the product first touches these entries and after
+ * the final values of @p dst are available in this range and @p src is not
+ * read any more, respectively. This is the pattern offered by the
+ * MatrixFree::cell_loop() variant with operations before and after the
+ * loop. As a consequence, each vector needs to be read from main memory
+ * only once per Chebyshev step. The optimization requires that the vectors
+ * provide access to their locally owned entries through
+ * <tt>VectorType::begin()</tt> like the deal.II vector classes do.
+ *
  * @author Martin Kronbichler, 2009; extension for full compatibility with
  * LinearOperator class: Jean-Paul Pelteret, 2015
  */
@@ -1265,6 +1293,18 @@ PreconditionJacobi<MatrixType>::Tstep (VectorType &dst, const VectorType &src) c
 
 
 
+template <typename MatrixType>
+template <typename Number>
+inline Number
+PreconditionJacobi<MatrixType>::apply (const types::global_dof_index index,
+                                       const Number                  value) const
+{
+  Assert (this->A!=0, ExcNotInitialized());
+  return static_cast<Number>(this->relaxation * value / this->A->diag_element(index));
+}
+
+
+
 //---------------------------------------------------------------------------
 
 template <typename MatrixType>
@@ -1730,6 +1770,78 @@ namespace internal
       VectorUpdatesRange<Number>(upd, src.local_size());
     }
 
+    // detects whether the matrix provides a vmult function that runs
+    // operations on ranges of vector entries before and after the
+    // matrix-vector product
+    template <typename MatrixType, typename VectorType>
+    struct has_vmult_with_std_functions
+    {
+    private:
+      typedef std_cxx11::function<void (const unsigned int,
+                                        const unsigned int)> RangeFunction;
+
+      template <typename T,
+                void (T::*)(VectorType &, const VectorType &,
+                            const RangeFunction &, const RangeFunction &) const>
+      struct Helper {};
+
+      template <typename T>
+      static char detect (Helper<T,&T::vmult> *);
+
+      template <typename T>
+      static long detect (...);
+
+    public:
+      static const bool value = (sizeof(detect<MatrixType>(0)) == sizeof(char));
+    };
+
+    // one step of the Chebyshev iteration with separate matrix-vector
+    // product and vector updates
+    template <typename MatrixType, typename VectorType>
+    inline
+    void
+    vmult_and_update (const MatrixType &matrix,
+                      const VectorType &src,
+                      const VectorType &matrix_diagonal_inverse,
+                      const double      factor1,
+                      const double      factor2,
+                      VectorType       &update1,
+                      VectorType       &update2,
+                      VectorType       &dst,
+                      internal::bool2type<false>)
+    {
+      matrix.vmult (update2, dst);
+      vector_updates (src, matrix_diagonal_inverse, false, factor1, factor2,
+                      update1, update2, dst);
+    }
+
+    // one step of the Chebyshev iteration where the vector updates are run
+    // by the matrix on the ranges of vector entries that the matrix-vector
+    // product has completed, while the entries are still in cache
+    template <typename MatrixType, typename VectorType>
+    inline
+    void
+    vmult_and_update (const MatrixType &matrix,
+                      const VectorType &src,
+                      const VectorType &matrix_diagonal_inverse,
+                      const double      factor1,
+                      const double      factor2,
+                      VectorType       &update1,
+                      VectorType       &update2,
+                      VectorType       &dst,
+                      internal::bool2type<true>)
+    {
+      typedef typename VectorType::value_type Number;
+      VectorUpdater<Number> upd(src.begin(), matrix_diagonal_inverse.begin(),
+                                false, factor1, factor2,
+                                update1.begin(), update2.begin(), dst.begin());
+      matrix.vmult (update2, dst,
+                    std_cxx11::function<void (const unsigned int,
+                                              const unsigned int)>(),
+                    std_cxx11::bind (&VectorUpdater<Number>::apply_to_subrange,
+                                     &upd, std_cxx11::_1, std_cxx11::_2));
+    }
+
     template <typename VectorType>
     struct DiagonalPreconditioner
     {
@@ -1902,14 +2014,13 @@ PreconditionChebyshev<MatrixType,VectorType>::vmult (VectorType       &dst,
                                                      const VectorType &src) const
 {
   Assert (is_initialized, ExcMessage("Preconditioner not initialized"));
+  const internal::bool2type<internal::PreconditionChebyshev::
+  has_vmult_with_std_functions<MatrixType,VectorType>::value> fuse_updates;
   double rhok  = delta / theta,  sigma = theta / delta;
   if (data.nonzero_starting && !dst.all_zero())
-    {
-      matrix_ptr->vmult (update2, dst);
-      internal::PreconditionChebyshev::vector_updates
-      (src, data.matrix_diagonal_inverse, false, 0., 1./theta, update1,
-       update2, dst);
-    }
+    internal::PreconditionChebyshev::vmult_and_update
+    (*matrix_ptr, src, data.matrix_diagonal_inverse, 0., 1./theta, update1,
+     update2, dst, fuse_updates);
   else
     internal::PreconditionChebyshev::vector_updates
     (src, data.matrix_diagonal_inverse, true, 0., 1./theta, update1,
@@ -1917,13 +2028,12 @@ PreconditionChebyshev<MatrixType,VectorType>::vmult (VectorType       &dst,
 
   for (unsigned int k=0; k<data.degree; ++k)
     {
-      matrix_ptr->vmult (update2, dst);
       const double rhokp = 1./(2.*sigma-rhok);
       const double factor1 = rhokp * rhok, factor2 = 2.*rhokp/delta;
       rhok = rhokp;
-      internal::PreconditionChebyshev::vector_updates
-      (src, data.matrix_diagonal_inverse, false, factor1, factor2, update1,
-       update2, dst);
+      internal::PreconditionChebyshev::vmult_and_update
+      (*matrix_ptr, src, data.matrix_diagonal_inverse, factor1, factor2,
+       update1, update2, dst, fuse_updates);
     }
 }
 
@@ -24,12 +24,25 @@
 #include <deal.II/base/exceptions.h>
 #include <deal.II/base/logstream.h>
 #include <deal.II/base/subscriptor.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/template_constraints.h>
 #include <cmath>
+#include <utility>
+#include <vector>
 
 DEAL_II_NAMESPACE_OPEN
 
 // forward declaration
 class PreconditionIdentity;
+template <typename Number> class Vector;
+namespace LinearAlgebra
+{
+  namespace distributed
+  {
+    template <typename Number> class Vector;
+  }
+}
 
 
 /*!@addtogroup Solvers */
@@ -86,6 +99,29 @@ class PreconditionIdentity;
  * @deprecated Alternatively these estimates can be written to deallog by
  * setting flags in @p AdditionalData.
  *
+ *
+ * <h3>Merged vector updates with pointwise preconditioners</h3>
+ *
+ * Since the work of a cg iteration apart from the matrix-vector product is
+ * dominated by memory transfer, it is beneficial to merge the vector updates
+ * of an iteration into as few passes through the vectors as possible. If the
+ * preconditioner acts on each vector entry separately, like a diagonal
+ * (Jacobi) preconditioner, it can signal this to the solver by providing a
+ * member function
+ * @code
+ *   Number apply (const types::global_dof_index index,
+ *                 const Number                  value) const;
+ * @endcode
+ * that returns the preconditioned value of a vector entry with the given
+ * (global) index, where @p Number is the @p value_type of the vector. For
+ * vectors of type Vector and LinearAlgebra::distributed::Vector, the solver
+ * then performs the update of the solution and the residual, the
+ * application of the preconditioner, and the computation of the residual
+ * norm and the inner product for the next search direction in one single
+ * sweep through the vectors, combining the two inner products into one
+ * global reduction. PreconditionJacobi provides this function. The
+ * iterates are the same as with separate vector operations up to roundoff.
+ *
  * <h3>Observing the progress of linear solver iterations</h3>
  *
  * The solve() function of this class uses the mechanism described in the
@@ -450,6 +486,205 @@ SolverCG<VectorType>::compute_eigs_and_cond
 
 
 
+namespace internal
+{
+  namespace SolverCG
+  {
+    // detects whether the preconditioner provides a function apply(index,
+    // value) that applies the preconditioner to a single vector entry
+    template <typename PreconditionerType, typename Number>
+    struct has_apply
+    {
+    private:
+      template <typename T,
+                Number (T::*)(const types::global_dof_index, const Number) const>
+      struct Helper {};
+
+      template <typename T>
+      static char detect (Helper<T,&T::apply> *);
+
+      template <typename T>
+      static long detect (...);
+
+    public:
+      static const bool value = (sizeof(detect<PreconditionerType>(0)) == sizeof(char));
+    };
+
+    // the vector types for which the solver can access the locally owned
+    // entries directly
+    template <typename VectorType>
+    struct is_supported_vector
+    {
+      static const bool value = false;
+    };
+
+    template <typename Number>
+    struct is_supported_vector<dealii::Vector<Number> >
+    {
+      static const bool value = true;
+    };
+
+    template <typename Number>
+    struct is_supported_vector<LinearAlgebra::distributed::Vector<Number> >
+    {
+      static const bool value = true;
+    };
+
+    template <typename VectorType, typename PreconditionerType>
+    struct use_merged_updates
+    {
+      static const bool value =
+        is_supported_vector<VectorType>::value &&
+        has_apply<PreconditionerType,typename VectorType::value_type>::value;
+    };
+
+    template <typename Number>
+    inline
+    types::global_dof_index
+    local_size (const dealii::Vector<Number> &vec)
+    {
+      return vec.size();
+    }
+
+    template <typename Number>
+    inline
+    types::global_dof_index
+    local_size (const LinearAlgebra::distributed::Vector<Number> &vec)
+    {
+      return vec.local_size();
+    }
+
+    template <typename Number>
+    inline
+    types::global_dof_index
+    first_local_index (const dealii::Vector<Number> &)
+    {
+      return 0;
+    }
+
+    template <typename Number>
+    inline
+    types::global_dof_index
+    first_local_index (const LinearAlgebra::distributed::Vector<Number> &vec)
+    {
+      return vec.local_range().first;
+    }
+
+    template <typename Number>
+    inline
+    void
+    sum_over_processors (const dealii::Vector<Number> &,
+                         std::vector<double>          &)
+    {}
+
+    template <typename Number>
+    inline
+    void
+    sum_over_processors (const LinearAlgebra::distributed::Vector<Number> &vec,
+                         std::vector<double>                              &values)
+    {
+      const std::vector<double> local_values (values);
+      Utilities::MPI::sum (local_values, vec.get_mpi_communicator(), values);
+    }
+
+    // Number of vector entries whose partial sums are accumulated together
+    // in the merged update. The inner products are summed up chunk by chunk
+    // in a fixed order, so the result does not depend on the number of
+    // threads.
+    const unsigned int merged_update_chunk_size = 512;
+
+    // applies x += alpha d and g += alpha h, then h = P g, and computes the
+    // partial sums of g*g and g*h on a range of chunks
+    template <typename PreconditionerType, typename Number>
+    void
+    merged_update_on_chunks (const PreconditionerType     *preconditioner,
+                             const double                  alpha,
+                             const types::global_dof_index size,
+                             const types::global_dof_index offset,
+                             Number                       *x,
+                             Number                       *g,
+                             Number                       *h,
+                             const Number                 *d,
+                             double                       *partial_sums,
+                             const unsigned int            begin_chunk,
+                             const unsigned int            end_chunk)
+    {
+      for (unsigned int c=begin_chunk; c<end_chunk; ++c)
+        {
+          const types::global_dof_index begin = c * merged_update_chunk_size;
+          const types::global_dof_index end =
+            std::min (size, begin + merged_update_chunk_size);
+          double norm_sqr = 0, inner_product = 0;
+          for (types::global_dof_index i=begin; i<end; ++i)
+            {
+              x[i] += alpha * d[i];
+              const Number g_i = g[i] + alpha * h[i];
+              const Number h_i = preconditioner->apply (offset+i, g_i);
+              g[i] = g_i;
+              h[i] = h_i;
+              norm_sqr += g_i * g_i;
+              inner_product += g_i * h_i;
+            }
+          partial_sums[2*c] = norm_sqr;
+          partial_sums[2*c+1] = inner_product;
+        }
+    }
+
+    // performs the updates of the solution and the residual together with
+    // the preconditioner application in one sweep and returns g*g and g*h
+    template <typename PreconditionerType, typename VectorType>
+    std::pair<double,double>
+    merged_update (const PreconditionerType &preconditioner,
+                   const double              alpha,
+                   VectorType               &x,
+                   VectorType               &g,
+                   VectorType               &h,
+                   const VectorType         &d,
+                   internal::bool2type<true>)
+    {
+      const types::global_dof_index size = local_size (x);
+      const unsigned int n_chunks =
+        (size + merged_update_chunk_size - 1) / merged_update_chunk_size;
+      std::vector<double> partial_sums (2*n_chunks);
+      if (n_chunks > 0)
+        parallel::apply_to_subranges
+        (0U, n_chunks,
+         std_cxx11::bind (&merged_update_on_chunks<PreconditionerType,
+                          typename VectorType::value_type>,
+                          &preconditioner, alpha, size, first_local_index (x),
+                          x.begin(), g.begin(), h.begin(), d.begin(),
+                          &partial_sums[0], std_cxx11::_1, std_cxx11::_2),
+         std::max (1U, internal::Vector::minimum_parallel_grain_size /
+                   merged_update_chunk_size));
+
+      std::vector<double> sums (2, 0.);
+      for (unsigned int c=0; c<n_chunks; ++c)
+        {
+          sums[0] += partial_sums[2*c];
+          sums[1] += partial_sums[2*c+1];
+        }
+      sum_over_processors (x, sums);
+      return std::make_pair (sums[0], sums[1]);
+    }
+
+    template <typename PreconditionerType, typename VectorType>
+    std::pair<double,double>
+    merged_update (const PreconditionerType &,
+                   const double,
+                   VectorType &,
+                   VectorType &,
+                   VectorType &,
+                   const VectorType &,
+                   internal::bool2type<false>)
+    {
+      Assert (false, ExcInternalError());
+      return std::pair<double,double>();
+    }
+  }
+}
+
+
+
 template <typename VectorType>
 template <typename MatrixType, typename PreconditionerType>
 void
@@ -485,6 +720,11 @@ SolverCG<VectorType>::solve (const MatrixType         &A,
   int  it=0;
   double res = -std::numeric_limits<double>::max();
 
+  // merge the vector updates with the preconditioner application if the
+  // preconditioner works on individual vector entries
+  const bool merge_updates =
+    internal::SolverCG::use_merged_updates<VectorType,PreconditionerType>::value;
+
   try
     {
       // define some aliases for simpler access
@@ -542,32 +782,57 @@ SolverCG<VectorType>::solve (const MatrixType         &A,
           Assert(alpha != 0., ExcDivideByZero());
           alpha = gh/alpha;
 
-          x.add(alpha,d);
-          res = std::sqrt(g.add_and_dot(alpha, h, g));
+          if (merge_updates == true)
+            {
+              // update x and g, apply the preconditioner, and compute both
+              // inner products in one sweep through the vectors
+              const std::pair<double,double> products =
+                internal::SolverCG::merged_update
+                (precondition, alpha, x, g, h, d,
+                 internal::bool2type<merge_updates>());
+              res = std::sqrt(products.first);
 
-          print_vectors(it, x, g, d);
+              print_vectors(it, x, g, d);
 
-          conv = this->iteration_status(it, res, x);
-          if (conv != SolverControl::iterate)
-            break;
-
-          if (types_are_equal<PreconditionerType,PreconditionIdentity>::value
-              == false)
-            {
-              precondition.vmult(h,g);
+              conv = this->iteration_status(it, res, x);
+              if (conv != SolverControl::iterate)
+                break;
 
               beta = gh;
               Assert(beta != 0., ExcDivideByZero());
-              gh   = g*h;
+              gh   = products.second;
               beta = gh/beta;
               d.sadd(beta,-1.,h);
             }
           else
             {
-              beta = gh;
-              gh = res*res;
-              beta = gh/beta;
-              d.sadd(beta,-1.,g);
+              x.add(alpha,d);
+              res = std::sqrt(g.add_and_dot(alpha, h, g));
+
+              print_vectors(it, x, g, d);
+
+              conv = this->iteration_status(it, res, x);
+              if (conv != SolverControl::iterate)
+                break;
+
+              if (types_are_equal<PreconditionerType,PreconditionIdentity>::value
+                  == false)
+                {
+                  precondition.vmult(h,g);
+
+                  beta = gh;
+                  Assert(beta != 0., ExcDivideByZero());
+                  gh   = g*h;
+                  beta = gh/beta;
+                  d.sadd(beta,-1.,h);
+                }
+              else
+                {
+                  beta = gh;
+                  gh = res*res;
+                  beta = gh/beta;
+                  d.sadd(beta,-1.,g);
+                }
             }
 
           this->coefficients_signal(alpha,beta);
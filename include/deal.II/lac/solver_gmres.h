@@ -21,6 +21,8 @@
 #include <deal.II/base/config.h>
 #include <deal.II/base/subscriptor.h>
 #include <deal.II/base/logstream.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/parallel.h>
 #include <deal.II/lac/householder.h>
 #include <deal.II/lac/solver.h>
 #include <deal.II/lac/solver_control.h>
@@ -34,6 +36,14 @@
 
 DEAL_II_NAMESPACE_OPEN
 
+namespace LinearAlgebra
+{
+  namespace distributed
+  {
+    template <typename Number> class Vector;
+  }
+}
+
 /*!@addtogroup Solvers */
 /*@{*/
 
@@ -238,6 +248,33 @@ public:
      */
     bool force_re_orthogonalization;
 
+    /**
+     * Algorithms for orthogonalizing a new Krylov vector against the
+     * previous ones.
+     */
+    enum OrthogonalizationStrategy
+    {
+      /**
+       * Modified Gram-Schmidt, which computes the inner products with the
+       * previous vectors one after the other. This needs one global
+       * reduction per basis vector.
+       */
+      modified_gram_schmidt,
+      /**
+       * Classical Gram-Schmidt, which computes the inner products with all
+       * previous vectors in one pass through the vectors and one global
+       * reduction. If the norm of the orthogonalized vector indicates a loss
+       * of orthogonality, a second classical Gram-Schmidt pass is applied.
+       */
+      classical_gram_schmidt
+    };
+
+    /**
+     * The algorithm used for orthogonalization. Defaults to
+     * modified_gram_schmidt.
+     */
+    OrthogonalizationStrategy orthogonalization_strategy;
+
     /**
      * Compute all eigenvalues of the Hessenberg matrix generated while
      * solving, i.e., the projected system matrix. This gives an approximation
@@ -403,6 +440,24 @@ protected:
                          Vector<double>                                      &h,
                          bool                                                &re_orthogonalize);
 
+  /**
+   * Orthogonalize the vector @p vv against the @p dim (orthogonal) vectors
+   * given by the first argument using the classical Gram-Schmidt algorithm,
+   * computing all inner products in one pass through the vectors. The norm
+   * of the orthogonalized vector is obtained from the inner products by the
+   * Pythagorean theorem. If it has shrunk by more than a factor
+   * $1/\sqrt{2}$ against the norm of the input vector or @p re_orthogonalize
+   * is set, a second classical Gram-Schmidt pass is applied. Returns the
+   * norm of the orthogonalized vector and stores the factors used for
+   * orthogonalization in @p h.
+   */
+  static double
+  classical_gram_schmidt (const internal::SolverGMRES::TmpVectors<VectorType> &orthogonal_vectors,
+                          const unsigned int                                  dim,
+                          VectorType                                          &vv,
+                          Vector<double>                                      &h,
+                          const bool                                          re_orthogonalize);
+
   /**
    * Estimates the eigenvalues from the Hessenberg matrix, H_orig, generated
    * during the inner iterations. Uses these estimate to compute the condition
@@ -617,6 +672,7 @@ AdditionalData (const unsigned int max_n_tmp_vectors,
   right_preconditioning(right_preconditioning),
   use_default_residual(use_default_residual),
   force_re_orthogonalization(force_re_orthogonalization),
+  orthogonalization_strategy(modified_gram_schmidt),
   compute_eigenvalues(false)
 {}
 
@@ -635,6 +691,7 @@ AdditionalData (const unsigned int max_n_tmp_vectors,
   right_preconditioning(right_preconditioning),
   use_default_residual(use_default_residual),
   force_re_orthogonalization(force_re_orthogonalization),
+  orthogonalization_strategy(modified_gram_schmidt),
   compute_eigenvalues(compute_eigenvalues)
 {}
 
@@ -751,6 +808,255 @@ SolverGMRES<VectorType>::modified_gram_schmidt
 
 
 
+namespace internal
+{
+  namespace SolverGMRES
+  {
+    // Number of vector entries whose partial sums are accumulated together
+    // in the multi-vector inner product. The partial sums are combined in a
+    // fixed order, so the result does not depend on the number of threads.
+    const unsigned int multi_dot_chunk_size = 256;
+
+    // computes the inner products of vv with all vectors in basis and the
+    // squared norm of vv on a range of chunks
+    template <typename Number>
+    void
+    multi_dot_on_chunks (const std::vector<const Number *> *basis,
+                         const Number                      *vv,
+                         const std::size_t                  size,
+                         double                            *partial_sums,
+                         const unsigned int                 begin_chunk,
+                         const unsigned int                 end_chunk)
+    {
+      const unsigned int n_vectors = basis->size();
+      for (unsigned int c=begin_chunk; c<end_chunk; ++c)
+        {
+          const std::size_t begin = c * multi_dot_chunk_size;
+          const std::size_t end = std::min (size, begin + multi_dot_chunk_size);
+          double *sums = partial_sums + c * (n_vectors+1);
+          for (unsigned int v=0; v<n_vectors; ++v)
+            {
+              const Number *basis_v = (*basis)[v];
+              double sum = 0;
+              for (std::size_t i=begin; i<end; ++i)
+                sum += basis_v[i] * vv[i];
+              sums[v] = sum;
+            }
+          double sum = 0;
+          for (std::size_t i=begin; i<end; ++i)
+            sum += vv[i] * vv[i];
+          sums[n_vectors] = sum;
+        }
+    }
+
+    // subtracts the linear combination of the basis vectors with the given
+    // coefficients from vv on a range of chunks
+    template <typename Number>
+    void
+    multi_add_on_chunks (const std::vector<const Number *> *basis,
+                         const dealii::Vector<double>      *coefficients,
+                         Number                            *vv,
+                         const std::size_t                  size,
+                         const unsigned int                 begin_chunk,
+                         const unsigned int                 end_chunk)
+    {
+      const unsigned int n_vectors = basis->size();
+      for (unsigned int c=begin_chunk; c<end_chunk; ++c)
+        {
+          const std::size_t begin = c * multi_dot_chunk_size;
+          const std::size_t end = std::min (size, begin + multi_dot_chunk_size);
+          for (unsigned int v=0; v<n_vectors; ++v)
+            {
+              const Number *basis_v = (*basis)[v];
+              const Number factor = (*coefficients)(v);
+              for (std::size_t i=begin; i<end; ++i)
+                vv[i] -= factor * basis_v[i];
+            }
+        }
+    }
+
+    template <typename Number>
+    void
+    multi_dot_local (const std::vector<const Number *> &basis,
+                     const Number                      *vv,
+                     const std::size_t                  size,
+                     std::vector<double>               &products)
+    {
+      const unsigned int n_chunks =
+        (size + multi_dot_chunk_size - 1) / multi_dot_chunk_size;
+      std::vector<double> partial_sums (n_chunks * (basis.size()+1));
+      if (n_chunks > 0)
+        parallel::apply_to_subranges
+        (0U, n_chunks,
+         std_cxx11::bind (&multi_dot_on_chunks<Number>, &basis, vv, size,
+                          &partial_sums[0], std_cxx11::_1, std_cxx11::_2),
+         std::max (1U, internal::Vector::minimum_parallel_grain_size /
+                   (multi_dot_chunk_size * (1+static_cast<unsigned int>(basis.size())))));
+      products.resize (basis.size()+1);
+      std::fill (products.begin(), products.end(), 0.);
+      for (unsigned int c=0; c<n_chunks; ++c)
+        for (unsigned int v=0; v<basis.size()+1; ++v)
+          products[v] += partial_sums[c*(basis.size()+1)+v];
+    }
+
+    template <typename Number>
+    void
+    multi_add_local (const std::vector<const Number *> &basis,
+                     const dealii::Vector<double>      &coefficients,
+                     Number                            *vv,
+                     const std::size_t                  size)
+    {
+      const unsigned int n_chunks =
+        (size + multi_dot_chunk_size - 1) / multi_dot_chunk_size;
+      if (n_chunks > 0)
+        parallel::apply_to_subranges
+        (0U, n_chunks,
+         std_cxx11::bind (&multi_add_on_chunks<Number>, &basis, &coefficients,
+                          vv, size, std_cxx11::_1, std_cxx11::_2),
+         std::max (1U, internal::Vector::minimum_parallel_grain_size /
+                   (multi_dot_chunk_size * (1+static_cast<unsigned int>(basis.size())))));
+    }
+
+    // Computes the inner products of vv with the first dim vectors of the
+    // basis and stores them in the first dim entries of products, followed
+    // by the squared norm of vv. The generic version computes one inner
+    // product after the other, whereas the versions for Vector and
+    // LinearAlgebra::distributed::Vector below read vv only once and use
+    // a single global reduction.
+    template <typename VectorType>
+    void
+    multi_dot (const TmpVectors<VectorType> &basis,
+               const unsigned int            dim,
+               const VectorType             &vv,
+               std::vector<double>          &products)
+    {
+      products.resize (dim+1);
+      for (unsigned int i=0; i<dim; ++i)
+        products[i] = vv * basis[i];
+      products[dim] = vv * vv;
+    }
+
+    template <typename Number>
+    void
+    multi_dot (const TmpVectors<dealii::Vector<Number> > &basis,
+               const unsigned int                         dim,
+               const dealii::Vector<Number>              &vv,
+               std::vector<double>                       &products)
+    {
+      std::vector<const Number *> basis_data (dim);
+      for (unsigned int i=0; i<dim; ++i)
+        basis_data[i] = basis[i].begin();
+      multi_dot_local (basis_data, vv.begin(), vv.size(), products);
+    }
+
+    template <typename Number>
+    void
+    multi_dot (const TmpVectors<LinearAlgebra::distributed::Vector<Number> > &basis,
+               const unsigned int                                             dim,
+               const LinearAlgebra::distributed::Vector<Number>              &vv,
+               std::vector<double>                                           &products)
+    {
+      std::vector<const Number *> basis_data (dim);
+      for (unsigned int i=0; i<dim; ++i)
+        basis_data[i] = basis[i].begin();
+      std::vector<double> local_products;
+      multi_dot_local (basis_data, vv.begin(), vv.local_size(), local_products);
+      products.resize (local_products.size());
+      Utilities::MPI::sum (local_products, vv.get_mpi_communicator(), products);
+    }
+
+    // Subtracts the linear combination of the first dim vectors of the
+    // basis with the given coefficients from vv. The versions for Vector
+    // and LinearAlgebra::distributed::Vector read and write vv only once.
+    template <typename VectorType>
+    void
+    multi_add (const TmpVectors<VectorType> &basis,
+               const unsigned int            dim,
+               const dealii::Vector<double> &coefficients,
+               VectorType                   &vv)
+    {
+      for (unsigned int i=0; i<dim; ++i)
+        vv.add (-coefficients(i), basis[i]);
+    }
+
+    template <typename Number>
+    void
+    multi_add (const TmpVectors<dealii::Vector<Number> > &basis,
+               const unsigned int                         dim,
+               const dealii::Vector<double>              &coefficients,
+               dealii::Vector<Number>                    &vv)
+    {
+      std::vector<const Number *> basis_data (dim);
+      for (unsigned int i=0; i<dim; ++i)
+        basis_data[i] = basis[i].begin();
+      multi_add_local (basis_data, coefficients, vv.begin(), vv.size());
+    }
+
+    template <typename Number>
+    void
+    multi_add (const TmpVectors<LinearAlgebra::distributed::Vector<Number> > &basis,
+               const unsigned int                                             dim,
+               const dealii::Vector<double>                                  &coefficients,
+               LinearAlgebra::distributed::Vector<Number>                    &vv)
+    {
+      std::vector<const Number *> basis_data (dim);
+      for (unsigned int i=0; i<dim; ++i)
+        basis_data[i] = basis[i].begin();
+      multi_add_local (basis_data, coefficients, vv.begin(), vv.local_size());
+    }
+  }
+}
+
+
+
+template <class VectorType>
+inline
+double
+SolverGMRES<VectorType>::classical_gram_schmidt
+(const internal::SolverGMRES::TmpVectors<VectorType> &orthogonal_vectors,
+ const unsigned int                                  dim,
+ VectorType                                          &vv,
+ Vector<double>                                      &h,
+ const bool                                          re_orthogonalize)
+{
+  Assert(dim > 0, ExcInternalError());
+
+  std::vector<double> products;
+  internal::SolverGMRES::multi_dot (orthogonal_vectors, dim, vv, products);
+  for (unsigned int i=0; i<dim; ++i)
+    h(i) = products[i];
+  internal::SolverGMRES::multi_add (orthogonal_vectors, dim, h, vv);
+
+  // the norm of the orthogonalized vector follows from the Pythagorean
+  // theorem since the basis is orthonormal. If it is small compared to the
+  // norm of the input vector, the estimate suffers from cancellation and vv
+  // has likely lost orthogonality, so perform a second pass (criterion by
+  // Daniel, Gragg, Kaufman, and Stewart with parameter 1/sqrt(2))
+  const double norm_vv_start_sqr = products[dim];
+  double norm_vv_sqr = norm_vv_start_sqr;
+  for (unsigned int i=0; i<dim; ++i)
+    norm_vv_sqr -= h(i) * h(i);
+
+  if (re_orthogonalize == true || norm_vv_sqr < 0.5 * norm_vv_start_sqr)
+    {
+      Vector<double> h_correction (dim);
+      internal::SolverGMRES::multi_dot (orthogonal_vectors, dim, vv, products);
+      for (unsigned int i=0; i<dim; ++i)
+        h_correction(i) = products[i];
+      internal::SolverGMRES::multi_add (orthogonal_vectors, dim, h_correction, vv);
+      norm_vv_sqr = products[dim];
+      for (unsigned int i=0; i<dim; ++i)
+        {
+          h(i) += h_correction(i);
+          norm_vv_sqr -= h_correction(i) * h_correction(i);
+        }
+    }
+
+  return std::sqrt(std::max(norm_vv_sqr, 0.));
+}
+
+
+
 template<class VectorType>
 inline void
 SolverGMRES<VectorType>::compute_eigs_and_cond
@@ -976,9 +1282,14 @@ SolverGMRES<VectorType>::solve (const MatrixType         &A,
 
           dim = inner_iteration+1;
 
-          const double s = modified_gram_schmidt(tmp_vectors, dim,
-                                                 accumulated_iterations,
-                                                 vv, h, re_orthogonalize);
+          const double s =
+            (additional_data.orthogonalization_strategy ==
+             AdditionalData::classical_gram_schmidt)
+            ?
+            classical_gram_schmidt(tmp_vectors, dim, vv, h, re_orthogonalize)
+            :
+            modified_gram_schmidt(tmp_vectors, dim, accumulated_iterations,
+                                  vv, h, re_orthogonalize);
           h(inner_iteration+1) = s;
 
           //s=0 is a lucky breakdown, the solver will reach convergence,
@@ -0,0 +1,408 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__solver_pipelined_cg_h
+#define dealii__solver_pipelined_cg_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/lac/solver.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/vector_operations_internal.h>
+#include <deal.II/lac/vector_memory.h>
+
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+namespace LinearAlgebra
+{
+  namespace distributed
+  {
+    template <typename> class Vector;
+  }
+}
+
+
+namespace internal
+{
+  namespace SolverCommunicationAvoiding
+  {
+    /**
+     * Computes a set of inner products between vectors with a single global
+     * reduction. The inner products are started with start() and their
+     * result is available in the array passed to start() once finish() has
+     * returned. Work that does not depend on the inner products, such as a
+     * matrix-vector product, can be placed between the two calls.
+     *
+     * For generic vector types, the inner products are simply computed by
+     * <code>operator*</code> in start(), which implies one reduction per
+     * inner product in parallel. The specialization for
+     * LinearAlgebra::distributed::Vector below sums up the local
+     * contributions with the vectorized kernels of the vector classes and
+     * combines them into a single non-blocking
+     * <code>MPI_Iallreduce</code>.
+     */
+    template <typename VectorType>
+    class FusedInnerProducts
+    {
+    public:
+      void start (const std::vector<std::pair<const VectorType *, const VectorType *> > &pairs,
+                  std::vector<double> &results)
+      {
+        results.resize (pairs.size());
+        for (unsigned int i=0; i<pairs.size(); ++i)
+          results[i] = *pairs[i].first * *pairs[i].second;
+      }
+
+      void finish ()
+      {}
+    };
+
+
+
+    template <typename Number>
+    class FusedInnerProducts<LinearAlgebra::distributed::Vector<Number> >
+    {
+    public:
+      FusedInnerProducts ()
+        :
+        thread_loop_partitioner (new ::dealii::parallel::internal::TBBPartitioner())
+#ifdef DEAL_II_WITH_MPI
+        ,
+        request (MPI_REQUEST_NULL)
+#endif
+      {}
+
+      ~FusedInnerProducts ()
+      {
+        finish ();
+      }
+
+      void start (const std::vector<std::pair<const LinearAlgebra::distributed::Vector<Number> *,
+                  const LinearAlgebra::distributed::Vector<Number> *> > &pairs,
+                  std::vector<double> &results)
+      {
+        results.resize (pairs.size());
+        for (unsigned int i=0; i<pairs.size(); ++i)
+          {
+            const LinearAlgebra::distributed::Vector<Number> &a = *pairs[i].first;
+            const LinearAlgebra::distributed::Vector<Number> &b = *pairs[i].second;
+            AssertDimension (a.local_size(), b.local_size());
+
+            // use the same vectorized kernels as the inner products of the
+            // vector class, such that the results are the same as for a
+            // serial vector
+            Number sum = Number();
+            if (PointerComparison::equal (&a, &b))
+              {
+                ::dealii::internal::Norm2<Number,Number> norm2 (a.begin());
+                ::dealii::internal::parallel_reduce (norm2, a.local_size(), sum,
+                                                     thread_loop_partitioner);
+              }
+            else
+              {
+                ::dealii::internal::Dot<Number,Number> dot (a.begin(), b.begin());
+                ::dealii::internal::parallel_reduce (dot, a.local_size(), sum,
+                                                     thread_loop_partitioner);
+              }
+            results[i] = sum;
+          }
+
+#ifdef DEAL_II_WITH_MPI
+        if (pairs.size() > 0 &&
+            Utilities::MPI::n_mpi_processes(pairs[0].first->get_mpi_communicator()) > 1)
+          {
+#if MPI_VERSION >= 3
+            const int ierr =
+              MPI_Iallreduce (MPI_IN_PLACE, &results[0], results.size(),
+                              MPI_DOUBLE, MPI_SUM,
+                              pairs[0].first->get_mpi_communicator(), &request);
+#else
+            const int ierr =
+              MPI_Allreduce (MPI_IN_PLACE, &results[0], results.size(),
+                             MPI_DOUBLE, MPI_SUM,
+                             pairs[0].first->get_mpi_communicator());
+#endif
+            AssertThrow (ierr == MPI_SUCCESS, ExcInternalError());
+          }
+#endif
+      }
+
+      void finish ()
+      {
+#ifdef DEAL_II_WITH_MPI
+        if (request != MPI_REQUEST_NULL)
+          {
+            const int ierr = MPI_Wait (&request, MPI_STATUS_IGNORE);
+            AssertThrow (ierr == MPI_SUCCESS, ExcInternalError());
+          }
+#endif
+      }
+
+    private:
+      std_cxx11::shared_ptr< ::dealii::parallel::internal::TBBPartitioner> thread_loop_partitioner;
+
+#ifdef DEAL_II_WITH_MPI
+      MPI_Request request;
+#endif
+    };
+  }
+}
+
+
+
+/*!@addtogroup Solvers */
+/*@{*/
+
+/**
+ * Pipelined preconditioned conjugate gradient method for symmetric positive
+ * definite matrices, following P. Ghysels and W. Vanroose, "Hiding global
+ * synchronization latency in the preconditioned Conjugate Gradient
+ * algorithm", Parallel Computing 40(7):224--238, 2014.
+ *
+ * The classical cg method as implemented in SolverCG needs two global
+ * reductions per iteration whose results are immediately needed for the
+ * next vector update. On large parallel machines, the latency of these
+ * reductions dominates the run time once the local work becomes small. This
+ * variant rearranges the recurrences such that all inner products of an
+ * iteration, including the residual norm for the convergence check, are
+ * computed by a single reduction. For LinearAlgebra::distributed::Vector,
+ * this reduction is non-blocking and overlapped with one application of the
+ * preconditioner and one matrix-vector product.
+ *
+ * In exact arithmetic, the iterates are the same as in SolverCG. The price
+ * for hiding the latency is that the method keeps nine vectors instead of
+ * four, performs more vector updates per iteration, and is numerically
+ * somewhat less stable since the residual is computed by recurrences only.
+ * Furthermore, the residual norm used for the convergence check lags one
+ * iteration behind the matrix-vector product, so the method performs one
+ * additional matrix-vector product and preconditioner application over
+ * SolverCG. As for SolverCG, the preconditioner must be symmetric.
+ *
+ * For the requirements on matrices and vectors in order to work with this
+ * class, see the documentation of the Solver base class.
+ *
+ *
+ * <h3>Observing the progress of linear solver iterations</h3>
+ *
+ * The solve() function of this class uses the mechanism described in the
+ * Solver base class to determine convergence. This mechanism can also be used
+ * to observe the progress of the iteration.
+ */
+template <typename VectorType = Vector<double> >
+class SolverPipelinedCG : public Solver<VectorType>
+{
+public:
+  /**
+   * Standardized data struct to pipe additional data to the solver. There is
+   * no additional data for this solver.
+   */
+  struct AdditionalData
+  {
+  };
+
+  /**
+   * Constructor.
+   */
+  SolverPipelinedCG (SolverControl            &cn,
+                     VectorMemory<VectorType> &mem,
+                     const AdditionalData     &data = AdditionalData());
+
+  /**
+   * Constructor. Use an object of type GrowingVectorMemory as a default to
+   * allocate memory.
+   */
+  SolverPipelinedCG (SolverControl        &cn,
+                     const AdditionalData &data = AdditionalData());
+
+  /**
+   * Solve the linear system $Ax=b$ for x.
+   */
+  template <typename MatrixType, typename PreconditionerType>
+  void
+  solve (const MatrixType         &A,
+         VectorType               &x,
+         const VectorType         &b,
+         const PreconditionerType &precondition);
+
+protected:
+  /**
+   * Additional parameters.
+   */
+  AdditionalData additional_data;
+};
+
+/*@}*/
+
+/*------------------------- Implementation ----------------------------*/
+
+#ifndef DOXYGEN
+
+template <typename VectorType>
+SolverPipelinedCG<VectorType>::SolverPipelinedCG (SolverControl            &cn,
+                                                  VectorMemory<VectorType> &mem,
+                                                  const AdditionalData     &data)
+  :
+  Solver<VectorType>(cn,mem),
+  additional_data(data)
+{}
+
+
+
+template <typename VectorType>
+SolverPipelinedCG<VectorType>::SolverPipelinedCG (SolverControl        &cn,
+                                                  const AdditionalData &data)
+  :
+  Solver<VectorType>(cn),
+  additional_data(data)
+{}
+
+
+
+template <typename VectorType>
+template <typename MatrixType, typename PreconditionerType>
+void
+SolverPipelinedCG<VectorType>::solve (const MatrixType         &A,
+                                      VectorType               &x,
+                                      const VectorType         &b,
+                                      const PreconditionerType &precondition)
+{
+  deallog.push("pipelined-cg");
+
+  // the names of the vectors follow the paper by Ghysels and Vanroose: r is
+  // the residual, u = M r, w = A u, m = M w, n = A m, and p, s, q, z are
+  // the search direction and its images under A, M A, and A M A
+  typename VectorMemory<VectorType>::Pointer r_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer u_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer w_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer m_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer n_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer p_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer s_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer q_pointer (this->memory);
+  typename VectorMemory<VectorType>::Pointer z_pointer (this->memory);
+  VectorType &r = *r_pointer;
+  VectorType &u = *u_pointer;
+  VectorType &w = *w_pointer;
+  VectorType &m = *m_pointer;
+  VectorType &n = *n_pointer;
+  VectorType &p = *p_pointer;
+  VectorType &s = *s_pointer;
+  VectorType &q = *q_pointer;
+  VectorType &z = *z_pointer;
+
+  r.reinit (x, true);
+  u.reinit (x, true);
+  w.reinit (x, true);
+  m.reinit (x, true);
+  n.reinit (x, true);
+  // the search directions enter the first update multiplied by zero, so
+  // they must not contain garbage
+  p.reinit (x);
+  s.reinit (x);
+  q.reinit (x);
+  z.reinit (x);
+
+  if (!x.all_zero())
+    {
+      A.vmult (r, x);
+      r.sadd (-1., 1., b);
+    }
+  else
+    r = b;
+
+  precondition.vmult (u, r);
+  A.vmult (w, u);
+
+  internal::SolverCommunicationAvoiding::FusedInnerProducts<VectorType> reduction;
+  std::vector<std::pair<const VectorType *, const VectorType *> > pairs (3);
+  pairs[0] = std::make_pair (&r, &r);
+  pairs[1] = std::make_pair (&r, &u);
+  pairs[2] = std::make_pair (&w, &u);
+  std::vector<double> products;
+
+  SolverControl::State conv = SolverControl::iterate;
+  unsigned int it = 0;
+  double res = -std::numeric_limits<double>::max();
+  double gamma_old = 0, alpha_old = 0;
+  while (true)
+    {
+      // start the reduction and do the preconditioner application and
+      // matrix-vector product while it is in flight
+      reduction.start (pairs, products);
+      precondition.vmult (m, w);
+      A.vmult (n, m);
+      reduction.finish ();
+
+      res = std::sqrt (products[0]);
+      conv = this->iteration_status (it, res, x);
+      if (conv != SolverControl::iterate)
+        break;
+
+      const double gamma = products[1];
+      const double delta = products[2];
+      double alpha, beta;
+      if (it == 0)
+        {
+          beta = 0.;
+          Assert (delta != 0., ExcDivideByZero());
+          alpha = gamma / delta;
+        }
+      else
+        {
+          Assert (gamma_old != 0. && alpha_old != 0., ExcDivideByZero());
+          beta = gamma / gamma_old;
+          const double denominator = delta - beta * gamma / alpha_old;
+          Assert (denominator != 0., ExcDivideByZero());
+          alpha = gamma / denominator;
+        }
+
+      z.sadd (beta, 1., n);
+      q.sadd (beta, 1., m);
+      s.sadd (beta, 1., w);
+      p.sadd (beta, 1., u);
+      x.add (alpha, p);
+      r.add (-alpha, s);
+      u.add (-alpha, q);
+      w.add (-alpha, z);
+
+      gamma_old = gamma;
+      alpha_old = alpha;
+      ++it;
+    }
+
+  deallog.pop();
+
+  // in case of failure: throw exception
+  if (conv != SolverControl::success)
+    AssertThrow(false, SolverControl::NoConvergence (it, res));
+  // otherwise exit as normal
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,370 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__solver_s_step_cg_h
+#define dealii__solver_s_step_cg_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/solver.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/solver_pipelined_cg.h>
+#include <deal.II/lac/vector_memory.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+/*!@addtogroup Solvers */
+/*@{*/
+
+/**
+ * Preconditioned s-step conjugate gradient method for symmetric positive
+ * definite matrices, following A. T. Chronopoulos and C. W. Gear, "s-step
+ * iterative methods for symmetric linear systems", J. Comput. Appl. Math.
+ * 25:153--168, 1989.
+ *
+ * Instead of extending the Krylov space by one vector per iteration as
+ * SolverCG does, this method generates $s$ new basis vectors $z, MAz,
+ * \ldots, (MA)^{s-1}z$ from the preconditioned residual $z=Mr$ by $s$
+ * matrix-vector products and preconditioner applications without any
+ * global communication. The block of new vectors is made $A$-conjugate to
+ * the previous block, and the solution is updated by the Galerkin projection
+ * onto the new block. All inner products needed for one such outer step,
+ * i.e., the $s\times s$ Gram matrices and the residual norm, are computed by
+ * a single global reduction (a single <code>MPI_Allreduce</code> for
+ * LinearAlgebra::distributed::Vector, see SolverPipelinedCG). This reduces
+ * the number of global reductions from two per iteration to one per $s$
+ * iterations, at the cost of storing $4s+1$ vectors and solving small dense
+ * systems of size $s$. Contrary to SolverPipelinedCG, the reduction is not
+ * overlapped with any computations: all of its results are needed before the
+ * next block of basis vectors can be generated. The method therefore saves
+ * latency by doing fewer reductions, not by hiding them.
+ *
+ * In exact arithmetic, the iterates after each outer step coincide with
+ * every $s$-th iterate of SolverCG. The iteration numbers reported to the
+ * SolverControl are counted in multiples of $s$. Since the basis vectors are
+ * generated by powers of the preconditioned matrix, they become increasingly
+ * linearly dependent as $s$ grows, and the method loses accuracy. Values of
+ * $s$ up to around 5 are usually safe when a reasonable preconditioner is
+ * applied. As for SolverCG, the preconditioner must be symmetric.
+ *
+ * For the requirements on matrices and vectors in order to work with this
+ * class, see the documentation of the Solver base class.
+ *
+ *
+ * <h3>Observing the progress of linear solver iterations</h3>
+ *
+ * The solve() function of this class uses the mechanism described in the
+ * Solver base class to determine convergence. This mechanism can also be used
+ * to observe the progress of the iteration.
+ */
+template <typename VectorType = Vector<double> >
+class SolverSStepCG : public Solver<VectorType>
+{
+public:
+  /**
+   * Standardized data struct to pipe additional data to the solver.
+   */
+  struct AdditionalData
+  {
+    /**
+     * Constructor. Sets the number of steps per global reduction.
+     */
+    explicit
+    AdditionalData (const unsigned int n_steps = 4);
+
+    /**
+     * The number of Krylov vectors generated between two global reductions,
+     * i.e., the parameter $s$ of the method.
+     */
+    unsigned int n_steps;
+  };
+
+  /**
+   * Constructor.
+   */
+  SolverSStepCG (SolverControl            &cn,
+                 VectorMemory<VectorType> &mem,
+                 const AdditionalData     &data = AdditionalData());
+
+  /**
+   * Constructor. Use an object of type GrowingVectorMemory as a default to
+   * allocate memory.
+   */
+  SolverSStepCG (SolverControl        &cn,
+                 const AdditionalData &data = AdditionalData());
+
+  /**
+   * Solve the linear system $Ax=b$ for x.
+   */
+  template <typename MatrixType, typename PreconditionerType>
+  void
+  solve (const MatrixType         &A,
+         VectorType               &x,
+         const VectorType         &b,
+         const PreconditionerType &precondition);
+
+  /**
+   * The dense system of the Galerkin projection onto a block of search
+   * directions is singular, which happens when the Krylov space is exhausted
+   * or the basis vectors have become numerically linearly dependent.
+   */
+  DeclException0 (ExcSingularProjection);
+
+protected:
+  /**
+   * Additional parameters.
+   */
+  AdditionalData additional_data;
+};
+
+/*@}*/
+
+/*------------------------- Implementation ----------------------------*/
+
+#ifndef DOXYGEN
+
+template <typename VectorType>
+inline
+SolverSStepCG<VectorType>::AdditionalData::
+AdditionalData (const unsigned int n_steps)
+  :
+  n_steps (n_steps)
+{}
+
+
+
+template <typename VectorType>
+SolverSStepCG<VectorType>::SolverSStepCG (SolverControl            &cn,
+                                          VectorMemory<VectorType> &mem,
+                                          const AdditionalData     &data)
+  :
+  Solver<VectorType>(cn,mem),
+  additional_data(data)
+{}
+
+
+
+template <typename VectorType>
+SolverSStepCG<VectorType>::SolverSStepCG (SolverControl        &cn,
+                                          const AdditionalData &data)
+  :
+  Solver<VectorType>(cn),
+  additional_data(data)
+{}
+
+
+
+template <typename VectorType>
+template <typename MatrixType, typename PreconditionerType>
+void
+SolverSStepCG<VectorType>::solve (const MatrixType         &A,
+                                  VectorType               &x,
+                                  const VectorType         &b,
+                                  const PreconditionerType &precondition)
+{
+  const unsigned int s = additional_data.n_steps;
+  AssertThrow (s > 0, ExcMessage ("The number of steps must be positive."));
+
+  deallog.push("s-step-cg");
+
+  // V holds the new block of Krylov vectors and P the previous block of
+  // search directions, AV and AP their images under A. After the new block
+  // has been conjugated against P, it becomes the next P, so the storage of
+  // V and P (and AV and AP) is swapped.
+  std::vector<VectorType *> V (s), AV (s), P (s), AP (s);
+  for (unsigned int j=0; j<s; ++j)
+    {
+      V[j] = this->memory.alloc();
+      AV[j] = this->memory.alloc();
+      P[j] = this->memory.alloc();
+      AP[j] = this->memory.alloc();
+      V[j]->reinit (x, true);
+      AV[j]->reinit (x, true);
+      P[j]->reinit (x, true);
+      AP[j]->reinit (x, true);
+    }
+  VectorType *r = this->memory.alloc();
+  r->reinit (x, true);
+
+  SolverControl::State conv = SolverControl::iterate;
+  unsigned int it = 0;
+  double res = -std::numeric_limits<double>::max();
+
+  try
+    {
+      if (!x.all_zero())
+        {
+          A.vmult (*r, x);
+          r->sadd (-1., 1., b);
+        }
+      else
+        *r = b;
+
+      internal::SolverCommunicationAvoiding::FusedInnerProducts<VectorType> reduction;
+      std::vector<std::pair<const VectorType *, const VectorType *> > pairs;
+      std::vector<double> products;
+
+      // W is the projected matrix P^T A P of the previous block, C holds
+      // the couplings AP^T V between the previous and the new block, and B
+      // the coefficients that make the new block A-conjugate to the previous
+      // one
+      FullMatrix<double> W (s, s), W_inverse (s, s), C (s, s), B (s, s),
+                 VAV (s, s), WB (s, s), W_new (s, s);
+      Vector<double> Vr (s), Pr (s), BPr (s), a (s);
+      bool have_previous_block = false;
+
+      while (true)
+        {
+          // generate the Krylov basis z, MAz, ..., (MA)^{s-1}z
+          precondition.vmult (*V[0], *r);
+          for (unsigned int j=0; j<s; ++j)
+            {
+              A.vmult (*AV[j], *V[j]);
+              if (j+1 < s)
+                precondition.vmult (*V[j+1], *AV[j]);
+            }
+
+          // collect all inner products of this step into one reduction
+          pairs.clear();
+          pairs.push_back (std::make_pair (r, r));
+          for (unsigned int j=0; j<s; ++j)
+            pairs.push_back (std::make_pair (V[j], r));
+          for (unsigned int i=0; i<s; ++i)
+            for (unsigned int j=i; j<s; ++j)
+              pairs.push_back (std::make_pair (V[i], AV[j]));
+          if (have_previous_block)
+            {
+              for (unsigned int i=0; i<s; ++i)
+                for (unsigned int j=0; j<s; ++j)
+                  pairs.push_back (std::make_pair (AP[i], V[j]));
+              for (unsigned int i=0; i<s; ++i)
+                pairs.push_back (std::make_pair (P[i], r));
+            }
+          // all vectors of the next step depend on the results, so there is
+          // no work to place between start() and finish()
+          reduction.start (pairs, products);
+          reduction.finish ();
+
+          res = std::sqrt (products[0]);
+          conv = this->iteration_status (it, res, x);
+          if (conv != SolverControl::iterate)
+            break;
+
+          unsigned int index = 1;
+          for (unsigned int j=0; j<s; ++j, ++index)
+            Vr(j) = products[index];
+          for (unsigned int i=0; i<s; ++i)
+            for (unsigned int j=i; j<s; ++j, ++index)
+              VAV(i,j) = VAV(j,i) = products[index];
+
+          // conjugate the new block against the previous one: B = W^{-1} C
+          // and P_new = V - P B. The projected matrix and right hand side
+          // follow from P_new^T A P_new = V^T A V - C^T B - B^T C + B^T W B
+          // and P_new^T r = V^T r - B^T P^T r. In exact arithmetic, the
+          // last two terms of the former cancel and P^T r is zero, but
+          // including them makes the method considerably less sensitive to
+          // roundoff.
+          if (have_previous_block)
+            {
+              for (unsigned int i=0; i<s; ++i)
+                for (unsigned int j=0; j<s; ++j, ++index)
+                  C(i,j) = products[index];
+              for (unsigned int i=0; i<s; ++i, ++index)
+                Pr(i) = products[index];
+              W_inverse.mmult (B, C);
+              W.mmult (WB, B);
+              for (unsigned int i=0; i<s; ++i)
+                for (unsigned int j=0; j<s; ++j)
+                  {
+                    double sum = VAV(i,j);
+                    for (unsigned int l=0; l<s; ++l)
+                      sum += B(l,i) * (WB(l,j) - C(l,j)) - C(l,i) * B(l,j);
+                    W_new(i,j) = sum;
+                  }
+              W = W_new;
+              B.Tvmult (BPr, Pr);
+              Vr -= BPr;
+              for (unsigned int j=0; j<s; ++j)
+                for (unsigned int l=0; l<s; ++l)
+                  {
+                    V[j]->add (-B(l,j), *P[l]);
+                    AV[j]->add (-B(l,j), *AP[l]);
+                  }
+            }
+          else
+            W = VAV;
+          std::swap (V, P);
+          std::swap (AV, AP);
+          have_previous_block = true;
+
+          // Galerkin projection onto the new block
+          W_inverse = W;
+          W_inverse.gauss_jordan ();
+          W_inverse.vmult (a, Vr);
+          for (unsigned int j=0; j<s; ++j)
+            AssertThrow (numbers::is_finite(a(j)), ExcSingularProjection());
+          for (unsigned int j=0; j<s; ++j)
+            {
+              x.add (a(j), *P[j]);
+              r->add (-a(j), *AP[j]);
+            }
+
+          it += s;
+        }
+    }
+  catch (...)
+    {
+      for (unsigned int j=0; j<s; ++j)
+        {
+          this->memory.free (V[j]);
+          this->memory.free (AV[j]);
+          this->memory.free (P[j]);
+          this->memory.free (AP[j]);
+        }
+      this->memory.free (r);
+      deallog.pop();
+      throw;
+    }
+
+  for (unsigned int j=0; j<s; ++j)
+    {
+      this->memory.free (V[j]);
+      this->memory.free (AV[j]);
+      this->memory.free (P[j]);
+      this->memory.free (AP[j]);
+    }
+  this->memory.free (r);
+  deallog.pop();
+
+  // in case of failure: throw exception
+  if (conv != SolverControl::success)
+    AssertThrow(false, SolverControl::NoConvergence (it, res));
+  // otherwise exit as normal
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -17,9 +17,11 @@
 #define dealii__sparse_decomposition_h
 
 #include <deal.II/base/config.h>
+#include <deal.II/base/std_cxx11/function.h>
 #include <deal.II/lac/sparse_matrix.h>
 
 #include <cmath>
+#include <vector>
 
 DEAL_II_NAMESPACE_OPEN
 
@@ -93,6 +95,28 @@ DEAL_II_NAMESPACE_OPEN
  * restrictions on the sparsity see section `Fill-in' above).
  *
  *
+ * <h3>Parallelization</h3>
+ *
+ * The forward and backward substitutions with the factors, as well as the
+ * computation of the factors, are inherently sequential if the rows are
+ * processed one after the other. However, row $i$ of the lower triangular
+ * factor only depends on those rows $j<i$ for which the sparsity pattern has
+ * an entry $(i,j)$. This class therefore groups the rows into levels such
+ * that the rows of one level only depend on rows of earlier levels (level
+ * scheduling), separately for the lower and the upper triangular part. The
+ * rows within a level are then processed in parallel by the derived classes
+ * using the threads available through MultithreadInfo. Since each row is
+ * computed with the same operations in the same order as in the sequential
+ * algorithm, the results do not depend on the number of threads.
+ *
+ * The levels only depend on the sparsity pattern. They are computed in the
+ * first call to initialize() and kept as long as the sparsity pattern is
+ * reused, i.e., when <code>use_previous_sparsity</code> is set in the
+ * AdditionalData object. If the number of rows per level is small on
+ * average, as for example for matrices with a narrow band, or if only one
+ * thread is available, the rows are processed in their natural order.
+ *
+ *
  * <h3>Particular implementations</h3>
  *
  * It is enough to override the initialize() and vmult() methods to implement
@@ -316,6 +340,59 @@ protected:
    */
   void prebuild_lower_bound ();
 
+  /**
+   * Group the rows of the sparsity pattern into levels for the parallel
+   * processing of the lower and upper triangular part, see the section on
+   * parallelization in the general documentation of this class. Does
+   * nothing if the levels have already been computed for the current
+   * sparsity pattern. Requires the #prebuilt_lower_bound array.
+   */
+  void compute_level_schedule ();
+
+  /**
+   * Return whether the rows should be processed level by level in parallel
+   * rather than in their natural order.
+   */
+  bool use_level_schedule () const;
+
+  /**
+   * Call @p worker on ranges of indices into #lower_level_rows (if @p
+   * lower is true) or #upper_level_rows (otherwise). The ranges within one
+   * level are processed in parallel, and all rows of a level are done before
+   * the next level is started.
+   */
+  void
+  apply_level_by_level (const bool lower,
+                        const std_cxx11::function<void (const size_type,
+                                                        const size_type)> &worker) const;
+
+  /**
+   * The rows of the matrix sorted by their level with respect to the
+   * dependencies in the lower triangular part, i.e., row $i$ is in a later
+   * level than all rows $j<i$ with an entry $(i,j)$. Rows within a level
+   * are sorted by increasing index.
+   */
+  std::vector<size_type> lower_level_rows;
+
+  /**
+   * Index of the first entry in #lower_level_rows for each level, with one
+   * additional entry that points to the end of the array.
+   */
+  std::vector<size_type> lower_level_start;
+
+  /**
+   * Like #lower_level_rows for the dependencies in the upper triangular
+   * part, i.e., row $i$ is in a later level than all rows $j>i$ with an
+   * entry $(i,j)$.
+   */
+  std::vector<size_type> upper_level_rows;
+
+  /**
+   * Index of the first entry in #upper_level_rows for each level, with one
+   * additional entry that points to the end of the array.
+   */
+  std::vector<size_type> upper_level_start;
+
 private:
 
   /**
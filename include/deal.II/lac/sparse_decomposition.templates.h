@@ -19,6 +19,8 @@
 
 
 #include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/parallel.h>
 #include <deal.II/base/template_constraints.h>
 #include <deal.II/base/utilities.h>
 #include <deal.II/lac/sparse_decomposition.h>
@@ -49,6 +51,23 @@ void SparseLUDecomposition<number>::clear()
   std::vector<const size_type *> tmp;
   tmp.swap (prebuilt_lower_bound);
 
+  {
+    std::vector<size_type> tmp;
+    tmp.swap (lower_level_rows);
+  }
+  {
+    std::vector<size_type> tmp;
+    tmp.swap (lower_level_start);
+  }
+  {
+    std::vector<size_type> tmp;
+    tmp.swap (upper_level_rows);
+  }
+  {
+    std::vector<size_type> tmp;
+    tmp.swap (upper_level_start);
+  }
+
   SparseMatrix<number>::clear();
 
   if (own_sparsity)
@@ -69,6 +88,7 @@ void SparseLUDecomposition<number>::initialize (
   const SparsityPattern &matrix_sparsity=matrix.get_sparsity_pattern();
 
   const SparsityPattern *sparsity_pattern_to_use = 0;
+  bool keep_level_schedule = false;
 
   if (data.use_this_sparsity)
     sparsity_pattern_to_use = data.use_this_sparsity;
@@ -85,6 +105,7 @@ void SparseLUDecomposition<number>::initialize (
       // iteration steps on an
       // unchanged grid.
       sparsity_pattern_to_use = &this->get_sparsity_pattern();
+      keep_level_schedule = true;
     }
   else if (data.extra_off_diagonals==0)
     {
@@ -123,6 +144,16 @@ void SparseLUDecomposition<number>::initialize (
     std::vector<const size_type *> tmp;
     tmp.swap (prebuilt_lower_bound);
   }
+
+  // the level schedule only depends on the sparsity pattern, so keep it
+  // when the previous pattern is reused
+  if (keep_level_schedule == false)
+    {
+      lower_level_rows.clear();
+      lower_level_start.clear();
+      upper_level_rows.clear();
+      upper_level_start.clear();
+    }
   SparseMatrix<number>::reinit (*sparsity_pattern_to_use);
 }
 
@@ -149,6 +180,123 @@ SparseLUDecomposition<number>::prebuild_lower_bound()
     }
 }
 
+
+
+namespace internal
+{
+  namespace SparseLUDecompositionImplementation
+  {
+    // the average number of rows per level above which the rows are
+    // processed level by level in parallel. half of this number is the
+    // grain size, such that a level of average size is split between at
+    // least two threads
+    const unsigned int minimum_rows_per_level = 64;
+
+    // sort the rows by their level with a counting sort, keeping the
+    // natural order of the rows within each level
+    template <typename size_type>
+    void
+    sort_rows_by_level (const std::vector<unsigned int> &level,
+                        const unsigned int               n_levels,
+                        std::vector<size_type>          &level_rows,
+                        std::vector<size_type>          &level_start)
+    {
+      level_start.clear ();
+      level_start.resize (n_levels+1, 0);
+      for (size_type row=0; row<level.size(); ++row)
+        ++level_start[level[row]+1];
+      for (unsigned int l=0; l<n_levels; ++l)
+        level_start[l+1] += level_start[l];
+
+      std::vector<size_type> position (level_start.begin(), level_start.end()-1);
+      level_rows.resize (level.size());
+      for (size_type row=0; row<level.size(); ++row)
+        level_rows[position[level[row]]++] = row;
+    }
+  }
+}
+
+
+
+template<typename number>
+void
+SparseLUDecomposition<number>::compute_level_schedule ()
+{
+  const size_type N = this->m();
+  if (lower_level_rows.size() == N && upper_level_rows.size() == N)
+    return;
+
+  Assert (prebuilt_lower_bound.size() == N, ExcNotInitialized());
+  const size_type *const
+  column_numbers = this->get_sparsity_pattern().colnums;
+  const std::size_t *const
+  rowstart_indices = this->get_sparsity_pattern().rowstart;
+
+  // the level of a row is one more than the highest level of the rows it
+  // depends on. the diagonal element is stored first in each row, followed
+  // by the elements left of the diagonal and then the ones right of it
+  std::vector<unsigned int> level (N);
+  unsigned int n_levels = 0;
+  for (size_type row=0; row<N; ++row)
+    {
+      unsigned int row_level = 0;
+      for (const size_type *col=&column_numbers[rowstart_indices[row]+1];
+           col != prebuilt_lower_bound[row]; ++col)
+        row_level = std::max (row_level, level[*col]+1);
+      level[row] = row_level;
+      n_levels = std::max (n_levels, row_level+1);
+    }
+  internal::SparseLUDecompositionImplementation::
+  sort_rows_by_level (level, n_levels, lower_level_rows, lower_level_start);
+
+  n_levels = 0;
+  for (size_type row=N; row>0; )
+    {
+      --row;
+      unsigned int row_level = 0;
+      for (const size_type *col=prebuilt_lower_bound[row];
+           col != &column_numbers[rowstart_indices[row+1]]; ++col)
+        row_level = std::max (row_level, level[*col]+1);
+      level[row] = row_level;
+      n_levels = std::max (n_levels, row_level+1);
+    }
+  internal::SparseLUDecompositionImplementation::
+  sort_rows_by_level (level, n_levels, upper_level_rows, upper_level_start);
+}
+
+
+
+template<typename number>
+bool
+SparseLUDecomposition<number>::use_level_schedule () const
+{
+  // only go through the levels if there are enough rows per level on average
+  // to make up for the synchronization after each level
+  const std::size_t max_n_levels =
+    std::max (lower_level_start.size(), upper_level_start.size());
+  return (MultithreadInfo::n_threads() > 1 &&
+          max_n_levels > 1 &&
+          lower_level_rows.size() >= (max_n_levels-1) *
+          internal::SparseLUDecompositionImplementation::minimum_rows_per_level);
+}
+
+
+
+template<typename number>
+void
+SparseLUDecomposition<number>::apply_level_by_level
+(const bool lower,
+ const std_cxx11::function<void (const size_type, const size_type)> &worker) const
+{
+  const std::vector<size_type> &level_start =
+    lower ? lower_level_start : upper_level_start;
+  for (unsigned int l=0; l+1<level_start.size(); ++l)
+    parallel::apply_to_subranges (level_start[l], level_start[l+1], worker,
+                                  internal::SparseLUDecompositionImplementation::minimum_rows_per_level/2);
+}
+
+
+
 template <typename number>
 template <typename somenumber>
 void
@@ -226,7 +374,11 @@ std::size_t
 SparseLUDecomposition<number>::memory_consumption () const
 {
   return (SparseMatrix<number>::memory_consumption () +
-          MemoryConsumption::memory_consumption(prebuilt_lower_bound));
+          MemoryConsumption::memory_consumption(prebuilt_lower_bound) +
+          MemoryConsumption::memory_consumption(lower_level_rows) +
+          MemoryConsumption::memory_consumption(lower_level_start) +
+          MemoryConsumption::memory_consumption(upper_level_rows) +
+          MemoryConsumption::memory_consumption(upper_level_start));
 }
 
 
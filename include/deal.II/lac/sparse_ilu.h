@@ -19,6 +19,7 @@
 
 
 #include <deal.II/base/config.h>
+#include <deal.II/base/thread_local_storage.h>
 #include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/lac/sparse_decomposition.h>
 #include <deal.II/lac/exceptions.h>
@@ -154,6 +155,60 @@ public:
                   "that the matrix for which you try to compute a "
                   "decomposition is singular.");
   //@}
+
+private:
+  /**
+   * Compute row @p k of the decomposition. All rows that row @p k depends
+   * on must have been computed before. @p iw is a work array of size m()
+   * whose entries must be set to numbers::invalid_size_type, which they are
+   * again upon return.
+   */
+  void factorize_row (const size_type         k,
+                      std::vector<size_type> &iw);
+
+  /**
+   * Compute the rows given by the entries @p begin to @p end of the array
+   * of rows sorted by levels, using the work array of the current thread.
+   */
+  void factorize_rows_on_level (Threads::ThreadLocalStorage<std::vector<size_type> > *iw,
+                                const size_type begin,
+                                const size_type end);
+
+  /**
+   * Perform the forward substitution with the lower triangular factor for
+   * one row.
+   */
+  template <typename somenumber>
+  void forward_row (const size_type     row,
+                    Vector<somenumber> &dst) const;
+
+  /**
+   * Perform the backward substitution with the upper triangular factor for
+   * one row.
+   */
+  template <typename somenumber>
+  void backward_row (const size_type     row,
+                     Vector<somenumber> &dst) const;
+
+  /**
+   * Perform the forward substitution for the rows given by the entries @p
+   * begin to @p end of the array of rows sorted by levels of the lower
+   * triangular factor.
+   */
+  template <typename somenumber>
+  void forward_rows_on_level (Vector<somenumber> *dst,
+                              const size_type     begin,
+                              const size_type     end) const;
+
+  /**
+   * Perform the backward substitution for the rows given by the entries @p
+   * begin to @p end of the array of rows sorted by levels of the upper
+   * triangular factor.
+   */
+  template <typename somenumber>
+  void backward_rows_on_level (Vector<somenumber> *dst,
+                               const size_type     begin,
+                               const size_type     end) const;
 };
 
 /*@}*/
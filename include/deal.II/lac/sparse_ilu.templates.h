@@ -19,6 +19,7 @@
 
 
 #include <deal.II/base/config.h>
+#include <deal.II/base/std_cxx11/bind.h>
 #include <deal.II/lac/vector.h>
 #include <deal.II/lac/sparse_ilu.h>
 
@@ -55,6 +56,36 @@ void SparseILU<number>::initialize (const SparseMatrix<somenumber> &matrix,
   if (data.strengthen_diagonal>0)
     this->strengthen_diagonal_impl();
 
+  this->compute_level_schedule ();
+
+  // compute the factorization row by row, using a work array that maps the
+  // column indices of the current row to the positions of the entries. rows
+  // on the same level do not depend on each other and can be factorized in
+  // parallel, with a separate work array on each thread
+  const size_type N = this->m();
+  if (this->use_level_schedule())
+    {
+      Threads::ThreadLocalStorage<std::vector<size_type> >
+      iw (std::vector<size_type> (N, numbers::invalid_size_type));
+      this->apply_level_by_level (true,
+                                  std_cxx11::bind (&SparseILU<number>::factorize_rows_on_level,
+                                                   this, &iw,
+                                                   std_cxx11::_1, std_cxx11::_2));
+    }
+  else
+    {
+      std::vector<size_type> iw (N, numbers::invalid_size_type);
+      for (size_type k=0; k<N; ++k)
+        factorize_row (k, iw);
+    }
+}
+
+
+
+template <typename number>
+void SparseILU<number>::factorize_row (const size_type         k,
+                                       std::vector<size_type> &iw)
+{
   // in the following, we implement algorithm 10.4 in the book by Saad by
   // translating in essence the algorithm given at the end of section 10.3.2,
   // using the names of variables used there
@@ -64,75 +95,163 @@ void SparseILU<number>::initialize (const SparseMatrix<somenumber> &matrix,
 
   number *luval = this->SparseMatrix<number>::val;
 
-  const size_type N = this->m();
   size_type jrow = 0;
 
-  std::vector<size_type> iw (N, numbers::invalid_size_type);
+  const size_type j1 = ia[k],
+                  j2 = ia[k+1]-1;
 
-  for (size_type k=0; k<N; ++k)
-    {
-      const size_type j1 = ia[k],
-                      j2 = ia[k+1]-1;
-
-      for (size_type j=j1; j<=j2; ++j)
-        iw[ja[j]] = j;
+  for (size_type j=j1; j<=j2; ++j)
+    iw[ja[j]] = j;
 
-      // the algorithm in the book works on the elements of row k left of the
-      // diagonal. however, since we store the diagonal element at the first
-      // position, start at the element after the diagonal and run as long as
-      // we don't walk into the right half
-      size_type j = j1+1;
+  // the algorithm in the book works on the elements of row k left of the
+  // diagonal. however, since we store the diagonal element at the first
+  // position, start at the element after the diagonal and run as long as
+  // we don't walk into the right half
+  size_type j = j1+1;
 
-      // pathological case: the current row of the matrix has only the
-      // diagonal entry. then we have nothing to do.
-      if (j > j2)
-        goto label_200;
+  // pathological case: the current row of the matrix has only the
+  // diagonal entry. then we have nothing to do.
+  if (j > j2)
+    goto label_200;
 
 label_150:
 
-      jrow = ja[j];
-      if (jrow >= k)
-        goto label_200;
+  jrow = ja[j];
+  if (jrow >= k)
+    goto label_200;
+
+  // actual computations:
+  {
+    number t1 = luval[j] * luval[ia[jrow]];
+    luval[j] = t1;
 
-      // actual computations:
+    // jj runs from just right of the diagonal to the end of the row
+    size_type jj = ia[jrow]+1;
+    while (ja[jj] < jrow)
+      ++jj;
+    for (; jj<ia[jrow+1]; ++jj)
       {
-        number t1 = luval[j] * luval[ia[jrow]];
-        luval[j] = t1;
-
-        // jj runs from just right of the diagonal to the end of the row
-        size_type jj = ia[jrow]+1;
-        while (ja[jj] < jrow)
-          ++jj;
-        for (; jj<ia[jrow+1]; ++jj)
-          {
-            const size_type jw = iw[ja[jj]];
-            if (jw != numbers::invalid_size_type)
-              luval[jw] -= t1 * luval[jj];
-          }
-
-        ++j;
-        if (j<=j2)
-          goto label_150;
+        const size_type jw = iw[ja[jj]];
+        if (jw != numbers::invalid_size_type)
+          luval[jw] -= t1 * luval[jj];
       }
 
+    ++j;
+    if (j<=j2)
+      goto label_150;
+  }
+
 label_200:
 
-      // in the book there is an assertion that we have hit the diagonal
-      // element, i.e. that jrow==k. however, we store the diagonal element at
-      // the front, so jrow must actually be larger than k or j is already in
-      // the next row
-      Assert ((jrow > k) || (j==ia[k+1]), ExcInternalError());
+  // in the book there is an assertion that we have hit the diagonal
+  // element, i.e. that jrow==k. however, we store the diagonal element at
+  // the front, so jrow must actually be larger than k or j is already in
+  // the next row
+  Assert ((jrow > k) || (j==ia[k+1]), ExcInternalError());
 
-      // now we have to deal with the diagonal element. in the book it is
-      // located at position 'j', but here we use the convention of storing
-      // the diagonal element first, so instead of j we use uptr[k]=ia[k]
-      Assert (luval[ia[k]] != 0, ExcZeroPivot(k));
+  // now we have to deal with the diagonal element. in the book it is
+  // located at position 'j', but here we use the convention of storing
+  // the diagonal element first, so instead of j we use uptr[k]=ia[k]
+  Assert (luval[ia[k]] != 0, ExcZeroPivot(k));
 
-      luval[ia[k]] = 1./luval[ia[k]];
+  luval[ia[k]] = 1./luval[ia[k]];
 
-      for (size_type j=j1; j<=j2; ++j)
-        iw[ja[j]] = numbers::invalid_size_type;
-    }
+  for (size_type j=j1; j<=j2; ++j)
+    iw[ja[j]] = numbers::invalid_size_type;
+}
+
+
+
+template <typename number>
+void SparseILU<number>::factorize_rows_on_level
+(Threads::ThreadLocalStorage<std::vector<size_type> > *iw,
+ const size_type                                      begin,
+ const size_type                                      end)
+{
+  std::vector<size_type> &my_iw = iw->get();
+  for (size_type i=begin; i<end; ++i)
+    factorize_row (this->lower_level_rows[i], my_iw);
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+inline
+void SparseILU<number>::forward_row (const size_type     row,
+                                     Vector<somenumber> &dst) const
+{
+  const size_type *const column_numbers
+    = this->get_sparsity_pattern().colnums;
+
+  // get start of this row. skip the
+  // diagonal element
+  const size_type *const rowstart
+    = &column_numbers[this->get_sparsity_pattern().rowstart[row]+1];
+  // find the position where the part
+  // right of the diagonal starts
+  const size_type *const first_after_diagonal = this->prebuilt_lower_bound[row];
+
+  somenumber dst_row = dst(row);
+  const number *luval = this->SparseMatrix<number>::val +
+                        (rowstart - column_numbers);
+  for (const size_type *col=rowstart; col!=first_after_diagonal; ++col, ++luval)
+    dst_row -= *luval * dst(*col);
+  dst(row) = dst_row;
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+inline
+void SparseILU<number>::backward_row (const size_type     row,
+                                      Vector<somenumber> &dst) const
+{
+  const size_type *const column_numbers
+    = this->get_sparsity_pattern().colnums;
+
+  // get end of this row
+  const size_type *const rowend
+    = &column_numbers[this->get_sparsity_pattern().rowstart[row+1]];
+  // find the position where the part
+  // right of the diagonal starts
+  const size_type *const first_after_diagonal = this->prebuilt_lower_bound[row];
+
+  somenumber dst_row = dst(row);
+  const number *luval = this->SparseMatrix<number>::val +
+                        (first_after_diagonal - column_numbers);
+  for (const size_type *col=first_after_diagonal; col!=rowend; ++col, ++luval)
+    dst_row -= *luval * dst(*col);
+
+  // scale by the diagonal element.
+  // note that the diagonal element
+  // was stored inverted
+  dst(row) = dst_row * this->diag_element(row);
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void SparseILU<number>::forward_rows_on_level (Vector<somenumber> *dst,
+                                               const size_type     begin,
+                                               const size_type     end) const
+{
+  for (size_type i=begin; i<end; ++i)
+    forward_row (this->lower_level_rows[i], *dst);
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void SparseILU<number>::backward_rows_on_level (Vector<somenumber> *dst,
+                                                const size_type     begin,
+                                                const size_type     end) const
+{
+  for (size_type i=begin; i<end; ++i)
+    backward_row (this->upper_level_rows[i], *dst);
 }
 
 
@@ -146,10 +265,6 @@ void SparseILU<number>::vmult (Vector<somenumber>       &dst,
   Assert (dst.size() == this->m(), ExcDimensionMismatch(dst.size(), this->m()));
 
   const size_type N=dst.size();
-  const std::size_t *const rowstart_indices
-    = this->get_sparsity_pattern().rowstart;
-  const size_type *const column_numbers
-    = this->get_sparsity_pattern().colnums;
 
   // solve LUx=b in two steps:
   // first Ly = b, then
@@ -162,51 +277,38 @@ void SparseILU<number>::vmult (Vector<somenumber>       &dst,
   //       - sum_{j=0}^{i-1} L_{ij}y_j
   // we split the y_i = b_i off and
   // perform it at the outset of the
-  // loop
-  dst = src;
-  for (size_type row=0; row<N; ++row)
-    {
-      // get start of this row. skip the
-      // diagonal element
-      const size_type *const rowstart = &column_numbers[rowstart_indices[row]+1];
-      // find the position where the part
-      // right of the diagonal starts
-      const size_type *const first_after_diagonal = this->prebuilt_lower_bound[row];
-
-      somenumber dst_row = dst(row);
-      const number *luval = this->SparseMatrix<number>::val +
-                            (rowstart - column_numbers);
-      for (const size_type *col=rowstart; col!=first_after_diagonal; ++col, ++luval)
-        dst_row -= *luval * dst(*col);
-      dst(row) = dst_row;
-    }
-
-  // now the backward solve. same
+  // loop.
+  //
+  // then the backward solve. same
   // procedure, but we need not set
   // dst before, since this is already
-  // done.
+  // done. note that we need to scale
+  // now, since the diagonal is not
+  // equal to one now.
   //
-  // note that we need to scale now,
-  // since the diagonal is not equal to
-  // one now
-  for (int row=N-1; row>=0; --row)
+  // if there are enough rows per
+  // level, the rows of each level
+  // are processed in parallel
+  dst = src;
+  if (this->use_level_schedule())
     {
-      // get end of this row
-      const size_type *const rowend = &column_numbers[rowstart_indices[row+1]];
-      // find the position where the part
-      // right of the diagonal starts
-      const size_type *const first_after_diagonal = this->prebuilt_lower_bound[row];
-
-      somenumber dst_row = dst(row);
-      const number *luval = this->SparseMatrix<number>::val +
-                            (first_after_diagonal - column_numbers);
-      for (const size_type *col=first_after_diagonal; col!=rowend; ++col, ++luval)
-        dst_row -= *luval * dst(*col);
-
-      // scale by the diagonal element.
-      // note that the diagonal element
-      // was stored inverted
-      dst(row) = dst_row * this->diag_element(row);
+      this->apply_level_by_level (true,
+                                  std_cxx11::bind (&SparseILU<number>::template
+                                                   forward_rows_on_level<somenumber>,
+                                                   this, &dst,
+                                                   std_cxx11::_1, std_cxx11::_2));
+      this->apply_level_by_level (false,
+                                  std_cxx11::bind (&SparseILU<number>::template
+                                                   backward_rows_on_level<somenumber>,
+                                                   this, &dst,
+                                                   std_cxx11::_1, std_cxx11::_2));
+    }
+  else
+    {
+      for (size_type row=0; row<N; ++row)
+        forward_row (row, dst);
+      for (size_type row=N; row>0; --row)
+        backward_row (row-1, dst);
     }
 }
 
@@ -0,0 +1,447 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__sparse_matrix_bsr_h
+#define dealii__sparse_matrix_bsr_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/smartpointer.h>
+#include <deal.II/lac/exceptions.h>
+#include <deal.II/lac/sparsity_pattern_bsr.h>
+
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+template<typename number> class Vector;
+template<typename number> class SparseMatrix;
+
+/*! @addtogroup Matrix1
+ *@{
+ */
+
+/**
+ * A sparse matrix in the block compressed sparse row (BSR) format with
+ * variable block sizes, based on a SparsityPatternBSR. For each pair of
+ * chunks of rows and columns present in the sparsity pattern, all entries
+ * are stored as a small dense matrix. Since there is only one column index
+ * per chunk pair, the memory transfer for the indices in matrix-vector
+ * products is reduced by up to the square of the chunk size compared to
+ * SparseMatrix, and the entries of a chunk pair are multiplied by dense
+ * kernels whose loop bounds are compile-time constants for chunk sizes up
+ * to four.
+ *
+ * The entries of one chunk row are stored contiguously: For a chunk row with
+ * $r$ rows, the chunk pairs appear in the order of the chunk sparsity
+ * pattern (i.e., the diagonal chunk first), each as a dense $r\times c$
+ * matrix in row-major order, where $c$ is the size of the respective column
+ * chunk.
+ *
+ * The matrix can be assembled like a SparseMatrix, for example through
+ * ConstraintMatrix::distribute_local_to_global(), or copied from an
+ * assembled SparseMatrix with copy_from(). It implements the functions
+ * vmult(), Tvmult(), vmult_add(), Tvmult_add(), and precondition_Jacobi(),
+ * which makes it possible to use it with the iterative solvers and with
+ * PreconditionJacobi and PreconditionChebyshev.
+ *
+ * @note Instantiations for this template are provided for <tt>@<float@> and
+ * @<double@></tt>; others can be generated in application programs (see the
+ * section on
+ * @ref Instantiations
+ * in the manual).
+ */
+template <typename number>
+class SparseMatrixBSR : public virtual Subscriptor
+{
+public:
+  /**
+   * Declare the type for container size.
+   */
+  typedef types::global_dof_index size_type;
+
+  /**
+   * Type of matrix entries. This typedef is analogous to <tt>value_type</tt>
+   * in the standard library containers.
+   */
+  typedef number value_type;
+
+  /**
+   * @name Constructors and initialization.
+   */
+//@{
+  /**
+   * Constructor. Creates an empty matrix that needs to be initialized with
+   * reinit() before use.
+   */
+  SparseMatrixBSR ();
+
+  /**
+   * Constructor. Sets up the matrix for the given sparsity pattern with all
+   * entries set to zero. The sparsity pattern is stored by reference and must
+   * remain valid as long as the matrix uses it.
+   */
+  explicit SparseMatrixBSR (const SparsityPatternBSR &sparsity_pattern);
+
+  /**
+   * Destructor.
+   */
+  ~SparseMatrixBSR ();
+
+  /**
+   * Set up the matrix for the given sparsity pattern with all entries set to
+   * zero.
+   */
+  void reinit (const SparsityPatternBSR &sparsity_pattern);
+
+  /**
+   * Release all memory and return to a state just like after having called
+   * the default constructor.
+   */
+  void clear ();
+
+  /**
+   * Set all entries to zero. The argument must be zero.
+   */
+  SparseMatrixBSR &operator = (const double d);
+
+  /**
+   * Copy the entries of the given @p matrix, whose sparsity pattern must be
+   * contained in the sparsity pattern of this object. Entries of this
+   * object that are not present in @p matrix are set to zero.
+   */
+  template <typename number2>
+  void copy_from (const SparseMatrix<number2> &matrix);
+//@}
+  /**
+   * @name Information on the matrix
+   */
+//@{
+  /**
+   * Return whether the object is empty.
+   */
+  bool empty () const;
+
+  /**
+   * Return the number of rows.
+   */
+  size_type m () const;
+
+  /**
+   * Return the number of columns.
+   */
+  size_type n () const;
+
+  /**
+   * Return the number of stored entries, including zero entries within the
+   * stored chunk pairs.
+   */
+  std::size_t n_nonzero_elements () const;
+
+  /**
+   * Return the sparsity pattern of this matrix.
+   */
+  const SparsityPatternBSR &get_sparsity_pattern () const;
+
+  /**
+   * Determine an estimate for the memory consumption (in bytes) of this
+   * object.
+   */
+  std::size_t memory_consumption () const;
+//@}
+  /**
+   * @name Modifying entries
+   */
+//@{
+  /**
+   * Set the element $(i,j)$ to @p value. The entry must be part of the
+   * sparsity pattern.
+   */
+  void set (const size_type i,
+            const size_type j,
+            const number    value);
+
+  /**
+   * Add @p value to the element $(i,j)$. The entry must be part of the
+   * sparsity pattern unless @p value is zero.
+   */
+  void add (const size_type i,
+            const size_type j,
+            const number    value);
+
+  /**
+   * Add the given values to the entries of row @p row in the columns given
+   * by @p col_indices, with the same meaning of the arguments as in
+   * SparseMatrix::add(). If the column indices are sorted, the entries are
+   * found in one pass through the chunk row.
+   */
+  template <typename number2>
+  void add (const size_type  row,
+            const size_type  n_cols,
+            const size_type *col_indices,
+            const number2   *values,
+            const bool       elide_zero_values = true,
+            const bool       col_indices_are_sorted = false);
+//@}
+  /**
+   * @name Entry access
+   */
+//@{
+  /**
+   * Return the value of the entry $(i,j)$, which must be part of the
+   * sparsity pattern.
+   */
+  number operator () (const size_type i,
+                      const size_type j) const;
+
+  /**
+   * Return the value of the entry $(i,j)$, or zero if it is not part of the
+   * sparsity pattern.
+   */
+  number el (const size_type i,
+             const size_type j) const;
+
+  /**
+   * Return the diagonal entry in row @p i.
+   */
+  number diag_element (const size_type i) const;
+//@}
+  /**
+   * @name Multiplications
+   */
+//@{
+  /**
+   * Matrix-vector multiplication: let $dst = M*src$ with $M$ being this
+   * matrix. The chunk rows are processed in parallel.
+   */
+  template <class OutVector, class InVector>
+  void vmult (OutVector      &dst,
+              const InVector &src) const;
+
+  /**
+   * Matrix-vector multiplication: let $dst = M^T*src$ with $M$ being this
+   * matrix.
+   */
+  template <class OutVector, class InVector>
+  void Tvmult (OutVector      &dst,
+               const InVector &src) const;
+
+  /**
+   * Adding matrix-vector multiplication. Add $M*src$ on $dst$ with $M$ being
+   * this matrix.
+   */
+  template <class OutVector, class InVector>
+  void vmult_add (OutVector      &dst,
+                  const InVector &src) const;
+
+  /**
+   * Adding matrix-vector multiplication. Add $M^T*src$ to $dst$ with $M$
+   * being this matrix.
+   */
+  template <class OutVector, class InVector>
+  void Tvmult_add (OutVector      &dst,
+                   const InVector &src) const;
+//@}
+  /**
+   * @name Preconditioning methods
+   */
+//@{
+  /**
+   * Apply the Jacobi preconditioner, which multiplies every element of the
+   * @p src vector by the inverse of the respective diagonal element and
+   * multiplies the result with the relaxation factor @p omega.
+   */
+  template <typename somenumber>
+  void precondition_Jacobi (Vector<somenumber>       &dst,
+                            const Vector<somenumber> &src,
+                            const number              omega = 1.) const;
+//@}
+  /**
+   * @addtogroup Exceptions
+   * @{
+   */
+
+  /**
+   * Exception
+   */
+  DeclException0 (ExcSourceEqualsDestination);
+
+  /**
+   * Exception
+   */
+  DeclException2 (ExcInvalidIndex,
+                  size_type, size_type,
+                  << "You are trying to access the matrix entry with index <"
+                  << arg1 << ',' << arg2
+                  << ">, but this entry does not exist in the sparsity pattern "
+                  "of this matrix.");
+  //@}
+
+private:
+  /**
+   * Return the index of the entry $(i,j)$ in the array of values, or
+   * numbers::invalid_size_type if the entry is not part of the sparsity
+   * pattern.
+   */
+  std::size_t value_index (const size_type i,
+                           const size_type j) const;
+
+  /**
+   * The sparsity pattern.
+   */
+  SmartPointer<const SparsityPatternBSR,SparseMatrixBSR<number> > cols;
+
+  /**
+   * The entries of the matrix, see the general documentation of this class
+   * for the layout.
+   */
+  std::vector<number> val;
+};
+
+/*@}*/
+
+#ifndef DOXYGEN
+/*---------------------- Inline functions -----------------------------------*/
+
+
+template <typename number>
+inline
+bool
+SparseMatrixBSR<number>::empty () const
+{
+  return cols == 0 || cols->empty();
+}
+
+
+
+template <typename number>
+inline
+typename SparseMatrixBSR<number>::size_type
+SparseMatrixBSR<number>::m () const
+{
+  return cols == 0 ? 0 : cols->n_rows();
+}
+
+
+
+template <typename number>
+inline
+typename SparseMatrixBSR<number>::size_type
+SparseMatrixBSR<number>::n () const
+{
+  return cols == 0 ? 0 : cols->n_cols();
+}
+
+
+
+template <typename number>
+inline
+std::size_t
+SparseMatrixBSR<number>::n_nonzero_elements () const
+{
+  return val.size();
+}
+
+
+
+template <typename number>
+inline
+const SparsityPatternBSR &
+SparseMatrixBSR<number>::get_sparsity_pattern () const
+{
+  Assert (cols != 0, ExcNotInitialized());
+  return *cols;
+}
+
+
+
+template <typename number>
+inline
+void
+SparseMatrixBSR<number>::set (const size_type i,
+                              const size_type j,
+                              const number    value)
+{
+  AssertIsFinite(value);
+  const std::size_t index = value_index (i, j);
+  Assert (index != numbers::invalid_size_type, ExcInvalidIndex(i, j));
+  val[index] = value;
+}
+
+
+
+template <typename number>
+inline
+void
+SparseMatrixBSR<number>::add (const size_type i,
+                              const size_type j,
+                              const number    value)
+{
+  AssertIsFinite(value);
+  if (value == number())
+    return;
+  const std::size_t index = value_index (i, j);
+  Assert (index != numbers::invalid_size_type, ExcInvalidIndex(i, j));
+  val[index] += value;
+}
+
+
+
+template <typename number>
+inline
+number
+SparseMatrixBSR<number>::operator () (const size_type i,
+                                      const size_type j) const
+{
+  const std::size_t index = value_index (i, j);
+  Assert (index != numbers::invalid_size_type, ExcInvalidIndex(i, j));
+  return val[index];
+}
+
+
+
+template <typename number>
+inline
+number
+SparseMatrixBSR<number>::el (const size_type i,
+                             const size_type j) const
+{
+  const std::size_t index = value_index (i, j);
+  return index != numbers::invalid_size_type ? val[index] : number();
+}
+
+
+
+template <typename number>
+inline
+number
+SparseMatrixBSR<number>::diag_element (const size_type i) const
+{
+  Assert (cols != 0, ExcNotInitialized());
+  AssertIndexRange (i, m());
+
+  // the diagonal chunk is stored first in each chunk row
+  const size_type chunk = cols->index_to_chunk[i];
+  const unsigned int local_row = i - cols->chunk_starts[chunk];
+  return val[cols->chunk_row_value_start[chunk] +
+             local_row * (cols->chunk_size(chunk) + 1)];
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,573 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__sparse_matrix_bsr_templates_h
+#define dealii__sparse_matrix_bsr_templates_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/template_constraints.h>
+#include <deal.II/lac/sparse_matrix_bsr.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <algorithm>
+#include <deal.II/base/std_cxx11/bind.h>
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace SparseMatrixBSR
+  {
+    typedef types::global_dof_index size_type;
+
+    /**
+     * Multiply the dense @p n_rows times @p n_cols chunk pair stored
+     * row-wise at @p values by the entries of @p src starting at
+     * @p col_start and add the result to @p sums. The sizes are template
+     * arguments such that the compiler can unroll the loops.
+     */
+    template <int n_rows, int n_cols,
+              typename number, typename InVector, typename sum_type>
+    inline
+    void
+    chunk_vmult (const number    *values,
+                 const InVector  &src,
+                 const size_type  col_start,
+                 sum_type        *sums)
+    {
+      sum_type x[n_cols];
+      for (int j=0; j<n_cols; ++j)
+        x[j] = src(col_start+j);
+      for (int i=0; i<n_rows; ++i)
+        for (int j=0; j<n_cols; ++j)
+          sums[i] += values[i*n_cols+j] * x[j];
+    }
+
+
+
+    /**
+     * Same as above for chunk sizes only known at run time.
+     */
+    template <typename number, typename InVector, typename sum_type>
+    inline
+    void
+    chunk_vmult (const unsigned int  n_rows,
+                 const unsigned int  n_cols,
+                 const number       *values,
+                 const InVector     &src,
+                 const size_type     col_start,
+                 sum_type           *sums)
+    {
+      for (unsigned int i=0; i<n_rows; ++i)
+        {
+          sum_type sum = sum_type();
+          for (unsigned int j=0; j<n_cols; ++j)
+            sum += values[i*n_cols+j] * src(col_start+j);
+          sums[i] += sum;
+        }
+    }
+
+
+
+    /**
+     * Select the kernel with compile-time column size for a chunk pair with
+     * @p n_rows rows.
+     */
+    template <int n_rows,
+              typename number, typename InVector, typename sum_type>
+    inline
+    void
+    chunk_vmult_select_cols (const unsigned int  n_cols,
+                             const number       *values,
+                             const InVector     &src,
+                             const size_type     col_start,
+                             sum_type           *sums)
+    {
+      switch (n_cols)
+        {
+        case 1:
+          chunk_vmult<n_rows,1> (values, src, col_start, sums);
+          break;
+        case 2:
+          chunk_vmult<n_rows,2> (values, src, col_start, sums);
+          break;
+        case 3:
+          chunk_vmult<n_rows,3> (values, src, col_start, sums);
+          break;
+        case 4:
+          chunk_vmult<n_rows,4> (values, src, col_start, sums);
+          break;
+        default:
+          chunk_vmult (n_rows, n_cols, values, src, col_start, sums);
+        }
+    }
+
+
+
+    /**
+     * Multiply the chunk pair of the given sizes by @p src, using the
+     * kernels with compile-time sizes for chunk sizes up to four.
+     */
+    template <typename number, typename InVector, typename sum_type>
+    inline
+    void
+    chunk_vmult_select (const unsigned int  n_rows,
+                        const unsigned int  n_cols,
+                        const number       *values,
+                        const InVector     &src,
+                        const size_type     col_start,
+                        sum_type           *sums)
+    {
+      switch (n_rows)
+        {
+        case 1:
+          chunk_vmult_select_cols<1> (n_cols, values, src, col_start, sums);
+          break;
+        case 2:
+          chunk_vmult_select_cols<2> (n_cols, values, src, col_start, sums);
+          break;
+        case 3:
+          chunk_vmult_select_cols<3> (n_cols, values, src, col_start, sums);
+          break;
+        case 4:
+          chunk_vmult_select_cols<4> (n_cols, values, src, col_start, sums);
+          break;
+        default:
+          chunk_vmult (n_rows, n_cols, values, src, col_start, sums);
+        }
+    }
+
+
+
+    /**
+     * Multiply the chunk rows in the range
+     * <code>[begin_chunk,end_chunk)</code> by the vector @p src and either
+     * write the result into @p dst or add it to @p dst, depending on @p add.
+     *
+     * In the sequential case, this function is called on all chunk rows, in
+     * the parallel case it may be called on a subrange, at the discretion of
+     * the task scheduler.
+     */
+    template <typename number,
+              typename InVector,
+              typename OutVector>
+    void vmult_on_subrange (const size_type           begin_chunk,
+                            const size_type           end_chunk,
+                            const number             *values,
+                            const size_type          *chunk_starts,
+                            const std::size_t        *chunk_row_value_start,
+                            const SparsityPattern    &chunk_sparsity_pattern,
+                            const InVector           &src,
+                            OutVector                &dst,
+                            const bool                add)
+    {
+      typedef typename OutVector::value_type sum_type;
+      std::vector<sum_type> sums;
+      for (size_type chunk=begin_chunk; chunk<end_chunk; ++chunk)
+        {
+          const unsigned int n_rows = chunk_starts[chunk+1] - chunk_starts[chunk];
+          sums.assign (n_rows, sum_type());
+
+          const number *chunk_values = values + chunk_row_value_start[chunk];
+          const unsigned int row_length = chunk_sparsity_pattern.row_length(chunk);
+          for (unsigned int k=0; k<row_length; ++k)
+            {
+              const size_type col_chunk = chunk_sparsity_pattern.column_number(chunk, k);
+              const unsigned int n_cols = chunk_starts[col_chunk+1] -
+                                          chunk_starts[col_chunk];
+              chunk_vmult_select (n_rows, n_cols, chunk_values, src,
+                                  chunk_starts[col_chunk], &sums[0]);
+              chunk_values += n_rows * n_cols;
+            }
+
+          for (unsigned int i=0; i<n_rows; ++i)
+            if (add)
+              dst(chunk_starts[chunk]+i) += sums[i];
+            else
+              dst(chunk_starts[chunk]+i) = sums[i];
+        }
+    }
+  }
+}
+
+
+
+template <typename number>
+SparseMatrixBSR<number>::SparseMatrixBSR ()
+  :
+  cols(0, "SparseMatrixBSR")
+{}
+
+
+
+template <typename number>
+SparseMatrixBSR<number>::SparseMatrixBSR (const SparsityPatternBSR &sparsity_pattern)
+  :
+  cols(0, "SparseMatrixBSR")
+{
+  reinit (sparsity_pattern);
+}
+
+
+
+template <typename number>
+SparseMatrixBSR<number>::~SparseMatrixBSR ()
+{
+  cols = 0;
+}
+
+
+
+template <typename number>
+void
+SparseMatrixBSR<number>::reinit (const SparsityPatternBSR &sparsity_pattern)
+{
+  cols = &sparsity_pattern;
+  val.assign (sparsity_pattern.n_nonzero_elements(), number());
+}
+
+
+
+template <typename number>
+void
+SparseMatrixBSR<number>::clear ()
+{
+  cols = 0;
+  std::vector<number>().swap (val);
+}
+
+
+
+template <typename number>
+SparseMatrixBSR<number> &
+SparseMatrixBSR<number>::operator = (const double d)
+{
+  (void)d;
+  Assert (d==0, ExcScalarAssignmentOnlyForZeroValue());
+
+  std::fill (val.begin(), val.end(), number());
+  return *this;
+}
+
+
+
+template <typename number>
+template <typename number2>
+void
+SparseMatrixBSR<number>::copy_from (const SparseMatrix<number2> &matrix)
+{
+  Assert (m() == matrix.m(), ExcDimensionMismatch(m(), matrix.m()));
+  Assert (n() == matrix.n(), ExcDimensionMismatch(n(), matrix.n()));
+
+  *this = 0;
+
+  // SparseMatrix stores the diagonal first and the remaining entries of a
+  // row sorted, so we can add the latter in one sweep through the chunk row
+  std::vector<size_type> column_indices;
+  std::vector<number2>   values;
+  for (size_type row=0; row<matrix.m(); ++row)
+    {
+      column_indices.clear();
+      values.clear();
+      for (typename SparseMatrix<number2>::const_iterator
+           entry = matrix.begin(row); entry != matrix.end(row); ++entry)
+        if (entry->column() == row)
+          add (row, row, entry->value());
+        else
+          {
+            column_indices.push_back (entry->column());
+            values.push_back (entry->value());
+          }
+      if (column_indices.size() > 0)
+        add (row, column_indices.size(), &column_indices[0], &values[0],
+             true, true);
+    }
+}
+
+
+
+template <typename number>
+std::size_t
+SparseMatrixBSR<number>::value_index (const size_type i,
+                                      const size_type j) const
+{
+  Assert (cols != 0, ExcNotInitialized());
+  AssertIndexRange (i, m());
+  AssertIndexRange (j, n());
+
+  const SparsityPatternBSR &pattern = *cols;
+  const size_type row_chunk = pattern.index_to_chunk[i];
+  const size_type col_chunk = pattern.index_to_chunk[j];
+  const unsigned int n_rows = pattern.chunk_size (row_chunk);
+  const unsigned int local_row = i - pattern.chunk_starts[row_chunk];
+  const unsigned int local_col = j - pattern.chunk_starts[col_chunk];
+  const std::size_t start = pattern.chunk_row_value_start[row_chunk];
+
+  if (row_chunk == col_chunk)
+    return start + local_row*n_rows + local_col;
+
+  // walk through the chunk row behind the diagonal chunk, which is sorted,
+  // and sum up the widths of the chunk pairs before the one we look for
+  const SparsityPattern &chunk_pattern = pattern.chunk_sparsity_pattern;
+  const unsigned int row_length = chunk_pattern.row_length (row_chunk);
+  std::size_t position = n_rows;
+  for (unsigned int k=1; k<row_length; ++k)
+    {
+      const size_type column = chunk_pattern.column_number (row_chunk, k);
+      const unsigned int n_cols = pattern.chunk_size (column);
+      if (column == col_chunk)
+        return start + n_rows*position + local_row*n_cols + local_col;
+      else if (column > col_chunk)
+        break;
+      position += n_cols;
+    }
+  return numbers::invalid_size_type;
+}
+
+
+
+template <typename number>
+template <typename number2>
+void
+SparseMatrixBSR<number>::add (const size_type  row,
+                              const size_type  n_cols,
+                              const size_type *col_indices,
+                              const number2   *values,
+                              const bool       elide_zero_values,
+                              const bool       col_indices_are_sorted)
+{
+  Assert (cols != 0, ExcNotInitialized());
+  AssertIndexRange (row, m());
+
+  if (col_indices_are_sorted == false)
+    {
+      for (size_type j=0; j<n_cols; ++j)
+        {
+          const number value = values[j];
+          AssertIsFinite(value);
+          if (elide_zero_values && value == number())
+            continue;
+          const std::size_t index = value_index (row, col_indices[j]);
+          Assert (index != numbers::invalid_size_type,
+                  ExcInvalidIndex(row, col_indices[j]));
+          val[index] += value;
+        }
+      return;
+    }
+
+  // for sorted column indices, the chunks of the columns are sorted as well
+  // and we can find all entries in one pass through the chunk row. the
+  // diagonal chunk comes first and is treated separately
+  const SparsityPatternBSR &pattern = *cols;
+  const SparsityPattern &chunk_pattern = pattern.chunk_sparsity_pattern;
+  const size_type row_chunk = pattern.index_to_chunk[row];
+  const unsigned int n_rows = pattern.chunk_size (row_chunk);
+  const unsigned int local_row = row - pattern.chunk_starts[row_chunk];
+  const unsigned int row_length = chunk_pattern.row_length (row_chunk);
+  number *row_values = &val[pattern.chunk_row_value_start[row_chunk]];
+
+  unsigned int k = 1;
+  std::size_t position = n_rows;
+  for (size_type j=0; j<n_cols; ++j)
+    {
+      const number value = values[j];
+      AssertIsFinite(value);
+      if (elide_zero_values && value == number())
+        continue;
+
+      const size_type col_chunk = pattern.index_to_chunk[col_indices[j]];
+      const unsigned int local_col = col_indices[j] - pattern.chunk_starts[col_chunk];
+      if (col_chunk == row_chunk)
+        {
+          row_values[local_row*n_rows + local_col] += value;
+          continue;
+        }
+
+      while (k<row_length &&
+             chunk_pattern.column_number (row_chunk, k) < col_chunk)
+        {
+          position += pattern.chunk_size (chunk_pattern.column_number (row_chunk, k));
+          ++k;
+        }
+      Assert (k<row_length &&
+              chunk_pattern.column_number (row_chunk, k) == col_chunk,
+              ExcInvalidIndex(row, col_indices[j]));
+      row_values[n_rows*position +
+                 local_row*pattern.chunk_size (col_chunk) + local_col] += value;
+    }
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixBSR<number>::vmult (OutVector      &dst,
+                                const InVector &src) const
+{
+  Assert(m() == dst.size(), ExcDimensionMismatch(m(),dst.size()));
+  Assert(n() == src.size(), ExcDimensionMismatch(n(),src.size()));
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  if (empty())
+    return;
+
+  parallel::apply_to_subranges (0U, cols->n_chunks(),
+                                std_cxx11::bind (&internal::SparseMatrixBSR::vmult_on_subrange
+                                                 <number,InVector,OutVector>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 &val[0],
+                                                 &cols->chunk_starts[0],
+                                                 &cols->chunk_row_value_start[0],
+                                                 std_cxx11::cref(cols->chunk_sparsity_pattern),
+                                                 std_cxx11::cref(src),
+                                                 std_cxx11::ref(dst),
+                                                 false),
+                                internal::SparseMatrix::minimum_parallel_grain_size);
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixBSR<number>::vmult_add (OutVector      &dst,
+                                    const InVector &src) const
+{
+  Assert(m() == dst.size(), ExcDimensionMismatch(m(),dst.size()));
+  Assert(n() == src.size(), ExcDimensionMismatch(n(),src.size()));
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  if (empty())
+    return;
+
+  parallel::apply_to_subranges (0U, cols->n_chunks(),
+                                std_cxx11::bind (&internal::SparseMatrixBSR::vmult_on_subrange
+                                                 <number,InVector,OutVector>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 &val[0],
+                                                 &cols->chunk_starts[0],
+                                                 &cols->chunk_row_value_start[0],
+                                                 std_cxx11::cref(cols->chunk_sparsity_pattern),
+                                                 std_cxx11::cref(src),
+                                                 std_cxx11::ref(dst),
+                                                 true),
+                                internal::SparseMatrix::minimum_parallel_grain_size);
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixBSR<number>::Tvmult (OutVector      &dst,
+                                 const InVector &src) const
+{
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  dst = 0;
+  Tvmult_add (dst, src);
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixBSR<number>::Tvmult_add (OutVector      &dst,
+                                     const InVector &src) const
+{
+  Assert(n() == dst.size(), ExcDimensionMismatch(n(),dst.size()));
+  Assert(m() == src.size(), ExcDimensionMismatch(m(),src.size()));
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  if (empty())
+    return;
+
+  // the transpose product scatters into the destination vector, which we do
+  // sequentially like SparseMatrix::Tvmult_add
+  typedef typename OutVector::value_type result_type;
+  const SparsityPatternBSR &pattern = *cols;
+  const SparsityPattern &chunk_pattern = pattern.chunk_sparsity_pattern;
+  const number *values = &val[0];
+  for (size_type chunk=0; chunk<pattern.n_chunks(); ++chunk)
+    {
+      const size_type row_start = pattern.chunk_starts[chunk];
+      const unsigned int n_rows = pattern.chunk_size (chunk);
+      const unsigned int row_length = chunk_pattern.row_length (chunk);
+      for (unsigned int k=0; k<row_length; ++k)
+        {
+          const size_type col_chunk = chunk_pattern.column_number (chunk, k);
+          const size_type col_start = pattern.chunk_starts[col_chunk];
+          const unsigned int n_cols = pattern.chunk_size (col_chunk);
+          for (unsigned int i=0; i<n_rows; ++i)
+            {
+              const result_type src_value = src(row_start+i);
+              for (unsigned int j=0; j<n_cols; ++j)
+                dst(col_start+j) += values[i*n_cols+j] * src_value;
+            }
+          values += n_rows * n_cols;
+        }
+    }
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void
+SparseMatrixBSR<number>::precondition_Jacobi (Vector<somenumber>       &dst,
+                                              const Vector<somenumber> &src,
+                                              const number              om) const
+{
+  Assert (cols != 0, ExcNotInitialized());
+  Assert (dst.size() == n(), ExcDimensionMismatch (dst.size(), n()));
+  Assert (src.size() == n(), ExcDimensionMismatch (src.size(), n()));
+
+  // the diagonal entries of a chunk row are the diagonal of the dense
+  // diagonal chunk, which comes first in the chunk row
+  const SparsityPatternBSR &pattern = *cols;
+  somenumber       *dst_ptr = dst.begin();
+  const somenumber *src_ptr = src.begin();
+  for (size_type chunk=0; chunk<pattern.n_chunks(); ++chunk)
+    {
+      const size_type row_start = pattern.chunk_starts[chunk];
+      const unsigned int n_rows = pattern.chunk_size (chunk);
+      const number *diag_ptr = &val[pattern.chunk_row_value_start[chunk]];
+      for (unsigned int i=0; i<n_rows; ++i, diag_ptr += n_rows+1)
+        dst_ptr[row_start+i] = om * src_ptr[row_start+i] / *diag_ptr;
+    }
+}
+
+
+
+template <typename number>
+std::size_t
+SparseMatrixBSR<number>::memory_consumption () const
+{
+  return (sizeof(*this) +
+          MemoryConsumption::memory_consumption(val));
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,452 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__sparse_matrix_sell_h
+#define dealii__sparse_matrix_sell_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/base/vectorization.h>
+#include <deal.II/lac/exceptions.h>
+
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+template<typename number> class Vector;
+template<typename number> class SparseMatrix;
+
+/*! @addtogroup Matrix1
+ *@{
+ */
+
+/**
+ * A sparse matrix stored in the sliced ELLPACK format with sorting windows,
+ * also known as SELL-C-$\sigma$ format. This class is meant as a read-only
+ * copy of an assembled SparseMatrix that provides faster matrix-vector
+ * products on hardware with SIMD units.
+ *
+ * The rows of the matrix are grouped into slices of
+ * <tt>C=VectorizedArray<number>::n_array_elements</tt> consecutive rows. The
+ * entries of all rows in a slice are stored in column-major order, i.e., the
+ * first entry of each of the @p C rows, then the second entry of each row,
+ * and so on, padded with zeros to the length of the longest row in the
+ * slice. This allows the matrix-vector product to process the @p C rows of a
+ * slice simultaneously with one VectorizedArray for the matrix entries and a
+ * gather operation for the entries of the source vector, rather than working
+ * on one row at a time with scalar indirect loads as done in the compressed
+ * row storage of SparseMatrix.
+ *
+ * In order to reduce the amount of padding for matrices with varying row
+ * lengths, the rows within windows of @p sigma consecutive rows are sorted
+ * by decreasing length before they are assigned to slices. Since the sorting
+ * is limited to a window, the access pattern into the source vector stays
+ * local. The default <tt>sigma=1</tt> keeps the original row order.
+ *
+ * This class implements the functions vmult(), Tvmult(), vmult_add(),
+ * Tvmult_add(), residual(), precondition_Jacobi(), and el(), which makes it
+ * possible to use it as a matrix in the iterative solvers such as SolverCG
+ * and SolverGMRES, as well as in preconditioners like PreconditionJacobi and
+ * PreconditionChebyshev. The values of the matrix cannot be changed after
+ * the matrix has been set up; the matrix needs to be re-created by reinit()
+ * once the values of the underlying SparseMatrix change.
+ *
+ * @note Column indices are stored as 32-bit integers to keep the index
+ * traffic low and to be able to use the hardware gather instructions. The
+ * number of columns must therefore be smaller than 2^31.
+ *
+ * @note Instantiations for this template are provided for <tt>@<float@> and
+ * @<double@></tt>; others can be generated in application programs (see the
+ * section on
+ * @ref Instantiations
+ * in the manual).
+ */
+template <typename number>
+class SparseMatrixSELL : public virtual Subscriptor
+{
+public:
+  /**
+   * Declare the type for container size.
+   */
+  typedef types::global_dof_index size_type;
+
+  /**
+   * Type of matrix entries. This typedef is analogous to <tt>value_type</tt>
+   * in the standard library containers.
+   */
+  typedef number value_type;
+
+  /**
+   * The number of rows in each slice, given by the length of the SIMD
+   * vectors for the given number type.
+   */
+  static const unsigned int slice_size = VectorizedArray<number>::n_array_elements;
+
+  /**
+   * @name Constructors and initialization.
+   */
+//@{
+  /**
+   * Constructor. Creates an empty matrix that needs to be initialized with
+   * reinit() before use.
+   */
+  SparseMatrixSELL ();
+
+  /**
+   * Constructor. Sets up the matrix by calling reinit() with the given
+   * arguments.
+   */
+  template <typename number2>
+  explicit SparseMatrixSELL (const SparseMatrix<number2> &matrix,
+                             const unsigned int           sigma = 1);
+
+  /**
+   * Copy the sparsity pattern and the values of the given @p matrix into the
+   * sliced ELLPACK format. The rows within each window of @p sigma rows are
+   * sorted by decreasing row length before they are grouped into slices. A
+   * value of one disables the sorting. Values of @p sigma larger than one
+   * should be a multiple of #slice_size.
+   *
+   * The given matrix is not referenced after this call, i.e., the matrix and
+   * its sparsity pattern may be destroyed afterwards.
+   */
+  template <typename number2>
+  void reinit (const SparseMatrix<number2> &matrix,
+               const unsigned int           sigma = 1);
+
+  /**
+   * Release all memory and return to a state just like after having called
+   * the default constructor.
+   */
+  void clear ();
+//@}
+  /**
+   * @name Information on the matrix
+   */
+//@{
+  /**
+   * Return whether the object is empty. It is empty if either of the two
+   * dimensions is zero.
+   */
+  bool empty () const;
+
+  /**
+   * Return the dimension of the codomain (or range) space. To remember: the
+   * matrix is of dimension $m \times n$.
+   */
+  size_type m () const;
+
+  /**
+   * Return the dimension of the domain space. To remember: the matrix is of
+   * dimension $m \times n$.
+   */
+  size_type n () const;
+
+  /**
+   * Return the number of nonzero elements of the matrix this object was
+   * created from, i.e., the number of entries in its sparsity pattern.
+   */
+  size_type n_nonzero_elements () const;
+
+  /**
+   * Return the number of entries actually stored by this object, including
+   * the zeros padded into slices with rows of different length. The ratio
+   * between this number and n_nonzero_elements() describes the overhead of
+   * the storage format for the given matrix and choice of @p sigma.
+   */
+  std::size_t n_stored_elements () const;
+
+  /**
+   * Return the sorting window @p sigma this object was set up with.
+   */
+  unsigned int get_sigma () const;
+
+  /**
+   * Determine an estimate for the memory consumption (in bytes) of this
+   * object. See MemoryConsumption.
+   */
+  std::size_t memory_consumption () const;
+//@}
+  /**
+   * @name Entry Access
+   */
+//@{
+  /**
+   * Return the value of the entry (<i>i,j</i>). If the entry is not part of
+   * the sparsity pattern, zero is returned. This function needs to search
+   * through the slice row and is thus not meant for performance-critical
+   * code.
+   */
+  number el (const size_type i,
+             const size_type j) const;
+
+  /**
+   * Return the main diagonal element in the <i>i</i>th row. This function
+   * throws an error if the matrix is not quadratic.
+   */
+  number diag_element (const size_type i) const;
+//@}
+  /**
+   * @name Matrix vector multiplications
+   */
+//@{
+  /**
+   * Matrix-vector multiplication: let <i>dst = M*src</i> with <i>M</i> being
+   * this matrix.
+   *
+   * Source and destination must not be the same vector.
+   *
+   * @dealiiOperationIsMultithreaded
+   */
+  template <class OutVector, class InVector>
+  void vmult (OutVector      &dst,
+              const InVector &src) const;
+
+  /**
+   * Matrix-vector multiplication: let <i>dst = M<sup>T</sup>*src</i> with
+   * <i>M</i> being this matrix. This function does the same as vmult() but
+   * takes the transposed matrix.
+   *
+   * Source and destination must not be the same vector.
+   */
+  template <class OutVector, class InVector>
+  void Tvmult (OutVector      &dst,
+               const InVector &src) const;
+
+  /**
+   * Adding Matrix-vector multiplication. Add <i>M*src</i> on <i>dst</i> with
+   * <i>M</i> being this matrix.
+   *
+   * Source and destination must not be the same vector.
+   *
+   * @dealiiOperationIsMultithreaded
+   */
+  template <class OutVector, class InVector>
+  void vmult_add (OutVector      &dst,
+                  const InVector &src) const;
+
+  /**
+   * Adding Matrix-vector multiplication. Add <i>M<sup>T</sup>*src</i> to
+   * <i>dst</i> with <i>M</i> being this matrix. This function does the same
+   * as vmult_add() but takes the transposed matrix.
+   *
+   * Source and destination must not be the same vector.
+   */
+  template <class OutVector, class InVector>
+  void Tvmult_add (OutVector      &dst,
+                   const InVector &src) const;
+
+  /**
+   * Compute the residual of an equation <i>Mx=b</i>, where the residual is
+   * defined to be <i>r=b-Mx</i>. Write the residual into <tt>dst</tt>. The
+   * <i>l<sub>2</sub></i> norm of the residual vector is returned.
+   *
+   * Source <i>x</i> and destination <i>dst</i> must not be the same vector.
+   *
+   * @dealiiOperationIsMultithreaded
+   */
+  template <typename somenumber>
+  somenumber residual (Vector<somenumber>       &dst,
+                       const Vector<somenumber> &x,
+                       const Vector<somenumber> &b) const;
+//@}
+  /**
+   * @name Preconditioning methods
+   */
+//@{
+  /**
+   * Apply the Jacobi preconditioner, which multiplies every element of the
+   * <tt>src</tt> vector by the inverse of the respective diagonal element and
+   * multiplies the result with the relaxation factor <tt>omega</tt>.
+   */
+  template <typename somenumber>
+  void precondition_Jacobi (Vector<somenumber>       &dst,
+                            const Vector<somenumber> &src,
+                            const number              omega = 1.) const;
+//@}
+  /**
+   * @addtogroup Exceptions
+   * @{
+   */
+
+  /**
+   * Exception
+   */
+  DeclException0 (ExcSourceEqualsDestination);
+
+  /**
+   * Exception
+   */
+  DeclException1 (ExcTooManyColumns,
+                  size_type,
+                  << "The matrix has " << arg1 << " columns, but the sliced "
+                  << "ELLPACK format stores column indices as 32-bit integers "
+                  << "and can only represent matrices with less than 2^31 "
+                  << "columns.");
+  //@}
+private:
+  /**
+   * Number of rows of the matrix.
+   */
+  size_type n_rows;
+
+  /**
+   * Number of columns of the matrix.
+   */
+  size_type n_cols;
+
+  /**
+   * Number of entries in the sparsity pattern of the original matrix.
+   */
+  size_type n_nonzeros;
+
+  /**
+   * The sorting window used in reinit().
+   */
+  unsigned int sigma;
+
+  /**
+   * The matrix row stored in each slot of a slice, with the slots of slice
+   * @p s at positions <tt>s*slice_size</tt> through
+   * <tt>(s+1)*slice_size-1</tt>. Unused slots at the end of the last slice
+   * are marked by numbers::invalid_dof_index.
+   */
+  std::vector<size_type> slot_to_row;
+
+  /**
+   * The inverse of #slot_to_row, i.e., the slot in which the given matrix row
+   * is stored.
+   */
+  std::vector<size_type> row_to_slot;
+
+  /**
+   * Start of each slice within #values, in units of VectorizedArray. This
+   * array has one more entry than there are slices, such that the number of
+   * entries in a slice row is given by the difference of two consecutive
+   * entries.
+   */
+  std::vector<std::size_t> slice_start;
+
+  /**
+   * The matrix entries, one VectorizedArray per slice column.
+   */
+  AlignedVector<VectorizedArray<number> > values;
+
+  /**
+   * The column indices of the entries in #values, with #slice_size indices
+   * per slice column. Padded entries point to the last valid column of the
+   * respective row, such that no additional cache lines are touched.
+   */
+  std::vector<unsigned int> column_indices;
+
+  /**
+   * The diagonal of the matrix in the original row order, used by
+   * diag_element(). Empty if the matrix is not quadratic.
+   */
+  std::vector<number> diagonal;
+
+  /**
+   * The inverse of the diagonal in the order of the slots, one
+   * VectorizedArray per slice, used for the Jacobi preconditioner. Unused
+   * slots at the end of the last slice are zero. Empty if the matrix is not
+   * quadratic.
+   */
+  AlignedVector<VectorizedArray<number> > inverse_diagonal;
+};
+
+/*@}*/
+
+#ifndef DOXYGEN
+/*---------------------- Inline functions -----------------------------------*/
+
+
+
+template <typename number>
+inline
+bool
+SparseMatrixSELL<number>::empty () const
+{
+  return n_rows == 0 || n_cols == 0;
+}
+
+
+
+template <typename number>
+inline
+typename SparseMatrixSELL<number>::size_type
+SparseMatrixSELL<number>::m () const
+{
+  return n_rows;
+}
+
+
+
+template <typename number>
+inline
+typename SparseMatrixSELL<number>::size_type
+SparseMatrixSELL<number>::n () const
+{
+  return n_cols;
+}
+
+
+
+template <typename number>
+inline
+typename SparseMatrixSELL<number>::size_type
+SparseMatrixSELL<number>::n_nonzero_elements () const
+{
+  return n_nonzeros;
+}
+
+
+
+template <typename number>
+inline
+std::size_t
+SparseMatrixSELL<number>::n_stored_elements () const
+{
+  return values.size() * slice_size;
+}
+
+
+
+template <typename number>
+inline
+unsigned int
+SparseMatrixSELL<number>::get_sigma () const
+{
+  return sigma;
+}
+
+
+
+template <typename number>
+inline
+number
+SparseMatrixSELL<number>::diag_element (const size_type i) const
+{
+  Assert (m() == n(), ExcNotQuadratic());
+  AssertIndexRange(i, diagonal.size());
+  return diagonal[i];
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
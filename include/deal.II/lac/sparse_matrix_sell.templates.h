@@ -0,0 +1,570 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__sparse_matrix_sell_templates_h
+#define dealii__sparse_matrix_sell_templates_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/template_constraints.h>
+#include <deal.II/lac/sparse_matrix_sell.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deal.II/base/std_cxx11/bind.h>
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace SparseMatrixSELL
+  {
+    typedef types::global_dof_index size_type;
+
+    /**
+     * Comparison function for sorting pairs of row length and row index by
+     * decreasing row length.
+     */
+    inline
+    bool
+    longer_row (const std::pair<size_type,size_type> &a,
+                const std::pair<size_type,size_type> &b)
+    {
+      return a.first > b.first;
+    }
+
+
+
+    /**
+     * Read the entries of @p src at the given @p indices into the lanes of a
+     * VectorizedArray. This is the general implementation for arbitrary
+     * vector types that goes through the element access operator of the
+     * vector.
+     */
+    template <typename number, typename InVector>
+    inline
+    void
+    gather_entries (VectorizedArray<number> &x,
+                    const InVector          &src,
+                    const unsigned int      *indices)
+    {
+      for (unsigned int v=0; v<VectorizedArray<number>::n_array_elements; ++v)
+        x[v] = src(indices[v]);
+    }
+
+
+
+    /**
+     * Specialization of the gather operation for deal.II vectors with the
+     * same number type as the matrix, which use the gather instructions of
+     * the hardware when available.
+     */
+    template <typename number>
+    inline
+    void
+    gather_entries (VectorizedArray<number>        &x,
+                    const ::dealii::Vector<number> &src,
+                    const unsigned int             *indices)
+    {
+      x.gather(src.begin(), indices);
+    }
+
+
+
+    /**
+     * Multiply the rows of the slices in the range
+     * <code>[begin_slice,end_slice)</code> by the vector @p src and either
+     * write the result into @p dst or add it to @p dst, depending on @p add.
+     *
+     * In the sequential case, this function is called on all slices, in the
+     * parallel case it may be called on a subrange, at the discretion of the
+     * task scheduler.
+     */
+    template <typename number,
+              typename InVector,
+              typename OutVector>
+    void vmult_on_subrange (const size_type                        begin_slice,
+                            const size_type                        end_slice,
+                            const VectorizedArray<number>         *values,
+                            const unsigned int                    *column_indices,
+                            const std::size_t                     *slice_start,
+                            const size_type                       *slot_to_row,
+                            const InVector                        &src,
+                            OutVector                             &dst,
+                            const bool                             add)
+    {
+      const unsigned int n_lanes = VectorizedArray<number>::n_array_elements;
+      for (size_type slice=begin_slice; slice<end_slice; ++slice)
+        {
+          VectorizedArray<number> sum = VectorizedArray<number>();
+          for (std::size_t j=slice_start[slice]; j<slice_start[slice+1]; ++j)
+            {
+              VectorizedArray<number> x;
+              gather_entries(x, src, column_indices+j*n_lanes);
+              sum += values[j] * x;
+            }
+
+          const size_type *rows = slot_to_row + slice*n_lanes;
+          for (unsigned int v=0; v<n_lanes; ++v)
+            if (rows[v] != numbers::invalid_dof_index)
+              {
+                if (add)
+                  dst(rows[v]) += typename OutVector::value_type(sum[v]);
+                else
+                  dst(rows[v]) = typename OutVector::value_type(sum[v]);
+              }
+        }
+    }
+
+
+
+    /**
+     * Compute the residual $b-Mx$ for the rows of the slices in the range
+     * <code>[begin_slice,end_slice)</code> and return the square of its
+     * $l_2$ norm on these rows.
+     */
+    template <typename number,
+              typename somenumber>
+    somenumber
+    residual_on_subrange (const size_type                 begin_slice,
+                          const size_type                 end_slice,
+                          const VectorizedArray<number>  *values,
+                          const unsigned int             *column_indices,
+                          const std::size_t              *slice_start,
+                          const size_type                *slot_to_row,
+                          const ::dealii::Vector<somenumber> &x,
+                          const ::dealii::Vector<somenumber> &b,
+                          ::dealii::Vector<somenumber>   &dst)
+    {
+      const unsigned int n_lanes = VectorizedArray<number>::n_array_elements;
+      somenumber norm_sqr = 0.;
+      for (size_type slice=begin_slice; slice<end_slice; ++slice)
+        {
+          VectorizedArray<number> sum = VectorizedArray<number>();
+          for (std::size_t j=slice_start[slice]; j<slice_start[slice+1]; ++j)
+            {
+              VectorizedArray<number> xj;
+              gather_entries(xj, x, column_indices+j*n_lanes);
+              sum += values[j] * xj;
+            }
+
+          const size_type *rows = slot_to_row + slice*n_lanes;
+          for (unsigned int v=0; v<n_lanes; ++v)
+            if (rows[v] != numbers::invalid_dof_index)
+              {
+                const somenumber r = b(rows[v]) - somenumber(sum[v]);
+                dst(rows[v]) = r;
+                norm_sqr += r * r;
+              }
+        }
+      return norm_sqr;
+    }
+
+
+
+    /**
+     * Apply the Jacobi preconditioner with relaxation factor @p om to the
+     * rows of the slices in the range <code>[begin_slice,end_slice)</code>,
+     * multiplying by the inverse diagonal of one slice at a time.
+     */
+    template <typename number,
+              typename somenumber>
+    void
+    precondition_Jacobi_on_subrange (const size_type                begin_slice,
+                                     const size_type                end_slice,
+                                     const VectorizedArray<number> *inverse_diagonal,
+                                     const size_type               *slot_to_row,
+                                     const number                   om,
+                                     const somenumber              *src,
+                                     somenumber                    *dst)
+    {
+      const unsigned int n_lanes = VectorizedArray<number>::n_array_elements;
+      for (size_type slice=begin_slice; slice<end_slice; ++slice)
+        {
+          const size_type *rows = slot_to_row + slice*n_lanes;
+          VectorizedArray<number> x = VectorizedArray<number>();
+          for (unsigned int v=0; v<n_lanes; ++v)
+            if (rows[v] != numbers::invalid_dof_index)
+              x[v] = src[rows[v]];
+
+          x *= om * inverse_diagonal[slice];
+
+          for (unsigned int v=0; v<n_lanes; ++v)
+            if (rows[v] != numbers::invalid_dof_index)
+              dst[rows[v]] = somenumber(x[v]);
+        }
+    }
+  }
+}
+
+
+
+template <typename number>
+SparseMatrixSELL<number>::SparseMatrixSELL ()
+  :
+  n_rows (0),
+  n_cols (0),
+  n_nonzeros (0),
+  sigma (1)
+{}
+
+
+
+template <typename number>
+template <typename number2>
+SparseMatrixSELL<number>::SparseMatrixSELL (const SparseMatrix<number2> &matrix,
+                                            const unsigned int           sigma_in)
+  :
+  n_rows (0),
+  n_cols (0),
+  n_nonzeros (0),
+  sigma (1)
+{
+  reinit (matrix, sigma_in);
+}
+
+
+
+template <typename number>
+template <typename number2>
+void
+SparseMatrixSELL<number>::reinit (const SparseMatrix<number2> &matrix,
+                                  const unsigned int           sigma_in)
+{
+  Assert (sigma_in > 0, ExcMessage("The sorting window must not be empty"));
+  AssertThrow (matrix.n() < (static_cast<size_type>(1) << 31),
+               ExcTooManyColumns(matrix.n()));
+
+  clear ();
+  if (matrix.m() == 0 || matrix.n() == 0)
+    return;
+
+  n_rows = matrix.m();
+  n_cols = matrix.n();
+  n_nonzeros = matrix.n_nonzero_elements();
+  sigma = sigma_in;
+
+  const size_type n_slices = (n_rows + slice_size - 1) / slice_size;
+
+  // sort the rows by decreasing length within each window of sigma rows. use
+  // a stable sort in order to keep the original order for rows of the same
+  // length
+  std::vector<std::pair<size_type,size_type> > lengths(n_rows);
+  for (size_type row=0; row<n_rows; ++row)
+    lengths[row] = std::make_pair(matrix.get_row_length(row), row);
+  if (sigma > 1)
+    for (size_type start=0; start<n_rows; start+=sigma)
+      {
+        const size_type end = std::min(start+sigma, n_rows);
+        std::stable_sort(lengths.begin()+start, lengths.begin()+end,
+                         &internal::SparseMatrixSELL::longer_row);
+      }
+
+  slot_to_row.resize(n_slices*slice_size, numbers::invalid_dof_index);
+  row_to_slot.resize(n_rows);
+  for (size_type slot=0; slot<n_rows; ++slot)
+    {
+      slot_to_row[slot] = lengths[slot].second;
+      row_to_slot[lengths[slot].second] = slot;
+    }
+
+  // the width of each slice is determined by the longest row in the slice
+  slice_start.resize(n_slices+1);
+  slice_start[0] = 0;
+  for (size_type slice=0; slice<n_slices; ++slice)
+    {
+      size_type max_length = 0;
+      for (unsigned int v=0; v<slice_size; ++v)
+        if (slice*slice_size+v < n_rows)
+          max_length = std::max(max_length, lengths[slice*slice_size+v].first);
+      slice_start[slice+1] = slice_start[slice] + max_length;
+    }
+
+  // copy the entries row by row into the slices. padded entries get a zero
+  // value and repeat the last column index of the row (or the column of the
+  // first entry in the first row for empty rows)
+  values.resize_fast(slice_start[n_slices]);
+  column_indices.resize(slice_start[n_slices]*slice_size);
+  for (size_type slot=0; slot<n_slices*slice_size; ++slot)
+    {
+      const size_type slice = slot / slice_size;
+      const unsigned int lane = slot % slice_size;
+      std::size_t index = slice_start[slice];
+      unsigned int last_column = 0;
+      if (slot < n_rows)
+        for (typename SparseMatrix<number2>::const_iterator
+             entry = matrix.begin(slot_to_row[slot]);
+             entry != matrix.end(slot_to_row[slot]); ++entry, ++index)
+          {
+            last_column = entry->column();
+            values[index][lane] = entry->value();
+            column_indices[index*slice_size+lane] = last_column;
+          }
+      for ( ; index<slice_start[slice+1]; ++index)
+        {
+          values[index][lane] = number();
+          column_indices[index*slice_size+lane] = last_column;
+        }
+    }
+
+  if (n_rows == n_cols)
+    {
+      diagonal.resize(n_rows);
+      for (size_type row=0; row<n_rows; ++row)
+        diagonal[row] = matrix.diag_element(row);
+
+      inverse_diagonal.resize(n_slices);
+      for (size_type slot=0; slot<n_rows; ++slot)
+        inverse_diagonal[slot/slice_size][slot%slice_size]
+          = number(1.)/diagonal[slot_to_row[slot]];
+    }
+}
+
+
+
+template <typename number>
+void
+SparseMatrixSELL<number>::clear ()
+{
+  n_rows = 0;
+  n_cols = 0;
+  n_nonzeros = 0;
+  sigma = 1;
+  std::vector<size_type>().swap(slot_to_row);
+  std::vector<size_type>().swap(row_to_slot);
+  std::vector<std::size_t>().swap(slice_start);
+  values.clear();
+  std::vector<unsigned int>().swap(column_indices);
+  std::vector<number>().swap(diagonal);
+  inverse_diagonal.clear();
+}
+
+
+
+template <typename number>
+number
+SparseMatrixSELL<number>::el (const size_type i,
+                              const size_type j) const
+{
+  AssertIndexRange(i, m());
+  AssertIndexRange(j, n());
+
+  const size_type slot = row_to_slot[i];
+  const size_type slice = slot / slice_size;
+  const unsigned int lane = slot % slice_size;
+  // padded entries come after the actual entries of the row and repeat its
+  // last column index, so the first match is the actual entry
+  for (std::size_t index=slice_start[slice]; index<slice_start[slice+1]; ++index)
+    if (column_indices[index*slice_size+lane] == j)
+      return values[index][lane];
+  return number();
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixSELL<number>::vmult (OutVector      &dst,
+                                 const InVector &src) const
+{
+  Assert(m() == dst.size(), ExcDimensionMismatch(m(),dst.size()));
+  Assert(n() == src.size(), ExcDimensionMismatch(n(),src.size()));
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  if (empty())
+    return;
+
+  parallel::apply_to_subranges (0U, slice_start.size()-1,
+                                std_cxx11::bind (&internal::SparseMatrixSELL::vmult_on_subrange
+                                                 <number,InVector,OutVector>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 values.begin(),
+                                                 &column_indices[0],
+                                                 &slice_start[0],
+                                                 &slot_to_row[0],
+                                                 std_cxx11::cref(src),
+                                                 std_cxx11::ref(dst),
+                                                 false),
+                                internal::SparseMatrix::minimum_parallel_grain_size/slice_size+1);
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixSELL<number>::vmult_add (OutVector      &dst,
+                                     const InVector &src) const
+{
+  Assert(m() == dst.size(), ExcDimensionMismatch(m(),dst.size()));
+  Assert(n() == src.size(), ExcDimensionMismatch(n(),src.size()));
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  if (empty())
+    return;
+
+  parallel::apply_to_subranges (0U, slice_start.size()-1,
+                                std_cxx11::bind (&internal::SparseMatrixSELL::vmult_on_subrange
+                                                 <number,InVector,OutVector>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 values.begin(),
+                                                 &column_indices[0],
+                                                 &slice_start[0],
+                                                 &slot_to_row[0],
+                                                 std_cxx11::cref(src),
+                                                 std_cxx11::ref(dst),
+                                                 true),
+                                internal::SparseMatrix::minimum_parallel_grain_size/slice_size+1);
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixSELL<number>::Tvmult (OutVector      &dst,
+                                  const InVector &src) const
+{
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  dst = 0;
+  Tvmult_add (dst, src);
+}
+
+
+
+template <typename number>
+template <class OutVector, class InVector>
+void
+SparseMatrixSELL<number>::Tvmult_add (OutVector      &dst,
+                                      const InVector &src) const
+{
+  Assert(n() == dst.size(), ExcDimensionMismatch(n(),dst.size()));
+  Assert(m() == src.size(), ExcDimensionMismatch(m(),src.size()));
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  if (empty())
+    return;
+
+  // the transpose product scatters into the destination vector, which we do
+  // sequentially like SparseMatrix::Tvmult_add. the padded entries are zero
+  // and can be added without harm
+  const size_type n_slices = slice_start.size()-1;
+  for (size_type slice=0; slice<n_slices; ++slice)
+    {
+      VectorizedArray<number> src_values = VectorizedArray<number>();
+      for (unsigned int v=0; v<slice_size; ++v)
+        if (slot_to_row[slice*slice_size+v] != numbers::invalid_dof_index)
+          src_values[v] = src(slot_to_row[slice*slice_size+v]);
+
+      for (std::size_t j=slice_start[slice]; j<slice_start[slice+1]; ++j)
+        {
+          const VectorizedArray<number> products = values[j] * src_values;
+          for (unsigned int v=0; v<slice_size; ++v)
+            dst(column_indices[j*slice_size+v]) +=
+              typename OutVector::value_type(products[v]);
+        }
+    }
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+somenumber
+SparseMatrixSELL<number>::residual (Vector<somenumber>       &dst,
+                                    const Vector<somenumber> &u,
+                                    const Vector<somenumber> &b) const
+{
+  Assert(m() == dst.size(), ExcDimensionMismatch(m(),dst.size()));
+  Assert(m() == b.size(), ExcDimensionMismatch(m(),b.size()));
+  Assert(n() == u.size(), ExcDimensionMismatch(n(),u.size()));
+  Assert (&u != &dst, ExcSourceEqualsDestination());
+
+  if (empty())
+    return 0.;
+
+  return
+    std::sqrt
+    (parallel::accumulate_from_subranges<somenumber>
+     (std_cxx11::bind (&internal::SparseMatrixSELL::residual_on_subrange
+                       <number,somenumber>,
+                       std_cxx11::_1, std_cxx11::_2,
+                       values.begin(),
+                       &column_indices[0],
+                       &slice_start[0],
+                       &slot_to_row[0],
+                       std_cxx11::cref(u),
+                       std_cxx11::cref(b),
+                       std_cxx11::ref(dst)),
+      0, slice_start.size()-1,
+      internal::SparseMatrix::minimum_parallel_grain_size/slice_size+1));
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void
+SparseMatrixSELL<number>::precondition_Jacobi (Vector<somenumber>       &dst,
+                                               const Vector<somenumber> &src,
+                                               const number              om) const
+{
+  Assert (m() == n(), ExcNotQuadratic());
+  Assert (dst.size() == n(), ExcDimensionMismatch (dst.size(), n()));
+  Assert (src.size() == n(), ExcDimensionMismatch (src.size(), n()));
+
+  if (empty())
+    return;
+
+  parallel::apply_to_subranges (0U, slice_start.size()-1,
+                                std_cxx11::bind (&internal::SparseMatrixSELL::precondition_Jacobi_on_subrange
+                                                 <number,somenumber>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 inverse_diagonal.begin(),
+                                                 &slot_to_row[0],
+                                                 om,
+                                                 src.begin(),
+                                                 dst.begin()),
+                                internal::SparseMatrix::minimum_parallel_grain_size/slice_size+1);
+}
+
+
+
+template <typename number>
+std::size_t
+SparseMatrixSELL<number>::memory_consumption () const
+{
+  return (sizeof(*this) +
+          MemoryConsumption::memory_consumption(slot_to_row) +
+          MemoryConsumption::memory_consumption(row_to_slot) +
+          MemoryConsumption::memory_consumption(slice_start) +
+          values.memory_consumption() +
+          MemoryConsumption::memory_consumption(column_indices) +
+          MemoryConsumption::memory_consumption(diagonal) +
+          inverse_diagonal.memory_consumption());
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
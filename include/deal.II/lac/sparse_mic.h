@@ -172,6 +172,59 @@ private:
    * Compute the row-th "inner sum".
    */
   number get_rowsum (const size_type row) const;
+
+  /**
+   * Compute the entries of #diag and #inv_diag for the rows given by the
+   * entries @p begin to @p end of the array of rows sorted by levels of the
+   * lower triangular part.
+   */
+  template <typename somenumber>
+  void factorize_rows_on_level (const SparseMatrix<somenumber> *matrix,
+                                const size_type                 begin,
+                                const size_type                 end);
+
+  /**
+   * Compute the entries of #diag and #inv_diag for one row.
+   */
+  template <typename somenumber>
+  void factorize_row (const SparseMatrix<somenumber> &matrix,
+                      const size_type                 row);
+
+  /**
+   * Perform the forward substitution with the lower triangular factor for
+   * one row.
+   */
+  template <typename somenumber>
+  void forward_row (const size_type     row,
+                    Vector<somenumber> &dst) const;
+
+  /**
+   * Scale one row by the diagonal and perform the backward substitution with
+   * the upper triangular factor.
+   */
+  template <typename somenumber>
+  void backward_row (const size_type     row,
+                     Vector<somenumber> &dst) const;
+
+  /**
+   * Perform the forward substitution for the rows given by the entries @p
+   * begin to @p end of the array of rows sorted by levels of the lower
+   * triangular part.
+   */
+  template <typename somenumber>
+  void forward_rows_on_level (Vector<somenumber> *dst,
+                              const size_type     begin,
+                              const size_type     end) const;
+
+  /**
+   * Perform the backward substitution for the rows given by the entries @p
+   * begin to @p end of the array of rows sorted by levels of the upper
+   * triangular part.
+   */
+  template <typename somenumber>
+  void backward_rows_on_level (Vector<somenumber> *dst,
+                               const size_type     begin,
+                               const size_type     end) const;
 };
 
 /*@}*/
@@ -18,6 +18,7 @@
 
 
 #include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/std_cxx11/bind.h>
 #include <deal.II/lac/sparse_mic.h>
 #include <deal.II/lac/vector.h>
 
@@ -97,24 +98,73 @@ void SparseMIC<number>::initialize (const SparseMatrix<somenumber> &matrix,
   for (size_type row=0; row<this->m(); row++)
     inner_sums[row] = get_rowsum(row);
 
-  for (size_type row=0; row<this->m(); row++)
-    {
-      const number temp = this->begin(row)->value();
-      number temp1 = 0;
-
-      // work on the lower left part of the matrix. we know
-      // it's symmetric, so we can work with this alone
+  // a row depends on the rows of the entries left of the diagonal in the
+  // given matrix, whereas the levels are computed from the sparsity pattern
+  // of the decomposition. rows on the same level can only be computed in
+  // parallel if the latter contains all of these entries, which is the case
+  // if the matrix uses the same sparsity pattern, but not necessarily if
+  // a different one was given in the AdditionalData object
+  this->compute_level_schedule ();
+  bool levels_cover_matrix = this->use_level_schedule();
+  if (levels_cover_matrix &&
+      (&this->get_sparsity_pattern() != &matrix.get_sparsity_pattern()))
+    for (size_type row=0; (row<this->m()) && levels_cover_matrix; ++row)
       for (typename SparseMatrix<somenumber>::const_iterator
            p = matrix.begin(row)+1;
            (p != matrix.end(row)) && (p->column() < row);
            ++p)
-        temp1 += p->value() / diag[p->column()] * inner_sums[p->column()];
+        if (this->get_sparsity_pattern().exists (row, p->column()) == false)
+          {
+            levels_cover_matrix = false;
+            break;
+          }
+
+  if (levels_cover_matrix)
+    this->apply_level_by_level (true,
+                                std_cxx11::bind (&SparseMIC<number>::template
+                                                 factorize_rows_on_level<somenumber>,
+                                                 this, &matrix,
+                                                 std_cxx11::_1, std_cxx11::_2));
+  else
+    for (size_type row=0; row<this->m(); row++)
+      factorize_row (matrix, row);
+}
 
-      Assert(temp-temp1 > 0, ExcStrengthenDiagonalTooSmall());
-      diag[row] = temp - temp1;
 
-      inv_diag[row] = 1.0/diag[row];
-    }
+
+template <typename number>
+template <typename somenumber>
+inline
+void SparseMIC<number>::factorize_row (const SparseMatrix<somenumber> &matrix,
+                                       const size_type                 row)
+{
+  const number temp = this->begin(row)->value();
+  number temp1 = 0;
+
+  // work on the lower left part of the matrix. we know
+  // it's symmetric, so we can work with this alone
+  for (typename SparseMatrix<somenumber>::const_iterator
+       p = matrix.begin(row)+1;
+       (p != matrix.end(row)) && (p->column() < row);
+       ++p)
+    temp1 += p->value() / diag[p->column()] * inner_sums[p->column()];
+
+  Assert(temp-temp1 > 0, ExcStrengthenDiagonalTooSmall());
+  diag[row] = temp - temp1;
+
+  inv_diag[row] = 1.0/diag[row];
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void SparseMIC<number>::factorize_rows_on_level (const SparseMatrix<somenumber> *matrix,
+                                                 const size_type                 begin,
+                                                 const size_type                 end)
+{
+  for (size_type i=begin; i<end; ++i)
+    factorize_row (*matrix, this->lower_level_rows[i]);
 }
 
 
@@ -137,6 +187,78 @@ SparseMIC<number>::get_rowsum (const size_type row) const
 
 
 
+template <typename number>
+template <typename somenumber>
+inline
+void
+SparseMIC<number>::forward_row (const size_type     row,
+                                Vector<somenumber> &dst) const
+{
+  // get start of this row. skip
+  // the diagonal element
+  for (typename SparseMatrix<number>::const_iterator
+       p = this->begin(row)+1;
+       (p != this->end(row)) && (p->column() < row);
+       ++p)
+    dst(row) -= p->value() * dst(p->column());
+
+  dst(row) *= inv_diag[row];
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+inline
+void
+SparseMIC<number>::backward_row (const size_type     row,
+                                 Vector<somenumber> &dst) const
+{
+  // v = Xu for this row. the
+  // backward substitution only
+  // accesses rows that are already
+  // done, so this can be done here
+  dst(row) *= diag[row];
+
+  // get end of this row
+  for (typename SparseMatrix<number>::const_iterator
+       p = this->begin(row)+1;
+       p != this->end(row);
+       ++p)
+    if (p->column() > row)
+      dst(row) -= p->value() * dst(p->column());
+
+  dst(row) *= inv_diag[row];
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void
+SparseMIC<number>::forward_rows_on_level (Vector<somenumber> *dst,
+                                          const size_type     begin,
+                                          const size_type     end) const
+{
+  for (size_type i=begin; i<end; ++i)
+    forward_row (this->lower_level_rows[i], *dst);
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void
+SparseMIC<number>::backward_rows_on_level (Vector<somenumber> *dst,
+                                           const size_type     begin,
+                                           const size_type     end) const
+{
+  for (size_type i=begin; i<end; ++i)
+    backward_row (this->upper_level_rows[i], *dst);
+}
+
+
+
 template <typename number>
 template <typename somenumber>
 void
@@ -150,39 +272,30 @@ SparseMIC<number>::vmult (Vector<somenumber>       &dst,
   // We assume the underlying matrix A is: A = X - L - U, where -L and -U are
   // strictly lower- and upper- diagonal parts of the system.
   //
-  // Solve (X-L)X{-1}(X-U) x = b in 3 steps:
+  // Solve (X-L)X{-1}(X-U) x = b in 3 steps: (X-L)u = b, v = Xu, and
+  // (X-U)x = v, where the second step is merged into the third. If there
+  // are enough rows per level, the rows of each level are processed in
+  // parallel.
   dst = src;
-  for (size_type row=0; row<N; ++row)
+  if (this->use_level_schedule())
     {
-      // Now: (X-L)u = b
-
-      // get start of this row. skip
-      // the diagonal element
-      for (typename SparseMatrix<number>::const_iterator
-           p = this->begin(row)+1;
-           (p != this->end(row)) && (p->column() < row);
-           ++p)
-        dst(row) -= p->value() * dst(p->column());
-
-      dst(row) *= inv_diag[row];
+      this->apply_level_by_level (true,
+                                  std_cxx11::bind (&SparseMIC<number>::template
+                                                   forward_rows_on_level<somenumber>,
+                                                   this, &dst,
+                                                   std_cxx11::_1, std_cxx11::_2));
+      this->apply_level_by_level (false,
+                                  std_cxx11::bind (&SparseMIC<number>::template
+                                                   backward_rows_on_level<somenumber>,
+                                                   this, &dst,
+                                                   std_cxx11::_1, std_cxx11::_2));
     }
-
-  // Now: v = Xu
-  for (size_type row=0; row<N; row++)
-    dst(row) *= diag[row];
-
-  // x = (X-U)v
-  for (int row=N-1; row>=0; --row)
+  else
     {
-      // get end of this row
-      for (typename SparseMatrix<number>::const_iterator
-           p = this->begin(row)+1;
-           p != this->end(row);
-           ++p)
-        if (p->column() > static_cast<size_type>(row))
-          dst(row) -= p->value() * dst(p->column());
-
-      dst(row) *= inv_diag[row];
+      for (size_type row=0; row<N; ++row)
+        forward_row (row, dst);
+      for (size_type row=N; row>0; --row)
+        backward_row (row-1, dst);
     }
 }
 
@@ -0,0 +1,337 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii__sparsity_pattern_bsr_h
+#define dealii__sparsity_pattern_bsr_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+class DynamicSparsityPattern;
+template <typename number> class SparseMatrixBSR;
+
+/*! @addtogroup Sparsity
+ *@{
+ */
+
+/**
+ * A sparsity pattern in the block compressed sparse row (BSR) format with
+ * variable block sizes. The rows and columns of a square matrix are
+ * partitioned into blocks of consecutive indices, called chunks here in
+ * order to avoid confusion with the block matrices of deal.II, and the
+ * pattern stores only one column index per pair of chunks that has at least
+ * one nonzero entry. All entries within such a pair of chunks are stored by
+ * SparseMatrixBSR as a small dense matrix.
+ *
+ * This format is meant for vector-valued problems discretized with FESystem,
+ * where all components at a support point couple with the same degrees of
+ * freedom. With the default numbering of degrees of freedom by
+ * DoFHandler::distribute_dofs(), all components of an FESystem at a vertex,
+ * line, or face are numbered consecutively and thus form a chunk of size
+ * <tt>dim</tt> for elasticity or <tt>dim+1</tt> for Taylor-Hood elements at
+ * the vertices. Compared to SparsityPattern, the memory for the column
+ * indices is then reduced by a factor of up to the square of the chunk size.
+ * Note that the numbering by DoFRenumbering::component_wise() separates the
+ * components from each other and thus leads to chunks of size one.
+ *
+ * In contrast to ChunkSparsityPattern, the chunks do not need to have the
+ * same size. By default, copy_from() groups consecutive rows with identical
+ * column indices into chunks, which detects the natural chunks of FESystem
+ * discretizations from the sparsity pattern alone:
+ * @code
+ * DynamicSparsityPattern dsp (dof_handler.n_dofs());
+ * DoFTools::make_sparsity_pattern (dof_handler, dsp, constraints);
+ * SparsityPatternBSR sparsity_pattern;
+ * sparsity_pattern.copy_from (dsp);
+ * SparseMatrixBSR<double> matrix (sparsity_pattern);
+ * @endcode
+ * Alternatively, the chunk sizes can be given explicitly, in which case all
+ * entries of the given pattern are contained in the chunks and additional
+ * zero entries are stored where the pattern of a chunk pair is not dense.
+ *
+ * The chunk structure is stored as a SparsityPattern on the chunks, which
+ * is available through get_chunk_sparsity_pattern(). As in SparsityPattern,
+ * the diagonal chunk is stored first in each chunk row.
+ */
+class SparsityPatternBSR : public Subscriptor
+{
+public:
+  /**
+   * Declare the type for container size.
+   */
+  typedef types::global_dof_index size_type;
+
+  /**
+   * Constructor. Initialize an empty pattern.
+   */
+  SparsityPatternBSR ();
+
+  /**
+   * Copy constructor. As for SparsityPattern, this constructor may only be
+   * called on empty objects, which is useful for storing patterns in STL
+   * containers.
+   */
+  SparsityPatternBSR (const SparsityPatternBSR &);
+
+  /**
+   * Copy operator. As for the copy constructor, this may only be called on
+   * empty objects.
+   */
+  SparsityPatternBSR &operator = (const SparsityPatternBSR &);
+
+  /**
+   * Set up the pattern from the given square sparsity pattern, e.g. a
+   * DynamicSparsityPattern or a SparsityPattern. Consecutive rows with the
+   * same column indices are grouped into chunks of at most @p max_chunk_size
+   * rows.
+   */
+  template <typename SparsityPatternType>
+  void copy_from (const SparsityPatternType &sparsity_pattern,
+                  const unsigned int         max_chunk_size = numbers::invalid_unsigned_int);
+
+  /**
+   * Set up the pattern from the given square sparsity pattern with the
+   * given sizes of the chunks, which must add up to the number of rows.
+   * Chunk pairs that contain at least one entry of @p sparsity_pattern are
+   * stored as a whole.
+   */
+  template <typename SparsityPatternType>
+  void copy_from (const SparsityPatternType       &sparsity_pattern,
+                  const std::vector<unsigned int> &chunk_sizes);
+
+  /**
+   * Release all memory and return to a state just like after having called
+   * the default constructor.
+   */
+  void clear ();
+
+  /**
+   * Return whether the object is empty.
+   */
+  bool empty () const;
+
+  /**
+   * Return the number of rows of the pattern.
+   */
+  size_type n_rows () const;
+
+  /**
+   * Return the number of columns of the pattern.
+   */
+  size_type n_cols () const;
+
+  /**
+   * Return the number of chunks into which the rows (and columns) are
+   * partitioned.
+   */
+  size_type n_chunks () const;
+
+  /**
+   * Return the first row (and column) of the given chunk.
+   */
+  size_type chunk_start (const size_type chunk) const;
+
+  /**
+   * Return the number of rows (and columns) of the given chunk.
+   */
+  unsigned int chunk_size (const size_type chunk) const;
+
+  /**
+   * Return the chunk that contains the given row (or column) index.
+   */
+  size_type chunk_index (const size_type index) const;
+
+  /**
+   * Return the number of stored entries, i.e., the sum over all stored chunk
+   * pairs of the product of their sizes. This includes zero entries within
+   * chunk pairs that are not dense.
+   */
+  std::size_t n_nonzero_elements () const;
+
+  /**
+   * Return whether the entry $(i,j)$ is stored, i.e., whether the pair of
+   * chunks containing $i$ and $j$ is part of the pattern.
+   */
+  bool exists (const size_type i,
+               const size_type j) const;
+
+  /**
+   * Return the sparsity pattern of the chunks.
+   */
+  const SparsityPattern &get_chunk_sparsity_pattern () const;
+
+  /**
+   * Determine an estimate for the memory consumption (in bytes) of this
+   * object.
+   */
+  std::size_t memory_consumption () const;
+
+  /**
+   * @addtogroup Exceptions
+   * @{
+   */
+
+  /**
+   * Exception
+   */
+  DeclException0 (ExcInvalidConstructorCall);
+
+  /**
+   * Exception
+   */
+  DeclException2 (ExcInvalidChunkSizes,
+                  size_type, size_type,
+                  << "The chunk sizes add up to " << arg1
+                  << ", but the sparsity pattern has " << arg2 << " rows.");
+  //@}
+
+private:
+  /**
+   * The number of rows and columns.
+   */
+  size_type rows;
+
+  /**
+   * The first index of each chunk, with an additional last entry that
+   * contains the number of rows.
+   */
+  std::vector<size_type> chunk_starts;
+
+  /**
+   * The chunk of each row index.
+   */
+  std::vector<size_type> index_to_chunk;
+
+  /**
+   * For each chunk row, the index of its first value in the array of values
+   * of SparseMatrixBSR, with an additional last entry that contains the
+   * total number of stored entries.
+   */
+  std::vector<std::size_t> chunk_row_value_start;
+
+  /**
+   * The sparsity pattern of the chunks.
+   */
+  SparsityPattern chunk_sparsity_pattern;
+
+  /**
+   * Set up the data structures from the chunk sizes in #chunk_starts and
+   * the pattern of chunks, to which the diagonal chunks are added.
+   */
+  void setup_chunks (DynamicSparsityPattern &chunk_dsp);
+
+  template <typename> friend class SparseMatrixBSR;
+};
+
+/*@}*/
+
+#ifndef DOXYGEN
+/*---------------------- Inline functions -----------------------------------*/
+
+
+inline
+bool
+SparsityPatternBSR::empty () const
+{
+  return rows == 0;
+}
+
+
+
+inline
+SparsityPatternBSR::size_type
+SparsityPatternBSR::n_rows () const
+{
+  return rows;
+}
+
+
+
+inline
+SparsityPatternBSR::size_type
+SparsityPatternBSR::n_cols () const
+{
+  return rows;
+}
+
+
+
+inline
+SparsityPatternBSR::size_type
+SparsityPatternBSR::n_chunks () const
+{
+  return chunk_starts.empty() ? 0 : chunk_starts.size()-1;
+}
+
+
+
+inline
+SparsityPatternBSR::size_type
+SparsityPatternBSR::chunk_start (const size_type chunk) const
+{
+  AssertIndexRange (chunk, n_chunks()+1);
+  return chunk_starts[chunk];
+}
+
+
+
+inline
+unsigned int
+SparsityPatternBSR::chunk_size (const size_type chunk) const
+{
+  AssertIndexRange (chunk, n_chunks());
+  return chunk_starts[chunk+1] - chunk_starts[chunk];
+}
+
+
+
+inline
+SparsityPatternBSR::size_type
+SparsityPatternBSR::chunk_index (const size_type index) const
+{
+  AssertIndexRange (index, rows);
+  return index_to_chunk[index];
+}
+
+
+
+inline
+std::size_t
+SparsityPatternBSR::n_nonzero_elements () const
+{
+  return chunk_row_value_start.empty() ? 0 : chunk_row_value_start.back();
+}
+
+
+
+inline
+const SparsityPattern &
+SparsityPatternBSR::get_chunk_sparsity_pattern () const
+{
+  return chunk_sparsity_pattern;
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -63,10 +63,10 @@ namespace SparsityTools
    * zero and @p n_partitions-1 for each node (i.e. row or column of the
    * matrix).
    *
-   * This function will generate an error if METIS is not installed unless @p
-   * n_partitions is one. I.e., you can write a program so that it runs in the
-   * single-processor single-partition case without METIS installed, and only
-   * requires METIS when multiple partitions are required.
+   * If deal.II was not configured with METIS, the partitioning is computed
+   * by partition_multilevel() instead. I.e., you can write a program so that
+   * it runs with and without METIS installed, though the partitions METIS
+   * computes are typically somewhat better.
    *
    * Note that the sparsity pattern itself is not changed by calling this
    * function. However, you will likely use the information generated by
@@ -81,6 +81,66 @@ namespace SparsityTools
                   const unsigned int         n_partitions,
                   std::vector<unsigned int> &partition_indices);
 
+  /**
+   * Like the previous function, but take into account that the nodes of the
+   * graph (i.e. the rows of the sparsity pattern) may represent different
+   * amounts of work. The partitioning then attempts to make the sum of @p
+   * node_weights of the nodes in each partition about equal, rather than
+   * their number. @p node_weights needs to have one entry per row of the
+   * sparsity pattern, or be empty, in which case all nodes have weight one.
+   */
+  void partition (const SparsityPattern           &sparsity_pattern,
+                  const std::vector<unsigned int> &node_weights,
+                  const unsigned int               n_partitions,
+                  std::vector<unsigned int>       &partition_indices);
+
+  /**
+   * Partition the graph represented by a sparsity pattern without the help of
+   * an external library. The arguments and the result are the same as for
+   * the partition() function, which calls this function if deal.II was not
+   * configured with METIS.
+   *
+   * The graph is partitioned by recursive bisection. Each bisection uses a
+   * multilevel scheme: The graph is first coarsened repeatedly by merging
+   * pairs of nodes connected by an edge (heavy-edge matching, i.e. preferring
+   * edges that stand for many edges of the original graph). The coarsest graph
+   * is bisected by growing one part from several starting nodes in a greedy
+   * way, and keeping the best result. This bisection is then transferred
+   * back to successively finer graphs and improved on each of them by the
+   * Fiduccia-Mattheyses algorithm that moves nodes along the boundary between
+   * the parts if that reduces the number of cut edges without violating the
+   * balance of node weights, which is kept within one percent (or the weight
+   * of the heaviest node on a coarse graph) of the target.
+   *
+   * The algorithm uses no randomness, so the result only depends on the
+   * sparsity pattern and the weights. This is important if, as in
+   * parallel::shared::Triangulation, every processor computes the partition
+   * on its own and all processors need to obtain the same one.
+   */
+  void partition_multilevel (const SparsityPattern           &sparsity_pattern,
+                             const std::vector<unsigned int> &node_weights,
+                             const unsigned int               n_partitions,
+                             std::vector<unsigned int>       &partition_indices);
+
+  namespace internal
+  {
+    namespace Partitioning
+    {
+      /**
+       * Improve the given bisection of the graph represented by @p
+       * sparsity_pattern, in which side 0 should have the fraction @p
+       * fraction_0 of the total node weight, in the same way as
+       * partition_multilevel() does on each level. The initial bisection
+       * may violate the balance of weights. This function is only exposed
+       * for testing.
+       */
+      void refine_bisection (const SparsityPattern           &sparsity_pattern,
+                             const std::vector<unsigned int> &node_weights,
+                             const double                     fraction_0,
+                             std::vector<unsigned int>       &side);
+    }
+  }
+
   /**
    * For a given sparsity pattern, compute a re-enumeration of row/column
    * indices based on the algorithm by Cuthill-McKee.
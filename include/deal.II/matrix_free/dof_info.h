@@ -275,6 +275,24 @@ namespace internal
        */
       void renumber_dofs (std::vector<types::global_dof_index> &renumbering);
 
+      /**
+       * Computes the ranges of locally owned vector entries that are touched
+       * for the first time and for the last time by the cells in the blocks
+       * of cells given by the argument, where block @p b is given by the
+       * range <tt>[cell_loop_blocks[b], cell_loop_blocks[b+1])</tt>. The
+       * ranges are stored in @p cell_loop_pre_list and @p
+       * cell_loop_post_list and are used by MatrixFree::cell_loop() to run
+       * operations on vector entries immediately before and after the cells
+       * that access them.
+       *
+       * Entries that are not touched by any cell are scheduled before the
+       * first block and after the last block. Entries that receive
+       * contributions from other MPI processes are scheduled after the
+       * final exchange of the loop, i.e., into the additional slot @p
+       * n_blocks of @p cell_loop_post_list_index.
+       */
+      void compute_vector_access_ranges (const std::vector<unsigned int> &cell_loop_blocks);
+
       /**
        * Returns the memory consumption in bytes of this class.
        */
@@ -413,6 +431,40 @@ namespace internal
        */
       std::vector<std::pair<unsigned int,unsigned int> > fe_index_conversion;
 
+      /**
+       * The granularity of the ranges of vector entries in @p
+       * cell_loop_pre_list and @p cell_loop_post_list. The vector entries
+       * are grouped into chunks of this size, which is chosen as a multiple
+       * of the cache line size for both float and double entries.
+       */
+      static const unsigned int chunk_size_vector_access = 64;
+
+      /**
+       * Stores the row start into @p cell_loop_pre_list for each block of
+       * cells in the fused cell loop.
+       */
+      std::vector<unsigned int> cell_loop_pre_list_index;
+
+      /**
+       * Stores the ranges of locally owned vector entries that are accessed
+       * for the first time by the cells of a block in the fused cell loop.
+       */
+      std::vector<std::pair<unsigned int,unsigned int> > cell_loop_pre_list;
+
+      /**
+       * Stores the row start into @p cell_loop_post_list for each block of
+       * cells in the fused cell loop, with one additional slot for the
+       * entries that can only be processed after the MPI exchange at the end
+       * of the loop.
+       */
+      std::vector<unsigned int> cell_loop_post_list_index;
+
+      /**
+       * Stores the ranges of locally owned vector entries that are accessed
+       * for the last time by the cells of a block in the fused cell loop.
+       */
+      std::vector<std::pair<unsigned int,unsigned int> > cell_loop_post_list;
+
       /**
        * Temporarily stores the numbers of ghosts during setup. Cleared when
        * calling @p assign_ghosts. Then, all information is collected by the
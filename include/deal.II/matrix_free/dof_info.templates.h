@@ -144,6 +144,10 @@ namespace internal
       cell_active_fe_index (dof_info_in.cell_active_fe_index),
       max_fe_index (dof_info_in.max_fe_index),
       fe_index_conversion (dof_info_in.fe_index_conversion),
+      cell_loop_pre_list_index (dof_info_in.cell_loop_pre_list_index),
+      cell_loop_pre_list (dof_info_in.cell_loop_pre_list),
+      cell_loop_post_list_index (dof_info_in.cell_loop_post_list_index),
+      cell_loop_post_list (dof_info_in.cell_loop_post_list),
       ghost_dofs (dof_info_in.ghost_dofs)
     {}
 
@@ -167,6 +171,10 @@ namespace internal
       cell_active_fe_index.clear();
       max_fe_index = 0;
       fe_index_conversion.clear();
+      cell_loop_pre_list_index.clear();
+      cell_loop_pre_list.clear();
+      cell_loop_post_list_index.clear();
+      cell_loop_post_list.clear();
     }
 
 
@@ -1918,6 +1926,101 @@ not_connect:
 
 
 
+    namespace internal
+    {
+      // collects the chunks of vector entries assigned to each slot into
+      // ranges in compressed row storage, merging adjacent chunks
+      void
+      fill_vector_access_list (const std::vector<unsigned int> &chunk_slot,
+                               const unsigned int               n_slots,
+                               const unsigned int               chunk_size,
+                               const unsigned int               n_entries,
+                               std::vector<unsigned int>        &list_index,
+                               std::vector<std::pair<unsigned int,unsigned int> > &list)
+      {
+        std::vector<std::vector<std::pair<unsigned int,unsigned int> > >
+        ranges (n_slots);
+        for (unsigned int c=0; c<chunk_slot.size(); ++c)
+          {
+            const unsigned int begin = c*chunk_size;
+            const unsigned int end = std::min(begin+chunk_size, n_entries);
+            std::vector<std::pair<unsigned int,unsigned int> > &slot =
+              ranges[chunk_slot[c]];
+            if (!slot.empty() && slot.back().second == begin)
+              slot.back().second = end;
+            else
+              slot.push_back(std::make_pair(begin, end));
+          }
+
+        list_index.resize(n_slots+1);
+        list_index[0] = 0;
+        list.clear();
+        for (unsigned int s=0; s<n_slots; ++s)
+          {
+            list.insert(list.end(), ranges[s].begin(), ranges[s].end());
+            list_index[s+1] = list.size();
+          }
+      }
+    }
+
+
+
+    void
+    DoFInfo::compute_vector_access_ranges (const std::vector<unsigned int> &cell_loop_blocks)
+    {
+      Assert (vector_partitioner.get() != 0, ExcNotInitialized());
+      Assert (cell_loop_blocks.size() > 0, ExcInternalError());
+      const unsigned int n_blocks = cell_loop_blocks.size()-1;
+      const unsigned int n_owned = vector_partitioner->local_size();
+      const unsigned int n_chunks = (n_owned+chunk_size_vector_access-1)/
+                                    chunk_size_vector_access;
+
+      // find the first and the last block that access a chunk. Since the
+      // blocks are traversed in order, the first block is the one setting
+      // the entry and the last block the one visiting it last. Untouched
+      // chunks are run before the first and after the last block
+      std::vector<unsigned int> first_block (n_chunks, numbers::invalid_unsigned_int);
+      std::vector<unsigned int> last_block (n_chunks, n_blocks);
+      for (unsigned int block=0; block<n_blocks; ++block)
+        for (unsigned int cell=cell_loop_blocks[block];
+             cell<cell_loop_blocks[block+1]; ++cell)
+          for (const unsigned int *it=begin_indices(cell); it!=end_indices(cell);
+               ++it)
+            if (*it < n_owned)
+              {
+                const unsigned int chunk = *it / chunk_size_vector_access;
+                if (first_block[chunk] == numbers::invalid_unsigned_int)
+                  first_block[chunk] = block;
+                last_block[chunk] = block;
+              }
+      for (unsigned int c=0; c<n_chunks; ++c)
+        if (first_block[c] == numbers::invalid_unsigned_int)
+          {
+            first_block[c] = 0;
+            last_block[c] = n_blocks;
+          }
+
+      // entries that receive contributions from other processors are only
+      // complete after the exchange at the end of the loop
+      const std::vector<std::pair<unsigned int,unsigned int> > &import_indices =
+        vector_partitioner->import_indices();
+      for (unsigned int i=0; i<import_indices.size(); ++i)
+        for (unsigned int c=import_indices[i].first/chunk_size_vector_access;
+             c<n_chunks && c*chunk_size_vector_access<import_indices[i].second; ++c)
+          last_block[c] = n_blocks;
+
+      internal::fill_vector_access_list (first_block, std::max(n_blocks, 1U),
+                                         chunk_size_vector_access, n_owned,
+                                         cell_loop_pre_list_index,
+                                         cell_loop_pre_list);
+      internal::fill_vector_access_list (last_block, n_blocks+1,
+                                         chunk_size_vector_access, n_owned,
+                                         cell_loop_post_list_index,
+                                         cell_loop_post_list);
+    }
+
+
+
     std::size_t
     DoFInfo::memory_consumption () const
     {
@@ -1928,6 +2031,10 @@ not_connect:
       memory += MemoryConsumption::memory_consumption (plain_dof_indices);
       memory += MemoryConsumption::memory_consumption (constraint_indicator);
       memory += MemoryConsumption::memory_consumption (*vector_partitioner);
+      memory += MemoryConsumption::memory_consumption (cell_loop_pre_list_index);
+      memory += MemoryConsumption::memory_consumption (cell_loop_pre_list);
+      memory += MemoryConsumption::memory_consumption (cell_loop_post_list_index);
+      memory += MemoryConsumption::memory_consumption (cell_loop_post_list);
       return memory;
     }
 
@@ -0,0 +1,216 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#ifndef dealii__matrix_free_face_info_h
+#define dealii__matrix_free_face_info_h
+
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/types.h>
+#include <deal.II/grid/tria.h>
+
+#include <vector>
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+
+namespace internal
+{
+  namespace MatrixFreeFunctions
+  {
+    /**
+     * Data type that describes the connectivity of a batch of faces to the
+     * cells on either side of the faces. A batch collects up to
+     * @p vectorization_width faces that are processed together by the
+     * vectorized face kernels in FEFaceEvaluation. All faces in a batch share
+     * the same local face numbers, subface index and orientation, such that
+     * the same tensor product kernels and index permutations apply to all
+     * lanes.
+     *
+     * The cells are given as the index <tt>macro_cell *
+     * vectorization_width + lane</tt>, i.e., in the numbering of the cells
+     * within MatrixFree. Unused lanes of a partially filled batch are marked
+     * by numbers::invalid_unsigned_int.
+     *
+     * The faces are described in the coordinate system of the interior
+     * cell, i.e., the normal vector points from the interior cell to the
+     * exterior cell. For a face between two cells of different refinement
+     * level (hanging node), the interior side is always the finer one and
+     * the exterior side is evaluated on the respective part of the face of
+     * the coarser cell. The reference coordinates on a face run along the
+     * coordinate directions of the cell other than the normal direction, in
+     * ascending order.
+     */
+    template <int vectorization_width>
+    struct FaceToCellTopology
+    {
+      /**
+       * Indices of the cells on the interior side of the faces.
+       */
+      unsigned int cells_interior[vectorization_width];
+
+      /**
+       * Indices of the cells on the exterior side of the faces. Set to
+       * numbers::invalid_unsigned_int for boundary faces.
+       */
+      unsigned int cells_exterior[vectorization_width];
+
+      /**
+       * Local number of the face within the interior cell, in the range
+       * <tt>[0,GeometryInfo<dim>::faces_per_cell)</tt>.
+       */
+      unsigned char interior_face_no;
+
+      /**
+       * Local number of the face within the exterior cell. Unused for
+       * boundary faces.
+       */
+      unsigned char exterior_face_no;
+
+      /**
+       * Describes which part of the face of the exterior cell is covered by
+       * the face. The value <tt>subface_index % 3</tt> encodes the first and
+       * the value <tt>subface_index / 3</tt> the second coordinate direction
+       * on the exterior face, where 0 stands for the full interval, 1 for
+       * the lower half and 2 for the upper half of the interval. Zero
+       * indicates a regular face between two cells of the same refinement
+       * level.
+       */
+      unsigned char subface_index;
+
+      /**
+       * Orientation of the face in the exterior cell relative to the
+       * interior cell. Bit 0 indicates that the two face coordinates are
+       * swapped, bits 1 and 2 that the first and second face coordinates of
+       * the exterior cell run in opposite direction compared to the interior
+       * cell.
+       */
+      unsigned char face_orientation;
+
+      /**
+       * The boundary id of the faces in case of a boundary face batch.
+       */
+      types::boundary_id boundary_id;
+
+      /**
+       * Returns the number of lanes that are filled with actual faces.
+       */
+      unsigned int n_filled_lanes () const;
+    };
+
+
+
+    /**
+     * The class that collects the faces of the mesh into batches suitable
+     * for the vectorized evaluation of face integrals in MatrixFree. Inner
+     * faces are stored first, followed by the boundary faces.
+     *
+     * If multithreading is enabled, the face batches are additionally
+     * colored: Batches of the same color do not touch cells that share a
+     * vertex. As a consequence, no degree of freedom is written to by two
+     * batches of the same color and the batches of one color can be worked
+     * on in %parallel.
+     */
+    template <int vectorization_width>
+    struct FaceInfo
+    {
+      /**
+       * Empty constructor.
+       */
+      FaceInfo ();
+
+      /**
+       * Clears all data fields in this class.
+       */
+      void clear ();
+
+      /**
+       * Extracts the faces of the given cells and collects them into
+       * batches. The cells are given by the level and index within the level
+       * in the order they are worked on by MatrixFree, including the padding
+       * of the last macro cells. If @p level is different from
+       * numbers::invalid_unsigned_int, only the faces between cells on this
+       * level and at the boundary are collected, whereas faces towards
+       * coarser cells (refinement edges) are skipped.
+       */
+      template <int dim>
+      void initialize (const dealii::Triangulation<dim> &tria,
+                       const std::vector<std::pair<unsigned int,unsigned int> > &cells,
+                       const unsigned int level,
+                       const bool         build_inner_faces,
+                       const bool         build_boundary_faces,
+                       const bool         use_coloring);
+
+      /**
+       * Returns the memory consumption of this class in bytes.
+       */
+      std::size_t memory_consumption () const;
+
+      /**
+       * The batches of faces, inner faces first, boundary faces second.
+       */
+      std::vector<FaceToCellTopology<vectorization_width> > faces;
+
+      /**
+       * The number of batches of inner faces.
+       */
+      unsigned int n_inner_face_batches;
+
+      /**
+       * The number of batches of boundary faces.
+       */
+      unsigned int n_boundary_face_batches;
+
+      /**
+       * Ranges of face batches that can be worked on independently. The
+       * batches of color @p c are given by the range <tt>[color_starts[c],
+       * color_starts[c+1])</tt>. The inner faces are given by the colors
+       * below @p n_inner_face_colors, the boundary faces by the remaining
+       * ones.
+       */
+      std::vector<unsigned int> color_starts;
+
+      /**
+       * The number of colors of inner face batches in @p color_starts.
+       */
+      unsigned int n_inner_face_colors;
+    };
+
+
+
+    /* ------------------- inline functions ----------------------------- */
+
+    template <int vectorization_width>
+    inline
+    unsigned int
+    FaceToCellTopology<vectorization_width>::n_filled_lanes () const
+    {
+      unsigned int n_lanes = 0;
+      while (n_lanes < vectorization_width &&
+             cells_interior[n_lanes] != numbers::invalid_unsigned_int)
+        ++n_lanes;
+      return n_lanes;
+    }
+
+  } // end of namespace MatrixFreeFunctions
+} // end of namespace internal
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,422 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#include <deal.II/base/geometry_info.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+
+#include <deal.II/matrix_free/face_info.h>
+
+#include <map>
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace MatrixFreeFunctions
+  {
+    namespace
+    {
+      // returns the index of the vertex of the given face of a cell, where
+      // the vertices of the face are enumerated lexicographically along the
+      // coordinate directions of the cell other than the face normal
+      template <int dim>
+      unsigned int
+      face_vertex_index (const unsigned int face_no,
+                         const unsigned int corner)
+      {
+        const unsigned int normal = face_no/2;
+        unsigned int vertex = (face_no%2) << normal;
+        for (unsigned int d=0, k=0; d<dim; ++d)
+          if (d != normal)
+            {
+              vertex |= ((corner >> k) & 1) << d;
+              ++k;
+            }
+        return vertex;
+      }
+
+
+
+      // determines how the face coordinates of the exterior cell relate to
+      // the ones of the interior cell by matching the vertices of the face
+      // with the vertices (and their midpoints in case of a face with
+      // hanging nodes) of the face seen from the exterior cell
+      template <int dim>
+      void
+      compute_face_orientation (const typename dealii::Triangulation<dim>::cell_iterator &cell,
+                                const unsigned int face_no,
+                                const typename dealii::Triangulation<dim>::cell_iterator &neighbor,
+                                const unsigned int neighbor_face_no,
+                                const bool         is_subface,
+                                unsigned char     &subface_index,
+                                unsigned char     &orientation)
+      {
+        subface_index = 0;
+        orientation = 0;
+        if (dim == 1)
+          return;
+
+        const unsigned int n_corners = GeometryInfo<dim>::vertices_per_face;
+        const unsigned int n_points_1d = is_subface ? 3 : 2;
+        const unsigned int n_candidates = dim == 3 ? n_points_1d*n_points_1d : n_points_1d;
+
+        Point<dim> exterior_corners[4];
+        for (unsigned int c=0; c<n_corners; ++c)
+          exterior_corners[c] =
+            neighbor->vertex(face_vertex_index<dim>(neighbor_face_no, c));
+
+        double eta[4][2];
+        for (unsigned int c=0; c<n_corners; ++c)
+          {
+            const Point<dim> corner =
+              cell->vertex(face_vertex_index<dim>(face_no, c));
+            double min_distance = std::numeric_limits<double>::max();
+            for (unsigned int i=0; i<n_candidates; ++i)
+              {
+                const double g0 = (i%n_points_1d) * 1./(n_points_1d-1);
+                const double g1 = (i/n_points_1d) * 1./(n_points_1d-1);
+                Point<dim> candidate;
+                if (dim == 2)
+                  candidate = (1.-g0) * exterior_corners[0] + g0 * exterior_corners[1];
+                else
+                  candidate = ((1.-g0)*(1.-g1)) * exterior_corners[0] +
+                              (g0*(1.-g1)) * exterior_corners[1] +
+                              ((1.-g0)*g1) * exterior_corners[2] +
+                              (g0*g1) * exterior_corners[3];
+                const double distance = corner.distance(candidate);
+                if (distance < min_distance)
+                  {
+                    min_distance = distance;
+                    eta[c][0] = g0;
+                    eta[c][1] = g1;
+                  }
+              }
+          }
+
+        // the face coordinates of the exterior side are an affine function
+        // of the face coordinates of the interior side, eta = b + A xi, with
+        // A a signed permutation matrix scaled by 1/2 for subfaces
+        const double scaling = is_subface ? 0.5 : 1.;
+        const bool swap = (dim == 3 && std::abs(eta[1][1]-eta[0][1]) > 0.25);
+        if (swap)
+          orientation |= 1;
+        for (unsigned int k=0; k<dim-1; ++k)
+          {
+            const unsigned int xi_corner = 1U << (swap ? 1-k : k);
+            const double slope = eta[xi_corner][k] - eta[0][k];
+            Assert (std::abs(std::abs(slope) - scaling) < 1e-10,
+                    ExcMessage ("Face integrals are only implemented for faces "
+                                "with isotropic refinement."));
+            if (slope < 0)
+              orientation |= 2U << k;
+            if (is_subface)
+              {
+                const double lower = std::min(eta[0][k], eta[0][k]+slope);
+                subface_index += (lower < 0.25 ? 1 : 2) * (k == 0 ? 1 : 3);
+              }
+          }
+      }
+
+
+
+      // encodes the data that needs to be equal within a batch of faces
+      inline
+      unsigned int
+      encode_inner_face_type (const unsigned int interior_face_no,
+                              const unsigned int exterior_face_no,
+                              const unsigned char subface_index,
+                              const unsigned char orientation)
+      {
+        return interior_face_no + (exterior_face_no << 3) +
+               (static_cast<unsigned int>(subface_index) << 6) +
+               (static_cast<unsigned int>(orientation) << 10);
+      }
+
+
+
+      // colors the face batches in the range [begin,end) such that batches
+      // of the same color do not touch cells that share a vertex, reorders
+      // the batches by color and appends the start of each color to
+      // color_starts
+      template <int dim, int vectorization_width>
+      void
+      color_face_batches (const dealii::Triangulation<dim> &tria,
+                          const std::vector<std::pair<unsigned int,unsigned int> > &cells,
+                          const unsigned int begin,
+                          const unsigned int end,
+                          std::vector<FaceToCellTopology<vectorization_width> > &faces,
+                          std::vector<unsigned int> &color_starts)
+      {
+        std::vector<std::vector<bool> > vertex_used_by_color;
+        std::vector<unsigned int> batch_color (end-begin);
+        std::vector<unsigned int> batch_vertices;
+        for (unsigned int batch=begin; batch<end; ++batch)
+          {
+            batch_vertices.clear();
+            for (unsigned int side=0; side<2; ++side)
+              for (unsigned int v=0; v<vectorization_width; ++v)
+                {
+                  const unsigned int cell_index = side == 0 ?
+                                                  faces[batch].cells_interior[v] :
+                                                  faces[batch].cells_exterior[v];
+                  if (cell_index == numbers::invalid_unsigned_int)
+                    continue;
+                  typename dealii::Triangulation<dim>::cell_iterator
+                  cell (&tria, cells[cell_index].first, cells[cell_index].second);
+                  for (unsigned int i=0; i<GeometryInfo<dim>::vertices_per_cell; ++i)
+                    batch_vertices.push_back (cell->vertex_index(i));
+                }
+
+            unsigned int color = 0;
+            for ( ; color<vertex_used_by_color.size(); ++color)
+              {
+                bool conflict = false;
+                for (unsigned int i=0; i<batch_vertices.size(); ++i)
+                  if (vertex_used_by_color[color][batch_vertices[i]] == true)
+                    {
+                      conflict = true;
+                      break;
+                    }
+                if (conflict == false)
+                  break;
+              }
+            if (color == vertex_used_by_color.size())
+              vertex_used_by_color.push_back (std::vector<bool>(tria.n_vertices(),
+                                                                false));
+            for (unsigned int i=0; i<batch_vertices.size(); ++i)
+              vertex_used_by_color[color][batch_vertices[i]] = true;
+            batch_color[batch-begin] = color;
+          }
+
+        std::vector<FaceToCellTopology<vectorization_width> > sorted_faces;
+        sorted_faces.reserve (end-begin);
+        for (unsigned int color=0; color<vertex_used_by_color.size(); ++color)
+          {
+            color_starts.push_back (begin + sorted_faces.size());
+            for (unsigned int batch=begin; batch<end; ++batch)
+              if (batch_color[batch-begin] == color)
+                sorted_faces.push_back (faces[batch]);
+          }
+        AssertDimension (sorted_faces.size(), end-begin);
+        std::copy (sorted_faces.begin(), sorted_faces.end(), faces.begin()+begin);
+      }
+    }
+
+
+
+    template <int vectorization_width>
+    FaceInfo<vectorization_width>::FaceInfo ()
+      :
+      n_inner_face_batches (0),
+      n_boundary_face_batches (0),
+      n_inner_face_colors (0)
+    {}
+
+
+
+    template <int vectorization_width>
+    void
+    FaceInfo<vectorization_width>::clear ()
+    {
+      faces.clear();
+      color_starts.clear();
+      n_inner_face_batches = 0;
+      n_boundary_face_batches = 0;
+      n_inner_face_colors = 0;
+    }
+
+
+
+    template <int vectorization_width>
+    template <int dim>
+    void
+    FaceInfo<vectorization_width>::initialize
+    (const dealii::Triangulation<dim> &tria,
+     const std::vector<std::pair<unsigned int,unsigned int> > &cells,
+     const unsigned int level,
+     const bool         build_inner_faces,
+     const bool         build_boundary_faces,
+     const bool         use_coloring)
+    {
+      clear();
+
+      // find the position of each cell within the numbering of MatrixFree.
+      // The last macro cells might be padded with copies of the last valid
+      // cell, so we only record the first appearance of each cell
+      std::vector<std::vector<unsigned int> > cell_position (tria.n_levels());
+      for (unsigned int i=0; i<cells.size(); ++i)
+        {
+          std::vector<unsigned int> &positions = cell_position[cells[i].first];
+          if (positions.empty())
+            positions.resize (tria.n_raw_cells(cells[i].first),
+                              numbers::invalid_unsigned_int);
+          if (positions[cells[i].second] == numbers::invalid_unsigned_int)
+            positions[cells[i].second] = i;
+        }
+
+      // collect the faces sorted by their type, given as the pair of cell
+      // positions on the interior and exterior side
+      std::map<unsigned int, std::vector<std::pair<unsigned int,unsigned int> > >
+      inner_faces, boundary_faces;
+      for (unsigned int i=0; i<cells.size(); ++i)
+        {
+          if (cell_position[cells[i].first][cells[i].second] != i)
+            continue;
+          typename dealii::Triangulation<dim>::cell_iterator
+          cell (&tria, cells[i].first, cells[i].second);
+          for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+            {
+              if (cell->at_boundary(f))
+                {
+                  if (build_boundary_faces)
+                    boundary_faces[f + (static_cast<unsigned int>
+                                        (cell->face(f)->boundary_id()) << 3)].
+                    push_back (std::make_pair(i, numbers::invalid_unsigned_int));
+                  continue;
+                }
+              if (build_inner_faces == false)
+                continue;
+
+              const typename dealii::Triangulation<dim>::cell_iterator
+              neighbor = cell->neighbor(f);
+
+              // for active cells, the face is visited from the finer side in
+              // case of hanging nodes. On levels, we skip the faces towards
+              // coarser cells
+              if (level == numbers::invalid_unsigned_int)
+                {
+                  if (neighbor->has_children())
+                    continue;
+                }
+              else if (neighbor->level() < cell->level())
+                continue;
+              const bool is_subface = (neighbor->level() < cell->level());
+
+              const unsigned int neighbor_position =
+                cell_position[neighbor->level()].empty() ?
+                numbers::invalid_unsigned_int :
+                cell_position[neighbor->level()][neighbor->index()];
+              AssertThrow (neighbor_position != numbers::invalid_unsigned_int,
+                           ExcMessage ("Face integrals are only implemented "
+                                       "for faces between cells that are "
+                                       "part of the MatrixFree object, i.e., "
+                                       "not across MPI process boundaries."));
+
+              // visit faces between cells of the same level only once
+              if (is_subface == false && neighbor_position < i)
+                continue;
+
+              const unsigned int neighbor_face_no =
+                dim == 1 ? 1-f :
+                (is_subface ? cell->neighbor_of_coarser_neighbor(f).first :
+                 cell->neighbor_of_neighbor(f));
+              unsigned char subface_index, orientation;
+              compute_face_orientation<dim> (cell, f, neighbor, neighbor_face_no,
+                                             is_subface, subface_index,
+                                             orientation);
+              inner_faces[encode_inner_face_type(f, neighbor_face_no,
+                                                 subface_index, orientation)].
+              push_back (std::make_pair(i, neighbor_position));
+            }
+        }
+
+      // build the batches of faces
+      FaceToCellTopology<vectorization_width> face_batch;
+      for (unsigned int pass=0; pass<2; ++pass)
+        {
+          const std::map<unsigned int, std::vector<std::pair<unsigned int,unsigned int> > >
+          &face_list = pass == 0 ? inner_faces : boundary_faces;
+          for (typename std::map<unsigned int, std::vector<std::pair<unsigned int,unsigned int> > >
+               ::const_iterator it = face_list.begin(); it != face_list.end(); ++it)
+            {
+              if (pass == 0)
+                {
+                  face_batch.interior_face_no = it->first & 7;
+                  face_batch.exterior_face_no = (it->first >> 3) & 7;
+                  face_batch.subface_index = (it->first >> 6) & 15;
+                  face_batch.face_orientation = it->first >> 10;
+                  face_batch.boundary_id = numbers::internal_face_boundary_id;
+                }
+              else
+                {
+                  face_batch.interior_face_no = it->first & 7;
+                  face_batch.exterior_face_no = 0;
+                  face_batch.subface_index = 0;
+                  face_batch.face_orientation = 0;
+                  face_batch.boundary_id = it->first >> 3;
+                }
+              for (unsigned int start=0; start<it->second.size();
+                   start += vectorization_width)
+                {
+                  for (unsigned int v=0; v<vectorization_width; ++v)
+                    if (start+v < it->second.size())
+                      {
+                        face_batch.cells_interior[v] = it->second[start+v].first;
+                        face_batch.cells_exterior[v] = it->second[start+v].second;
+                      }
+                    else
+                      {
+                        face_batch.cells_interior[v] = numbers::invalid_unsigned_int;
+                        face_batch.cells_exterior[v] = numbers::invalid_unsigned_int;
+                      }
+                  faces.push_back (face_batch);
+                }
+            }
+          if (pass == 0)
+            n_inner_face_batches = faces.size();
+          else
+            n_boundary_face_batches = faces.size() - n_inner_face_batches;
+        }
+
+      // finally, group the batches into colors
+      if (use_coloring)
+        {
+          color_face_batches (tria, cells, 0, n_inner_face_batches, faces,
+                              color_starts);
+          n_inner_face_colors = color_starts.size();
+          color_face_batches (tria, cells, n_inner_face_batches, faces.size(),
+                              faces, color_starts);
+        }
+      else
+        {
+          color_starts.push_back (0);
+          n_inner_face_colors = 1;
+          color_starts.push_back (n_inner_face_batches);
+        }
+      color_starts.push_back (faces.size());
+    }
+
+
+
+    template <int vectorization_width>
+    std::size_t
+    FaceInfo<vectorization_width>::memory_consumption () const
+    {
+      return sizeof(*this) +
+             faces.capacity() * sizeof(FaceToCellTopology<vectorization_width>) +
+             MemoryConsumption::memory_consumption (color_starts);
+    }
+
+  } // end of namespace MatrixFreeFunctions
+} // end of namespace internal
+
+
+DEAL_II_NAMESPACE_CLOSE
@@ -802,6 +802,25 @@ protected:
    */
   const Tensor<1,(dim>1?dim*(dim-1)/2:1),Tensor<1,dim,VectorizedArray<Number> > > * jacobian_grad_upper;
 
+  /**
+   * In case MappingInfo computes the Jacobians on general cells on the fly
+   * (see MatrixFree::AdditionalData::compute_jacobians_on_the_fly), this
+   * field holds the inverse Jacobians in the quadrature points of the
+   * present cell. The pointer @p jacobian then points into this field.
+   */
+  AlignedVector<Tensor<2,dim,VectorizedArray<Number> > > jacobians_on_the_fly;
+
+  /**
+   * Same as @p jacobians_on_the_fly, but for the JxW values. The pointer @p
+   * J_value then points into this field.
+   */
+  AlignedVector<VectorizedArray<Number> > JxW_values_on_the_fly;
+
+  /**
+   * Temporary storage for the evaluation of the Jacobians on the fly.
+   */
+  AlignedVector<VectorizedArray<Number> > scratch_data_on_the_fly;
+
   /**
    * After a call to reinit(), stores the number of the cell we are currently
    * working with.
@@ -1877,6 +1896,8 @@ FEEvaluationBase<dim,n_components_,Number>
   quadrature_points  (other.quadrature_points),
   jacobian_grad      (other.jacobian_grad),
   jacobian_grad_upper(other.jacobian_grad_upper),
+  jacobians_on_the_fly (other.jacobians_on_the_fly),
+  JxW_values_on_the_fly (other.JxW_values_on_the_fly),
   cell               (other.cell),
   cell_type          (other.cell_type),
   cell_data_number   (other.cell_data_number),
@@ -1892,6 +1913,14 @@ FEEvaluationBase<dim,n_components_,Number>
         hessians_quad[c][d] = 0;
     }
 
+  // point to our own copy of Jacobians computed on the fly
+  if (other.jacobians_on_the_fly.size() > 0 &&
+      other.jacobian == other.jacobians_on_the_fly.begin())
+    {
+      jacobian = jacobians_on_the_fly.begin();
+      J_value = JxW_values_on_the_fly.begin();
+    }
+
   // Create deep copy of mapped geometry for use in parallel...
   if (other.mapped_geometry.get() != 0)
     {
@@ -1950,6 +1979,23 @@ FEEvaluationBase<dim,n_components_,Number>::reinit (const unsigned int cell_in)
       jacobian  = &mapping_info->affine_data[cell_data_number].first;
       J_value   = &mapping_info->affine_data[cell_data_number].second;
     }
+  else if (mapping_info->jacobians_on_the_fly == true)
+    {
+      const unsigned int n_q_points = mapping_info->
+                                      mapping_data_gen[quad_no].n_q_points[active_quad_index];
+      if (jacobians_on_the_fly.size() != n_q_points)
+        {
+          jacobians_on_the_fly.resize(n_q_points);
+          JxW_values_on_the_fly.resize(n_q_points);
+        }
+      mapping_info->compute_jacobians_on_the_fly(cell_data_number, quad_no,
+                                                 active_quad_index,
+                                                 jacobians_on_the_fly.begin(),
+                                                 JxW_values_on_the_fly.begin(),
+                                                 scratch_data_on_the_fly);
+      jacobian = jacobians_on_the_fly.begin();
+      J_value = JxW_values_on_the_fly.begin();
+    }
   else
     {
       const unsigned int rowstart = mapping_info->
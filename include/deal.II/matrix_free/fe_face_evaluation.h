@@ -0,0 +1,1034 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#ifndef dealii__matrix_free_fe_face_evaluation_h
+#define dealii__matrix_free_fe_face_evaluation_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/template_constraints.h>
+#include <deal.II/base/vectorization.h>
+#include <deal.II/matrix_free/matrix_free.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+
+namespace internal
+{
+  /**
+   * The data types returned by FEFaceEvaluation for values and gradients.
+   * For scalar elements, the values are plain VectorizedArray numbers,
+   * otherwise they are tensors over the components.
+   */
+  template <int dim, int n_components, typename Number>
+  struct FEFaceEvaluationTypes
+  {
+    typedef Tensor<1,n_components,VectorizedArray<Number> > value_type;
+    typedef Tensor<1,n_components,Tensor<1,dim,VectorizedArray<Number> > > gradient_type;
+
+    static VectorizedArray<Number> &
+    value_component (value_type &value, const unsigned int comp)
+    {
+      return value[comp];
+    }
+
+    static const VectorizedArray<Number> &
+    value_component (const value_type &value, const unsigned int comp)
+    {
+      return value[comp];
+    }
+
+    static Tensor<1,dim,VectorizedArray<Number> > &
+    gradient_component (gradient_type &gradient, const unsigned int comp)
+    {
+      return gradient[comp];
+    }
+
+    static const Tensor<1,dim,VectorizedArray<Number> > &
+    gradient_component (const gradient_type &gradient, const unsigned int comp)
+    {
+      return gradient[comp];
+    }
+  };
+
+  template <int dim, typename Number>
+  struct FEFaceEvaluationTypes<dim,1,Number>
+  {
+    typedef VectorizedArray<Number> value_type;
+    typedef Tensor<1,dim,VectorizedArray<Number> > gradient_type;
+
+    static VectorizedArray<Number> &
+    value_component (value_type &value, const unsigned int)
+    {
+      return value;
+    }
+
+    static const VectorizedArray<Number> &
+    value_component (const value_type &value, const unsigned int)
+    {
+      return value;
+    }
+
+    static Tensor<1,dim,VectorizedArray<Number> > &
+    gradient_component (gradient_type &gradient, const unsigned int)
+    {
+      return gradient;
+    }
+
+    static const Tensor<1,dim,VectorizedArray<Number> > &
+    gradient_component (const gradient_type &gradient, const unsigned int)
+    {
+      return gradient;
+    }
+  };
+}
+
+
+
+/**
+ * The class that provides all functions necessary to evaluate functions at
+ * quadrature points on faces and to integrate over faces, in analogy to
+ * what FEEvaluation does for cells. The class works on batches of faces as
+ * set up by MatrixFree when the flags
+ * MatrixFree::AdditionalData::mapping_update_flags_inner_faces and
+ * MatrixFree::AdditionalData::mapping_update_flags_boundary_faces are
+ * given, and is usually used within the face and boundary operations of
+ * MatrixFree::loop().
+ *
+ * An object of this class represents one side of the faces: Either the
+ * interior side (the side the normal vector points away from) or the
+ * exterior side. On inner faces, two objects are typically used to compute
+ * the numerical fluxes in discontinuous Galerkin methods. The data is
+ * presented in the same ordering of quadrature points on both sides, such
+ * that the values from the two sides can be directly combined in the
+ * quadrature loop. In case of hanging nodes, the interior side is the
+ * finer cell and the exterior side the coarser one, which is evaluated on
+ * the part of its face that matches the face of the finer cell.
+ *
+ * The evaluation uses a tensor product scheme similar to FEEvaluation: the
+ * cell degrees of freedom are first interpolated to the face in the
+ * direction normal to the face (values and normal derivatives), followed by
+ * a sum factorization along the directions within the face. The
+ * implementation assumes elements of tensor product type with a full
+ * lexicographic basis (e.g. FE_Q, FE_DGQ and their systems) and does not
+ * resolve constraints, i.e., it can only be used for elements without
+ * hanging node constraints such as FE_DGQ.
+ *
+ * @param dim Dimension in which this class is to be used
+ *
+ * @param fe_degree Degree of the tensor product finite element with
+ * fe_degree+1 degrees of freedom per coordinate direction
+ *
+ * @param n_q_points_1d Number of points in the 1D quadrature formula,
+ * defaults to fe_degree+1
+ *
+ * @param n_components Number of vector components
+ *
+ * @param Number Number format, usually @p double or @p float
+ */
+template <int dim, int fe_degree, int n_q_points_1d = fe_degree+1,
+          int n_components_ = 1, typename Number = double>
+class FEFaceEvaluation
+{
+public:
+  typedef Number number_type;
+  typedef typename internal::FEFaceEvaluationTypes<dim,n_components_,Number>::value_type value_type;
+  typedef typename internal::FEFaceEvaluationTypes<dim,n_components_,Number>::gradient_type gradient_type;
+  static const unsigned int dimension     = dim;
+  static const unsigned int n_components  = n_components_;
+  static const unsigned int static_dofs_per_cell = Utilities::fixed_int_power<fe_degree+1,dim>::value;
+  static const unsigned int static_dofs_per_face = Utilities::fixed_int_power<fe_degree+1,dim-1>::value;
+  static const unsigned int static_n_q_points = Utilities::fixed_int_power<n_q_points_1d,dim-1>::value;
+
+  /**
+   * Constructor. Takes all data stored in MatrixFree. If applied to
+   * problems with more than one finite element or more than one quadrature
+   * formula selected during construction of @p matrix_free, @p fe_no and
+   * @p quad_no allow to select the appropriate components. The argument @p
+   * is_interior_face selects which of the two sides of a face is evaluated.
+   */
+  FEFaceEvaluation (const MatrixFree<dim,Number> &matrix_free,
+                    const bool                    is_interior_face = true,
+                    const unsigned int            fe_no = 0,
+                    const unsigned int            quad_no = 0);
+
+  /**
+   * Initializes the operation pointer to the current face batch. The
+   * numbering is the one used by MatrixFree::loop(), i.e., inner face
+   * batches come first and are followed by the boundary face batches.
+   */
+  void reinit (const unsigned int face_batch);
+
+  /**
+   * Reads the degrees of freedom of the cells adjacent to the faces of the
+   * current batch on the side selected at construction from the input
+   * vector. For vector-valued problems, either a block vector with one
+   * block per component or a single vector containing all components is
+   * accepted, in analogy to FEEvaluationBase::read_dof_values().
+   */
+  template <typename VectorType>
+  void read_dof_values (const VectorType &src);
+
+  /**
+   * Adds the values in the local degrees of freedom to the global vector.
+   */
+  template <typename VectorType>
+  void distribute_local_to_global (VectorType &dst) const;
+
+  /**
+   * Writes the values in the local degrees of freedom into the global
+   * vector, overwriting the previous content.
+   */
+  template <typename VectorType>
+  void set_dof_values (VectorType &dst) const;
+
+  /**
+   * Evaluates the function values and/or the gradients of the finite
+   * element function given by the local degrees of freedom in the
+   * quadrature points of the face.
+   */
+  void evaluate (const bool evaluate_values,
+                 const bool evaluate_gradients);
+
+  /**
+   * Multiplies the values and/or gradients submitted on the quadrature
+   * points of the face by the test functions and sums over the quadrature
+   * points, which computes the contribution of the face integral to the
+   * local degrees of freedom of the cell. The result is written into the
+   * local degrees of freedom, overwriting their previous content.
+   */
+  void integrate (const bool integrate_values,
+                  const bool integrate_gradients);
+
+  /**
+   * Returns the value of the finite element function at quadrature point
+   * @p q_point after a call to evaluate(true,...).
+   */
+  value_type get_value (const unsigned int q_point) const;
+
+  /**
+   * Returns the gradient of the finite element function in real space at
+   * quadrature point @p q_point after a call to evaluate(...,true).
+   */
+  gradient_type get_gradient (const unsigned int q_point) const;
+
+  /**
+   * Returns the derivative of the finite element function in direction of
+   * the normal vector of the face (pointing from the interior to the
+   * exterior side) at quadrature point @p q_point.
+   */
+  value_type get_normal_derivative (const unsigned int q_point) const;
+
+  /**
+   * Writes a value to be tested by the values of the test functions at
+   * quadrature point @p q_point. The value is multiplied by the area
+   * element of the face and the quadrature weight.
+   */
+  void submit_value (const value_type   val_in,
+                     const unsigned int q_point);
+
+  /**
+   * Writes a gradient to be tested by the gradients of the test functions
+   * at quadrature point @p q_point. Overwrites data submitted through
+   * submit_normal_derivative().
+   */
+  void submit_gradient (const gradient_type grad_in,
+                        const unsigned int  q_point);
+
+  /**
+   * Writes a value to be tested by the normal derivatives of the test
+   * functions at quadrature point @p q_point. Overwrites data submitted
+   * through submit_gradient().
+   */
+  void submit_normal_derivative (const value_type   grad_in,
+                                 const unsigned int q_point);
+
+  /**
+   * Returns the unit normal vector at quadrature point @p q_point. The
+   * normal points from the interior to the exterior side, for both the
+   * interior and the exterior evaluator.
+   */
+  Tensor<1,dim,VectorizedArray<Number> >
+  get_normal_vector (const unsigned int q_point) const;
+
+  /**
+   * Returns the area element of the face times the quadrature weight at
+   * quadrature point @p q_point.
+   */
+  VectorizedArray<Number> JxW (const unsigned int q_point) const;
+
+  /**
+   * Returns the quadrature point in real coordinates. Only available if
+   * update_quadrature_points was set in the face update flags of
+   * MatrixFree.
+   */
+  Point<dim,VectorizedArray<Number> >
+  quadrature_point (const unsigned int q_point) const;
+
+  /**
+   * Returns the boundary id of the current face batch.
+   */
+  types::boundary_id boundary_id () const;
+
+  /**
+   * Returns a pointer to the first element of the local degrees of freedom
+   * of the first component. The local degrees of freedom of each component
+   * are stored in lexicographic order.
+   */
+  VectorizedArray<Number> *begin_dof_values ();
+
+  /**
+   * The number of degrees of freedom per cell and component.
+   */
+  const unsigned int dofs_per_cell;
+
+  /**
+   * The number of quadrature points on the face.
+   */
+  const unsigned int n_q_points;
+
+private:
+  /**
+   * Performs the actual access to the global vectors for reading and
+   * writing, where the operation is selected by @p operation.
+   */
+  template <typename VectorType, typename VectorOperation>
+  void read_write_operation (const VectorOperation &operation,
+                             VectorType            *vectors[]) const;
+
+  /**
+   * Reorders the data on the quadrature points of the exterior side from
+   * the natural ordering of the exterior face to the ordering of the
+   * interior face (or back, if @p to_interior is false).
+   */
+  void permute_quadrature_data (VectorizedArray<Number> *data,
+                                const bool               to_interior);
+
+  /**
+   * Returns the position of the current data in the arrays of the face
+   * geometry.
+   */
+  unsigned int geometry_index (const unsigned int q_point) const;
+
+  const MatrixFree<dim,Number>                           &matrix_info;
+  const internal::MatrixFreeFunctions::DoFInfo           &dof_info;
+  const internal::MatrixFreeFunctions::ShapeInfo<Number> &data;
+  const typename internal::MatrixFreeFunctions::MappingInfo<dim,Number>::FaceMappingInfo
+  &mapping_data;
+  const bool         is_interior_face;
+  const unsigned int n_fe_components;
+  unsigned int       face_batch;
+  const internal::MatrixFreeFunctions::FaceToCellTopology<VectorizedArray<Number>::n_array_elements>
+  *face;
+
+  VectorizedArray<Number> values_dofs[n_components][static_dofs_per_cell];
+  VectorizedArray<Number> values_quad[n_components][static_n_q_points];
+  VectorizedArray<Number> gradients_quad[n_components][dim][static_n_q_points];
+  VectorizedArray<Number> scratch_data[2*static_dofs_per_face +
+                                       2*Utilities::fixed_int_power<(fe_degree+1 > n_q_points_1d ?
+                                                                     fe_degree+1 : n_q_points_1d),
+                                                                    dim-1>::value];
+};
+
+
+
+/*----------------------- Inline functions ----------------------------------*/
+
+#ifndef DOXYGEN
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::FEFaceEvaluation (const MatrixFree<dim,Number> &matrix_free,
+                    const bool                    is_interior_face_in,
+                    const unsigned int            fe_no,
+                    const unsigned int            quad_no)
+  :
+  dofs_per_cell       (static_dofs_per_cell),
+  n_q_points          (static_n_q_points),
+  matrix_info         (matrix_free),
+  dof_info            (matrix_free.get_dof_info(fe_no)),
+  data                (matrix_free.get_shape_info(fe_no, quad_no)),
+  mapping_data        (matrix_free.get_mapping_info().face_data[quad_no]),
+  is_interior_face    (is_interior_face_in),
+  n_fe_components     (matrix_free.get_dof_info(fe_no).n_components),
+  face_batch          (numbers::invalid_unsigned_int),
+  face                (0)
+{
+  AssertIndexRange (quad_no, matrix_free.get_mapping_info().face_data.size());
+  Assert (data.element_type == internal::MatrixFreeFunctions::tensor_general ||
+          data.element_type == internal::MatrixFreeFunctions::tensor_symmetric ||
+          data.element_type == internal::MatrixFreeFunctions::tensor_gausslobatto,
+          ExcMessage ("FEFaceEvaluation is only implemented for tensor "
+                      "product elements with a full lexicographic basis."));
+  Assert ((data.fe_degree == fe_degree &&
+           data.n_q_points == Utilities::fixed_int_power<n_q_points_1d,dim>::value),
+          ExcMessage ("The template arguments of FEFaceEvaluation do not match "
+                      "the degree of the finite element or the number of "
+                      "quadrature points selected in MatrixFree."));
+  Assert (mapping_data.n_q_points == static_n_q_points,
+          ExcMessage ("The face data in MatrixFree has not been initialized."));
+  Assert (n_fe_components == 1 || n_fe_components == n_components,
+          ExcDimensionMismatch (n_fe_components, n_components));
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::reinit (const unsigned int face_batch_in)
+{
+  face_batch = face_batch_in;
+  face = &matrix_info.get_face_info(face_batch);
+  Assert (is_interior_face == true ||
+          face_batch < matrix_info.n_inner_face_batches(),
+          ExcMessage ("The exterior side is only available on inner faces."));
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+template <typename VectorType, typename VectorOperation>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::read_write_operation (const VectorOperation &operation,
+                        VectorType            *vectors[]) const
+{
+  Assert (face != 0, ExcNotInitialized());
+  Assert (dof_info.store_plain_indices == true, ExcNotInitialized());
+  const unsigned int n_vectors = VectorizedArray<Number>::n_array_elements;
+  for (unsigned int comp=0; comp<(n_fe_components == 1 ? n_components : 1); ++comp)
+    internal::check_vector_compatibility (*vectors[comp], dof_info);
+
+  VectorizedArray<Number> (&dof_values)[n_components][static_dofs_per_cell] =
+    const_cast<VectorizedArray<Number> (&)[n_components][static_dofs_per_cell]>(values_dofs);
+
+  const unsigned int n_filled_lanes = face->n_filled_lanes();
+  for (unsigned int v=0; v<n_vectors; ++v)
+    {
+      if (v >= n_filled_lanes)
+        {
+          for (unsigned int comp=0; comp<n_components; ++comp)
+            for (unsigned int i=0; i<static_dofs_per_cell; ++i)
+              operation.process_empty (dof_values[comp][i][v]);
+          continue;
+        }
+
+      // the cells are stored in the interleaved format of MatrixFree, so
+      // find the macro cell and the lane within the macro cell
+      const unsigned int cell_index = is_interior_face ?
+                                      face->cells_interior[v] :
+                                      face->cells_exterior[v];
+      const unsigned int macro_cell = cell_index / n_vectors;
+      const unsigned int lane = cell_index % n_vectors;
+      const unsigned int n_lanes_cell = dof_info.row_starts[macro_cell][2] > 0 ?
+                                        dof_info.row_starts[macro_cell][2] :
+                                        n_vectors;
+      Assert (dof_info.begin_indicators(macro_cell) ==
+              dof_info.end_indicators(macro_cell),
+              ExcMessage ("FEFaceEvaluation does not support constraints."));
+      const unsigned int *dof_indices = dof_info.begin_indices_plain(macro_cell);
+
+      if (n_fe_components == 1)
+        for (unsigned int i=0; i<static_dofs_per_cell; ++i)
+          for (unsigned int comp=0; comp<n_components; ++comp)
+            operation.process_dof (dof_indices[i*n_lanes_cell+lane],
+                                   *vectors[comp], dof_values[comp][i][v]);
+      else
+        for (unsigned int comp=0; comp<n_components; ++comp)
+          for (unsigned int i=0; i<static_dofs_per_cell; ++i)
+            operation.process_dof (dof_indices[(comp*static_dofs_per_cell+i)*
+                                               n_lanes_cell+lane],
+                                   *vectors[0], dof_values[comp][i][v]);
+    }
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+template <typename VectorType>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::read_dof_values (const VectorType &src)
+{
+  typename internal::BlockVectorSelector<VectorType,
+           IsBlockVector<VectorType>::value>::BaseVectorType *src_data[n_components];
+  for (unsigned int d=0; d<n_components; ++d)
+    src_data[d] = internal::BlockVectorSelector<VectorType, IsBlockVector<VectorType>::value>::get_vector_component(const_cast<VectorType &>(src), d);
+
+  internal::VectorReader<Number> reader;
+  read_write_operation (reader, src_data);
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+template <typename VectorType>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::distribute_local_to_global (VectorType &dst) const
+{
+  typename internal::BlockVectorSelector<VectorType,
+           IsBlockVector<VectorType>::value>::BaseVectorType *dst_data[n_components];
+  for (unsigned int d=0; d<n_components; ++d)
+    dst_data[d] = internal::BlockVectorSelector<VectorType, IsBlockVector<VectorType>::value>::get_vector_component(dst, d);
+
+  internal::VectorDistributorLocalToGlobal<Number> distributor;
+  read_write_operation (distributor, dst_data);
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+template <typename VectorType>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::set_dof_values (VectorType &dst) const
+{
+  typename internal::BlockVectorSelector<VectorType,
+           IsBlockVector<VectorType>::value>::BaseVectorType *dst_data[n_components];
+  for (unsigned int d=0; d<n_components; ++d)
+    dst_data[d] = internal::BlockVectorSelector<VectorType, IsBlockVector<VectorType>::value>::get_vector_component(dst, d);
+
+  internal::VectorSetter<Number> setter;
+  read_write_operation (setter, dst_data);
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::permute_quadrature_data (VectorizedArray<Number> *quad_data,
+                           const bool               to_interior)
+{
+  if (is_interior_face || face->face_orientation == 0 || dim == 1)
+    return;
+
+  // position j on the exterior face of the quadrature point q on the
+  // interior face: the coordinates are possibly swapped and flipped
+  VectorizedArray<Number> *tmp = &scratch_data[0];
+  const unsigned int orientation = face->face_orientation;
+  for (unsigned int q=0; q<static_n_q_points; ++q)
+    {
+      const unsigned int index[2] = {q%n_q_points_1d, q/n_q_points_1d};
+      unsigned int j = 0;
+      for (unsigned int k=0, stride=1; k+1<dim; ++k, stride *= n_q_points_1d)
+        {
+          unsigned int i = index[(orientation & 1) ? 1-k : k];
+          if (orientation & (2U<<k))
+            i = n_q_points_1d-1-i;
+          j += i*stride;
+        }
+      if (to_interior)
+        tmp[q] = quad_data[j];
+      else
+        tmp[j] = quad_data[q];
+    }
+  for (unsigned int q=0; q<static_n_q_points; ++q)
+    quad_data[q] = tmp[q];
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::evaluate (const bool evaluate_values,
+            const bool evaluate_gradients)
+{
+  Assert (face != 0, ExcNotInitialized());
+  typedef internal::EvaluatorTensorProduct<internal::evaluate_general,(dim>1?dim-1:1),
+          fe_degree,n_q_points_1d,VectorizedArray<Number> > Eval;
+  const unsigned int n_dofs_1d = fe_degree+1;
+
+  const unsigned int face_no = is_interior_face ? face->interior_face_no :
+                               face->exterior_face_no;
+  const unsigned int normal = face_no/2;
+  const unsigned int side = face_no%2;
+  unsigned int tangential_strides[2] = {0, 0};
+  unsigned int stride_normal = 1;
+  for (unsigned int d=0, k=0, stride=1; d<dim; ++d, stride *= n_dofs_1d)
+    if (d == normal)
+      stride_normal = stride;
+    else
+      tangential_strides[k++] = stride;
+
+  // select the 1D shape functions along the face directions. On the
+  // exterior side of faces with hanging nodes, the points are located on
+  // one half of the coarse face
+  const VectorizedArray<Number> *shape_values[2], *shape_gradients[2];
+  for (unsigned int k=0; k<2; ++k)
+    {
+      const unsigned int half = is_interior_face ? 0 :
+                                (k==0 ? face->subface_index : face->subface_index/3) % 3;
+      shape_values[k] = half == 0 ? data.shape_values.begin() :
+                        data.shape_values_subface[half-1].begin();
+      shape_gradients[k] = half == 0 ? data.shape_gradients.begin() :
+                           data.shape_gradients_subface[half-1].begin();
+    }
+
+  VectorizedArray<Number> *face_values = &scratch_data[0];
+  VectorizedArray<Number> *face_gradients = face_values + static_dofs_per_face;
+  VectorizedArray<Number> *tmp = face_gradients + static_dofs_per_face;
+  VectorizedArray<Number> *tmp2 = tmp + (static_dofs_per_face > static_n_q_points ?
+                                         static_dofs_per_face : static_n_q_points);
+
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    {
+      // interpolate the values and normal derivatives to the face
+      for (unsigned int i1=0; i1<(dim>2 ? n_dofs_1d : 1); ++i1)
+        for (unsigned int i0=0; i0<(dim>1 ? n_dofs_1d : 1); ++i0)
+          {
+            const VectorizedArray<Number> *in = &values_dofs[comp][0] +
+                                                i0*tangential_strides[0] +
+                                                i1*tangential_strides[1];
+            VectorizedArray<Number> value = data.face_value[side][0] * in[0];
+            VectorizedArray<Number> gradient = data.face_gradient[side][0] * in[0];
+            for (unsigned int k=1; k<n_dofs_1d; ++k)
+              {
+                value += data.face_value[side][k] * in[k*stride_normal];
+                gradient += data.face_gradient[side][k] * in[k*stride_normal];
+              }
+            face_values[i1*n_dofs_1d+i0] = value;
+            face_gradients[i1*n_dofs_1d+i0] = gradient;
+          }
+
+      // sum factorization along the directions within the face
+      VectorizedArray<Number> *tangential_gradients[2];
+      for (unsigned int d=0, k=0; d<dim; ++d)
+        if (d != normal)
+          tangential_gradients[k++] = &gradients_quad[comp][d][0];
+      VectorizedArray<Number> *normal_gradients = &gradients_quad[comp][normal][0];
+      if (dim == 1)
+        {
+          values_quad[comp][0] = face_values[0];
+          normal_gradients[0] = face_gradients[0];
+        }
+      else if (dim == 2)
+        {
+          if (evaluate_values)
+            Eval::template apply<0,true,false> (shape_values[0], face_values,
+                                                values_quad[comp]);
+          if (evaluate_gradients)
+            {
+              Eval::template apply<0,true,false> (shape_gradients[0], face_values,
+                                                  tangential_gradients[0]);
+              Eval::template apply<0,true,false> (shape_values[0], face_gradients,
+                                                  normal_gradients);
+            }
+        }
+      else
+        {
+          Eval::template apply<0,true,false> (shape_values[0], face_values, tmp);
+          if (evaluate_values)
+            Eval::template apply<1,true,false> (shape_values[1], tmp,
+                                                values_quad[comp]);
+          if (evaluate_gradients)
+            {
+              Eval::template apply<1,true,false> (shape_gradients[1], tmp,
+                                                  tangential_gradients[1]);
+              Eval::template apply<0,true,false> (shape_gradients[0], face_values,
+                                                  tmp2);
+              Eval::template apply<1,true,false> (shape_values[1], tmp2,
+                                                  tangential_gradients[0]);
+              Eval::template apply<0,true,false> (shape_values[0], face_gradients,
+                                                  tmp2);
+              Eval::template apply<1,true,false> (shape_values[1], tmp2,
+                                                  normal_gradients);
+            }
+        }
+
+      // bring the data of the exterior side into the order of the interior
+      // quadrature points
+      if (evaluate_values)
+        permute_quadrature_data (&values_quad[comp][0], true);
+      if (evaluate_gradients)
+        for (unsigned int d=0; d<dim; ++d)
+          permute_quadrature_data (&gradients_quad[comp][d][0], true);
+    }
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::integrate (const bool integrate_values,
+             const bool integrate_gradients)
+{
+  Assert (face != 0, ExcNotInitialized());
+  typedef internal::EvaluatorTensorProduct<internal::evaluate_general,(dim>1?dim-1:1),
+          fe_degree,n_q_points_1d,VectorizedArray<Number> > Eval;
+  const unsigned int n_dofs_1d = fe_degree+1;
+
+  const unsigned int face_no = is_interior_face ? face->interior_face_no :
+                               face->exterior_face_no;
+  const unsigned int normal = face_no/2;
+  const unsigned int side = face_no%2;
+  unsigned int tangential_strides[2] = {0, 0};
+  unsigned int stride_normal = 1;
+  for (unsigned int d=0, k=0, stride=1; d<dim; ++d, stride *= n_dofs_1d)
+    if (d == normal)
+      stride_normal = stride;
+    else
+      tangential_strides[k++] = stride;
+
+  const VectorizedArray<Number> *shape_values[2], *shape_gradients[2];
+  for (unsigned int k=0; k<2; ++k)
+    {
+      const unsigned int half = is_interior_face ? 0 :
+                                (k==0 ? face->subface_index : face->subface_index/3) % 3;
+      shape_values[k] = half == 0 ? data.shape_values.begin() :
+                        data.shape_values_subface[half-1].begin();
+      shape_gradients[k] = half == 0 ? data.shape_gradients.begin() :
+                           data.shape_gradients_subface[half-1].begin();
+    }
+
+  VectorizedArray<Number> *face_values = &scratch_data[0];
+  VectorizedArray<Number> *face_gradients = face_values + static_dofs_per_face;
+  VectorizedArray<Number> *tmp = face_gradients + static_dofs_per_face;
+
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    {
+      // bring the data on the exterior side back into the natural order of
+      // the face
+      if (integrate_values)
+        permute_quadrature_data (&values_quad[comp][0], false);
+      if (integrate_gradients)
+        for (unsigned int d=0; d<dim; ++d)
+          permute_quadrature_data (&gradients_quad[comp][d][0], false);
+
+      VectorizedArray<Number> *tangential_gradients[2];
+      for (unsigned int d=0, k=0; d<dim; ++d)
+        if (d != normal)
+          tangential_gradients[k++] = &gradients_quad[comp][d][0];
+      VectorizedArray<Number> *normal_gradients = &gradients_quad[comp][normal][0];
+
+      // transposed sum factorization along the directions within the face
+      if (dim == 1)
+        {
+          face_values[0] = integrate_values ? values_quad[comp][0] :
+                           VectorizedArray<Number>();
+          face_gradients[0] = integrate_gradients ? normal_gradients[0] :
+                              VectorizedArray<Number>();
+        }
+      else if (dim == 2)
+        {
+          if (integrate_values)
+            Eval::template apply<0,false,false> (shape_values[0], values_quad[comp],
+                                                 face_values);
+          if (integrate_gradients)
+            {
+              if (integrate_values)
+                Eval::template apply<0,false,true> (shape_gradients[0],
+                                                    tangential_gradients[0],
+                                                    face_values);
+              else
+                Eval::template apply<0,false,false> (shape_gradients[0],
+                                                     tangential_gradients[0],
+                                                     face_values);
+              Eval::template apply<0,false,false> (shape_values[0], normal_gradients,
+                                                   face_gradients);
+            }
+        }
+      else
+        {
+          if (integrate_values)
+            {
+              Eval::template apply<0,false,false> (shape_values[0], values_quad[comp],
+                                                   tmp);
+              if (integrate_gradients)
+                Eval::template apply<0,false,true> (shape_gradients[0],
+                                                    tangential_gradients[0], tmp);
+            }
+          else
+            Eval::template apply<0,false,false> (shape_gradients[0],
+                                                 tangential_gradients[0], tmp);
+          Eval::template apply<1,false,false> (shape_values[1], tmp, face_values);
+          if (integrate_gradients)
+            {
+              Eval::template apply<0,false,false> (shape_values[0],
+                                                   tangential_gradients[1], tmp);
+              Eval::template apply<1,false,true> (shape_gradients[1], tmp,
+                                                  face_values);
+              Eval::template apply<0,false,false> (shape_values[0], normal_gradients,
+                                                   tmp);
+              Eval::template apply<1,false,false> (shape_values[1], tmp,
+                                                   face_gradients);
+            }
+        }
+
+      // expand the face data into the degrees of freedom of the cell
+      for (unsigned int i1=0; i1<(dim>2 ? n_dofs_1d : 1); ++i1)
+        for (unsigned int i0=0; i0<(dim>1 ? n_dofs_1d : 1); ++i0)
+          {
+            VectorizedArray<Number> *out = &values_dofs[comp][0] +
+                                           i0*tangential_strides[0] +
+                                           i1*tangential_strides[1];
+            const VectorizedArray<Number> value = face_values[i1*n_dofs_1d+i0];
+            if (integrate_gradients)
+              {
+                const VectorizedArray<Number> gradient = face_gradients[i1*n_dofs_1d+i0];
+                for (unsigned int k=0; k<n_dofs_1d; ++k)
+                  out[k*stride_normal] = data.face_value[side][k] * value +
+                                         data.face_gradient[side][k] * gradient;
+              }
+            else
+              for (unsigned int k=0; k<n_dofs_1d; ++k)
+                out[k*stride_normal] = data.face_value[side][k] * value;
+          }
+    }
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+unsigned int
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::geometry_index (const unsigned int q_point) const
+{
+  Assert (face != 0, ExcNotInitialized());
+  AssertIndexRange (q_point, static_n_q_points);
+  return face_batch*static_n_q_points + q_point;
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+typename FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>::value_type
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::get_value (const unsigned int q_point) const
+{
+  AssertIndexRange (q_point, static_n_q_points);
+  value_type value;
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+    value_component(value, comp) = values_quad[comp][q_point];
+  return value;
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+typename FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>::gradient_type
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::get_gradient (const unsigned int q_point) const
+{
+  const Tensor<2,dim,VectorizedArray<Number> > &jac =
+    mapping_data.jacobians[is_interior_face ? 0 : 1][geometry_index(q_point)];
+  gradient_type gradient;
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    {
+      Tensor<1,dim,VectorizedArray<Number> > &grad =
+        internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+        gradient_component(gradient, comp);
+      for (unsigned int d=0; d<dim; ++d)
+        {
+          grad[d] = jac[d][0] * gradients_quad[comp][0][q_point];
+          for (unsigned int e=1; e<dim; ++e)
+            grad[d] += jac[d][e] * gradients_quad[comp][e][q_point];
+        }
+    }
+  return gradient;
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+typename FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>::value_type
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::get_normal_derivative (const unsigned int q_point) const
+{
+  const gradient_type gradient = get_gradient (q_point);
+  const Tensor<1,dim,VectorizedArray<Number> > normal = get_normal_vector(q_point);
+  value_type normal_derivative;
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+    value_component(normal_derivative, comp) =
+      internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+      gradient_component(gradient, comp) * normal;
+  return normal_derivative;
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::submit_value (const value_type   val_in,
+                const unsigned int q_point)
+{
+  const VectorizedArray<Number> JxW = mapping_data.JxW_values[geometry_index(q_point)];
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    values_quad[comp][q_point] =
+      internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+      value_component(val_in, comp) * JxW;
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::submit_gradient (const gradient_type grad_in,
+                   const unsigned int  q_point)
+{
+  const unsigned int index = geometry_index(q_point);
+  const Tensor<2,dim,VectorizedArray<Number> > &jac =
+    mapping_data.jacobians[is_interior_face ? 0 : 1][index];
+  const VectorizedArray<Number> JxW = mapping_data.JxW_values[index];
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    {
+      const Tensor<1,dim,VectorizedArray<Number> > &grad =
+        internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+        gradient_component(grad_in, comp);
+      for (unsigned int d=0; d<dim; ++d)
+        {
+          VectorizedArray<Number> new_val = jac[0][d] * grad[0];
+          for (unsigned int e=1; e<dim; ++e)
+            new_val += jac[e][d] * grad[e];
+          gradients_quad[comp][d][q_point] = new_val * JxW;
+        }
+    }
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+void
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::submit_normal_derivative (const value_type   grad_in,
+                            const unsigned int q_point)
+{
+  const Tensor<1,dim,VectorizedArray<Number> > normal = get_normal_vector(q_point);
+  gradient_type gradient;
+  for (unsigned int comp=0; comp<n_components; ++comp)
+    internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+    gradient_component(gradient, comp) = normal *
+                                         internal::FEFaceEvaluationTypes<dim,n_components_,Number>::
+                                         value_component(grad_in, comp);
+  submit_gradient (gradient, q_point);
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+Tensor<1,dim,VectorizedArray<Number> >
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::get_normal_vector (const unsigned int q_point) const
+{
+  return mapping_data.normal_vectors[geometry_index(q_point)];
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+VectorizedArray<Number>
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::JxW (const unsigned int q_point) const
+{
+  return mapping_data.JxW_values[geometry_index(q_point)];
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+Point<dim,VectorizedArray<Number> >
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::quadrature_point (const unsigned int q_point) const
+{
+  Assert (mapping_data.quadrature_points.size() > 0,
+          ExcMessage ("Quadrature points on faces have not been computed. "
+                      "Set update_quadrature_points in the face update flags."));
+  return mapping_data.quadrature_points[geometry_index(q_point)];
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+types::boundary_id
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::boundary_id () const
+{
+  Assert (face != 0, ExcNotInitialized());
+  return face->boundary_id;
+}
+
+
+
+template <int dim, int fe_degree, int n_q_points_1d, int n_components_,
+          typename Number>
+inline
+VectorizedArray<Number> *
+FEFaceEvaluation<dim,fe_degree,n_q_points_1d,n_components_,Number>
+::begin_dof_values ()
+{
+  return &values_dofs[0][0];
+}
+
+
+#endif  // ifndef DOXYGEN
+
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -25,6 +25,7 @@
 #include <deal.II/fe/fe.h>
 #include <deal.II/fe/mapping.h>
 #include <deal.II/matrix_free/helper_functions.h>
+#include <deal.II/matrix_free/face_info.h>
 
 #include <memory>
 
@@ -75,13 +76,38 @@ namespace internal
        * for different kinds of iterators, e.g. standard DoFHandler,
        * multigrid, etc.)  on a fixed Triangulation. In addition, a mapping
        * and several quadrature formulas are given.
+       *
+       * If @p jacobians_on_the_fly is set, the inverse Jacobians and JxW
+       * values of cells with non-constant Jacobian are not stored for each
+       * quadrature point. Rather, the support points of the polynomial
+       * mapping are stored for these cells and the data is evaluated by
+       * compute_jacobians_on_the_fly() when accessing the cell.
        */
       void initialize (const dealii::Triangulation<dim>                &tria,
                        const std::vector<std::pair<unsigned int,unsigned int> > &cells,
                        const std::vector<unsigned int>         &active_fe_index,
                        const Mapping<dim>                      &mapping,
                        const std::vector<dealii::hp::QCollection<1> >  &quad,
-                       const UpdateFlags                        update_flags);
+                       const UpdateFlags                        update_flags,
+                       const bool                               jacobians_on_the_fly = false);
+
+      /**
+       * Computes the geometry information on the faces given by @p faces,
+       * where the cells are indexed as in the vector @p cells passed to
+       * initialize(). The face quadrature formulas are the tensor products
+       * of the one-dimensional formulas in @p quad (only the first entry of
+       * each hp::QCollection is used). The data is stored in the ordering of
+       * the quadrature points on the interior side of the faces, also for
+       * the data related to the exterior cells. If the orientation of some
+       * face batch requires to flip the face coordinates, the 1D quadrature
+       * formulas need to be symmetric.
+       */
+      void initialize_faces (const dealii::Triangulation<dim>                &tria,
+                             const std::vector<std::pair<unsigned int,unsigned int> > &cells,
+                             const std::vector<FaceToCellTopology<VectorizedArray<Number>::n_array_elements> > &faces,
+                             const Mapping<dim>                      &mapping,
+                             const std::vector<dealii::hp::QCollection<1> >  &quad,
+                             const UpdateFlags                        update_flags);
 
       /**
        * Helper function to determine which update flags must be set in the
@@ -102,6 +128,27 @@ namespace internal
        */
       unsigned int get_cell_data_index (const unsigned int cell_chunk_no) const;
 
+      /**
+       * Computes the inverse transposed Jacobians and the JxW values in all
+       * quadrature points of the quadrature formula @p quad_no (with hp index
+       * @p active_quad_index) on the general cell batch with data index
+       * @p cell_data_index (as returned by get_cell_data_index()) from the
+       * mapping support points stored for that batch. The result is written
+       * into the arrays @p inverse_jacobians and @p JxW_values which must
+       * hold as many entries as there are quadrature points. The array @p
+       * scratch_data is used as temporary storage and resized as necessary.
+       *
+       * Only available if the class has been initialized with the option to
+       * compute the Jacobians on the fly.
+       */
+      void compute_jacobians_on_the_fly
+      (const unsigned int                      cell_data_index,
+       const unsigned int                      quad_no,
+       const unsigned int                      active_quad_index,
+       Tensor<2,dim,VectorizedArray<Number> >  *inverse_jacobians,
+       VectorizedArray<Number>                 *JxW_values,
+       AlignedVector<VectorizedArray<Number> > &scratch_data) const;
+
       /**
        * Clears all data fields in this class.
        */
@@ -253,6 +300,23 @@ namespace internal
          */
         std::vector<AlignedVector<VectorizedArray<Number> > > quadrature_weights;
 
+        /**
+         * The values of the one-dimensional Lagrange polynomials through the
+         * mapping support points, evaluated in the points of the
+         * one-dimensional quadrature formula. The entry for quadrature point
+         * @p q and polynomial @p i is stored at position
+         * <tt>q*n_mapping_points_1d+i</tt>. Only filled if the Jacobians are
+         * computed on the fly. The outer index runs over the hp quadrature
+         * formulas.
+         */
+        std::vector<AlignedVector<VectorizedArray<Number> > > mapping_shape_values;
+
+        /**
+         * Same as @p mapping_shape_values but for the derivatives of the
+         * one-dimensional Lagrange polynomials.
+         */
+        std::vector<AlignedVector<VectorizedArray<Number> > > mapping_shape_gradients;
+
         /**
          * This variable stores the number of quadrature points for all
          * quadrature indices in the underlying element for easier access to
@@ -289,6 +353,62 @@ namespace internal
        */
       std::vector<MappingInfoDependent> mapping_data_gen;
 
+      /**
+       * Definition of a structure that stores the geometry data on faces for
+       * a given quadrature formula. The data is stored for all quadrature
+       * points of each face batch, i.e., the data of face batch @p face
+       * starts at index <tt>face*n_q_points</tt>. In contrast to the cell
+       * data, no compression for Cartesian or affine geometries is done.
+       */
+      struct FaceMappingInfo
+      {
+        /**
+         * Constructor.
+         */
+        FaceMappingInfo ();
+
+        /**
+         * The number of quadrature points on each face.
+         */
+        unsigned int n_q_points;
+
+        /**
+         * The Jacobian determinant of the face times the quadrature weight,
+         * i.e., the area element of the face.
+         */
+        AlignedVector<VectorizedArray<Number> > JxW_values;
+
+        /**
+         * The unit normal vectors on the faces, pointing from the interior
+         * to the exterior side.
+         */
+        AlignedVector<Tensor<1,dim,VectorizedArray<Number> > > normal_vectors;
+
+        /**
+         * The inverse transposed Jacobian of the cells adjacent to the
+         * faces, evaluated at the quadrature points of the face. Index 0
+         * refers to the interior cell and index 1 to the exterior cell. The
+         * latter is only filled for inner faces.
+         */
+        AlignedVector<Tensor<2,dim,VectorizedArray<Number> > > jacobians[2];
+
+        /**
+         * The quadrature points in real coordinates. Only filled if
+         * update_quadrature_points has been requested.
+         */
+        AlignedVector<Point<dim,VectorizedArray<Number> > > quadrature_points;
+
+        /**
+         * Returns the memory consumption in bytes.
+         */
+        std::size_t memory_consumption () const;
+      };
+
+      /**
+       * Contains the face data for each quadrature formula.
+       */
+      std::vector<FaceMappingInfo> face_data;
+
       /**
        * Stores whether JxW values have been initialized
        */
@@ -304,6 +424,32 @@ namespace internal
        */
       bool quadrature_points_initialized;
 
+      /**
+       * Stores whether the inverse Jacobians and JxW values on cells with
+       * non-constant Jacobian are computed on the fly from @p
+       * mapping_support_points rather than being stored for all quadrature
+       * points.
+       */
+      bool jacobians_on_the_fly;
+
+      /**
+       * The number of mapping support points per coordinate direction in
+       * case the Jacobians are computed on the fly, i.e., the degree of the
+       * polynomial mapping plus one.
+       */
+      unsigned int n_mapping_points_1d;
+
+      /**
+       * The support points of the polynomial mapping on the cells with
+       * non-constant Jacobian in case the Jacobians are computed on the fly.
+       * The support points are given by the tensor product of the
+       * Gauss-Lobatto points of degree <tt>n_mapping_points_1d-1</tt> and
+       * stored in lexicographic order, with the data of the cell batch with
+       * index <tt>get_cell_data_index(cell)</tt> starting at position
+       * <tt>get_cell_data_index(cell)*n_mapping_points_1d<sup>dim</sup></tt>.
+       */
+      AlignedVector<Point<dim,VectorizedArray<Number> > > mapping_support_points;
+
       /**
        * Internal temporary data used for the initialization.
        */
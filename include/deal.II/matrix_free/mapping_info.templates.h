@@ -16,9 +16,14 @@
 
 #include <deal.II/base/utilities.h>
 #include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/polynomial.h>
+#include <deal.II/base/quadrature_lib.h>
 #include <deal.II/fe/fe_nothing.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/fe/mapping_q1.h>
+#include <deal.II/fe/mapping_q.h>
+
+#include <map>
 
 #include <deal.II/matrix_free/mapping_info.h>
 
@@ -37,7 +42,9 @@ namespace internal
       :
       JxW_values_initialized (false),
       second_derivatives_initialized (false),
-      quadrature_points_initialized (false)
+      quadrature_points_initialized (false),
+      jacobians_on_the_fly (false),
+      n_mapping_points_1d (0)
     {}
 
 
@@ -49,10 +56,14 @@ namespace internal
       JxW_values_initialized = false;
       quadrature_points_initialized = false;
       second_derivatives_initialized = false;
+      jacobians_on_the_fly = false;
+      n_mapping_points_1d = 0;
       mapping_data_gen.clear();
+      face_data.clear();
       cell_type.clear();
       cartesian_data.clear();
       affine_data.clear();
+      mapping_support_points.clear();
     }
 
 
@@ -119,6 +130,51 @@ namespace internal
           return 1;
         else return tria.begin()->diameter();
       }
+
+
+
+      // returns the polynomial degree of the given mapping, or
+      // numbers::invalid_unsigned_int if the mapping is not described by
+      // polynomials
+      template <int dim>
+      unsigned int get_mapping_degree (const Mapping<dim> &mapping)
+      {
+        if (const MappingQGeneric<dim> *mapping_q_generic =
+              dynamic_cast<const MappingQGeneric<dim> *>(&mapping))
+          return mapping_q_generic->get_degree();
+        else if (const MappingQ<dim> *mapping_q =
+                   dynamic_cast<const MappingQ<dim> *>(&mapping))
+          return mapping_q->get_degree();
+        else
+          return numbers::invalid_unsigned_int;
+      }
+
+
+
+      // applies the matrix with n_rows x n_columns entries (stored row-wise)
+      // along the direction of a tensor product array that has unit stride
+      // @p stride, where the data in the other directions is collected into
+      // n_blocks blocks
+      template <typename Number>
+      void apply_matrix_1d (const VectorizedArray<Number> *matrix,
+                            const unsigned int             n_rows,
+                            const unsigned int             n_columns,
+                            const unsigned int             stride,
+                            const unsigned int             n_blocks,
+                            const VectorizedArray<Number> *in,
+                            VectorizedArray<Number>       *out)
+      {
+        for (unsigned int b=0; b<n_blocks; ++b)
+          for (unsigned int r=0; r<n_rows; ++r)
+            for (unsigned int s=0; s<stride; ++s)
+              {
+                const VectorizedArray<Number> *in_ptr = in + b*n_columns*stride + s;
+                VectorizedArray<Number> sum = matrix[r*n_columns] * in_ptr[0];
+                for (unsigned int c=1; c<n_columns; ++c)
+                  sum += matrix[r*n_columns+c] * in_ptr[c*stride];
+                out[(b*n_rows+r)*stride+s] = sum;
+              }
+      }
     }
 
 
@@ -131,7 +187,8 @@ namespace internal
      const std::vector<unsigned int>                          &active_fe_index,
      const Mapping<dim>                                       &mapping,
      const std::vector<dealii::hp::QCollection<1> >           &quad,
-     const UpdateFlags                                         update_flags_input)
+     const UpdateFlags                                         update_flags_input,
+     const bool                                                compute_on_the_fly)
     {
       clear();
       const unsigned int n_quads = quad.size();
@@ -156,6 +213,33 @@ namespace internal
       if (update_flags & update_quadrature_points)
         quadrature_points_initialized = true;
 
+      // in case the Jacobians are computed on the fly, collect the data of
+      // the polynomial mapping. The mapping is represented exactly by
+      // interpolation in the tensor product of Gauss-Lobatto points of the
+      // same degree
+      std_cxx11::shared_ptr<dealii::FEValues<dim> > fe_values_support_points;
+      std::vector<Polynomials::Polynomial<double> > mapping_polynomials;
+      if (compute_on_the_fly)
+        {
+          AssertThrow (!(update_flags & update_jacobian_grads),
+                       ExcNotImplemented("Computing Jacobians on the fly is "
+                                         "not implemented for second "
+                                         "derivatives"));
+          const unsigned int mapping_degree = internal::get_mapping_degree(mapping);
+          AssertThrow (mapping_degree != numbers::invalid_unsigned_int,
+                       ExcNotImplemented("Computing Jacobians on the fly is "
+                                         "only implemented for MappingQGeneric "
+                                         "and MappingQ"));
+          jacobians_on_the_fly = true;
+          n_mapping_points_1d = mapping_degree + 1;
+          const QGaussLobatto<1> points_1d (n_mapping_points_1d);
+          mapping_polynomials =
+            Polynomials::generate_complete_Lagrange_basis(points_1d.get_points());
+          fe_values_support_points.reset
+          (new dealii::FEValues<dim> (mapping, dummy_fe, Quadrature<dim>(points_1d),
+                                      update_quadrature_points));
+        }
+
       // when we make comparisons about the size of Jacobians we need to know
       // the approximate size of typical entries in Jacobians. We need to fix
       // the Jacobian size once and for all. We choose the diameter of the
@@ -206,6 +290,29 @@ namespace internal
               if (n_hp_quads > 1)
                 current_data.quad_index_conversion[q] = n_q_points;
 
+              // evaluate the polynomials of the mapping in the 1D quadrature
+              // points
+              if (jacobians_on_the_fly)
+                {
+                  current_data.mapping_shape_values.resize(n_hp_quads);
+                  current_data.mapping_shape_gradients.resize(n_hp_quads);
+                  current_data.mapping_shape_values[q].resize
+                  (n_q_points_1d[q]*n_mapping_points_1d);
+                  current_data.mapping_shape_gradients[q].resize
+                  (n_q_points_1d[q]*n_mapping_points_1d);
+                  std::vector<double> val_and_grad(2);
+                  for (unsigned int i=0; i<n_q_points_1d[q]; ++i)
+                    for (unsigned int j=0; j<n_mapping_points_1d; ++j)
+                      {
+                        mapping_polynomials[j].value(quad[my_q][q].point(i)[0],
+                                                     val_and_grad);
+                        current_data.mapping_shape_values[q][i*n_mapping_points_1d+j] =
+                          val_and_grad[0];
+                        current_data.mapping_shape_gradients[q][i*n_mapping_points_1d+j] =
+                          val_and_grad[1];
+                      }
+                }
+
               // To walk on the diagonal for lexicographic ordering, we have
               // to jump one index ahead in each direction. For direction 0,
               // this is just the next point, for direction 1, it means adding
@@ -400,10 +507,42 @@ namespace internal
 
                 } // end if (my_q == 0)
 
+              // general cell case with Jacobians computed on the fly: only
+              // need to store the mapping support points once for all
+              // quadrature formulas. The data index of the cell is given by
+              // the number of general cells before it, which is tracked by
+              // rowstart_jacobians.
+              if (get_cell_type(cell) == general && jacobians_on_the_fly)
+                {
+                  current_data.rowstart_jacobians.push_back (0);
+                  if (my_q == 0)
+                    {
+                      const unsigned int n_points =
+                        fe_values_support_points->n_quadrature_points;
+                      AssertDimension(mapping_support_points.size(),
+                                      get_cell_data_index(cell)*n_points);
+                      mapping_support_points.resize
+                      (mapping_support_points.size() + n_points);
+                      Point<dim,VectorizedArray<Number> > *points =
+                        &mapping_support_points[get_cell_data_index(cell)*n_points];
+                      for (unsigned int j=0; j<vectorization_length; ++j)
+                        {
+                          typename dealii::Triangulation<dim>::cell_iterator
+                          cell_it (&tria, cells[cell*vectorization_length+j].first,
+                                   cells[cell*vectorization_length+j].second);
+                          fe_values_support_points->reinit(cell_it);
+                          for (unsigned int i=0; i<n_points; ++i)
+                            for (unsigned int d=0; d<dim; ++d)
+                              points[i][d][j] =
+                                fe_values_support_points->quadrature_point(i)[d];
+                        }
+                    }
+                }
+
               // general cell case: now go through all quadrature points and
               // collect the data. done for all different quadrature formulas,
               // so do it outside the above loop.
-              if (get_cell_type(cell) == general)
+              else if (get_cell_type(cell) == general)
                 {
                   const unsigned int previous_size =
                     current_data.jacobians.size();
@@ -600,6 +739,277 @@ namespace internal
 
 
 
+    template <int dim, typename Number>
+    void
+    MappingInfo<dim,Number>::compute_jacobians_on_the_fly
+    (const unsigned int                      cell_data_index,
+     const unsigned int                      quad_no,
+     const unsigned int                      active_quad_index,
+     Tensor<2,dim,VectorizedArray<Number> >  *inverse_jacobians,
+     VectorizedArray<Number>                 *JxW_values,
+     AlignedVector<VectorizedArray<Number> > &scratch_data) const
+    {
+      Assert (jacobians_on_the_fly, ExcNotInitialized());
+      AssertIndexRange (quad_no, mapping_data_gen.size());
+      const MappingInfoDependent &current_data = mapping_data_gen[quad_no];
+      AssertIndexRange (active_quad_index, current_data.mapping_shape_values.size());
+
+      const unsigned int n_points_1d = n_mapping_points_1d;
+      const unsigned int n_points = Utilities::fixed_power<dim>(n_points_1d);
+      const unsigned int n_q_points = current_data.n_q_points[active_quad_index];
+      const unsigned int n_q_points_1d =
+        current_data.mapping_shape_values[active_quad_index].size() / n_points_1d;
+      AssertIndexRange ((cell_data_index+1)*n_points,
+                        mapping_support_points.size()+1);
+
+      const VectorizedArray<Number> *shape_values =
+        current_data.mapping_shape_values[active_quad_index].begin();
+      const VectorizedArray<Number> *shape_gradients =
+        current_data.mapping_shape_gradients[active_quad_index].begin();
+      const Point<dim,VectorizedArray<Number> > *points =
+        &mapping_support_points[cell_data_index*n_points];
+
+      // the scratch data holds the coordinates of the support points, two
+      // arrays for the intermediate results of the tensor product evaluation
+      // and the Jacobians in the quadrature points
+      const unsigned int max_size =
+        Utilities::fixed_power<dim>(std::max(n_points_1d, n_q_points_1d));
+      scratch_data.resize_fast ((dim+2)*max_size + dim*dim*n_q_points);
+      VectorizedArray<Number> *coordinates = scratch_data.begin();
+      VectorizedArray<Number> *tmp[2] = {coordinates + dim*max_size,
+                                         coordinates + (dim+1)*max_size
+                                        };
+      VectorizedArray<Number> *jacobians = coordinates + (dim+2)*max_size;
+
+      for (unsigned int d=0; d<dim; ++d)
+        for (unsigned int i=0; i<n_points; ++i)
+          coordinates[d*max_size+i] = points[i][d];
+
+      // compute the derivative of each component of the mapped position in
+      // each unit direction by sum factorization: apply the derivative
+      // matrix in the direction of the derivative and the interpolation
+      // matrix in all other directions
+      for (unsigned int comp=0; comp<dim; ++comp)
+        for (unsigned int deriv=0; deriv<dim; ++deriv)
+          {
+            const VectorizedArray<Number> *in = coordinates + comp*max_size;
+            unsigned int stride = 1, n_blocks = n_points/n_points_1d;
+            for (unsigned int direction=0; direction<dim; ++direction)
+              {
+                VectorizedArray<Number> *out = tmp[direction%2];
+                internal::apply_matrix_1d (direction == deriv ? shape_gradients :
+                                           shape_values, n_q_points_1d,
+                                           n_points_1d, stride, n_blocks, in, out);
+                stride *= n_q_points_1d;
+                n_blocks /= n_points_1d;
+                in = out;
+              }
+            for (unsigned int q=0; q<n_q_points; ++q)
+              jacobians[(q*dim+comp)*dim+deriv] = in[q];
+          }
+
+      const VectorizedArray<Number> *quadrature_weights =
+        current_data.quadrature_weights[active_quad_index].begin();
+      for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          Tensor<2,dim,VectorizedArray<Number> > jac;
+          for (unsigned int d=0; d<dim; ++d)
+            for (unsigned int e=0; e<dim; ++e)
+              jac[d][e] = jacobians[(q*dim+d)*dim+e];
+          JxW_values[q] = determinant(jac) * quadrature_weights[q];
+          inverse_jacobians[q] = transpose(invert(jac));
+        }
+    }
+
+
+
+    namespace internal
+    {
+      // computes the points on the unit cell corresponding to the
+      // quadrature points of a face as seen from one of the two adjacent
+      // cells. The points are enumerated in the order of the quadrature
+      // points on the interior side of the face, so we need to take the
+      // orientation and the subface index of the face into account.
+      template <int dim>
+      std::vector<Point<dim> >
+      get_face_points_on_cell (const Quadrature<1> &quad_1d,
+                               const unsigned int   face_no,
+                               const unsigned int   subface_index,
+                               const unsigned int   orientation)
+      {
+        const unsigned int n_q_points_1d = quad_1d.size();
+        const unsigned int n_q_points =
+          dim > 1 ? Utilities::fixed_power<dim-1>(n_q_points_1d) : 1;
+        const unsigned int normal = face_no/2;
+        unsigned int tangential[2] = {0, 0};
+        for (unsigned int d=0, k=0; d<dim; ++d)
+          if (d != normal)
+            tangential[k++] = d;
+
+        std::vector<Point<dim> > points (n_q_points);
+        for (unsigned int q=0; q<n_q_points; ++q)
+          {
+            const unsigned int index[2] = {q%n_q_points_1d, q/n_q_points_1d};
+            points[q][normal] = face_no%2;
+            for (unsigned int k=0; k+1<dim; ++k)
+              {
+                unsigned int i = index[(orientation & 1) ? 1-k : k];
+                if (orientation & (2U<<k))
+                  i = n_q_points_1d-1-i;
+                const unsigned int half = (k==0 ? subface_index :
+                                           subface_index/3) % 3;
+                points[q][tangential[k]] = half == 0 ? quad_1d.point(i)[0] :
+                                           0.5*(half-1) + 0.5*quad_1d.point(i)[0];
+              }
+          }
+        return points;
+      }
+    }
+
+
+
+    template <int dim, typename Number>
+    void
+    MappingInfo<dim,Number>::initialize_faces
+    (const dealii::Triangulation<dim>                         &tria,
+     const std::vector<std::pair<unsigned int,unsigned int> > &cells,
+     const std::vector<FaceToCellTopology<VectorizedArray<Number>::n_array_elements> > &faces,
+     const Mapping<dim>                                       &mapping,
+     const std::vector<dealii::hp::QCollection<1> >           &quad,
+     const UpdateFlags                                         update_flags)
+    {
+      face_data.clear();
+      face_data.resize (quad.size());
+
+      FE_Nothing<dim> dummy_fe;
+      const UpdateFlags update_flags_feval = update_jacobians |
+                                             update_inverse_jacobians |
+                                             (update_flags & update_quadrature_points);
+
+      // inner faces are stored before the boundary faces, so the inner faces
+      // are the ones at the beginning of the list with a valid exterior cell
+      unsigned int n_inner_faces = 0;
+      while (n_inner_faces < faces.size() &&
+             faces[n_inner_faces].cells_exterior[0] != numbers::invalid_unsigned_int)
+        ++n_inner_faces;
+
+      for (unsigned int my_q=0; my_q<quad.size(); ++my_q)
+        {
+          const Quadrature<1> &quad_1d = quad[my_q][0];
+          const unsigned int n_q_points_1d = quad_1d.size();
+          const unsigned int n_q_points =
+            dim > 1 ? Utilities::fixed_power<dim-1>(n_q_points_1d) : 1;
+
+          FaceMappingInfo &data = face_data[my_q];
+          data.n_q_points = n_q_points;
+          data.JxW_values.resize (faces.size()*n_q_points);
+          data.normal_vectors.resize (faces.size()*n_q_points);
+          data.jacobians[0].resize (faces.size()*n_q_points);
+          data.jacobians[1].resize (n_inner_faces*n_q_points);
+          if (update_flags & update_quadrature_points)
+            data.quadrature_points.resize (faces.size()*n_q_points);
+
+          std::vector<double> weights (n_q_points, 1.);
+          for (unsigned int q=0; q<n_q_points; ++q)
+            {
+              if (dim > 1)
+                weights[q] *= quad_1d.weight(q%n_q_points_1d);
+              if (dim > 2)
+                weights[q] *= quad_1d.weight(q/n_q_points_1d);
+            }
+
+          bool quadrature_is_symmetric = true;
+          for (unsigned int i=0; i<n_q_points_1d; ++i)
+            if (std::abs(quad_1d.point(i)[0] + quad_1d.point(n_q_points_1d-1-i)[0]
+                         - 1.) > 1e-12)
+              quadrature_is_symmetric = false;
+
+          // the FEValues objects for evaluating the mapping on the points
+          // of the faces, one per combination of face number, subface index
+          // and orientation that appears in the mesh
+          std::map<unsigned int, std_cxx11::shared_ptr<dealii::FEValues<dim> > >
+          fe_values;
+
+          for (unsigned int face=0; face<faces.size(); ++face)
+            {
+              const FaceToCellTopology<n_vector_elements> &face_topology = faces[face];
+              const unsigned int n_sides = face < n_inner_faces ? 2 : 1;
+              for (unsigned int side=0; side<n_sides; ++side)
+                {
+                  const unsigned int face_no = side == 0 ?
+                                               face_topology.interior_face_no :
+                                               face_topology.exterior_face_no;
+                  const unsigned int subface_index = side == 0 ? 0 :
+                                                     face_topology.subface_index;
+                  const unsigned int orientation = side == 0 ? 0 :
+                                                   face_topology.face_orientation;
+                  Assert (orientation < 2 || quadrature_is_symmetric,
+                          ExcMessage ("Face integrals on faces with flipped "
+                                      "orientation require symmetric 1D "
+                                      "quadrature formulas."));
+                  const unsigned int key = face_no + (subface_index << 3) +
+                                           (orientation << 7) + (side << 10);
+                  std_cxx11::shared_ptr<dealii::FEValues<dim> > &fe_val_ptr =
+                    fe_values[key];
+                  if (fe_val_ptr.get() == 0)
+                    fe_val_ptr.reset
+                    (new dealii::FEValues<dim> (mapping, dummy_fe,
+                                                Quadrature<dim>(internal::get_face_points_on_cell<dim>
+                                                                (quad_1d, face_no,
+                                                                 subface_index,
+                                                                 orientation)),
+                                                update_flags_feval));
+                  dealii::FEValues<dim> &fe_val = *fe_val_ptr;
+
+                  for (unsigned int v=0; v<n_vector_elements; ++v)
+                    {
+                      // unused lanes are filled with the data of the first
+                      // face in the batch to avoid invalid numbers
+                      const unsigned int lane =
+                        face_topology.cells_interior[v] == numbers::invalid_unsigned_int ? 0 : v;
+                      const unsigned int cell_index = side == 0 ?
+                                                      face_topology.cells_interior[lane] :
+                                                      face_topology.cells_exterior[lane];
+                      typename dealii::Triangulation<dim>::cell_iterator
+                      cell_it (&tria, cells[cell_index].first, cells[cell_index].second);
+                      fe_val.reinit (cell_it);
+
+                      for (unsigned int q=0; q<n_q_points; ++q)
+                        {
+                          const unsigned int index = face*n_q_points+q;
+                          const DerivativeForm<1,dim,dim> &inv_jac =
+                            fe_val.inverse_jacobian(q);
+                          for (unsigned int d=0; d<dim; ++d)
+                            for (unsigned int e=0; e<dim; ++e)
+                              data.jacobians[side][index][d][e][v] = inv_jac[e][d];
+                          if (side == 1)
+                            continue;
+
+                          // the normal vector is the direction of the
+                          // transformed normal of the reference face
+                          Tensor<1,dim> normal;
+                          for (unsigned int d=0; d<dim; ++d)
+                            normal[d] = inv_jac[face_no/2][d];
+                          const double normal_norm = normal.norm();
+                          const double sign = face_no%2 ? 1. : -1.;
+                          for (unsigned int d=0; d<dim; ++d)
+                            data.normal_vectors[index][d][v] =
+                              sign * normal[d] / normal_norm;
+                          data.JxW_values[index][v] = weights[q] * normal_norm *
+                                                      fe_val.jacobian(q).determinant();
+                          if (update_flags & update_quadrature_points)
+                            for (unsigned int d=0; d<dim; ++d)
+                              data.quadrature_points[index][d][v] =
+                                fe_val.quadrature_point(q)[d];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+
+
     template<int dim, typename Number>
     void
     MappingInfo<dim,Number>::evaluate_on_cell (const dealii::Triangulation<dim> &tria,
@@ -833,6 +1243,8 @@ namespace internal
       memory += MemoryConsumption::memory_consumption (quadrature);
       memory += MemoryConsumption::memory_consumption (face_quadrature);
       memory += MemoryConsumption::memory_consumption (quadrature_weights);
+      memory += MemoryConsumption::memory_consumption (mapping_shape_values);
+      memory += MemoryConsumption::memory_consumption (mapping_shape_gradients);
       memory += MemoryConsumption::memory_consumption (n_q_points);
       memory += MemoryConsumption::memory_consumption (n_q_points_face);
       memory += MemoryConsumption::memory_consumption (quad_index_conversion);
@@ -841,13 +1253,37 @@ namespace internal
 
 
 
+    template <int dim, typename Number>
+    MappingInfo<dim,Number>::FaceMappingInfo::FaceMappingInfo ()
+      :
+      n_q_points (0)
+    {}
+
+
+
+    template <int dim, typename Number>
+    std::size_t MappingInfo<dim,Number>::FaceMappingInfo::memory_consumption() const
+    {
+      std::size_t
+      memory = MemoryConsumption::memory_consumption (JxW_values);
+      memory += MemoryConsumption::memory_consumption (normal_vectors);
+      memory += MemoryConsumption::memory_consumption (jacobians[0]);
+      memory += MemoryConsumption::memory_consumption (jacobians[1]);
+      memory += MemoryConsumption::memory_consumption (quadrature_points);
+      return memory;
+    }
+
+
+
     template <int dim, typename Number>
     std::size_t MappingInfo<dim,Number>::memory_consumption() const
     {
       std::size_t
       memory= MemoryConsumption::memory_consumption (mapping_data_gen);
+      memory += MemoryConsumption::memory_consumption (face_data);
       memory += MemoryConsumption::memory_consumption (affine_data);
       memory += MemoryConsumption::memory_consumption (cartesian_data);
+      memory += MemoryConsumption::memory_consumption (mapping_support_points);
       memory += MemoryConsumption::memory_consumption (cell_type);
       memory += sizeof (*this);
       return memory;
@@ -912,6 +1348,12 @@ namespace internal
       size_info.print_memory_statistics
       (out, MemoryConsumption::memory_consumption (affine_data) +
        MemoryConsumption::memory_consumption (cartesian_data));
+      if (jacobians_on_the_fly)
+        {
+          out << "    Memory mapping support points:   ";
+          size_info.print_memory_statistics
+          (out, MemoryConsumption::memory_consumption (mapping_support_points));
+        }
       for (unsigned int j=0; j<mapping_data_gen.size(); ++j)
         {
           out << "    Data component " << j << std::endl;
@@ -36,6 +36,7 @@
 #include <deal.II/matrix_free/shape_info.h>
 #include <deal.II/matrix_free/dof_info.h>
 #include <deal.II/matrix_free/mapping_info.h>
+#include <deal.II/matrix_free/face_info.h>
 
 #ifdef DEAL_II_WITH_THREADS
 #include <tbb/task.h>
@@ -156,6 +157,9 @@ public:
       tasks_parallel_scheme (tasks_parallel_scheme),
       tasks_block_size      (tasks_block_size),
       mapping_update_flags  (mapping_update_flags),
+      mapping_update_flags_boundary_faces (update_default),
+      mapping_update_flags_inner_faces (update_default),
+      compute_jacobians_on_the_fly (false),
       level_mg_handler      (level_mg_handler),
       store_plain_indices   (store_plain_indices),
       initialize_indices    (initialize_indices),
@@ -224,6 +228,48 @@ public:
      */
     UpdateFlags         mapping_update_flags;
 
+    /**
+     * This flag determines the mapping data on boundary faces to be cached.
+     * If set to a value different from update_default, the boundary faces
+     * are collected into batches and the geometry data on them is computed,
+     * which is needed for evaluating boundary integrals with FEFaceEvaluation
+     * inside MatrixFree::loop(). The geometry data always includes the
+     * normal vectors, the area element JxW and the inverse Jacobian of the
+     * adjacent cell. Quadrature points are only cached if
+     * update_quadrature_points is set. Defaults to update_default, i.e., no
+     * face data is set up.
+     */
+    UpdateFlags         mapping_update_flags_boundary_faces;
+
+    /**
+     * Same as @p mapping_update_flags_boundary_faces but for the faces in
+     * the interior of the domain, i.e., the faces between two cells.
+     */
+    UpdateFlags         mapping_update_flags_inner_faces;
+
+    /**
+     * Controls how the geometry of cells with non-constant Jacobian (curved
+     * cells or general quadrilaterals/hexahedra) is represented. By default,
+     * this flag is false and the inverse Jacobians and the JxW values are
+     * stored for each quadrature point of these cells, which is the fastest
+     * option when memory bandwidth is not a limitation. If set to true, only
+     * the support points of the mapping are stored for these cells and
+     * FEEvaluation computes the inverse Jacobians and JxW values in the
+     * quadrature points on the fly in FEEvaluationBase::reinit() by sum
+     * factorization. This reduces the memory transfer for the geometry from
+     * <tt>(dim*dim+1)*n_q_points</tt> to <tt>dim*(p+1)<sup>dim</sup></tt>
+     * numbers per cell, where @p p is the degree of the mapping, at the cost
+     * of additional arithmetic operations. This is beneficial for operators
+     * of high degree on curved meshes where the evaluation is limited by the
+     * memory bandwidth. Cartesian cells and cells with constant Jacobian are
+     * not affected by this option.
+     *
+     * This option requires the mapping to be of type MappingQGeneric or
+     * MappingQ and is not implemented for second derivatives
+     * (update_hessians).
+     */
+    bool                compute_jacobians_on_the_fly;
+
     /**
      * This option can be used to define whether we work on a certain level of
      * the mesh, and not the active cells. If set to invalid_unsigned_int
@@ -474,6 +520,181 @@ public:
                   OutVector      &dst,
                   const InVector &src) const;
 
+  /**
+   * Same as the first cell_loop() variant, but additionally runs the
+   * operations @p operation_before_loop and @p operation_after_loop on
+   * ranges of locally owned vector entries, given as half-open intervals
+   * <tt>[begin,end)</tt> in the MPI-local index space of the vectors
+   * described by the DoFHandler with index @p dof_handler_index_pre_post.
+   * The operation before the loop is run on a range of entries right before
+   * the first cell that accesses them, and the operation after the loop
+   * right after the last cell that accesses them. Entries that are not
+   * accessed by any cell are processed at the beginning and at the end of
+   * the loop, respectively, and entries that receive contributions from
+   * other MPI processes after the final data exchange of the loop.
+   *
+   * The typical use of these operations is to zero the destination vector
+   * before the cell operation writes into it (in place of a call to
+   * <tt>dst = 0</tt> ahead of the loop), and to apply vector updates such as
+   * the ones of a Chebyshev iteration or a diagonal scaling right after the
+   * operator application has finalized a range of entries. This way, the
+   * vector entries are still in cache when they are touched by the
+   * additional operations, which avoids separate sweeps through main
+   * memory.
+   *
+   * The operation before the loop must not modify the source vector @p src,
+   * since its ghost values are exchanged at the start of the loop. The
+   * operation after the loop may modify @p src, because all cells reading
+   * from a range of entries have been processed when it is called. Either
+   * operation may be an empty function object.
+   *
+   * When the loop is run in parallel with threads, the operations before
+   * and after the loop are applied to the whole locally owned range before
+   * and after the loop, respectively, without the interleaving.
+   */
+  template <typename OutVector, typename InVector>
+  void cell_loop (const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                                  OutVector &,
+                                                  const InVector &,
+                                                  const std::pair<unsigned int,
+                                                  unsigned int> &)> &cell_operation,
+                  OutVector      &dst,
+                  const InVector &src,
+                  const std_cxx11::function<void (const unsigned int,
+                                                  const unsigned int)> &operation_before_loop,
+                  const std_cxx11::function<void (const unsigned int,
+                                                  const unsigned int)> &operation_after_loop,
+                  const unsigned int dof_handler_index_pre_post = 0) const;
+
+  /**
+   * Same as above, but for class member functions of class @p CLASS that
+   * are const.
+   */
+  template <typename CLASS, typename OutVector, typename InVector>
+  void cell_loop (void (CLASS::*function_pointer)(const MatrixFree &,
+                                                  OutVector &,
+                                                  const InVector &,
+                                                  const std::pair<unsigned int,
+                                                  unsigned int> &)const,
+                  const CLASS    *owning_class,
+                  OutVector      &dst,
+                  const InVector &src,
+                  const std_cxx11::function<void (const unsigned int,
+                                                  const unsigned int)> &operation_before_loop,
+                  const std_cxx11::function<void (const unsigned int,
+                                                  const unsigned int)> &operation_after_loop,
+                  const unsigned int dof_handler_index_pre_post = 0) const;
+
+  /**
+   * Same as above, but for class member functions which are non-const.
+   */
+  template <typename CLASS, typename OutVector, typename InVector>
+  void cell_loop (void (CLASS::*function_pointer)(const MatrixFree &,
+                                                  OutVector &,
+                                                  const InVector &,
+                                                  const std::pair<unsigned int,
+                                                  unsigned int> &),
+                  CLASS          *owning_class,
+                  OutVector      &dst,
+                  const InVector &src,
+                  const std_cxx11::function<void (const unsigned int,
+                                                  const unsigned int)> &operation_before_loop,
+                  const std_cxx11::function<void (const unsigned int,
+                                                  const unsigned int)> &operation_after_loop,
+                  const unsigned int dof_handler_index_pre_post = 0) const;
+
+  /**
+   * This method runs a loop over all cells, all inner faces and all
+   * boundary faces (in parallel) and performs the MPI data exchange on the
+   * source vector and destination vector. The first argument is the
+   * operation on a range of cells like in cell_loop(), the second argument
+   * is the operation on a range of inner face batches and the third
+   * argument the operation on a range of boundary face batches, all with
+   * the same signature. The face ranges are given in the numbering of face
+   * batches that FEFaceEvaluation::reinit() expects, with the inner faces
+   * in the range <tt>[0,n_inner_face_batches())</tt> and the boundary
+   * faces in the range <tt>[n_inner_face_batches(), n_inner_face_batches()
+   * + n_boundary_face_batches())</tt>.
+   *
+   * The faces must have been set up by specifying
+   * AdditionalData::mapping_update_flags_inner_faces and
+   * AdditionalData::mapping_update_flags_boundary_faces, respectively. If
+   * task parallelism is enabled, the face batches are worked on by color,
+   * such that no two batches that are run concurrently write into the same
+   * vector entries. All face batches are completed before the cells are
+   * worked on: the integrals of a face and of its two adjacent cells write
+   * into the same entries of @p dst, and the partitioning of the cells for
+   * the task-parallel cell_loop() does not take the faces into account, so
+   * cell and face work is not interleaved. Face integrals are currently only supported for the
+   * DoFHandler case (not hp::DoFHandler) and for faces between cells owned
+   * by the current processor.
+   */
+  template <typename OutVector, typename InVector>
+  void loop (const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                             OutVector &,
+                                             const InVector &,
+                                             const std::pair<unsigned int,
+                                             unsigned int> &)> &cell_operation,
+             const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                             OutVector &,
+                                             const InVector &,
+                                             const std::pair<unsigned int,
+                                             unsigned int> &)> &face_operation,
+             const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                             OutVector &,
+                                             const InVector &,
+                                             const std::pair<unsigned int,
+                                             unsigned int> &)> &boundary_operation,
+             OutVector      &dst,
+             const InVector &src) const;
+
+  /**
+   * Same as above, but for class member functions of class @p CLASS that
+   * are const, in analogy to the respective cell_loop() variant.
+   */
+  template <typename CLASS, typename OutVector, typename InVector>
+  void loop (void (CLASS::*cell_operation)(const MatrixFree &,
+                                           OutVector &,
+                                           const InVector &,
+                                           const std::pair<unsigned int,
+                                           unsigned int> &)const,
+             void (CLASS::*face_operation)(const MatrixFree &,
+                                           OutVector &,
+                                           const InVector &,
+                                           const std::pair<unsigned int,
+                                           unsigned int> &)const,
+             void (CLASS::*boundary_operation)(const MatrixFree &,
+                                               OutVector &,
+                                               const InVector &,
+                                               const std::pair<unsigned int,
+                                               unsigned int> &)const,
+             const CLASS    *owning_class,
+             OutVector      &dst,
+             const InVector &src) const;
+
+  /**
+   * Same as above, but for class member functions which are non-const.
+   */
+  template <typename CLASS, typename OutVector, typename InVector>
+  void loop (void (CLASS::*cell_operation)(const MatrixFree &,
+                                           OutVector &,
+                                           const InVector &,
+                                           const std::pair<unsigned int,
+                                           unsigned int> &),
+             void (CLASS::*face_operation)(const MatrixFree &,
+                                           OutVector &,
+                                           const InVector &,
+                                           const std::pair<unsigned int,
+                                           unsigned int> &),
+             void (CLASS::*boundary_operation)(const MatrixFree &,
+                                               OutVector &,
+                                               const InVector &,
+                                               const std::pair<unsigned int,
+                                               unsigned int> &),
+             CLASS          *owning_class,
+             OutVector      &dst,
+             const InVector &src) const;
+
   /**
    * In the hp adaptive case, a subrange of cells as computed during the cell
    * loop might contain elements of different degrees. Use this function to
@@ -604,6 +825,27 @@ public:
    */
   unsigned int n_macro_cells () const;
 
+  /**
+   * Returns the number of batches of inner faces that have been set up for
+   * face integrals, see AdditionalData::mapping_update_flags_inner_faces.
+   */
+  unsigned int n_inner_face_batches () const;
+
+  /**
+   * Returns the number of batches of boundary faces that have been set up
+   * for face integrals, see
+   * AdditionalData::mapping_update_flags_boundary_faces.
+   */
+  unsigned int n_boundary_face_batches () const;
+
+  /**
+   * Returns the boundary id of the faces in the given face batch, which
+   * must be a boundary face batch, i.e., lie in the range
+   * <tt>[n_inner_face_batches(), n_inner_face_batches() +
+   * n_boundary_face_batches())</tt>.
+   */
+  types::boundary_id get_boundary_id (const unsigned int face_batch) const;
+
   /**
    * In case this structure was built based on a DoFHandler, this returns the
    * DoFHandler.
@@ -772,6 +1014,12 @@ public:
   const internal::MatrixFreeFunctions::DoFInfo &
   get_dof_info (const unsigned int fe_component = 0) const;
 
+  /**
+   * Returns the connectivity of the given face batch to the adjacent cells.
+   */
+  const internal::MatrixFreeFunctions::FaceToCellTopology<VectorizedArray<Number>::n_array_elements> &
+  get_face_info (const unsigned int face_batch) const;
+
   /**
    * Returns the number of weights in the constraint pool.
    */
@@ -918,6 +1166,20 @@ private:
    */
   internal::MatrixFreeFunctions::TaskInfo task_info;
 
+  /**
+   * Describes the batches of faces for face integrals.
+   */
+  internal::MatrixFreeFunctions::FaceInfo<VectorizedArray<Number>::n_array_elements> face_info;
+
+  /**
+   * The subdivision of the macro cells into blocks for the variant of
+   * cell_loop() with operations on vector entries before and after the
+   * loop. Block @p b is given by the range <tt>[cell_loop_blocks[b],
+   * cell_loop_blocks[b+1])</tt>. The blocks do not straddle the boundaries
+   * between cells with and without ghost entries given by @p size_info.
+   */
+  std::vector<unsigned int> cell_loop_blocks;
+
   /**
    * Stores whether indices have been initialized.
    */
@@ -1025,6 +1287,51 @@ MatrixFree<dim,Number>::n_macro_cells () const
 
 
 
+template <int dim, typename Number>
+inline
+unsigned int
+MatrixFree<dim,Number>::n_inner_face_batches () const
+{
+  return face_info.n_inner_face_batches;
+}
+
+
+
+template <int dim, typename Number>
+inline
+unsigned int
+MatrixFree<dim,Number>::n_boundary_face_batches () const
+{
+  return face_info.n_boundary_face_batches;
+}
+
+
+
+template <int dim, typename Number>
+inline
+types::boundary_id
+MatrixFree<dim,Number>::get_boundary_id (const unsigned int face_batch) const
+{
+  Assert (face_batch >= face_info.n_inner_face_batches &&
+          face_batch < face_info.faces.size(),
+          ExcIndexRange (face_batch, face_info.n_inner_face_batches,
+                         face_info.faces.size()));
+  return face_info.faces[face_batch].boundary_id;
+}
+
+
+
+template <int dim, typename Number>
+inline
+const internal::MatrixFreeFunctions::FaceToCellTopology<VectorizedArray<Number>::n_array_elements> &
+MatrixFree<dim,Number>::get_face_info (const unsigned int face_batch) const
+{
+  AssertIndexRange (face_batch, face_info.faces.size());
+  return face_info.faces[face_batch];
+}
+
+
+
 template <int dim, typename Number>
 inline
 unsigned int
@@ -2194,6 +2501,45 @@ namespace internal
 
 #endif // DEAL_II_WITH_THREADS
 
+
+
+  // Worker for the loop over a range of face batches of the same color that
+  // binds away all arguments except the face range, for use with
+  // parallel::apply_to_subranges
+  template <typename MF, typename OutVector, typename InVector>
+  class FaceWorker
+  {
+  public:
+    typedef std_cxx11::function<void (const MF &,
+                                      OutVector &,
+                                      const InVector &,
+                                      const std::pair<unsigned int,
+                                      unsigned int> &)> FaceOperation;
+
+    FaceWorker (const FaceOperation &operation_in,
+                const MF            &matrix_free_in,
+                OutVector           &dst_in,
+                const InVector      &src_in)
+      :
+      operation (operation_in),
+      matrix_free (matrix_free_in),
+      dst (dst_in),
+      src (src_in)
+    {};
+
+    void operator() (const unsigned int begin,
+                     const unsigned int end) const
+    {
+      operation (matrix_free, dst, src, std::make_pair(begin, end));
+    }
+
+  private:
+    const FaceOperation &operation;
+    const MF            &matrix_free;
+    OutVector           &dst;
+    const InVector      &src;
+  };
+
 } // end of namespace internal
 
 
@@ -2542,6 +2888,327 @@ MatrixFree<dim,Number>::cell_loop
 }
 
 
+template <int dim, typename Number>
+template <typename OutVector, typename InVector>
+inline
+void
+MatrixFree<dim, Number>::cell_loop
+(const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                 OutVector &,
+                                 const InVector &,
+                                 const std::pair<unsigned int,
+                                 unsigned int> &)> &cell_operation,
+ OutVector       &dst,
+ const InVector  &src,
+ const std_cxx11::function<void (const unsigned int,
+                                 const unsigned int)> &operation_before_loop,
+ const std_cxx11::function<void (const unsigned int,
+                                 const unsigned int)> &operation_after_loop,
+ const unsigned int dof_handler_index_pre_post) const
+{
+  AssertIndexRange (dof_handler_index_pre_post, dof_info.size());
+  const internal::MatrixFreeFunctions::DoFInfo &info =
+    dof_info[dof_handler_index_pre_post];
+
+  // with threads, the cells are not worked on in the order of the blocks,
+  // so we cannot interleave the vector operations with the cell operations
+  if (task_info.use_multithreading == true)
+    {
+      const unsigned int n_owned = info.vector_partitioner->local_size();
+      if (operation_before_loop)
+        operation_before_loop (0, n_owned);
+      cell_loop (cell_operation, dst, src);
+      if (operation_after_loop)
+        operation_after_loop (0, n_owned);
+      return;
+    }
+
+  Assert (cell_loop_blocks.size() > 0 &&
+          info.cell_loop_post_list_index.size() == cell_loop_blocks.size()+1,
+          ExcNotInitialized());
+  const unsigned int n_blocks = cell_loop_blocks.size()-1;
+
+  bool ghosts_were_not_set = internal::update_ghost_values_start (src);
+  bool ghosts_are_imported = false, compress_is_started = false;
+
+  // walk through the blocks of cells in order. Before a block, run the
+  // operation before the loop on the vector entries that are accessed first
+  // by this block, and afterwards the operation after the loop on the
+  // entries that are accessed for the last time. The data exchange is
+  // placed around the cells with ghosts like in the serial variant of the
+  // other cell_loop
+  if (n_blocks == 0 && operation_before_loop)
+    for (unsigned int i=info.cell_loop_pre_list_index[0];
+         i<info.cell_loop_pre_list_index[1]; ++i)
+      operation_before_loop (info.cell_loop_pre_list[i].first,
+                             info.cell_loop_pre_list[i].second);
+  for (unsigned int block=0; block<n_blocks; ++block)
+    {
+      const std::pair<unsigned int,unsigned int>
+      cell_range (cell_loop_blocks[block], cell_loop_blocks[block+1]);
+
+      if (operation_before_loop)
+        for (unsigned int i=info.cell_loop_pre_list_index[block];
+             i<info.cell_loop_pre_list_index[block+1]; ++i)
+          operation_before_loop (info.cell_loop_pre_list[i].first,
+                                 info.cell_loop_pre_list[i].second);
+
+      if (ghosts_are_imported == false &&
+          cell_range.first >= size_info.boundary_cells_start)
+        {
+          internal::update_ghost_values_finish(src);
+          ghosts_are_imported = true;
+        }
+
+      cell_operation (*this, dst, src, cell_range);
+
+      if (compress_is_started == false &&
+          cell_range.second >= size_info.boundary_cells_end)
+        {
+          internal::compress_start(dst);
+          compress_is_started = true;
+        }
+
+      if (operation_after_loop)
+        for (unsigned int i=info.cell_loop_post_list_index[block];
+             i<info.cell_loop_post_list_index[block+1]; ++i)
+          operation_after_loop (info.cell_loop_post_list[i].first,
+                                info.cell_loop_post_list[i].second);
+    }
+
+  if (ghosts_are_imported == false)
+    internal::update_ghost_values_finish(src);
+  if (compress_is_started == false)
+    internal::compress_start(dst);
+  internal::compress_finish(dst);
+
+  // the remaining entries are the ones not accessed by any cell and the
+  // ones that receive contributions from other processors
+  if (operation_after_loop)
+    for (unsigned int i=info.cell_loop_post_list_index[n_blocks];
+         i<info.cell_loop_post_list_index[n_blocks+1]; ++i)
+      operation_after_loop (info.cell_loop_post_list[i].first,
+                            info.cell_loop_post_list[i].second);
+
+  internal::reset_ghost_values(src, ghosts_were_not_set);
+}
+
+
+
+template <int dim, typename Number>
+template <typename CLASS, typename OutVector, typename InVector>
+inline
+void
+MatrixFree<dim,Number>::cell_loop
+(void (CLASS::*function_pointer)(const MatrixFree<dim,Number> &,
+                                 OutVector &,
+                                 const InVector &,
+                                 const std::pair<unsigned int,
+                                 unsigned int> &)const,
+ const CLASS    *owning_class,
+ OutVector      &dst,
+ const InVector &src,
+ const std_cxx11::function<void (const unsigned int,
+                                 const unsigned int)> &operation_before_loop,
+ const std_cxx11::function<void (const unsigned int,
+                                 const unsigned int)> &operation_after_loop,
+ const unsigned int dof_handler_index_pre_post) const
+{
+  std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                            OutVector &,
+                            const InVector &,
+                            const std::pair<unsigned int,
+                            unsigned int> &)>
+  function = std_cxx11::bind<void>(function_pointer,
+                                   owning_class,
+                                   std_cxx11::_1,
+                                   std_cxx11::_2,
+                                   std_cxx11::_3,
+                                   std_cxx11::_4);
+  cell_loop (function, dst, src, operation_before_loop, operation_after_loop,
+             dof_handler_index_pre_post);
+}
+
+
+
+template <int dim, typename Number>
+template <typename CLASS, typename OutVector, typename InVector>
+inline
+void
+MatrixFree<dim,Number>::cell_loop
+(void(CLASS::*function_pointer)(const MatrixFree<dim,Number> &,
+                                OutVector &,
+                                const InVector &,
+                                const std::pair<unsigned int,
+                                unsigned int> &),
+ CLASS          *owning_class,
+ OutVector      &dst,
+ const InVector &src,
+ const std_cxx11::function<void (const unsigned int,
+                                 const unsigned int)> &operation_before_loop,
+ const std_cxx11::function<void (const unsigned int,
+                                 const unsigned int)> &operation_after_loop,
+ const unsigned int dof_handler_index_pre_post) const
+{
+  std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                            OutVector &,
+                            const InVector &,
+                            const std::pair<unsigned int,
+                            unsigned int> &)>
+  function = std_cxx11::bind<void>(function_pointer,
+                                   owning_class,
+                                   std_cxx11::_1,
+                                   std_cxx11::_2,
+                                   std_cxx11::_3,
+                                   std_cxx11::_4);
+  cell_loop (function, dst, src, operation_before_loop, operation_after_loop,
+             dof_handler_index_pre_post);
+}
+
+
+
+template <int dim, typename Number>
+template <typename OutVector, typename InVector>
+inline
+void
+MatrixFree<dim, Number>::loop
+(const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                 OutVector &,
+                                 const InVector &,
+                                 const std::pair<unsigned int,
+                                 unsigned int> &)> &cell_operation,
+ const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                 OutVector &,
+                                 const InVector &,
+                                 const std::pair<unsigned int,
+                                 unsigned int> &)> &face_operation,
+ const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                 OutVector &,
+                                 const InVector &,
+                                 const std::pair<unsigned int,
+                                 unsigned int> &)> &boundary_operation,
+ OutVector       &dst,
+ const InVector  &src) const
+{
+  // the face integrals need the ghost values on the source vector, so
+  // import them completely before starting with the faces
+  bool ghosts_were_not_set = internal::update_ghost_values_start (src);
+  internal::update_ghost_values_finish (src);
+
+  // work on the face batches color by color. Within a color, the face
+  // batches do not write into the same vector entries, so they can be
+  // worked on in parallel. The inner faces come first, the boundary faces
+  // afterwards
+  for (unsigned int color=0; color+1<face_info.color_starts.size(); ++color)
+    {
+      const unsigned int begin = face_info.color_starts[color];
+      const unsigned int end = face_info.color_starts[color+1];
+      if (begin == end)
+        continue;
+      internal::FaceWorker<MatrixFree<dim,Number>,OutVector,InVector>
+      worker (color < face_info.n_inner_face_colors ? face_operation :
+              boundary_operation, *this, dst, src);
+      if (task_info.use_multithreading == true)
+        parallel::apply_to_subranges (begin, end, worker, 1);
+      else
+        worker (begin, end);
+    }
+
+  // the cell loop adds the cell contributions and sends the contributions
+  // to ghost entries of dst (including the ones from the faces) to their
+  // owners
+  cell_loop (cell_operation, dst, src);
+
+  internal::reset_ghost_values(src, ghosts_were_not_set);
+}
+
+
+
+template <int dim, typename Number>
+template <typename CLASS, typename OutVector, typename InVector>
+inline
+void
+MatrixFree<dim,Number>::loop
+(void (CLASS::*cell_operation)(const MatrixFree<dim,Number> &,
+                               OutVector &,
+                               const InVector &,
+                               const std::pair<unsigned int,
+                               unsigned int> &)const,
+ void (CLASS::*face_operation)(const MatrixFree<dim,Number> &,
+                               OutVector &,
+                               const InVector &,
+                               const std::pair<unsigned int,
+                               unsigned int> &)const,
+ void (CLASS::*boundary_operation)(const MatrixFree<dim,Number> &,
+                                   OutVector &,
+                                   const InVector &,
+                                   const std::pair<unsigned int,
+                                   unsigned int> &)const,
+ const CLASS    *owning_class,
+ OutVector      &dst,
+ const InVector &src) const
+{
+  typedef std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                    OutVector &,
+                                    const InVector &,
+                                    const std::pair<unsigned int,
+                                    unsigned int> &)> Operation;
+  const Operation cell_function =
+    std_cxx11::bind<void>(cell_operation, owning_class, std_cxx11::_1,
+                          std_cxx11::_2, std_cxx11::_3, std_cxx11::_4);
+  const Operation face_function =
+    std_cxx11::bind<void>(face_operation, owning_class, std_cxx11::_1,
+                          std_cxx11::_2, std_cxx11::_3, std_cxx11::_4);
+  const Operation boundary_function =
+    std_cxx11::bind<void>(boundary_operation, owning_class, std_cxx11::_1,
+                          std_cxx11::_2, std_cxx11::_3, std_cxx11::_4);
+  loop (cell_function, face_function, boundary_function, dst, src);
+}
+
+
+
+template <int dim, typename Number>
+template <typename CLASS, typename OutVector, typename InVector>
+inline
+void
+MatrixFree<dim,Number>::loop
+(void (CLASS::*cell_operation)(const MatrixFree<dim,Number> &,
+                               OutVector &,
+                               const InVector &,
+                               const std::pair<unsigned int,
+                               unsigned int> &),
+ void (CLASS::*face_operation)(const MatrixFree<dim,Number> &,
+                               OutVector &,
+                               const InVector &,
+                               const std::pair<unsigned int,
+                               unsigned int> &),
+ void (CLASS::*boundary_operation)(const MatrixFree<dim,Number> &,
+                                   OutVector &,
+                                   const InVector &,
+                                   const std::pair<unsigned int,
+                                   unsigned int> &),
+ CLASS          *owning_class,
+ OutVector      &dst,
+ const InVector &src) const
+{
+  typedef std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                    OutVector &,
+                                    const InVector &,
+                                    const std::pair<unsigned int,
+                                    unsigned int> &)> Operation;
+  const Operation cell_function =
+    std_cxx11::bind<void>(cell_operation, owning_class, std_cxx11::_1,
+                          std_cxx11::_2, std_cxx11::_3, std_cxx11::_4);
+  const Operation face_function =
+    std_cxx11::bind<void>(face_operation, owning_class, std_cxx11::_1,
+                          std_cxx11::_2, std_cxx11::_3, std_cxx11::_4);
+  const Operation boundary_function =
+    std_cxx11::bind<void>(boundary_operation, owning_class, std_cxx11::_1,
+                          std_cxx11::_2, std_cxx11::_3, std_cxx11::_4);
+  loop (cell_function, face_function, boundary_function, dst, src);
+}
+
+
 #endif  // ifndef DOXYGEN
 
 
@@ -28,6 +28,7 @@
 #include <deal.II/matrix_free/shape_info.templates.h>
 #include <deal.II/matrix_free/mapping_info.templates.h>
 #include <deal.II/matrix_free/dof_info.templates.h>
+#include <deal.II/matrix_free/face_info.templates.h>
 
 
 DEAL_II_NAMESPACE_OPEN
@@ -63,6 +64,8 @@ copy_from (const MatrixFree<dim,Number> &v)
   shape_info = v.shape_info;
   cell_level_index = v.cell_level_index;
   task_info = v.task_info;
+  face_info = v.face_info;
+  cell_loop_blocks = v.cell_loop_blocks;
   size_info = v.size_info;
   indices_are_initialized = v.indices_are_initialized;
   mapping_is_initialized  = v.mapping_is_initialized;
@@ -211,11 +214,28 @@ internal_reinit(const Mapping<dim>                          &mapping,
   // that the active FE index for the transformations is given the active FE
   // index in the zeroth DoFHandler. TODO: how do things look like in the more
   // general case?
+  const bool build_inner_faces =
+    additional_data.mapping_update_flags_inner_faces != update_default;
+  const bool build_boundary_faces =
+    additional_data.mapping_update_flags_boundary_faces != update_default;
+  if (additional_data.initialize_indices == true &&
+      (build_inner_faces || build_boundary_faces))
+    face_info.initialize (dof_handler[0]->get_triangulation(), cell_level_index,
+                          additional_data.level_mg_handler, build_inner_faces,
+                          build_boundary_faces, task_info.use_multithreading);
+
   if (additional_data.initialize_mapping == true)
     {
       mapping_info.initialize (dof_handler[0]->get_triangulation(), cell_level_index,
                                dof_info[0].cell_active_fe_index, mapping, quad,
-                               additional_data.mapping_update_flags);
+                               additional_data.mapping_update_flags,
+                               additional_data.compute_jacobians_on_the_fly);
+      if (build_inner_faces || build_boundary_faces)
+        mapping_info.initialize_faces (dof_handler[0]->get_triangulation(),
+                                       cell_level_index, face_info.faces, mapping,
+                                       quad,
+                                       additional_data.mapping_update_flags_inner_faces |
+                                       additional_data.mapping_update_flags_boundary_faces);
 
       mapping_is_initialized = true;
     }
@@ -339,11 +359,15 @@ internal_reinit(const Mapping<dim>                            &mapping,
   // Evaluates transformations from unit to real cell, Jacobian determinants,
   // quadrature points in real space, based on the ordering of the cells
   // determined in @p extract_local_to_global_indices.
+  Assert (additional_data.mapping_update_flags_inner_faces == update_default &&
+          additional_data.mapping_update_flags_boundary_faces == update_default,
+          ExcNotImplemented());
   if (additional_data.initialize_mapping == true)
     {
       mapping_info.initialize (dof_handler[0]->get_triangulation(), cell_level_index,
                                dof_info[0].cell_active_fe_index, mapping, quad,
-                               additional_data.mapping_update_flags);
+                               additional_data.mapping_update_flags,
+                               additional_data.compute_jacobians_on_the_fly);
 
       mapping_is_initialized = true;
     }
@@ -735,6 +759,28 @@ void MatrixFree<dim,Number>::initialize_indices
                                constraint_pool_row_index,
                                irregular_cells, vectorization_length);
 
+  // subdivide the cells into blocks for running operations on vector
+  // entries interleaved with the cell loop. If no block size is set, choose
+  // it such that a block touches a few thousand vector entries, which keeps
+  // the data of a block in the cache
+  {
+    unsigned int block_size = task_info.block_size;
+    if (block_size == 0)
+      block_size = std::max(1U, 2048U / (dof_info[0].dofs_per_cell[0] *
+                                         vectorization_length + 1));
+    const unsigned int boundaries[3] = {size_info.boundary_cells_start,
+                                        size_info.boundary_cells_end,
+                                        size_info.n_macro_cells
+                                       };
+    cell_loop_blocks.resize(1, 0);
+    for (unsigned int part=0; part<3; ++part)
+      while (cell_loop_blocks.back() < boundaries[part])
+        cell_loop_blocks.push_back(std::min(cell_loop_blocks.back()+block_size,
+                                            boundaries[part]));
+  }
+  for (unsigned int no=0; no<n_fe; ++no)
+    dof_info[no].compute_vector_access_ranges(cell_loop_blocks);
+
   indices_are_initialized = true;
 }
 
@@ -748,6 +794,8 @@ void MatrixFree<dim,Number>::clear()
   cell_level_index.clear();
   size_info.clear();
   task_info.clear();
+  face_info.clear();
+  cell_loop_blocks.clear();
   dof_handlers.dof_handler.clear();
   dof_handlers.hp_dof_handler.clear();
   indices_are_initialized = false;
@@ -765,6 +813,8 @@ std::size_t MatrixFree<dim,Number>::memory_consumption () const
   memory += MemoryConsumption::memory_consumption (constraint_pool_data);
   memory += MemoryConsumption::memory_consumption (constraint_pool_row_index);
   memory += MemoryConsumption::memory_consumption (task_info);
+  memory += face_info.memory_consumption();
+  memory += MemoryConsumption::memory_consumption (cell_loop_blocks);
   memory += sizeof(*this);
   memory += mapping_info.memory_consumption();
   return memory;
@@ -20,9 +20,13 @@
 
 #include <deal.II/base/exceptions.h>
 #include <deal.II/base/vectorization.h>
+#include <deal.II/lac/full_matrix.h>
 
 #include <deal.II/matrix_free/fe_evaluation.h>
 
+#include <algorithm>
+#include <vector>
+
 
 DEAL_II_NAMESPACE_OPEN
 
@@ -92,6 +96,101 @@ namespace MatrixFreeOperators
 
 
 
+  /**
+   * Computes the diagonal of a matrix-free operator given by the cell-local
+   * operation @p cell_operation and writes it into @p diagonal. The cell
+   * operation is handed an FEEvaluation object that has been initialized on
+   * a batch of cells and whose degrees of freedom, accessible through
+   * FEEvaluationBase::begin_dof_values(), contain a unit vector. It must
+   * overwrite the degrees of freedom by the result of the local operator,
+   * i.e., perform the same evaluate(), quadrature point, and integrate()
+   * steps as the cell loop of the operator, without reading from or writing
+   * into global vectors. A typical cell operation for the Laplacian reads
+   * @code
+   * template <int dim, int fe_degree>
+   * void local_laplace (FEEvaluation<dim,fe_degree> &phi)
+   * {
+   *   phi.evaluate (false, true);
+   *   for (unsigned int q=0; q<phi.n_q_points; ++q)
+   *     phi.submit_gradient (phi.get_gradient(q), q);
+   *   phi.integrate (false, true);
+   * }
+   * @endcode
+   * and the diagonal is computed by
+   * @code
+   * MatrixFreeOperators::compute_diagonal<FEEvaluation<dim,fe_degree> >
+   *   (matrix_free, diagonal, &local_laplace<dim,fe_degree>);
+   * @endcode
+   *
+   * The local operator is applied to all unit vectors on a cell, working on
+   * VectorizedArray<Number>::n_array_elements cells at once. The resulting
+   * cell matrices are combined with the constraints stored in MatrixFree
+   * (i.e., the hanging node constraints of the ConstraintMatrix passed to
+   * MatrixFree::reinit()), so the result equals the diagonal of the
+   * condensed matrix assembled through
+   * ConstraintMatrix::distribute_local_to_global() for all degrees of
+   * freedom that are not constrained. The entries of constrained degrees of
+   * freedom are left at zero, so the user should set them to some suitable
+   * value (e.g. one) before inverting the diagonal for use in
+   * PreconditionJacobi or PreconditionChebyshev.
+   *
+   * The vector @p diagonal must be initialized by
+   * MatrixFree::initialize_dof_vector() for the given @p fe_component. It is
+   * set to zero at the beginning of this function. In parallel, the
+   * contributions to ghost entries are sent to their owners by
+   * compress(VectorOperation::add). The cost of this function is
+   * proportional to the number of cell degrees of freedom times the cost of
+   * the cell operation, i.e., roughly that many operator evaluations, but
+   * no sparse matrix is ever formed.
+   *
+   * The FEEvaluation type must be given explicitly as template argument. For
+   * vector-valued elements, all components of the element need to be
+   * represented by FEEvaluationType.
+   */
+  template <typename FEEvaluationType, typename VectorType>
+  void
+  compute_diagonal (const MatrixFree<FEEvaluationType::dimension,
+                    typename FEEvaluationType::number_type>          &data,
+                    VectorType                                         &diagonal,
+                    const std_cxx11::function<void (FEEvaluationType &)> &cell_operation,
+                    const unsigned int                                  fe_component = 0,
+                    const unsigned int                                  quad_no = 0);
+
+  /**
+   * Computes the cell matrices of a matrix-free operator given by the
+   * cell-local operation @p cell_operation, e.g. for use in a cell-wise
+   * block-Jacobi preconditioner. The cell operation has the same meaning as
+   * in compute_diagonal().
+   *
+   * On exit, @p block_diagonal has size MatrixFree::n_macro_cells() times
+   * VectorizedArray<Number>::n_array_elements, where the matrix of lane @p v
+   * of macro cell @p cell is stored at position
+   * <tt>cell*VectorizedArray<Number>::n_array_elements+v</tt>. The matrices
+   * for lanes not filled by the last macro cells (see
+   * MatrixFree::n_components_filled()) are empty. The rows and columns of
+   * the matrices are numbered the same way as the degrees of freedom in
+   * FEEvaluationBase::begin_dof_values(), i.e., in the lexicographic order
+   * of the tensor product basis, first all degrees of freedom of the first
+   * component, then the second component, and so on. The matrices refer to
+   * the local degrees of freedom before the constraints are resolved: A
+   * block-Jacobi preconditioner would read the local vector by
+   * FEEvaluation::read_dof_values(), multiply it by the inverse of the cell
+   * matrix, and add the result into the global vector by
+   * FEEvaluation::distribute_local_to_global(), which applies the
+   * constraints. For discontinuous elements, these matrices are the exact
+   * diagonal blocks of the global matrix.
+   */
+  template <typename FEEvaluationType>
+  void
+  compute_block_diagonal (const MatrixFree<FEEvaluationType::dimension,
+                          typename FEEvaluationType::number_type>       &data,
+                          std::vector<FullMatrix<typename FEEvaluationType::number_type> > &block_diagonal,
+                          const std_cxx11::function<void (FEEvaluationType &)> &cell_operation,
+                          const unsigned int                              fe_component = 0,
+                          const unsigned int                              quad_no = 0);
+
+
+
   // ------------------------------------ inline functions ---------------------
 
   template <int dim, int fe_degree, int n_components, typename Number>
@@ -205,6 +304,223 @@ namespace MatrixFreeOperators
       }
   }
 
+  namespace internal
+  {
+    // Applies the cell operation to all unit vectors of the current batch of
+    // cells in phi and stores the resulting cell matrices column by column
+    // into local_matrix, i.e., entry (i,j) of the cell matrix is at position
+    // j*n_local_dofs+i.
+    template <typename FEEvaluationType>
+    void
+    compute_cell_matrix (FEEvaluationType                                  &phi,
+                         const std_cxx11::function<void (FEEvaluationType &)> &cell_operation,
+                         AlignedVector<VectorizedArray<typename FEEvaluationType::number_type> > &local_matrix)
+    {
+      typedef typename FEEvaluationType::number_type Number;
+      const unsigned int n_local_dofs =
+        phi.dofs_per_cell * FEEvaluationType::n_components;
+      local_matrix.resize_fast (n_local_dofs * n_local_dofs);
+      VectorizedArray<Number> *dof_values = phi.begin_dof_values();
+      for (unsigned int j=0; j<n_local_dofs; ++j)
+        {
+          for (unsigned int i=0; i<n_local_dofs; ++i)
+            dof_values[i] = VectorizedArray<Number>();
+          dof_values[j] = make_vectorized_array<Number> (1.);
+
+          cell_operation (phi);
+
+          for (unsigned int i=0; i<n_local_dofs; ++i)
+            local_matrix[j*n_local_dofs+i] = dof_values[i];
+        }
+    }
+
+
+
+    // Extracts the global (vector-local) indices and weights that make up the
+    // value of each local degree of freedom for all lanes of the given macro
+    // cell. The data is read from DoFInfo in the same way as in
+    // FEEvaluationBase::read_write_operation.
+    template <int dim, typename Number>
+    void
+    get_cell_constraints (const MatrixFree<dim,Number> &data,
+                          const unsigned int            fe_component,
+                          const unsigned int            cell,
+                          const unsigned int            n_local_dofs,
+                          std::vector<std::vector<std::vector<std::pair<unsigned int,Number> > > > &cell_constraints)
+    {
+      const unsigned int n_vect = VectorizedArray<Number>::n_array_elements;
+      const dealii::internal::MatrixFreeFunctions::DoFInfo &dof_info =
+        data.get_dof_info(fe_component);
+      const unsigned int n_filled = dof_info.row_starts[cell][2] > 0 ?
+                                    dof_info.row_starts[cell][2] : n_vect;
+
+      cell_constraints.resize (n_vect);
+      for (unsigned int v=0; v<n_vect; ++v)
+        {
+          cell_constraints[v].resize (n_local_dofs);
+          for (unsigned int i=0; i<n_local_dofs; ++i)
+            cell_constraints[v][i].clear();
+        }
+
+      const unsigned int *dof_indices = dof_info.begin_indices(cell);
+      const std::pair<unsigned short,unsigned short> *indicators =
+        dof_info.begin_indicators(cell);
+      const std::pair<unsigned short,unsigned short> *indicators_end =
+        dof_info.end_indicators(cell);
+
+      // ind_local runs over the local degrees of freedom interleaved by the
+      // lanes of the vectorized array, jumping over unfilled lanes
+      unsigned int ind_local = 0;
+      for ( ; indicators != indicators_end; ++indicators)
+        {
+          for (unsigned int j=0; j<indicators->first; ++j, ++dof_indices)
+            {
+              cell_constraints[ind_local%n_vect][ind_local/n_vect].
+              push_back (std::make_pair(*dof_indices, Number(1.)));
+              ++ind_local;
+              while (ind_local % n_vect >= n_filled)
+                ++ind_local;
+            }
+
+          const Number *data_val = data.constraint_pool_begin(indicators->second);
+          const Number *end_pool = data.constraint_pool_end(indicators->second);
+          for ( ; data_val != end_pool; ++data_val, ++dof_indices)
+            cell_constraints[ind_local%n_vect][ind_local/n_vect].
+            push_back (std::make_pair(*dof_indices, *data_val));
+          ++ind_local;
+          while (ind_local % n_vect >= n_filled)
+            ++ind_local;
+        }
+      for ( ; ind_local < n_local_dofs*n_vect; ++dof_indices)
+        {
+          cell_constraints[ind_local%n_vect][ind_local/n_vect].
+          push_back (std::make_pair(*dof_indices, Number(1.)));
+          ++ind_local;
+          while (ind_local % n_vect >= n_filled)
+            ++ind_local;
+        }
+      Assert (dof_indices == dof_info.end_indices(cell), ExcInternalError());
+    }
+
+
+
+    // comparison operator for sorting the (global index, local index,
+    // weight) triplets in compute_diagonal by the global index
+    template <typename Number>
+    struct CompareGlobalIndex
+    {
+      bool operator() (const std::pair<unsigned int,std::pair<unsigned int,Number> > &a,
+                       const std::pair<unsigned int,std::pair<unsigned int,Number> > &b) const
+      {
+        return a.first < b.first;
+      }
+    };
+  }
+
+
+
+  template <typename FEEvaluationType, typename VectorType>
+  void
+  compute_diagonal (const MatrixFree<FEEvaluationType::dimension,
+                    typename FEEvaluationType::number_type>          &data,
+                    VectorType                                         &diagonal,
+                    const std_cxx11::function<void (FEEvaluationType &)> &cell_operation,
+                    const unsigned int                                  fe_component,
+                    const unsigned int                                  quad_no)
+  {
+    typedef typename FEEvaluationType::number_type Number;
+
+    FEEvaluationType phi (data, fe_component, quad_no);
+    const unsigned int n_local_dofs =
+      phi.dofs_per_cell * FEEvaluationType::n_components;
+    AssertDimension (data.get_dof_info(fe_component).n_components,
+                     FEEvaluationType::n_components);
+    dealii::internal::check_vector_compatibility (diagonal,
+                                                  data.get_dof_info(fe_component));
+
+    diagonal = 0;
+
+    AlignedVector<VectorizedArray<Number> > local_matrix;
+    std::vector<std::vector<std::vector<std::pair<unsigned int,Number> > > > cell_constraints;
+    std::vector<std::pair<unsigned int,std::pair<unsigned int,Number> > > entries;
+    for (unsigned int cell=0; cell<data.n_macro_cells(); ++cell)
+      {
+        phi.reinit (cell);
+        internal::compute_cell_matrix (phi, cell_operation, local_matrix);
+        internal::get_cell_constraints (data, fe_component, cell, n_local_dofs,
+                                        cell_constraints);
+
+        for (unsigned int v=0; v<data.n_components_filled(cell); ++v)
+          {
+            // the diagonal entry of global index g is the sum over
+            // w_i * A_ij * w_j for all local dofs i,j that depend on g with
+            // weights w_i and w_j, so collect all dependencies sorted by g
+            entries.clear();
+            for (unsigned int i=0; i<n_local_dofs; ++i)
+              for (unsigned int k=0; k<cell_constraints[v][i].size(); ++k)
+                entries.push_back (std::make_pair(cell_constraints[v][i][k].first,
+                                                  std::make_pair(i, cell_constraints[v][i][k].second)));
+            std::sort (entries.begin(), entries.end(),
+                       internal::CompareGlobalIndex<Number>());
+
+            for (unsigned int start=0; start<entries.size(); )
+              {
+                unsigned int end = start+1;
+                while (end < entries.size() && entries[end].first == entries[start].first)
+                  ++end;
+                Number sum = 0;
+                for (unsigned int a=start; a<end; ++a)
+                  for (unsigned int b=start; b<end; ++b)
+                    sum += entries[a].second.second *
+                           local_matrix[entries[b].second.first*n_local_dofs+
+                                        entries[a].second.first][v] *
+                           entries[b].second.second;
+                dealii::internal::vector_access (diagonal, entries[start].first) += sum;
+                start = end;
+              }
+          }
+      }
+
+    diagonal.compress (VectorOperation::add);
+  }
+
+
+
+  template <typename FEEvaluationType>
+  void
+  compute_block_diagonal (const MatrixFree<FEEvaluationType::dimension,
+                          typename FEEvaluationType::number_type>       &data,
+                          std::vector<FullMatrix<typename FEEvaluationType::number_type> > &block_diagonal,
+                          const std_cxx11::function<void (FEEvaluationType &)> &cell_operation,
+                          const unsigned int                              fe_component,
+                          const unsigned int                              quad_no)
+  {
+    typedef typename FEEvaluationType::number_type Number;
+    const unsigned int n_vect = VectorizedArray<Number>::n_array_elements;
+
+    FEEvaluationType phi (data, fe_component, quad_no);
+    const unsigned int n_local_dofs =
+      phi.dofs_per_cell * FEEvaluationType::n_components;
+
+    block_diagonal.clear();
+    block_diagonal.resize (data.n_macro_cells() * n_vect);
+
+    AlignedVector<VectorizedArray<Number> > local_matrix;
+    for (unsigned int cell=0; cell<data.n_macro_cells(); ++cell)
+      {
+        phi.reinit (cell);
+        internal::compute_cell_matrix (phi, cell_operation, local_matrix);
+        for (unsigned int v=0; v<data.n_components_filled(cell); ++v)
+          {
+            FullMatrix<Number> &matrix = block_diagonal[cell*n_vect+v];
+            matrix.reinit (n_local_dofs, n_local_dofs);
+            for (unsigned int i=0; i<n_local_dofs; ++i)
+              for (unsigned int j=0; j<n_local_dofs; ++j)
+                matrix(i,j) = local_matrix[j*n_local_dofs+i][v];
+          }
+      }
+  }
+
 } // end of namespace MatrixFreeOperators
 
 
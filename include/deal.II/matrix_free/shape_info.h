@@ -168,6 +168,22 @@ namespace internal
        */
       std::vector<Number>    subface_value[2];
 
+      /**
+       * Stores one-dimensional values of shape functions on the quadrature
+       * points of the two subfaces in vectorized format, i.e., evaluated on
+       * the quadrature points mapped to the lower half (index 0) and the
+       * upper half (index 1) of the unit interval. Needed for evaluating face
+       * integrals on the coarser side of a face with hanging nodes.
+       */
+      AlignedVector<VectorizedArray<Number> > shape_values_subface[2];
+
+      /**
+       * Stores one-dimensional gradients of shape functions on the quadrature
+       * points of the two subfaces in vectorized format, similar to
+       * shape_values_subface.
+       */
+      AlignedVector<VectorizedArray<Number> > shape_gradients_subface[2];
+
       /**
        * Non-vectorized version of shape values. Needed when evaluating face
        * info.
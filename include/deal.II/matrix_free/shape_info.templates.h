@@ -164,6 +164,11 @@ namespace internal
       this->face_value[1].resize(n_dofs_1d);
       this->face_gradient[1].resize(n_dofs_1d);
       this->subface_value[1].resize(array_size);
+      for (unsigned int i=0; i<2; ++i)
+        {
+          this->shape_values_subface[i].resize_fast (array_size);
+          this->shape_gradients_subface[i].resize_fast (array_size);
+        }
       this->shape_values_number.resize (array_size);
       this->shape_gradient_number.resize (array_size);
 
@@ -190,8 +195,16 @@ namespace internal
                 fe->shape_grad_grad(my_i,q_point)[0][0];
               q_point[0] *= 0.5;
               subface_value[0][i*n_q_points_1d+q] = fe->shape_value(my_i,q_point);
+              shape_values_subface[0][i*n_q_points_1d+q] =
+                subface_value[0][i*n_q_points_1d+q];
+              shape_gradients_subface[0][i*n_q_points_1d+q] =
+                fe->shape_grad(my_i,q_point)[0];
               q_point[0] += 0.5;
               subface_value[1][i*n_q_points_1d+q] = fe->shape_value(my_i,q_point);
+              shape_values_subface[1][i*n_q_points_1d+q] =
+                subface_value[1][i*n_q_points_1d+q];
+              shape_gradients_subface[1][i*n_q_points_1d+q] =
+                fe->shape_grad(my_i,q_point)[0];
             }
           Point<dim> q_point;
           this->face_value[0][i] = fe->shape_value(my_i,q_point);
@@ -404,6 +417,8 @@ namespace internal
         {
           memory += MemoryConsumption::memory_consumption(face_value[i]);
           memory += MemoryConsumption::memory_consumption(face_gradient[i]);
+          memory += MemoryConsumption::memory_consumption(shape_values_subface[i]);
+          memory += MemoryConsumption::memory_consumption(shape_gradients_subface[i]);
         }
       memory += MemoryConsumption::memory_consumption(shape_values_number);
       memory += MemoryConsumption::memory_consumption(shape_gradient_number);
@@ -119,6 +119,26 @@ public:
                                  LinearAlgebra::distributed::Vector<Number>       &dst,
                                  const LinearAlgebra::distributed::Vector<Number> &src) const;
 
+  /**
+   * Transfer from a vector on the global grid to vectors defined on each of
+   * the levels separately, i.e., the multigrid right hand side, and restrict
+   * the result to all coarser levels. The effect is the same as for
+   * MGLevelGlobalTransfer::copy_to_mg().
+   *
+   * The vector @p src may hold numbers of a different type than the level
+   * vectors, which is the typical setup of a multigrid V-cycle run in single
+   * precision underneath an outer solver in double precision. If the level
+   * numbering on the finest level coincides with the global numbering, the
+   * conversion to the level precision is done in the same sweep that fills
+   * the ghosted vector used by the restriction from the finest level,
+   * avoiding a second pass through the finest level vector.
+   */
+  template <typename Number2>
+  void
+  copy_to_mg (const DoFHandler<dim,dim>                                  &mg_dof,
+              MGLevelObject<LinearAlgebra::distributed::Vector<Number> > &dst,
+              const LinearAlgebra::distributed::Vector<Number2>          &src) const;
+
   /**
    * Finite element does not provide prolongation matrices.
    */
@@ -211,6 +231,14 @@ private:
    */
   std::vector<std::vector<std::vector<unsigned short> > > dirichlet_indices;
 
+  /**
+   * Restrict the content of the ghosted level vector on level
+   * <tt>from_level</tt>, which must have been filled with the locally owned
+   * values before, and add the result to @p dst.
+   */
+  void restrict_ghosted_and_add (const unsigned int                      from_level,
+                                 LinearAlgebra::distributed::Vector<Number> &dst) const;
+
   /**
    * Performs templated prolongation operation
    */
@@ -24,6 +24,9 @@
 #include <deal.II/base/point.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/thread_local_storage.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
+#include <deal.II/grid/cell_bounding_box_tree.h>
 
 #include <deal.II/lac/vector.h>
 
@@ -62,6 +65,17 @@ namespace Functions
    * FEValues::get_function_values or FEValues::get_function_gradients with
    * the given quadrature points.
    *
+   * The functions that evaluate the function at a list of points, such as
+   * value_list() and vector_value_list(), are designed for large numbers of
+   * points: the points are located with a CellBoundingBoxTree that is built
+   * the first time it is needed and then reused for all subsequent calls,
+   * sorted by the cells they lie in, and the cells are then worked on in
+   * parallel using WorkStream. For finite elements whose shape function
+   * values do not depend on the mapping (such as FE_Q, FE_DGQ, or systems of
+   * these), values are computed directly from the shape functions at the
+   * reference coordinates of the points, without setting up an FEValues
+   * object for each cell.
+   *
    * If you only need the quadrature points but not the values of the finite
    * element function (you might want this for the adjoint interpolation), you
    * can also use the function @p compute_point_locations alone.
@@ -403,9 +417,14 @@ namespace Functions
      * points, the second is a list of quadrature points matching each cell of
      * the first list, and the third contains the index of the given
      * quadrature points, i.e., @p points[maps[3][4]] ends up as the 5th
-     * quadrature point in the 4th cell. This is where optimization would
-     * help. This function returns the number of cells that contain the given
-     * set of points.
+     * quadrature point in the 4th cell. This function returns the number of
+     * cells that contain the given set of points.
+     *
+     * Points that lie in the cell set with set_active_cell() are assigned to
+     * that cell. All other points are located with a CellBoundingBoxTree,
+     * which is built on the first call and reused afterwards. The cells are
+     * returned sorted by their level and index, and the points within each
+     * cell in the order in which they appear in @p points.
      */
     unsigned int
     compute_point_locations
@@ -452,6 +471,79 @@ namespace Functions
      */
     const unsigned int n_components;
 
+    /**
+     * For each element of the finite element collection of the DoF handler,
+     * whether the values of its shape functions can be computed from the
+     * reference coordinates alone, i.e., without the mapping. For these
+     * elements, vector_value_list() does not set up an FEValues object.
+     */
+    std::vector<bool> mapping_independent_values;
+
+    /**
+     * A tree of bounding boxes around the active cells, used to locate the
+     * points passed to the list functions. The tree is only built when it is
+     * first needed. Copies of this object share the tree.
+     */
+    mutable std_cxx11::shared_ptr<const CellBoundingBoxTree<dim> > cell_tree;
+
+    /**
+     * A mutex that guards the creation of #cell_tree.
+     */
+    mutable Threads::Mutex cell_tree_mutex;
+
+    /**
+     * Scratch data for the evaluation of the function on the cells that
+     * contain the points passed to the list functions.
+     */
+    struct ScratchData
+    {
+      Vector<typename VectorType::value_type> dof_values;
+    };
+
+    /**
+     * Return the tree of bounding boxes, and build it if this has not
+     * happened yet.
+     */
+    const CellBoundingBoxTree<dim> &get_cell_tree () const;
+
+    /**
+     * Compute the values of the function at the points of
+     * compute_point_locations() that lie in the cell pointed to by @p cell,
+     * and write them into the respective entries of @p values. This function
+     * is called by WorkStream from vector_value_list().
+     */
+    void
+    compute_values_on_cell (const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator &cell,
+                            ScratchData                                                       &scratch,
+                            const std::vector<typename DoFHandlerType::active_cell_iterator> &cells,
+                            const std::vector<std::vector<Point<dim> > >                     &qpoints,
+                            const std::vector<std::vector<unsigned int> >                    &maps,
+                            std::vector<Vector<typename VectorType::value_type> >            &values) const;
+
+    /**
+     * Same as above, but for the gradients. Called from
+     * vector_gradient_list().
+     */
+    void
+    compute_gradients_on_cell (const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator &cell,
+                               ScratchData                                                                  &scratch,
+                               const std::vector<typename DoFHandlerType::active_cell_iterator>            &cells,
+                               const std::vector<std::vector<Point<dim> > >                                &qpoints,
+                               const std::vector<std::vector<unsigned int> >                               &maps,
+                               std::vector<std::vector<Tensor<1,dim,typename VectorType::value_type> > >   &gradients) const;
+
+    /**
+     * Same as above, but for the Laplacians. Called from
+     * vector_laplacian_list().
+     */
+    void
+    compute_laplacians_on_cell (const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator &cell,
+                                ScratchData                                                       &scratch,
+                                const std::vector<typename DoFHandlerType::active_cell_iterator> &cells,
+                                const std::vector<std::vector<Point<dim> > >                     &qpoints,
+                                const std::vector<std::vector<unsigned int> >                    &maps,
+                                std::vector<Vector<typename VectorType::value_type> >            &values) const;
+
     /**
      * Given a cell, return the reference coordinates of the given point
      * within this cell if it indeed lies within the cell. Otherwise return an
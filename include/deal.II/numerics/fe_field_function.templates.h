@@ -16,11 +16,11 @@
 
 #include <deal.II/base/utilities.h>
 #include <deal.II/base/logstream.h>
+#include <deal.II/base/work_stream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/std_cxx11/bind.h>
 #include <deal.II/grid/grid_tools.h>
 #include <deal.II/hp/fe_collection.h>
-#include <deal.II/hp/fe_values.h>
-#include <deal.II/hp/mapping_collection.h>
-#include <deal.II/hp/q_collection.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/numerics/fe_field_function.h>
 #include <deal.II/numerics/vector_tools.h>
@@ -44,6 +44,17 @@ namespace Functions
     cell_hint(dh->end()),
     n_components(mydh.get_fe().n_components())
   {
+    // find out for which elements we can evaluate the shape functions
+    // without a mapping: this is the case if FEValues requests nothing but
+    // the values of the shape functions from the element and the mapping
+    const hp::FECollection<dim> fe_collection (dh->get_fe());
+    mapping_independent_values.resize (fe_collection.size());
+    for (unsigned int i=0; i<fe_collection.size(); ++i)
+      {
+        const FEValues<dim> fe_v (mapping, fe_collection[i], QGauss<dim>(1),
+                                  update_values);
+        mapping_independent_values[i] = (fe_v.get_update_flags() == update_values);
+      }
   }
 
 
@@ -244,33 +255,24 @@ namespace Functions
     std::vector<std::vector<Point<dim> > > qpoints;
     std::vector<std::vector<unsigned int> > maps;
 
-    unsigned int ncells = compute_point_locations(points, cells, qpoints, maps);
-    hp::MappingCollection<dim> mapping_collection (mapping);
-    hp::FECollection<dim> fe_collection (dh->get_fe ());
-    hp::QCollection<dim> quadrature_collection;
-    // Create quadrature collection
-    for (unsigned int i=0; i<ncells; ++i)
-      {
-        // Number of quadrature points on this cell
-        unsigned int nq = qpoints[i].size();
-        // Construct a quadrature formula
-        std::vector< double > ww(nq, 1./((double) nq));
-
-        quadrature_collection.push_back (Quadrature<dim> (qpoints[i], ww));
-      }
-    // Get a function value object
-    hp::FEValues<dim> fe_v(mapping_collection, fe_collection, quadrature_collection,
-                           update_values);
-    // Now gather all the informations we need
-    for (unsigned int i=0; i<ncells; ++i)
-      {
-        fe_v.reinit(cells[i], i, 0);
-        const unsigned int nq = qpoints[i].size();
-        std::vector< Vector<typename VectorType::value_type> > vvalues (nq, Vector<typename VectorType::value_type>(n_components));
-        fe_v.get_present_fe_values ().get_function_values(data_vector, vvalues);
-        for (unsigned int q=0; q<nq; ++q)
-          values[maps[i][q]] = vvalues[q];
-      }
+    const unsigned int ncells = compute_point_locations(points, cells, qpoints, maps);
+    if (ncells == 0)
+      return;
+
+    // work on the cells in parallel. each cell writes into different
+    // entries of the output array, so no copier is needed
+    WorkStream::run (cells.begin(), cells.end(),
+                     std_cxx11::bind (&FEFieldFunction<dim, DoFHandlerType, VectorType>::compute_values_on_cell,
+                                      this,
+                                      std_cxx11::_1,
+                                      std_cxx11::_2,
+                                      std_cxx11::cref(cells),
+                                      std_cxx11::cref(qpoints),
+                                      std_cxx11::cref(maps),
+                                      std_cxx11::ref(values)),
+                     std_cxx11::function<void (const int &)>(),
+                     ScratchData(),
+                     /* dummy CopyData object = */ 0);
   }
 
 
@@ -305,39 +307,22 @@ namespace Functions
     std::vector<std::vector<Point<dim> > > qpoints;
     std::vector<std::vector<unsigned int> > maps;
 
-    unsigned int ncells = compute_point_locations(points, cells, qpoints, maps);
-    hp::MappingCollection<dim> mapping_collection (mapping);
-    hp::FECollection<dim> fe_collection (dh->get_fe ());
-    hp::QCollection<dim> quadrature_collection;
-    // Create quadrature collection
-    for (unsigned int i=0; i<ncells; ++i)
-      {
-        // Number of quadrature points on this cell
-        unsigned int nq = qpoints[i].size();
-        // Construct a quadrature formula
-        std::vector< double > ww(nq, 1./((double) nq));
-
-        quadrature_collection.push_back (Quadrature<dim> (qpoints[i], ww));
-      }
-    // Get a function value object
-    hp::FEValues<dim> fe_v(mapping_collection, fe_collection, quadrature_collection,
-                           update_gradients);
-    // Now gather all the informations we need
-    for (unsigned int i=0; i<ncells; ++i)
-      {
-        fe_v.reinit(cells[i], i, 0);
-        const unsigned int nq = qpoints[i].size();
-        std::vector< std::vector<Tensor<1,dim,typename VectorType::value_type> > >
-        vgrads (nq, std::vector<Tensor<1,dim,typename VectorType::value_type> >(n_components));
-        fe_v.get_present_fe_values ().get_function_gradients(data_vector, vgrads);
-        for (unsigned int q=0; q<nq; ++q)
-          {
-            const unsigned int s = vgrads[q].size();
-            values[maps[i][q]].resize(s);
-            for (unsigned int l=0; l<s; l++)
-              values[maps[i][q]][l] = vgrads[q][l];
-          }
-      }
+    const unsigned int ncells = compute_point_locations(points, cells, qpoints, maps);
+    if (ncells == 0)
+      return;
+
+    WorkStream::run (cells.begin(), cells.end(),
+                     std_cxx11::bind (&FEFieldFunction<dim, DoFHandlerType, VectorType>::compute_gradients_on_cell,
+                                      this,
+                                      std_cxx11::_1,
+                                      std_cxx11::_2,
+                                      std_cxx11::cref(cells),
+                                      std_cxx11::cref(qpoints),
+                                      std_cxx11::cref(maps),
+                                      std_cxx11::ref(values)),
+                     std_cxx11::function<void (const int &)>(),
+                     ScratchData(),
+                     /* dummy CopyData object = */ 0);
   }
 
   template <int dim, typename DoFHandlerType, typename VectorType>
@@ -370,33 +355,22 @@ namespace Functions
     std::vector<std::vector<Point<dim> > > qpoints;
     std::vector<std::vector<unsigned int> > maps;
 
-    unsigned int ncells = compute_point_locations(points, cells, qpoints, maps);
-    hp::MappingCollection<dim> mapping_collection (mapping);
-    hp::FECollection<dim> fe_collection (dh->get_fe ());
-    hp::QCollection<dim> quadrature_collection;
-    // Create quadrature collection
-    for (unsigned int i=0; i<ncells; ++i)
-      {
-        // Number of quadrature points on this cell
-        unsigned int nq = qpoints[i].size();
-        // Construct a quadrature formula
-        std::vector< double > ww(nq, 1./((double) nq));
-
-        quadrature_collection.push_back (Quadrature<dim> (qpoints[i], ww));
-      }
-    // Get a function value object
-    hp::FEValues<dim> fe_v(mapping_collection, fe_collection, quadrature_collection,
-                           update_hessians);
-    // Now gather all the informations we need
-    for (unsigned int i=0; i<ncells; ++i)
-      {
-        fe_v.reinit(cells[i], i, 0);
-        const unsigned int nq = qpoints[i].size();
-        std::vector< Vector<typename VectorType::value_type> > vvalues (nq, Vector<typename VectorType::value_type>(n_components));
-        fe_v.get_present_fe_values ().get_function_laplacians(data_vector, vvalues);
-        for (unsigned int q=0; q<nq; ++q)
-          values[maps[i][q]] = vvalues[q];
-      }
+    const unsigned int ncells = compute_point_locations(points, cells, qpoints, maps);
+    if (ncells == 0)
+      return;
+
+    WorkStream::run (cells.begin(), cells.end(),
+                     std_cxx11::bind (&FEFieldFunction<dim, DoFHandlerType, VectorType>::compute_laplacians_on_cell,
+                                      this,
+                                      std_cxx11::_1,
+                                      std_cxx11::_2,
+                                      std_cxx11::cref(cells),
+                                      std_cxx11::cref(qpoints),
+                                      std_cxx11::cref(maps),
+                                      std_cxx11::ref(values)),
+                     std_cxx11::function<void (const int &)>(),
+                     ScratchData(),
+                     /* dummy CopyData object = */ 0);
   }
 
   template <int dim, typename DoFHandlerType, typename VectorType>
@@ -435,147 +409,242 @@ namespace Functions
     // Now the easy case.
     if (np==0) return 0;
 
-    // Keep track of the points we
-    // found
-    std::vector<bool> point_flags(np, false);
-
-    // Set this to true until all
-    // points have been classified
-    bool left_over = true;
-
-    // Current quadrature point
-    typename DoFHandlerType::active_cell_iterator cell = cell_hint.get();
-    if (cell == dh->end())
-      cell = dh->begin_active();
+    std::vector<typename DoFHandlerType::active_cell_iterator> point_cells (np);
+    std::vector<Point<dim> > reference_points (np);
+
+    // First see which points lie in the cell we have been given as a
+    // hint. to avoid the comparably expensive inversion of the mapping for
+    // points that are far away, only look at points inside the bounding box
+    // of the vertices of the cell. points that lie in a curved cell but
+    // outside this box are simply found with the tree below
+    std::vector<unsigned int> points_to_search;
+    const typename DoFHandlerType::active_cell_iterator hint = cell_hint.get();
+    if (hint != dh->end())
+      {
+        Point<dim> lower_corner = hint->vertex(0),
+                   upper_corner = hint->vertex(0);
+        for (unsigned int v=1; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+          for (unsigned int d=0; d<dim; ++d)
+            {
+              lower_corner[d] = std::min (lower_corner[d], hint->vertex(v)[d]);
+              upper_corner[d] = std::max (upper_corner[d], hint->vertex(v)[d]);
+            }
 
-    {
-      // see if the point is
-      // inside the
-      // cell. there are two
-      // ways that
-      // transform_real_to_unit_cell
-      // can indicate that a
-      // point is outside: by
-      // returning
-      // coordinates that lie
-      // outside the
-      // reference cell, or
-      // by throwing an
-      // exception. handle
-      // both
-      boost::optional<Point<dim> >
-      qp = get_reference_coordinates (cell, points[0]);
-      if (!qp)
-        {
-          const std::pair<typename dealii::internal::ActiveCellIterator<dim, dim, DoFHandlerType>::type, Point<dim> >
-          my_pair  = GridTools::find_active_cell_around_point
-                     (mapping, *dh, points[0]);
-          AssertThrow (!my_pair.first->is_artificial(),
-                       VectorTools::ExcPointNotAvailableHere());
-
-          cell = my_pair.first;
-          qp = my_pair.second;
-          point_flags[0] = true;
-        }
-
-      // Put in the first point.
-      cells.push_back(cell);
-      qpoints.push_back(std::vector<Point<dim> >(1, qp.get()));
-      maps.push_back(std::vector<unsigned int> (1, 0));
-    }
-
-
-    // Check if we need to do anything else
-    if (points.size() > 1)
-      left_over = true;
+        for (unsigned int p=0; p<np; ++p)
+          {
+            bool inside_box = true;
+            for (unsigned int d=0; d<dim; ++d)
+              if (points[p][d] < lower_corner[d] || points[p][d] > upper_corner[d])
+                inside_box = false;
+
+            const boost::optional<Point<dim> >
+            qp = (inside_box ?
+                  get_reference_coordinates (hint, points[p]) :
+                  boost::optional<Point<dim> >());
+            if (qp)
+              {
+                point_cells[p] = hint;
+                reference_points[p] = qp.get();
+              }
+            else
+              points_to_search.push_back (p);
+          }
+      }
     else
-      left_over = false;
+      {
+        points_to_search.resize (np);
+        for (unsigned int p=0; p<np; ++p)
+          points_to_search[p] = p;
+      }
 
+    // Then locate all remaining points at once. this happens in parallel
+    // inside the tree
+    if (points_to_search.size() > 0)
+      {
+        const CellBoundingBoxTree<dim> &tree = get_cell_tree ();
 
-    // This is the first index of a non processed point
-    unsigned int first_outside = 1;
+        std::vector<Point<dim> > search_points (points_to_search.size());
+        for (unsigned int i=0; i<points_to_search.size(); ++i)
+          search_points[i] = points[points_to_search[i]];
 
-    // And this is the index of the current cell
-    unsigned int c = 0;
+        std::vector<typename CellBoundingBoxTree<dim>::active_cell_iterator> tria_cells;
+        std::vector<Point<dim> > search_reference_points;
+        tree.find_active_cells_around_points (search_points, tria_cells,
+                                              search_reference_points);
 
-    while (left_over == true)
-      {
-        // Assume this is the last one
-        left_over = false;
-        Assert(first_outside < np,
-               ExcIndexRange(first_outside, 0, np));
-
-        // If we found one in this cell, keep looking in the same cell
-        for (unsigned int p=first_outside; p<np; ++p)
-          if (point_flags[p] == false)
-            {
-              // same logic as above
-              const boost::optional<Point<dim> >
-              qp = get_reference_coordinates (cells[c], points[p]);
-              if (qp)
-                {
-                  point_flags[p] = true;
-                  qpoints[c].push_back(qp.get());
-                  maps[c].push_back(p);
-                }
-              else
-                {
-                  // Set things up for next round
-                  if (left_over == false)
-                    first_outside = p;
-                  left_over = true;
-                }
-            }
-        // If we got here and there is
-        // no left over, we are
-        // done. Else we need to find
-        // the next cell
-        if (left_over == true)
+        for (unsigned int i=0; i<points_to_search.size(); ++i)
           {
-            const std::pair<typename dealii::internal::ActiveCellIterator<dim, dim, DoFHandlerType>::type, Point<dim> > my_pair
-              = GridTools::find_active_cell_around_point (mapping, *dh, points[first_outside]);
-            AssertThrow (!my_pair.first->is_artificial(),
+            AssertThrow (tria_cells[i] != dh->get_triangulation().end(),
+                         GridTools::ExcPointNotFound<dim>(search_points[i]));
+            const typename DoFHandlerType::active_cell_iterator
+            cell (&dh->get_triangulation(), tria_cells[i]->level(),
+                  tria_cells[i]->index(), &*dh);
+            AssertThrow (!cell->is_artificial(),
                          VectorTools::ExcPointNotAvailableHere());
 
-            cells.push_back(my_pair.first);
-            qpoints.push_back(std::vector<Point<dim> >(1, my_pair.second));
-            maps.push_back(std::vector<unsigned int>(1, first_outside));
-            c++;
-            point_flags[first_outside] = true;
-            // And check if we can exit the loop now
-            if (first_outside == np-1)
-              left_over = false;
+            point_cells[points_to_search[i]] = cell;
+            reference_points[points_to_search[i]] = search_reference_points[i];
           }
       }
 
-    // Augment of one the number of cells
-    ++c;
-    // Debug Checking
-    Assert(c == cells.size(), ExcInternalError());
+    // Finally sort the points by the cells they lie in. since the point
+    // index is part of the key, the order is unique
+    std::vector<std::pair<std::pair<int,int>,unsigned int> > sorted_points (np);
+    for (unsigned int p=0; p<np; ++p)
+      sorted_points[p] = std::make_pair (std::make_pair (point_cells[p]->level(),
+                                                         point_cells[p]->index()),
+                                         p);
+    std::sort (sorted_points.begin(), sorted_points.end());
+
+    for (unsigned int i=0; i<np; ++i)
+      {
+        const unsigned int p = sorted_points[i].second;
+        if (i == 0 || sorted_points[i].first != sorted_points[i-1].first)
+          {
+            cells.push_back (point_cells[p]);
+            qpoints.push_back (std::vector<Point<dim> >());
+            maps.push_back (std::vector<unsigned int>());
+          }
+        qpoints.back().push_back (reference_points[p]);
+        maps.back().push_back (p);
+      }
+
+    return cells.size();
+  }
+
+
+
+  template <int dim, typename DoFHandlerType, typename VectorType>
+  const CellBoundingBoxTree<dim> &
+  FEFieldFunction<dim, DoFHandlerType, VectorType>::get_cell_tree () const
+  {
+    Threads::Mutex::ScopedLock lock (cell_tree_mutex);
+    if (cell_tree.get() == 0)
+      cell_tree.reset (new CellBoundingBoxTree<dim> (dh->get_triangulation(),
+                                                     mapping));
+    return *cell_tree;
+  }
+
+
+
+  template <int dim, typename DoFHandlerType, typename VectorType>
+  void
+  FEFieldFunction<dim, DoFHandlerType, VectorType>::
+  compute_values_on_cell (const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator &cell,
+                          ScratchData                                                       &scratch,
+                          const std::vector<typename DoFHandlerType::active_cell_iterator> &cells,
+                          const std::vector<std::vector<Point<dim> > >                     &qpoints,
+                          const std::vector<std::vector<unsigned int> >                    &maps,
+                          std::vector<Vector<typename VectorType::value_type> >            &values) const
+  {
+    typedef typename VectorType::value_type number;
+
+    const unsigned int index = cell - cells.begin();
+    const FiniteElement<dim> &fe = (*cell)->get_fe();
+    const unsigned int nq = qpoints[index].size();
+
+    // if the values of the shape functions do not depend on the mapping,
+    // evaluate them directly at the reference points instead of setting up
+    // an FEValues object for this particular set of points. the sum over
+    // the shape functions is done in the same order as in
+    // FEValues::get_function_values
+    if (mapping_independent_values[(*cell)->active_fe_index()])
+      {
+        scratch.dof_values.reinit (fe.dofs_per_cell, true);
+        (*cell)->get_dof_values (data_vector, scratch.dof_values);
+
+        for (unsigned int q=0; q<nq; ++q)
+          {
+            const Point<dim> &unit_point = qpoints[index][q];
+            Vector<number> &point_values = values[maps[index][q]];
+            point_values.reinit (n_components);
+
+            for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+              {
+                const number value = scratch.dof_values(i);
+                if (value == number())
+                  continue;
+
+                if (fe.is_primitive(i))
+                  point_values(fe.system_to_component_index(i).first)
+                  += value * fe.shape_value (i, unit_point);
+                else
+                  for (unsigned int c=0; c<n_components; ++c)
+                    if (fe.get_nonzero_components(i)[c])
+                      point_values(c) += value * fe.shape_value_component (i, unit_point, c);
+              }
+          }
+      }
+    else
+      {
+        const std::vector<double> weights (nq, 1./((double) nq));
+        FEValues<dim> fe_v (mapping, fe, Quadrature<dim>(qpoints[index], weights),
+                            update_values);
+        fe_v.reinit (*cell);
+        std::vector< Vector<number> > vvalues (nq, Vector<number>(n_components));
+        fe_v.get_function_values (data_vector, vvalues);
+        for (unsigned int q=0; q<nq; ++q)
+          values[maps[index][q]] = vvalues[q];
+      }
+  }
 
-    Assert(c == maps.size(),
-           ExcDimensionMismatch(c, maps.size()));
 
-    Assert(c == qpoints.size(),
-           ExcDimensionMismatch(c, qpoints.size()));
 
-#ifdef DEBUG
-    unsigned int qps = 0;
-    // The number of points in all
-    // the cells must be the same as
-    // the number of points we
-    // started off from.
-    for (unsigned int n=0; n<c; ++n)
+  template <int dim, typename DoFHandlerType, typename VectorType>
+  void
+  FEFieldFunction<dim, DoFHandlerType, VectorType>::
+  compute_gradients_on_cell (const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator &cell,
+                             ScratchData                                                                  &,
+                             const std::vector<typename DoFHandlerType::active_cell_iterator>            &cells,
+                             const std::vector<std::vector<Point<dim> > >                                &qpoints,
+                             const std::vector<std::vector<unsigned int> >                               &maps,
+                             std::vector<std::vector<Tensor<1,dim,typename VectorType::value_type> > >   &gradients) const
+  {
+    const unsigned int index = cell - cells.begin();
+    const unsigned int nq = qpoints[index].size();
+
+    const std::vector<double> weights (nq, 1./((double) nq));
+    FEValues<dim> fe_v (mapping, (*cell)->get_fe(),
+                        Quadrature<dim>(qpoints[index], weights),
+                        update_gradients);
+    fe_v.reinit (*cell);
+    std::vector< std::vector<Tensor<1,dim,typename VectorType::value_type> > >
+    vgrads (nq, std::vector<Tensor<1,dim,typename VectorType::value_type> >(n_components));
+    fe_v.get_function_gradients (data_vector, vgrads);
+    for (unsigned int q=0; q<nq; ++q)
       {
-        Assert(qpoints[n].size() == maps[n].size(),
-               ExcDimensionMismatch(qpoints[n].size(), maps[n].size()));
-        qps += qpoints[n].size();
+        const unsigned int s = vgrads[q].size();
+        gradients[maps[index][q]].resize(s);
+        for (unsigned int l=0; l<s; l++)
+          gradients[maps[index][q]][l] = vgrads[q][l];
       }
-    Assert(qps == np,
-           ExcDimensionMismatch(qps, np));
-#endif
+  }
+
+
 
-    return c;
+  template <int dim, typename DoFHandlerType, typename VectorType>
+  void
+  FEFieldFunction<dim, DoFHandlerType, VectorType>::
+  compute_laplacians_on_cell (const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator &cell,
+                              ScratchData                                                       &,
+                              const std::vector<typename DoFHandlerType::active_cell_iterator> &cells,
+                              const std::vector<std::vector<Point<dim> > >                     &qpoints,
+                              const std::vector<std::vector<unsigned int> >                    &maps,
+                              std::vector<Vector<typename VectorType::value_type> >            &values) const
+  {
+    const unsigned int index = cell - cells.begin();
+    const unsigned int nq = qpoints[index].size();
+
+    const std::vector<double> weights (nq, 1./((double) nq));
+    FEValues<dim> fe_v (mapping, (*cell)->get_fe(),
+                        Quadrature<dim>(qpoints[index], weights),
+                        update_hessians);
+    fe_v.reinit (*cell);
+    std::vector< Vector<typename VectorType::value_type> >
+    vvalues (nq, Vector<typename VectorType::value_type>(n_components));
+    fe_v.get_function_laplacians (data_vector, vvalues);
+    for (unsigned int q=0; q<nq; ++q)
+      values[maps[index][q]] = vvalues[q];
   }
 
 
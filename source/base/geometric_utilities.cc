@@ -16,6 +16,7 @@
 
 #include <deal.II/base/geometric_utilities.h>
 #include <deal.II/base/exceptions.h>
+#include <limits>
 
 
 DEAL_II_NAMESPACE_OPEN
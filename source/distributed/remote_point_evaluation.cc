@@ -0,0 +1,679 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/distributed/remote_point_evaluation.h>
+#include <deal.II/distributed/tria_base.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/grid/cell_bounding_box_tree.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/la_parallel_block_vector.h>
+#include <deal.II/lac/petsc_vector.h>
+#include <deal.II/lac/petsc_block_vector.h>
+#include <deal.II/lac/trilinos_vector.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace
+{
+  /**
+   * Return whether the point is inside the box whose lower corner is stored
+   * in the first @p spacedim entries of @p box and whose upper corner is
+   * stored in the following @p spacedim entries.
+   */
+  template <int spacedim>
+  inline
+  bool
+  box_contains_point (const double          *box,
+                      const Point<spacedim> &p)
+  {
+    for (unsigned int d=0; d<spacedim; ++d)
+      if (p[d] < box[d] || p[d] > box[spacedim+d])
+        return false;
+    return true;
+  }
+
+
+
+  /**
+   * Send the data stored under the rank of each processor in @p send_data to
+   * that processor, and receive data from each processor in @p sources into
+   * @p received_data. Data for the current processor is copied directly.
+   */
+  template <typename T>
+  void
+  exchange_data (const MPI_Comm                                 &communicator,
+                 const std::map<unsigned int, std::vector<T> >  &send_data,
+                 const std::vector<unsigned int>                &sources,
+                 const int                                       tag,
+                 std::map<unsigned int, std::vector<T> >        &received_data)
+  {
+    const unsigned int my_rank = Utilities::MPI::this_mpi_process (communicator);
+
+    received_data.clear ();
+    const typename std::map<unsigned int, std::vector<T> >::const_iterator
+    self = send_data.find (my_rank);
+    if (self != send_data.end())
+      received_data[my_rank] = self->second;
+
+#ifdef DEAL_II_WITH_MPI
+    std::vector<MPI_Request> requests;
+    requests.reserve (send_data.size());
+    for (typename std::map<unsigned int, std::vector<T> >::const_iterator
+         it = send_data.begin(); it != send_data.end(); ++it)
+      if (it->first != my_rank)
+        {
+          requests.push_back (MPI_Request());
+          MPI_Isend (it->second.size() > 0 ? const_cast<T *>(&it->second[0]) : 0,
+                     it->second.size() * sizeof(T), MPI_BYTE,
+                     it->first, tag, communicator, &requests.back());
+        }
+
+    for (unsigned int i=0; i<sources.size(); ++i)
+      {
+        MPI_Status status;
+        MPI_Probe (sources[i], tag, communicator, &status);
+        int n_bytes;
+        MPI_Get_count (&status, MPI_BYTE, &n_bytes);
+
+        std::vector<T> &data = received_data[sources[i]];
+        data.resize (n_bytes / sizeof(T));
+        MPI_Recv (data.size() > 0 ? &data[0] : 0, n_bytes, MPI_BYTE,
+                  sources[i], tag, communicator, MPI_STATUS_IGNORE);
+      }
+
+    if (requests.size() > 0)
+      MPI_Waitall (requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+#else
+    (void)tag;
+    Assert (sources.size() == 0, ExcInternalError());
+    Assert (send_data.size() == (self != send_data.end() ? 1U : 0U),
+            ExcInternalError());
+#endif
+  }
+
+
+
+  /**
+   * Look for a locally owned cell around the point @p p among the cells
+   * whose bounding boxes in @p tree contain the point. Points at a distance
+   * of up to @p tolerance outside of the reference cell are accepted. Among
+   * several cells, the one closest to the point is chosen, and among cells
+   * at the same distance the one on the finest level and with the smallest
+   * index.
+   */
+  template <int dim, int spacedim>
+  bool
+  find_locally_owned_cell_around_point (const CellBoundingBoxTree<dim,spacedim>                   &tree,
+                                        const Mapping<dim,spacedim>                               &mapping,
+                                        const Point<spacedim>                                     &p,
+                                        const double                                               tolerance,
+                                        typename Triangulation<dim,spacedim>::active_cell_iterator &cell,
+                                        Point<dim>                                                 &reference_point)
+  {
+    const std::vector<typename Triangulation<dim,spacedim>::active_cell_iterator>
+    candidates = tree.find_cells_with_bounding_box_around_point (p);
+
+    bool   found = false;
+    double best_distance = tolerance;
+    for (unsigned int i=0; i<candidates.size(); ++i)
+      if (candidates[i]->is_locally_owned())
+        try
+          {
+            const Point<dim> p_cell = mapping.transform_real_to_unit_cell (candidates[i], p);
+            const double distance = GeometryInfo<dim>::distance_to_unit_cell (p_cell);
+
+            if ((distance < best_distance)
+                ||
+                ((distance == best_distance)
+                 &&
+                 ((found == false)
+                  ||
+                  (candidates[i]->level() > cell->level())
+                  ||
+                  ((candidates[i]->level() == cell->level()) &&
+                   (candidates[i]->index() < cell->index())))))
+              {
+                found           = true;
+                best_distance   = distance;
+                cell            = candidates[i];
+                reference_point = p_cell;
+              }
+          }
+        catch (const typename Mapping<dim,spacedim>::ExcTransformationFailed &)
+          {
+            // the point is far outside of this cell
+          }
+
+    return found;
+  }
+}
+
+
+
+namespace parallel
+{
+  template <int dim, int spacedim>
+  RemotePointEvaluation<dim,spacedim>::RemotePointEvaluation (const double tolerance)
+    :
+    tolerance (tolerance),
+    tria (0, typeid(*this).name()),
+    mapping (0, typeid(*this).name()),
+    communicator (MPI_COMM_SELF)
+  {
+    clear ();
+  }
+
+
+
+  template <int dim, int spacedim>
+  RemotePointEvaluation<dim,spacedim>::~RemotePointEvaluation ()
+  {
+    clear ();
+  }
+
+
+
+  template <int dim, int spacedim>
+  void
+  RemotePointEvaluation<dim,spacedim>::clear ()
+  {
+    tria = 0;
+    mapping = 0;
+    communicator = MPI_COMM_SELF;
+
+    std::vector<unsigned int>().swap (point_owners);
+    std::vector<unsigned int>().swap (recv_ranks);
+    std::vector<unsigned int> (1, 0).swap (recv_offsets);
+    std::vector<unsigned int>().swap (recv_point_indices);
+    std::vector<unsigned int>().swap (send_ranks);
+    std::vector<unsigned int> (1, 0).swap (send_offsets);
+    std::vector<std::pair<int,int> >().swap (evaluation_cells);
+    std::vector<unsigned int> (1, 0).swap (evaluation_cell_offsets);
+    std::vector<Point<dim> >().swap (evaluation_reference_points);
+    std::vector<unsigned int>().swap (evaluation_buffer_indices);
+  }
+
+
+
+  template <int dim, int spacedim>
+  void
+  RemotePointEvaluation<dim,spacedim>::
+  reinit (const std::vector<Point<spacedim> >       &points,
+          const dealii::Triangulation<dim,spacedim> &triangulation,
+          const Mapping<dim,spacedim>               &mapping)
+  {
+    clear ();
+
+    tria = &triangulation;
+    this->mapping = &mapping;
+
+    const parallel::Triangulation<dim,spacedim> *parallel_tria
+      = dynamic_cast<const parallel::Triangulation<dim,spacedim> *>(&triangulation);
+    if (parallel_tria != 0)
+      communicator = parallel_tria->get_communicator();
+    const unsigned int n_ranks = Utilities::MPI::n_mpi_processes (communicator);
+    const unsigned int my_rank = Utilities::MPI::this_mpi_process (communicator);
+
+    const CellBoundingBoxTree<dim,spacedim> tree (triangulation, mapping);
+
+    // compute the box around the locally owned cells and exchange it with
+    // all other processors. processors without locally owned cells get an
+    // empty box
+    std::vector<double> local_box (2*spacedim);
+    for (unsigned int d=0; d<spacedim; ++d)
+      {
+        local_box[d]          = std::numeric_limits<double>::max();
+        local_box[spacedim+d] = -std::numeric_limits<double>::max();
+      }
+    for (typename dealii::Triangulation<dim,spacedim>::active_cell_iterator
+         cell = triangulation.begin_active(); cell != triangulation.end(); ++cell)
+      if (cell->is_locally_owned())
+        {
+          const std::pair<Point<spacedim>,Point<spacedim> > box
+            = tree.get_cell_bounding_box (cell);
+          for (unsigned int d=0; d<spacedim; ++d)
+            {
+              local_box[d]          = std::min (local_box[d], box.first[d]);
+              local_box[spacedim+d] = std::max (local_box[spacedim+d], box.second[d]);
+            }
+        }
+
+    std::vector<double> all_boxes (2*spacedim*n_ranks);
+#ifdef DEAL_II_WITH_MPI
+    if (n_ranks > 1)
+      MPI_Allgather (&local_box[0], 2*spacedim, MPI_DOUBLE,
+                     &all_boxes[0], 2*spacedim, MPI_DOUBLE,
+                     communicator);
+    else
+#endif
+      all_boxes = local_box;
+
+    // ask each processor whose box contains a point whether the point is
+    // in one of its locally owned cells
+    std::map<unsigned int, std::vector<unsigned int> > requested_points;
+    for (unsigned int i=0; i<points.size(); ++i)
+      for (unsigned int rank=0; rank<n_ranks; ++rank)
+        if (box_contains_point<spacedim> (&all_boxes[2*spacedim*rank], points[i]))
+          requested_points[rank].push_back (i);
+
+    std::map<unsigned int, std::vector<double> > send_points;
+    std::vector<unsigned int> destinations;
+    for (typename std::map<unsigned int, std::vector<unsigned int> >::const_iterator
+         it = requested_points.begin(); it != requested_points.end(); ++it)
+      {
+        std::vector<double> &coordinates = send_points[it->first];
+        coordinates.reserve (spacedim * it->second.size());
+        for (unsigned int j=0; j<it->second.size(); ++j)
+          for (unsigned int d=0; d<spacedim; ++d)
+            coordinates.push_back (points[it->second[j]][d]);
+
+        if (it->first != my_rank)
+          destinations.push_back (it->first);
+      }
+
+    std::vector<unsigned int> sources;
+#ifdef DEAL_II_WITH_MPI
+    if (n_ranks > 1)
+      sources = Utilities::MPI::compute_point_to_point_communication_pattern (communicator,
+                destinations);
+#endif
+
+    std::map<unsigned int, std::vector<double> > received_points;
+    exchange_data (communicator, send_points, sources, 4001, received_points);
+
+    // locate all points we have been asked for at once. if the tree finds
+    // a cell that is not locally owned, or none at all, the point may still
+    // lie on the boundary of a locally owned cell, or be within the
+    // tolerance
+    std::vector<Point<spacedim> > located_points;
+    for (typename std::map<unsigned int, std::vector<double> >::const_iterator
+         it = received_points.begin(); it != received_points.end(); ++it)
+      for (unsigned int j=0; j<it->second.size()/spacedim; ++j)
+        {
+          Point<spacedim> p;
+          for (unsigned int d=0; d<spacedim; ++d)
+            p[d] = it->second[spacedim*j+d];
+          located_points.push_back (p);
+        }
+
+    std::vector<typename dealii::Triangulation<dim,spacedim>::active_cell_iterator> located_cells;
+    std::vector<Point<dim> > located_reference_points;
+    tree.find_active_cells_around_points (located_points, located_cells,
+                                          located_reference_points);
+
+    std::vector<bool> point_located (located_points.size(), true);
+    for (unsigned int k=0; k<located_points.size(); ++k)
+      if (located_cells[k] == triangulation.end() ||
+          located_cells[k]->is_locally_owned() == false)
+        point_located[k] = find_locally_owned_cell_around_point (tree, mapping, located_points[k],
+                           tolerance, located_cells[k],
+                           located_reference_points[k]);
+
+    // tell the processors which of their points we have found
+    std::map<unsigned int, std::vector<unsigned int> > found_points;
+    {
+      unsigned int k = 0;
+      for (typename std::map<unsigned int, std::vector<double> >::const_iterator
+           it = received_points.begin(); it != received_points.end(); ++it)
+        {
+          std::vector<unsigned int> &found = found_points[it->first];
+          found.resize (it->second.size()/spacedim);
+          for (unsigned int j=0; j<found.size(); ++j, ++k)
+            found[j] = (point_located[k] ? 1 : 0);
+        }
+    }
+
+    std::map<unsigned int, std::vector<unsigned int> > replies;
+    exchange_data (communicator, found_points, destinations, 4002, replies);
+
+    // each point is evaluated by the processor with the smallest rank among
+    // those that have found it. we go through the processors in ascending
+    // order, so this is the first one
+    point_owners.resize (points.size(), numbers::invalid_unsigned_int);
+    std::map<unsigned int, std::vector<unsigned int> > accepted_points;
+    for (typename std::map<unsigned int, std::vector<unsigned int> >::const_iterator
+         it = requested_points.begin(); it != requested_points.end(); ++it)
+      {
+        const std::vector<unsigned int> &reply = replies[it->first];
+        AssertDimension (reply.size(), it->second.size());
+
+        std::vector<unsigned int> &accepted = accepted_points[it->first];
+        accepted.resize (reply.size(), 0);
+        for (unsigned int j=0; j<reply.size(); ++j)
+          if (reply[j] == 1 && point_owners[it->second[j]] == numbers::invalid_unsigned_int)
+            {
+              point_owners[it->second[j]] = it->first;
+              accepted[j] = 1;
+              recv_point_indices.push_back (it->second[j]);
+            }
+
+        if (recv_point_indices.size() > recv_offsets.back())
+          {
+            recv_ranks.push_back (it->first);
+            recv_offsets.push_back (recv_point_indices.size());
+          }
+      }
+
+    std::map<unsigned int, std::vector<unsigned int> > points_to_evaluate;
+    exchange_data (communicator, accepted_points, sources, 4003, points_to_evaluate);
+
+    // set up the list of points to evaluate on this processor, in the order
+    // in which their values are sent, and then sort them by cell
+    std::vector<std::pair<std::pair<int,int>,unsigned int> > sorted_points;
+    std::vector<Point<dim> > reference_points;
+    {
+      unsigned int k = 0;
+      for (typename std::map<unsigned int, std::vector<unsigned int> >::const_iterator
+           it = points_to_evaluate.begin(); it != points_to_evaluate.end(); ++it)
+        {
+          for (unsigned int j=0; j<it->second.size(); ++j, ++k)
+            if (it->second[j] == 1)
+              {
+                Assert (point_located[k], ExcInternalError());
+                sorted_points.push_back (std::make_pair (std::make_pair (located_cells[k]->level(),
+                                                                         located_cells[k]->index()),
+                                                         reference_points.size()));
+                reference_points.push_back (located_reference_points[k]);
+              }
+
+          if (reference_points.size() > send_offsets.back())
+            {
+              send_ranks.push_back (it->first);
+              send_offsets.push_back (reference_points.size());
+            }
+        }
+      Assert (k == located_points.size(), ExcInternalError());
+    }
+
+    std::sort (sorted_points.begin(), sorted_points.end());
+    evaluation_reference_points.resize (sorted_points.size());
+    evaluation_buffer_indices.resize (sorted_points.size());
+    for (unsigned int i=0; i<sorted_points.size(); ++i)
+      {
+        if (i == 0 || sorted_points[i].first != sorted_points[i-1].first)
+          {
+            if (i > 0)
+              evaluation_cell_offsets.push_back (i);
+            evaluation_cells.push_back (sorted_points[i].first);
+          }
+        evaluation_reference_points[i] = reference_points[sorted_points[i].second];
+        evaluation_buffer_indices[i]   = sorted_points[i].second;
+      }
+    if (sorted_points.size() > 0)
+      evaluation_cell_offsets.push_back (sorted_points.size());
+  }
+
+
+
+  template <int dim, int spacedim>
+  template <typename DoFHandlerType, typename VectorType>
+  void
+  RemotePointEvaluation<dim,spacedim>::
+  evaluate (const DoFHandlerType                                  &dof_handler,
+            const VectorType                                      &vector,
+            std::vector<Vector<typename VectorType::value_type> > &values) const
+  {
+    typedef typename VectorType::value_type number;
+
+    Assert (tria != 0, ExcNotInitialized());
+    Assert (&dof_handler.get_triangulation() == &*tria,
+            ExcMessage ("The DoF handler must be built on the triangulation "
+                        "passed to reinit()."));
+
+    const unsigned int n_components = dof_handler.get_fe().n_components();
+
+    // find out for which elements we can evaluate the shape functions
+    // without a mapping, as in Functions::FEFieldFunction
+    const hp::FECollection<dim,spacedim> fe_collection (dof_handler.get_fe());
+    std::vector<bool> mapping_independent_values (fe_collection.size());
+    for (unsigned int i=0; i<fe_collection.size(); ++i)
+      {
+        const FEValues<dim,spacedim> fe_values (*mapping, fe_collection[i], QGauss<dim>(1),
+                                                update_values);
+        mapping_independent_values[i] = (fe_values.get_update_flags() == update_values);
+      }
+
+    // evaluate the field at the points we are responsible for
+    std::vector<number> send_buffer (send_offsets.back() * n_components);
+    parallel::apply_to_subranges (0U, static_cast<unsigned int>(evaluation_cells.size()),
+                                  std_cxx11::bind (&RemotePointEvaluation<dim,spacedim>::
+                                                   template evaluate_on_cells<DoFHandlerType,VectorType>,
+                                                   this, &dof_handler, &vector,
+                                                   &mapping_independent_values, &send_buffer,
+                                                   std_cxx11::_1, std_cxx11::_2),
+                                  16);
+
+    // send the values to the processors that asked for them, and receive
+    // the values of our own points
+    std::vector<number> recv_buffer (recv_offsets.back() * n_components);
+    const unsigned int my_rank = Utilities::MPI::this_mpi_process (communicator);
+
+#ifdef DEAL_II_WITH_MPI
+    std::vector<MPI_Request> requests;
+    requests.reserve (send_ranks.size());
+    for (unsigned int k=0; k<send_ranks.size(); ++k)
+      if (send_ranks[k] != my_rank)
+        {
+          requests.push_back (MPI_Request());
+          MPI_Isend (&send_buffer[send_offsets[k]*n_components],
+                     (send_offsets[k+1]-send_offsets[k]) * n_components * sizeof(number),
+                     MPI_BYTE, send_ranks[k], 4004, communicator, &requests.back());
+        }
+
+    for (unsigned int k=0; k<recv_ranks.size(); ++k)
+      if (recv_ranks[k] != my_rank)
+        MPI_Recv (&recv_buffer[recv_offsets[k]*n_components],
+                  (recv_offsets[k+1]-recv_offsets[k]) * n_components * sizeof(number),
+                  MPI_BYTE, recv_ranks[k], 4004, communicator, MPI_STATUS_IGNORE);
+#endif
+
+    const std::vector<unsigned int>::const_iterator
+    send_self = std::find (send_ranks.begin(), send_ranks.end(), my_rank),
+    recv_self = std::find (recv_ranks.begin(), recv_ranks.end(), my_rank);
+    Assert ((send_self == send_ranks.end()) == (recv_self == recv_ranks.end()),
+            ExcInternalError());
+    if (send_self != send_ranks.end())
+      {
+        const unsigned int k_send = send_self - send_ranks.begin(),
+                           k_recv = recv_self - recv_ranks.begin();
+        Assert (send_offsets[k_send+1]-send_offsets[k_send] ==
+                recv_offsets[k_recv+1]-recv_offsets[k_recv],
+                ExcInternalError());
+        std::copy (send_buffer.begin() + send_offsets[k_send]*n_components,
+                   send_buffer.begin() + send_offsets[k_send+1]*n_components,
+                   recv_buffer.begin() + recv_offsets[k_recv]*n_components);
+      }
+
+    values.resize (point_owners.size());
+    for (unsigned int i=0; i<values.size(); ++i)
+      values[i].reinit (n_components);
+    for (unsigned int j=0; j<recv_point_indices.size(); ++j)
+      for (unsigned int c=0; c<n_components; ++c)
+        values[recv_point_indices[j]](c) = recv_buffer[j*n_components+c];
+
+#ifdef DEAL_II_WITH_MPI
+    if (requests.size() > 0)
+      MPI_Waitall (requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+#endif
+  }
+
+
+
+  template <int dim, int spacedim>
+  template <typename DoFHandlerType, typename VectorType>
+  void
+  RemotePointEvaluation<dim,spacedim>::
+  evaluate_on_cells (const DoFHandlerType                           *dof_handler,
+                     const VectorType                               *vector,
+                     const std::vector<bool>                        *mapping_independent_values,
+                     std::vector<typename VectorType::value_type>   *send_buffer,
+                     const unsigned int                              begin,
+                     const unsigned int                              end) const
+  {
+    typedef typename VectorType::value_type number;
+
+    Vector<number> dof_values;
+    for (unsigned int c=begin; c<end; ++c)
+      {
+        const typename DoFHandlerType::active_cell_iterator
+        cell (&*tria, evaluation_cells[c].first, evaluation_cells[c].second,
+              dof_handler);
+        const FiniteElement<dim,spacedim> &fe = cell->get_fe();
+        const unsigned int n_components = fe.n_components();
+        const unsigned int first = evaluation_cell_offsets[c];
+        const unsigned int n_points = evaluation_cell_offsets[c+1] - first;
+
+        // if possible, compute the values directly from the shape functions
+        // at the reference points, in the same order as
+        // FEValues::get_function_values
+        if ((*mapping_independent_values)[cell->active_fe_index()])
+          {
+            dof_values.reinit (fe.dofs_per_cell, true);
+            cell->get_dof_values (*vector, dof_values);
+
+            for (unsigned int q=0; q<n_points; ++q)
+              {
+                const Point<dim> &unit_point = evaluation_reference_points[first+q];
+                number *point_values
+                  = &(*send_buffer)[evaluation_buffer_indices[first+q]*n_components];
+
+                for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+                  {
+                    const number value = dof_values(i);
+                    if (value == number())
+                      continue;
+
+                    if (fe.is_primitive(i))
+                      point_values[fe.system_to_component_index(i).first]
+                      += value * fe.shape_value (i, unit_point);
+                    else
+                      for (unsigned int d=0; d<n_components; ++d)
+                        if (fe.get_nonzero_components(i)[d])
+                          point_values[d] += value * fe.shape_value_component (i, unit_point, d);
+                  }
+              }
+          }
+        else
+          {
+            const std::vector<Point<dim> >
+            unit_points (evaluation_reference_points.begin() + first,
+                         evaluation_reference_points.begin() + first + n_points);
+            const std::vector<double> weights (n_points, 1./n_points);
+            FEValues<dim,spacedim> fe_values (*mapping, fe,
+                                              Quadrature<dim>(unit_points, weights),
+                                              update_values);
+            fe_values.reinit (cell);
+
+            std::vector<Vector<number> > cell_values (n_points, Vector<number>(n_components));
+            fe_values.get_function_values (*vector, cell_values);
+            for (unsigned int q=0; q<n_points; ++q)
+              for (unsigned int d=0; d<n_components; ++d)
+                (*send_buffer)[evaluation_buffer_indices[first+q]*n_components+d]
+                  = cell_values[q](d);
+          }
+      }
+  }
+
+
+
+  template <int dim, int spacedim>
+  unsigned int
+  RemotePointEvaluation<dim,spacedim>::n_points () const
+  {
+    return point_owners.size();
+  }
+
+
+
+  template <int dim, int spacedim>
+  bool
+  RemotePointEvaluation<dim,spacedim>::point_found (const unsigned int i) const
+  {
+    AssertIndexRange (i, point_owners.size());
+    return (point_owners[i] != numbers::invalid_unsigned_int);
+  }
+
+
+
+  template <int dim, int spacedim>
+  bool
+  RemotePointEvaluation<dim,spacedim>::all_points_found () const
+  {
+    return (recv_point_indices.size() == point_owners.size());
+  }
+
+
+
+  template <int dim, int spacedim>
+  unsigned int
+  RemotePointEvaluation<dim,spacedim>::get_point_owner (const unsigned int i) const
+  {
+    AssertIndexRange (i, point_owners.size());
+    return point_owners[i];
+  }
+
+
+
+  template <int dim, int spacedim>
+  unsigned int
+  RemotePointEvaluation<dim,spacedim>::n_evaluation_points () const
+  {
+    return evaluation_reference_points.size();
+  }
+
+
+
+  template <int dim, int spacedim>
+  std::size_t
+  RemotePointEvaluation<dim,spacedim>::memory_consumption () const
+  {
+    return (sizeof(*this) +
+            MemoryConsumption::memory_consumption (point_owners) +
+            MemoryConsumption::memory_consumption (recv_ranks) +
+            MemoryConsumption::memory_consumption (recv_offsets) +
+            MemoryConsumption::memory_consumption (recv_point_indices) +
+            MemoryConsumption::memory_consumption (send_ranks) +
+            MemoryConsumption::memory_consumption (send_offsets) +
+            MemoryConsumption::memory_consumption (evaluation_cells) +
+            MemoryConsumption::memory_consumption (evaluation_cell_offsets) +
+            MemoryConsumption::memory_consumption (evaluation_reference_points) +
+            MemoryConsumption::memory_consumption (evaluation_buffer_indices));
+  }
+}
+
+
+// explicit instantiations
+#include "remote_point_evaluation.inst"
+
+DEAL_II_NAMESPACE_CLOSE
@@ -19,6 +19,9 @@
 #include <deal.II/base/geometry_info.h>
 #include <deal.II/base/utilities.h>
 #include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/std_cxx11/bind.h>
 #include <deal.II/grid/tria.h>
 #include <deal.II/grid/tria_iterator.h>
 #include <deal.II/dofs/dof_handler.h>
@@ -32,6 +35,10 @@
 #include <algorithm>
 #include <numeric>
 
+#ifdef DEAL_II_WITH_THREADS
+#  include <tbb/atomic.h>
+#endif
+
 DEAL_II_NAMESPACE_OPEN
 
 
@@ -46,6 +53,63 @@ namespace internal
       // the following
       using dealii::DoFHandler;
 
+      namespace
+      {
+        /**
+         * The type used to store the position of the first cell adjoining
+         * an object when distributing degrees of freedom with several
+         * threads. Several cells may try to lower this value concurrently, so
+         * it must be updated atomically.
+         */
+#ifdef DEAL_II_WITH_THREADS
+        typedef tbb::atomic<unsigned int> AtomicCellPosition;
+#else
+        typedef unsigned int AtomicCellPosition;
+#endif
+
+        AtomicCellPosition
+        make_atomic_cell_position (const unsigned int position)
+        {
+#ifdef DEAL_II_WITH_THREADS
+          return tbb::make_atomic (position);
+#else
+          return position;
+#endif
+        }
+
+        /**
+         * Set @p target to the minimum of its present value and @p value.
+         */
+        void
+        atomic_min (AtomicCellPosition &target,
+                    const unsigned int  value)
+        {
+#ifdef DEAL_II_WITH_THREADS
+          unsigned int old_value = target;
+          while (value < old_value)
+            {
+              const unsigned int seen_value = target.compare_and_swap (value, old_value);
+              if (seen_value == old_value)
+                break;
+              old_value = seen_value;
+            }
+#else
+          if (value < target)
+            target = value;
+#endif
+        }
+
+        /**
+         * The number of cells, or entries of the arrays of dof indices, that
+         * are worked on by one task in the parallel loops below. Each cell
+         * only involves a few dozen operations, so chunks need to be
+         * reasonably large to amortize the cost of spawning tasks.
+         */
+        const unsigned int cell_grain_size = 512;
+        const unsigned int index_grain_size = 8192;
+      }
+
+
       struct Implementation
       {
 
@@ -220,6 +284,12 @@ namespace internal
           Assert (dof_handler.get_triangulation().n_levels() > 0,
                   ExcMessage("Empty triangulation"));
 
+          // if we can use several threads, use the algorithm that works on
+          // independent chunks of cells. it yields the same numbering as the
+          // loop below
+          if (MultithreadInfo::n_threads() > 1)
+            return distribute_dofs_threaded (offset, subdomain_id, dof_handler);
+
           types::global_dof_index next_free_dof = offset;
           typename DoFHandler<dim,spacedim>::active_cell_iterator
           cell = dof_handler.begin_active(),
@@ -243,6 +313,342 @@ namespace internal
         }
 
 
+        /**
+         * Data shared between the passes of distribute_dofs_threaded(). The
+         * cells are identified by their position in the order in which
+         * active cell iterators traverse the triangulation, i.e., level by
+         * level and within each level by their index. For each vertex, line,
+         * and quad, we store the position of the first cell that adjoins it
+         * and on which we distribute degrees of freedom: this cell is the one
+         * that numbers the degrees of freedom on the object in the sequential
+         * loop. For each cell, we store the number of degrees of freedom it
+         * numbers, and later the first index it assigns.
+         */
+        struct ThreadedDistributionData
+        {
+          std::vector<unsigned int>            first_position_on_level;
+          std::vector<AtomicCellPosition>      vertex_owners;
+          std::vector<AtomicCellPosition>      line_owners;
+          std::vector<AtomicCellPosition>      quad_owners;
+          std::vector<types::global_dof_index> cell_dof_offsets;
+        };
+
+
+        /**
+         * Return whether degrees of freedom are distributed on the given
+         * cell, i.e., whether it is active and either all cells or only the
+         * ones with the given subdomain id are considered.
+         */
+        template <typename CellIterator>
+        static
+        bool
+        distributes_dofs (const CellIterator           &cell,
+                          const types::subdomain_id     subdomain_id)
+        {
+          return (cell->used()
+                  &&
+                  cell->active()
+                  &&
+                  ((subdomain_id == numbers::invalid_subdomain_id)
+                   ||
+                   (cell->subdomain_id() == subdomain_id)));
+        }
+
+
+        /**
+         * First pass of distribute_dofs_threaded(): for the cells with
+         * indices in the range [begin,end) on the given level, record the
+         * cell as owner of all its vertices, lines, and quads unless a cell
+         * earlier in the order of traversal also adjoins the object.
+         */
+        template <int dim, int spacedim>
+        static
+        void
+        find_owners_on_subrange (const DoFHandler<dim,spacedim> *dof_handler,
+                                 const types::subdomain_id       subdomain_id,
+                                 const unsigned int              level,
+                                 ThreadedDistributionData       *data,
+                                 const unsigned int              begin,
+                                 const unsigned int              end)
+        {
+          const FiniteElement<dim,spacedim> &fe = dof_handler->get_fe();
+          for (unsigned int index=begin; index<end; ++index)
+            {
+              const TriaRawIterator<dealii::DoFCellAccessor<DoFHandler<dim,spacedim>,false> >
+              cell (&dof_handler->get_triangulation(), level, index, dof_handler);
+              if (!distributes_dofs (cell, subdomain_id))
+                continue;
+
+              const unsigned int position = data->first_position_on_level[level] + index;
+              if (fe.dofs_per_vertex > 0)
+                for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+                  atomic_min (data->vertex_owners[cell->vertex_index(v)], position);
+              if (dim > 1 && fe.dofs_per_line > 0)
+                for (unsigned int l=0; l<GeometryInfo<dim>::lines_per_cell; ++l)
+                  atomic_min (data->line_owners[cell->line_index(l)], position);
+              if (dim > 2 && fe.dofs_per_quad > 0)
+                for (unsigned int q=0; q<GeometryInfo<dim>::quads_per_cell; ++q)
+                  atomic_min (data->quad_owners[cell->quad_index(q)], position);
+            }
+        }
+
+
+        /**
+         * Second pass of distribute_dofs_threaded(): count the degrees of
+         * freedom that each of the cells with indices in the range
+         * [begin,end) on the given level numbers, i.e., the ones on the
+         * objects it owns and the ones in its interior.
+         */
+        template <int dim, int spacedim>
+        static
+        void
+        count_dofs_on_subrange (const DoFHandler<dim,spacedim> *dof_handler,
+                                const types::subdomain_id       subdomain_id,
+                                const unsigned int              level,
+                                ThreadedDistributionData       *data,
+                                const unsigned int              begin,
+                                const unsigned int              end)
+        {
+          const FiniteElement<dim,spacedim> &fe = dof_handler->get_fe();
+          for (unsigned int index=begin; index<end; ++index)
+            {
+              const TriaRawIterator<dealii::DoFCellAccessor<DoFHandler<dim,spacedim>,false> >
+              cell (&dof_handler->get_triangulation(), level, index, dof_handler);
+              const unsigned int position = data->first_position_on_level[level] + index;
+              data->cell_dof_offsets[position] = 0;
+              if (!distributes_dofs (cell, subdomain_id))
+                continue;
+
+              types::global_dof_index n_dofs = fe.template n_dofs_per_object<dim>();
+              if (fe.dofs_per_vertex > 0)
+                for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+                  if (data->vertex_owners[cell->vertex_index(v)] == position)
+                    n_dofs += fe.dofs_per_vertex;
+              if (dim > 1 && fe.dofs_per_line > 0)
+                for (unsigned int l=0; l<GeometryInfo<dim>::lines_per_cell; ++l)
+                  if (data->line_owners[cell->line_index(l)] == position)
+                    n_dofs += fe.dofs_per_line;
+              if (dim > 2 && fe.dofs_per_quad > 0)
+                for (unsigned int q=0; q<GeometryInfo<dim>::quads_per_cell; ++q)
+                  if (data->quad_owners[cell->quad_index(q)] == position)
+                    n_dofs += fe.dofs_per_quad;
+              data->cell_dof_offsets[position] = n_dofs;
+            }
+        }
+
+
+        /**
+         * Number the degrees of freedom on the quad with the given number of
+         * a cell, starting at @p next_free_dof, and return the next unused
+         * index. Quads are only separate objects in 3d, so the general
+         * template can not be called.
+         */
+        template <int dim, int spacedim>
+        static
+        types::global_dof_index
+        distribute_dofs_on_quad (const TriaRawIterator<dealii::DoFCellAccessor<DoFHandler<dim,spacedim>,false> > &,
+                                 const unsigned int,
+                                 const unsigned int,
+                                 const types::global_dof_index next_free_dof)
+        {
+          Assert (false, ExcImpossibleInDim(dim));
+          return next_free_dof;
+        }
+
+
+        template <int spacedim>
+        static
+        types::global_dof_index
+        distribute_dofs_on_quad (const TriaRawIterator<dealii::DoFCellAccessor<DoFHandler<3,spacedim>,false> > &cell,
+                                 const unsigned int            quad,
+                                 const unsigned int            dofs_per_quad,
+                                 types::global_dof_index       next_free_dof)
+        {
+          const typename DoFHandler<3,spacedim>::quad_iterator
+          quad_iterator = cell->quad(quad);
+          for (unsigned int d=0; d<dofs_per_quad; ++d)
+            quad_iterator->set_dof_index (d, next_free_dof++);
+          return next_free_dof;
+        }
+
+
+        /**
+         * Third pass of distribute_dofs_threaded(): number the degrees of
+         * freedom on the objects owned by the cells with indices in the
+         * range [begin,end) on the given level, starting at the index
+         * computed for each cell, in the same order as
+         * distribute_dofs_on_cell() does. Since every object is numbered by
+         * exactly one cell, the cells can be processed in any order.
+         */
+        template <int dim, int spacedim>
+        static
+        void
+        assign_dofs_on_subrange (const DoFHandler<dim,spacedim> *dof_handler,
+                                 const types::subdomain_id       subdomain_id,
+                                 const unsigned int              level,
+                                 const ThreadedDistributionData *data,
+                                 const unsigned int              begin,
+                                 const unsigned int              end)
+        {
+          const FiniteElement<dim,spacedim> &fe = dof_handler->get_fe();
+          for (unsigned int index=begin; index<end; ++index)
+            {
+              const TriaRawIterator<dealii::DoFCellAccessor<DoFHandler<dim,spacedim>,false> >
+              cell (&dof_handler->get_triangulation(), level, index, dof_handler);
+              if (!distributes_dofs (cell, subdomain_id))
+                continue;
+
+              const unsigned int position = data->first_position_on_level[level] + index;
+              types::global_dof_index next_free_dof = data->cell_dof_offsets[position];
+
+              if (fe.dofs_per_vertex > 0)
+                for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+                  if (data->vertex_owners[cell->vertex_index(v)] == position)
+                    for (unsigned int d=0; d<fe.dofs_per_vertex; ++d)
+                      cell->set_vertex_dof_index (v, d, next_free_dof++);
+              if (dim > 1 && fe.dofs_per_line > 0)
+                for (unsigned int l=0; l<GeometryInfo<dim>::lines_per_cell; ++l)
+                  if (data->line_owners[cell->line_index(l)] == position)
+                    for (unsigned int d=0; d<fe.dofs_per_line; ++d)
+                      cell->line(l)->set_dof_index (d, next_free_dof++);
+              if (dim > 2 && fe.dofs_per_quad > 0)
+                for (unsigned int q=0; q<GeometryInfo<dim>::quads_per_cell; ++q)
+                  if (data->quad_owners[cell->quad_index(q)] == position)
+                    next_free_dof = distribute_dofs_on_quad (cell, q, fe.dofs_per_quad,
+                                                             next_free_dof);
+              for (unsigned int d=0; d<fe.template n_dofs_per_object<dim>(); ++d)
+                cell->set_dof_index (d, next_free_dof++);
+
+              Assert (next_free_dof == data->cell_dof_offsets[position+1],
+                      ExcInternalError());
+            }
+        }
+
+
+        /**
+         * Update the cache of dof indices for the cells with indices in the
+         * range [begin,end) on the given level. If the last argument is
+         * true, only active cells that are not artificial are considered,
+         * otherwise all used cells.
+         */
+        template <int dim, int spacedim>
+        static
+        void
+        update_cell_dof_indices_cache_on_subrange (const DoFHandler<dim,spacedim> *dof_handler,
+                                                   const unsigned int              level,
+                                                   const bool                      active_only,
+                                                   const unsigned int              begin,
+                                                   const unsigned int              end)
+        {
+          for (unsigned int index=begin; index<end; ++index)
+            {
+              const TriaRawIterator<dealii::DoFCellAccessor<DoFHandler<dim,spacedim>,false> >
+              cell (&dof_handler->get_triangulation(), level, index, dof_handler);
+              if (cell->used()
+                  &&
+                  (!active_only || (cell->active() && !cell->is_artificial())))
+                cell->update_cell_dof_indices_cache ();
+            }
+        }
+
+
+        /**
+         * Update the cache of dof indices on all levels, splitting the cells
+         * of each level into chunks that are processed in parallel.
+         */
+        template <int dim, int spacedim>
+        static
+        void
+        update_cell_dof_indices_caches (const DoFHandler<dim,spacedim> &dof_handler,
+                                        const bool                      active_only)
+        {
+          const dealii::Triangulation<dim,spacedim> &tria
+            = dof_handler.get_triangulation();
+          for (unsigned int level=0; level<tria.n_levels(); ++level)
+            parallel::apply_to_subranges (0U, tria.n_raw_cells(level),
+                                          std_cxx11::bind (&update_cell_dof_indices_cache_on_subrange<dim,spacedim>,
+                                                           &dof_handler, level, active_only,
+                                                           std_cxx11::_1, std_cxx11::_2),
+                                          cell_grain_size);
+        }
+
+
+        /**
+         * Same as distribute_dofs(), but with the cells split into chunks
+         * that are processed in parallel. The numbering is identical to the
+         * one of the sequential loop over cells: a cell numbers the degrees
+         * of freedom on a vertex, line, or quad if it is the first cell in
+         * the order of traversal that adjoins the object. We first determine
+         * these owners, then count the degrees of freedom each cell numbers,
+         * compute the first index of each cell as a prefix sum over these
+         * counts, and finally let all cells number their objects
+         * independently.
+         */
+        template <int dim, int spacedim>
+        static
+        types::global_dof_index
+        distribute_dofs_threaded (const types::global_dof_index offset,
+                                  const types::subdomain_id     subdomain_id,
+                                  DoFHandler<dim,spacedim>     &dof_handler)
+        {
+          const dealii::Triangulation<dim,spacedim> &tria
+            = dof_handler.get_triangulation();
+
+          ThreadedDistributionData data;
+          data.first_position_on_level.resize (tria.n_levels()+1, 0);
+          for (unsigned int level=0; level<tria.n_levels(); ++level)
+            data.first_position_on_level[level+1]
+              = data.first_position_on_level[level] + tria.n_raw_cells(level);
+          const unsigned int n_positions = data.first_position_on_level.back();
+
+          const AtomicCellPosition no_owner = make_atomic_cell_position (numbers::invalid_unsigned_int);
+          data.vertex_owners.resize (tria.n_vertices(), no_owner);
+          if (dim > 1)
+            data.line_owners.resize (tria.n_raw_lines(), no_owner);
+          if (dim > 2)
+            data.quad_owners.resize (tria.n_raw_quads(), no_owner);
+          data.cell_dof_offsets.resize (n_positions+1, 0);
+
+          for (unsigned int level=0; level<tria.n_levels(); ++level)
+            parallel::apply_to_subranges (0U, tria.n_raw_cells(level),
+                                          std_cxx11::bind (&find_owners_on_subrange<dim,spacedim>,
+                                                           &dof_handler, subdomain_id, level, &data,
+                                                           std_cxx11::_1, std_cxx11::_2),
+                                          cell_grain_size);
+
+          for (unsigned int level=0; level<tria.n_levels(); ++level)
+            parallel::apply_to_subranges (0U, tria.n_raw_cells(level),
+                                          std_cxx11::bind (&count_dofs_on_subrange<dim,spacedim>,
+                                                           &dof_handler, subdomain_id, level, &data,
+                                                           std_cxx11::_1, std_cxx11::_2),
+                                          cell_grain_size);
+
+          // convert the counts into the first index of each cell. this is a
+          // single sweep over an array of integers and cheap compared to the
+          // other passes
+          types::global_dof_index next_free_dof = offset;
+          for (unsigned int position=0; position<n_positions; ++position)
+            {
+              const types::global_dof_index n_dofs_on_cell = data.cell_dof_offsets[position];
+              data.cell_dof_offsets[position] = next_free_dof;
+              next_free_dof += n_dofs_on_cell;
+            }
+          data.cell_dof_offsets[n_positions] = next_free_dof;
+
+          for (unsigned int level=0; level<tria.n_levels(); ++level)
+            parallel::apply_to_subranges (0U, tria.n_raw_cells(level),
+                                          std_cxx11::bind (&assign_dofs_on_subrange<dim,spacedim>,
+                                                           &dof_handler, subdomain_id, level,
+                                                           static_cast<const ThreadedDistributionData *>(&data),
+                                                           std_cxx11::_1, std_cxx11::_2),
+                                          cell_grain_size);
+
+          update_cell_dof_indices_caches (dof_handler, true);
+
+          return next_free_dof;
+        }
+
+
         /**
          * Distribute dofs on the given
          * cell, with new dofs starting
@@ -489,6 +895,74 @@ namespace internal
         /* --------------------- renumber_dofs functionality ---------------- */
 
 
+        /**
+         * Replace the dof indices with indices in the range [begin,end) of
+         * the given array by their new numbers. Invalid indices, i.e., ones
+         * of unused objects, are left untouched. See renumber_dofs() for
+         * the meaning of the second argument.
+         */
+        static
+        void
+        renumber_dof_indices_on_subrange (const std::vector<types::global_dof_index> *new_numbers,
+                                          const IndexSet                             *indices,
+                                          std::vector<types::global_dof_index>       *dof_indices,
+                                          const std::size_t                           begin,
+                                          const std::size_t                           end)
+        {
+          if (indices->n_elements() == 0)
+            {
+              for (std::size_t i=begin; i<end; ++i)
+                if ((*dof_indices)[i] != numbers::invalid_dof_index)
+                  (*dof_indices)[i] = (*new_numbers)[(*dof_indices)[i]];
+            }
+          else
+            {
+              for (std::size_t i=begin; i<end; ++i)
+                if ((*dof_indices)[i] != numbers::invalid_dof_index)
+                  (*dof_indices)[i] = (*new_numbers)[indices->index_within_set((*dof_indices)[i])];
+            }
+        }
+
+
+        /**
+         * Replace all dof indices in the given array by their new numbers,
+         * working on chunks of the array in parallel.
+         */
+        static
+        void
+        renumber_dof_indices (const std::vector<types::global_dof_index> &new_numbers,
+                              const IndexSet                             &indices,
+                              std::vector<types::global_dof_index>       &dof_indices)
+        {
+          parallel::apply_to_subranges (std::size_t(0), dof_indices.size(),
+                                        std_cxx11::bind (&renumber_dof_indices_on_subrange,
+                                                         &new_numbers, &indices, &dof_indices,
+                                                         std_cxx11::_1, std_cxx11::_2),
+                                        index_grain_size);
+        }
+
+
+        /**
+         * Check that the dof indices on the vertices of the given DoFHandler
+         * are only invalid for unused vertices.
+         */
+        template <int dim, int spacedim>
+        static
+        void
+        check_vertex_dof_indices (const DoFHandler<dim,spacedim> &dof_handler)
+        {
+          (void)dof_handler;
+#ifdef DEBUG
+          for (std::size_t i=0; i<dof_handler.vertex_dofs.size(); ++i)
+            if (dof_handler.vertex_dofs[i] == DoFHandler<dim,spacedim>::invalid_dof_index)
+              Assert (dof_handler.get_triangulation()
+                      .vertex_used(i / dof_handler.selected_fe->dofs_per_vertex)
+                      == false,
+                      ExcInternalError ());
+#endif
+        }
+
+
         /**
          * Implementation of the
          * general template of same
@@ -519,40 +993,26 @@ namespace internal
           // the interface of two cells more
           // than once. Anyway, this way it's
           // not only more correct but also
-          // faster; note, however, that dof
-          // numbers may be invalid_dof_index,
-          // namely when the appropriate
+          // faster, in particular since the
+          // arrays can be split into chunks
+          // that are worked on in parallel;
+          // note, however, that dof numbers
+          // may be invalid_dof_index, namely
+          // when the appropriate
           // vertex/line/etc is unused
-          for (std::vector<types::global_dof_index>::iterator
-               i=dof_handler.vertex_dofs.begin();
-               i!=dof_handler.vertex_dofs.end(); ++i)
-            if (*i != DoFHandler<1,spacedim>::invalid_dof_index)
-              *i = new_numbers[*i];
-            else if (check_validity)
-              // if index is
-              // invalid_dof_index:
-              // check if this one
-              // really is unused
-              Assert (dof_handler.get_triangulation()
-                      .vertex_used((i-dof_handler.vertex_dofs.begin()) /
-                                   dof_handler.selected_fe->dofs_per_vertex)
-                      == false,
-                      ExcInternalError ());
+          if (check_validity)
+            check_vertex_dof_indices (dof_handler);
+
+          renumber_dof_indices (new_numbers, IndexSet(0), dof_handler.vertex_dofs);
 
           for (unsigned int level=0; level<dof_handler.levels.size(); ++level)
-            for (std::vector<types::global_dof_index>::iterator
-                 i=dof_handler.levels[level]->dof_object.dofs.begin();
-                 i!=dof_handler.levels[level]->dof_object.dofs.end(); ++i)
-              if (*i != DoFHandler<1,spacedim>::invalid_dof_index)
-                *i = new_numbers[*i];
+            renumber_dof_indices (new_numbers, IndexSet(0),
+                                  dof_handler.levels[level]->dof_object.dofs);
 
           // update the cache
           // used for cell dof
           // indices
-          for (typename DoFHandler<1,spacedim>::level_cell_iterator
-               cell = dof_handler.begin();
-               cell != dof_handler.end(); ++cell)
-            cell->update_cell_dof_indices_cache ();
+          update_cell_dof_indices_caches (dof_handler, false);
         }
 
         template <int spacedim>
@@ -616,53 +1076,28 @@ namespace internal
           // the interface of two cells more
           // than once. Anyway, this way it's
           // not only more correct but also
-          // faster; note, however, that dof
-          // numbers may be invalid_dof_index,
-          // namely when the appropriate
+          // faster, in particular since the
+          // arrays can be split into chunks
+          // that are worked on in parallel;
+          // note, however, that dof numbers
+          // may be invalid_dof_index, namely
+          // when the appropriate
           // vertex/line/etc is unused
-          for (std::vector<types::global_dof_index>::iterator
-               i=dof_handler.vertex_dofs.begin();
-               i!=dof_handler.vertex_dofs.end(); ++i)
-            if (*i != DoFHandler<2,spacedim>::invalid_dof_index)
-              *i = (indices.n_elements() == 0)?
-                   (new_numbers[*i]) :
-                   (new_numbers[indices.index_within_set(*i)]);
-            else if (check_validity)
-              // if index is invalid_dof_index:
-              // check if this one really is
-              // unused
-              Assert (dof_handler.get_triangulation()
-                      .vertex_used((i-dof_handler.vertex_dofs.begin()) /
-                                   dof_handler.selected_fe->dofs_per_vertex)
-                      == false,
-                      ExcInternalError ());
+          if (check_validity)
+            check_vertex_dof_indices (dof_handler);
 
-          for (std::vector<types::global_dof_index>::iterator
-               i=dof_handler.faces->lines.dofs.begin();
-               i!=dof_handler.faces->lines.dofs.end(); ++i)
-            if (*i != DoFHandler<2,spacedim>::invalid_dof_index)
-              *i = ((indices.n_elements() == 0) ?
-                    new_numbers[*i] :
-                    new_numbers[indices.index_within_set(*i)]);
+          renumber_dof_indices (new_numbers, indices, dof_handler.vertex_dofs);
+
+          renumber_dof_indices (new_numbers, indices, dof_handler.faces->lines.dofs);
 
           for (unsigned int level=0; level<dof_handler.levels.size(); ++level)
-            {
-              for (std::vector<types::global_dof_index>::iterator
-                   i=dof_handler.levels[level]->dof_object.dofs.begin();
-                   i!=dof_handler.levels[level]->dof_object.dofs.end(); ++i)
-                if (*i != DoFHandler<2,spacedim>::invalid_dof_index)
-                  *i = ((indices.n_elements() == 0) ?
-                        new_numbers[*i] :
-                        new_numbers[indices.index_within_set(*i)]);
-            }
+            renumber_dof_indices (new_numbers, indices,
+                                  dof_handler.levels[level]->dof_object.dofs);
 
           // update the cache
           // used for cell dof
           // indices
-          for (typename DoFHandler<2,spacedim>::level_cell_iterator
-               cell = dof_handler.begin();
-               cell != dof_handler.end(); ++cell)
-            cell->update_cell_dof_indices_cache ();
+          update_cell_dof_indices_caches (dof_handler, false);
         }
 
         template <int spacedim>
@@ -762,60 +1197,29 @@ namespace internal
           // the interface of two cells more
           // than once. Anyway, this way it's
           // not only more correct but also
-          // faster; note, however, that dof
-          // numbers may be invalid_dof_index,
-          // namely when the appropriate
+          // faster, in particular since the
+          // arrays can be split into chunks
+          // that are worked on in parallel;
+          // note, however, that dof numbers
+          // may be invalid_dof_index, namely
+          // when the appropriate
           // vertex/line/etc is unused
-          for (std::vector<types::global_dof_index>::iterator
-               i=dof_handler.vertex_dofs.begin();
-               i!=dof_handler.vertex_dofs.end(); ++i)
-            if (*i != DoFHandler<3,spacedim>::invalid_dof_index)
-              *i = ((indices.n_elements() == 0) ?
-                    new_numbers[*i] :
-                    new_numbers[indices.index_within_set(*i)]);
-            else if (check_validity)
-              // if index is invalid_dof_index:
-              // check if this one really is
-              // unused
-              Assert (dof_handler.get_triangulation()
-                      .vertex_used((i-dof_handler.vertex_dofs.begin()) /
-                                   dof_handler.selected_fe->dofs_per_vertex)
-                      == false,
-                      ExcInternalError ());
+          if (check_validity)
+            check_vertex_dof_indices (dof_handler);
 
-          for (std::vector<types::global_dof_index>::iterator
-               i=dof_handler.faces->lines.dofs.begin();
-               i!=dof_handler.faces->lines.dofs.end(); ++i)
-            if (*i != DoFHandler<3,spacedim>::invalid_dof_index)
-              *i = ((indices.n_elements() == 0) ?
-                    new_numbers[*i] :
-                    new_numbers[indices.index_within_set(*i)]);
-          for (std::vector<types::global_dof_index>::iterator
-               i=dof_handler.faces->quads.dofs.begin();
-               i!=dof_handler.faces->quads.dofs.end(); ++i)
-            if (*i != DoFHandler<3,spacedim>::invalid_dof_index)
-              *i = ((indices.n_elements() == 0) ?
-                    new_numbers[*i] :
-                    new_numbers[indices.index_within_set(*i)]);
+          renumber_dof_indices (new_numbers, indices, dof_handler.vertex_dofs);
+
+          renumber_dof_indices (new_numbers, indices, dof_handler.faces->lines.dofs);
+          renumber_dof_indices (new_numbers, indices, dof_handler.faces->quads.dofs);
 
           for (unsigned int level=0; level<dof_handler.levels.size(); ++level)
-            {
-              for (std::vector<types::global_dof_index>::iterator
-                   i=dof_handler.levels[level]->dof_object.dofs.begin();
-                   i!=dof_handler.levels[level]->dof_object.dofs.end(); ++i)
-                if (*i != DoFHandler<3,spacedim>::invalid_dof_index)
-                  *i = ((indices.n_elements() == 0) ?
-                        new_numbers[*i] :
-                        new_numbers[indices.index_within_set(*i)]);
-            }
+            renumber_dof_indices (new_numbers, indices,
+                                  dof_handler.levels[level]->dof_object.dofs);
 
           // update the cache
           // used for cell dof
           // indices
-          for (typename DoFHandler<3,spacedim>::level_cell_iterator
-               cell = dof_handler.begin();
-               cell != dof_handler.end(); ++cell)
-            cell->update_cell_dof_indices_cache ();
+          update_cell_dof_indices_caches (dof_handler, false);
         }
 
         template <int spacedim>
@@ -37,6 +37,8 @@
 #include <deal.II/hp/fe_collection.h>
 #include <deal.II/hp/fe_values.h>
 
+#include <deal.II/matrix_free/matrix_free.h>
+
 #include <deal.II/multigrid/mg_tools.h>
 
 #include <deal.II/distributed/tria.h>
@@ -1255,6 +1257,141 @@ namespace DoFRenumbering
 
 
 
+  namespace
+  {
+    // helper function for compute_space_filling_curve() and
+    // compute_matrix_free_data_locality(): number the locally owned degrees
+    // of freedom in the order in which they are first encountered on the
+    // given active cells, which must include all locally owned cells
+    template <typename DoFHandlerType, class iterator>
+    void
+    compute_locally_owned_cell_wise (std::vector<types::global_dof_index> &new_indices,
+                                     const DoFHandlerType                 &dof_handler,
+                                     const std::vector<iterator>          &cells)
+    {
+      const IndexSet locally_owned = dof_handler.locally_owned_dofs();
+      new_indices.resize (locally_owned.n_elements());
+      std::fill (new_indices.begin(), new_indices.end(),
+                 numbers::invalid_dof_index);
+
+      types::global_dof_index next_free = 0;
+      std::vector<types::global_dof_index> local_dof_indices;
+      for (unsigned int c=0; c<cells.size(); ++c)
+        {
+          local_dof_indices.resize (cells[c]->get_fe().dofs_per_cell);
+          cells[c]->get_dof_indices (local_dof_indices);
+
+          // keep the relative order of the degrees of freedom first
+          // encountered on this cell
+          std::sort (local_dof_indices.begin(), local_dof_indices.end());
+
+          for (unsigned int i=0; i<local_dof_indices.size(); ++i)
+            if (locally_owned.is_element (local_dof_indices[i]))
+              {
+                const types::global_dof_index idx
+                  = locally_owned.index_within_set (local_dof_indices[i]);
+                if (new_indices[idx] == numbers::invalid_dof_index)
+                  {
+                    new_indices[idx] = locally_owned.nth_index_in_set (next_free);
+                    ++next_free;
+                  }
+              }
+        }
+
+      Assert (next_free == locally_owned.n_elements(),
+              ExcRenumberingIncomplete());
+    }
+  }
+
+
+
+  template <typename DoFHandlerType>
+  void
+  space_filling_curve (DoFHandlerType                   &dof_handler,
+                       const GridTools::SpaceFillingCurve curve)
+  {
+    std::vector<types::global_dof_index> renumbering;
+    compute_space_filling_curve (renumbering, dof_handler, curve);
+
+    dof_handler.renumber_dofs (renumbering);
+  }
+
+
+
+  template <typename DoFHandlerType>
+  void
+  compute_space_filling_curve (std::vector<types::global_dof_index> &new_indices,
+                               const DoFHandlerType                 &dof_handler,
+                               const GridTools::SpaceFillingCurve    curve)
+  {
+    std::vector<typename DoFHandlerType::active_cell_iterator> cells;
+    std::vector<Point<DoFHandlerType::space_dimension> > centers;
+    for (typename DoFHandlerType::active_cell_iterator
+         cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+      if (cell->is_locally_owned())
+        {
+          cells.push_back (cell);
+          centers.push_back (cell->center());
+        }
+
+    const std::vector<unsigned int> order
+      = GridTools::compute_space_filling_curve_order (centers, curve);
+
+    std::vector<typename DoFHandlerType::active_cell_iterator> ordered_cells (cells.size());
+    for (unsigned int c=0; c<cells.size(); ++c)
+      ordered_cells[c] = cells[order[c]];
+
+    compute_locally_owned_cell_wise (new_indices, dof_handler, ordered_cells);
+  }
+
+
+
+  template <int dim, typename Number>
+  void
+  matrix_free_data_locality (DoFHandler<dim>               &dof_handler,
+                             const MatrixFree<dim,Number>  &matrix_free)
+  {
+    std::vector<types::global_dof_index> renumbering;
+    compute_matrix_free_data_locality (renumbering, dof_handler, matrix_free);
+
+    dof_handler.renumber_dofs (renumbering);
+  }
+
+
+
+  template <int dim, typename Number>
+  void
+  compute_matrix_free_data_locality (std::vector<types::global_dof_index> &new_indices,
+                                     const DoFHandler<dim>                &dof_handler,
+                                     const MatrixFree<dim,Number>         &matrix_free)
+  {
+    // find out which of the DoF handlers of the matrix-free object this is
+    unsigned int dof_index = 0;
+    while (dof_index < matrix_free.n_components() &&
+           &matrix_free.get_dof_handler (dof_index) != &dof_handler)
+      ++dof_index;
+    AssertThrow (dof_index < matrix_free.n_components(),
+                 ExcMessage ("The MatrixFree object must have been initialized "
+                             "with the given DoFHandler."));
+
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+    cells.reserve (matrix_free.n_physical_cells());
+    for (unsigned int macro_cell=0; macro_cell<matrix_free.n_macro_cells(); ++macro_cell)
+      for (unsigned int v=0; v<matrix_free.n_components_filled (macro_cell); ++v)
+        {
+          const typename DoFHandler<dim>::cell_iterator
+          cell = matrix_free.get_cell_iterator (macro_cell, v, dof_index);
+          Assert (cell->active(),
+                  ExcMessage ("This function only works for MatrixFree objects "
+                              "set up on the active cells."));
+          cells.push_back (cell);
+        }
+
+    compute_locally_owned_cell_wise (new_indices, dof_handler, cells);
+  }
+
+
+
   template <typename DoFHandlerType>
   void
   sort_selected_dofs_back (DoFHandlerType          &dof_handler,
@@ -1,6 +1,6 @@
 // ---------------------------------------------------------------------
 //
-// Copyright (C) 1999 - 2015 by the deal.II authors
+// Copyright (C) 1999 - 2016 by the deal.II authors
 //
 // This file is part of the deal.II library.
 //
@@ -14,6 +14,9 @@
 // ---------------------------------------------------------------------
 
 #include <deal.II/base/thread_management.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/std_cxx11/bind.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/table.h>
 #include <deal.II/base/template_constraints.h>
@@ -49,6 +52,291 @@ DEAL_II_NAMESPACE_OPEN
 
 namespace DoFTools
 {
+  namespace internal
+  {
+    namespace
+    {
+      /**
+       * The minimal number of cells for which it is worth filling a separate
+       * sparsity pattern on a thread of its own.
+       */
+      const unsigned int min_cells_per_task = 256;
+
+
+      /**
+       * Return the locally owned cells, restricted to the given subdomain
+       * unless it is numbers::invalid_subdomain_id, in the order in which
+       * make_sparsity_pattern() works on them.
+       */
+      template <typename DoFHandlerType>
+      std::vector<typename DoFHandlerType::active_cell_iterator>
+      get_cells_for_sparsity_pattern (const DoFHandlerType      &dof,
+                                      const types::subdomain_id  subdomain_id)
+      {
+        std::vector<typename DoFHandlerType::active_cell_iterator> cells;
+        cells.reserve (dof.get_triangulation().n_active_cells());
+        for (typename DoFHandlerType::active_cell_iterator cell = dof.begin_active();
+             cell != dof.end(); ++cell)
+          if (((subdomain_id == numbers::invalid_subdomain_id)
+               ||
+               (subdomain_id == cell->subdomain_id()))
+              &&
+              cell->is_locally_owned())
+            cells.push_back (cell);
+        return cells;
+      }
+
+
+      /**
+       * Fill @p sparsity with the entries that the cells in the range
+       * <tt>[begin,end)</tt> generate, as make_sparsity_pattern() does for
+       * all cells. If @p dof_masks is not empty, it contains the couplings of
+       * the degrees of freedom of each element of the finite element
+       * collection.
+       *
+       * The sparsity pattern is first set up to store only the rows these
+       * cells (or the degrees of freedom they are constrained to) write into,
+       * which keeps memory consumption proportional to the number of cells
+       * rather than to the total number of degrees of freedom.
+       */
+      template <typename DoFHandlerType>
+      void
+      make_sparsity_pattern_on_cell_range
+      (const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator begin,
+       const typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator end,
+       const ConstraintMatrix              &constraints,
+       const bool                           keep_constrained_dofs,
+       const std::vector<Table<2,bool> >   &dof_masks,
+       DynamicSparsityPattern              &sparsity)
+      {
+        typedef typename std::vector<typename DoFHandlerType::active_cell_iterator>::const_iterator
+        cell_iterator;
+
+        if (begin == end)
+          return;
+
+        const types::global_dof_index n_dofs = (*begin)->get_dof_handler().n_dofs();
+        std::vector<types::global_dof_index> dofs_on_this_cell;
+
+        // find the rows that we may write into. only store these rows, not
+        // the whole range between the smallest and the largest one: with a
+        // mesh-independent numbering of the degrees of freedom, a chunk of
+        // cells may touch rows all over the index space, and storing the
+        // range would then mean storing nearly all rows in every chunk
+        std::vector<types::global_dof_index> rows_touched;
+        for (cell_iterator cell=begin; cell!=end; ++cell)
+          {
+            dofs_on_this_cell.resize ((*cell)->get_fe().dofs_per_cell);
+            (*cell)->get_dof_indices (dofs_on_this_cell);
+            for (unsigned int i=0; i<dofs_on_this_cell.size(); ++i)
+              {
+                rows_touched.push_back (dofs_on_this_cell[i]);
+
+                const std::vector<std::pair<types::global_dof_index,double> > *
+                entries = constraints.get_constraint_entries (dofs_on_this_cell[i]);
+                if (entries != 0)
+                  for (unsigned int j=0; j<entries->size(); ++j)
+                    rows_touched.push_back ((*entries)[j].first);
+              }
+          }
+
+        if (rows_touched.size() == 0)
+          return;
+
+        std::sort (rows_touched.begin(), rows_touched.end());
+        rows_touched.erase (std::unique (rows_touched.begin(), rows_touched.end()),
+                            rows_touched.end());
+        IndexSet rows (n_dofs);
+        rows.add_indices (rows_touched.begin(), rows_touched.end());
+        rows.compress ();
+        std::vector<types::global_dof_index>().swap (rows_touched);
+
+        sparsity.reinit (n_dofs, n_dofs, rows);
+
+        for (cell_iterator cell=begin; cell!=end; ++cell)
+          {
+            dofs_on_this_cell.resize ((*cell)->get_fe().dofs_per_cell);
+            (*cell)->get_dof_indices (dofs_on_this_cell);
+
+            if (dof_masks.size() == 0)
+              constraints.add_entries_local_to_global (dofs_on_this_cell,
+                                                       sparsity,
+                                                       keep_constrained_dofs);
+            else
+              constraints.add_entries_local_to_global (dofs_on_this_cell,
+                                                       sparsity,
+                                                       keep_constrained_dofs,
+                                                       dof_masks[(*cell)->active_fe_index()]);
+          }
+      }
+
+
+      /**
+       * Split the given cells into chunks and fill one sparsity pattern for
+       * each chunk, working on the chunks in parallel.
+       */
+      template <typename DoFHandlerType>
+      void
+      make_sparsity_patterns_on_chunks
+      (const std::vector<typename DoFHandlerType::active_cell_iterator> &cells,
+       const ConstraintMatrix              &constraints,
+       const bool                           keep_constrained_dofs,
+       const std::vector<Table<2,bool> >   &dof_masks,
+       std::vector<DynamicSparsityPattern> &chunk_sparsities)
+      {
+        const unsigned int n_chunks
+          = std::max (1U,
+                      std::min (MultithreadInfo::n_threads(),
+                                static_cast<unsigned int>(cells.size() / min_cells_per_task)));
+        chunk_sparsities.clear ();
+        chunk_sparsities.resize (n_chunks);
+
+        Threads::TaskGroup<> tasks;
+        for (unsigned int c=0; c<n_chunks; ++c)
+          tasks += Threads::new_task (&make_sparsity_pattern_on_cell_range<DoFHandlerType>,
+                                      cells.begin() + cells.size()*c/n_chunks,
+                                      cells.begin() + cells.size()*(c+1)/n_chunks,
+                                      constraints,
+                                      keep_constrained_dofs,
+                                      dof_masks,
+                                      chunk_sparsities[c]);
+        tasks.join_all ();
+      }
+
+
+      /**
+       * For sparsity pattern types other than DynamicSparsityPattern, we can
+       * not add entries from several threads, so let the caller fill the
+       * sparsity pattern sequentially.
+       */
+      template <typename DoFHandlerType, typename SparsityPatternType>
+      bool
+      make_sparsity_pattern_in_parallel (const DoFHandlerType              &,
+                                         SparsityPatternType               &,
+                                         const ConstraintMatrix            &,
+                                         const bool,
+                                         const std::vector<Table<2,bool> > &,
+                                         const types::subdomain_id)
+      {
+        return false;
+      }
+
+
+      /**
+       * If several threads are available and the mesh is large enough, fill
+       * a separate DynamicSparsityPattern on each of several chunks of cells
+       * in parallel and merge them into @p sparsity, again in parallel.
+       * Return whether this was done.
+       */
+      template <typename DoFHandlerType>
+      bool
+      make_sparsity_pattern_in_parallel (const DoFHandlerType              &dof,
+                                         DynamicSparsityPattern            &sparsity,
+                                         const ConstraintMatrix            &constraints,
+                                         const bool                         keep_constrained_dofs,
+                                         const std::vector<Table<2,bool> > &dof_masks,
+                                         const types::subdomain_id          subdomain_id)
+      {
+        if ((MultithreadInfo::n_threads() == 1)
+            ||
+            (dof.get_triangulation().n_active_cells() < 2*min_cells_per_task))
+          return false;
+
+        std::vector<DynamicSparsityPattern> chunk_sparsities;
+        make_sparsity_patterns_on_chunks<DoFHandlerType>
+        (get_cells_for_sparsity_pattern (dof, subdomain_id),
+         constraints, keep_constrained_dofs, dof_masks,
+         chunk_sparsities);
+
+        std::vector<const DynamicSparsityPattern *> chunk_pointers;
+        for (unsigned int c=0; c<chunk_sparsities.size(); ++c)
+          if (chunk_sparsities[c].n_rows() > 0)
+            chunk_pointers.push_back (&chunk_sparsities[c]);
+        sparsity.merge (chunk_pointers);
+
+        return true;
+      }
+
+
+      /**
+       * Compute the sorted union of the columns that the given sparsity
+       * patterns store in row @p row.
+       */
+      void
+      get_merged_row (const std::vector<DynamicSparsityPattern> &sparsities,
+                      const types::global_dof_index              row,
+                      std::vector<types::global_dof_index>      &columns)
+      {
+        columns.clear ();
+        unsigned int n_sparsities_with_entries = 0;
+        for (unsigned int c=0; c<sparsities.size(); ++c)
+          {
+            if (sparsities[c].n_rows() == 0)
+              continue;
+            const types::global_dof_index row_length = sparsities[c].row_length(row);
+            if (row_length == 0)
+              continue;
+
+            ++n_sparsities_with_entries;
+            for (types::global_dof_index k=0; k<row_length; ++k)
+              columns.push_back (sparsities[c].column_number(row, k));
+          }
+
+        // the columns of each sparsity pattern are already sorted and unique
+        if (n_sparsities_with_entries > 1)
+          {
+            std::sort (columns.begin(), columns.end());
+            columns.erase (std::unique (columns.begin(), columns.end()),
+                           columns.end());
+          }
+      }
+
+
+      /**
+       * Compute the lengths of the rows in the range <tt>[begin,end)</tt> of
+       * a SparsityPattern that contains all entries of the given sparsity
+       * patterns as well as the diagonal.
+       */
+      void
+      compute_merged_row_lengths (const types::global_dof_index              begin,
+                                  const types::global_dof_index              end,
+                                  const std::vector<DynamicSparsityPattern> &sparsities,
+                                  std::vector<unsigned int>                 &row_lengths)
+      {
+        std::vector<types::global_dof_index> columns;
+        for (types::global_dof_index row=begin; row<end; ++row)
+          {
+            get_merged_row (sparsities, row, columns);
+            row_lengths[row] = columns.size();
+            if (!std::binary_search (columns.begin(), columns.end(), row))
+              ++row_lengths[row];
+          }
+      }
+
+
+      /**
+       * Copy the union of the entries of the given sparsity patterns in the
+       * rows <tt>[begin,end)</tt> into @p sparsity, which must already have
+       * the right row lengths.
+       */
+      void
+      copy_merged_rows (const types::global_dof_index              begin,
+                        const types::global_dof_index              end,
+                        const std::vector<DynamicSparsityPattern> &sparsities,
+                        SparsityPattern                           &sparsity)
+      {
+        std::vector<types::global_dof_index> columns;
+        for (types::global_dof_index row=begin; row<end; ++row)
+          {
+            get_merged_row (sparsities, row, columns);
+            if (columns.size() > 0)
+              sparsity.add_entries (row, columns.begin(), columns.end(), true);
+          }
+      }
+    }
+  }
+
+
 
   template <typename DoFHandlerType, typename SparsityPatternType>
   void
@@ -79,6 +367,12 @@ namespace DoFTools
                   "associated DoF handler objects, asking for any subdomain other "
                   "than the locally owned one does not make sense."));
 
+    if (internal::make_sparsity_pattern_in_parallel (dof, sparsity, constraints,
+                                                     keep_constrained_dofs,
+                                                     std::vector<Table<2,bool> >(),
+                                                     subdomain_id))
+      return;
+
     std::vector<types::global_dof_index> dofs_on_this_cell;
     dofs_on_this_cell.reserve (max_dofs_per_cell(dof));
     typename DoFHandlerType::active_cell_iterator cell = dof.begin_active(),
@@ -109,6 +403,57 @@ namespace DoFTools
 
 
 
+  template <typename DoFHandlerType>
+  void
+  make_and_compress_sparsity_pattern (const DoFHandlerType      &dof,
+                                      SparsityPattern           &sparsity,
+                                      const ConstraintMatrix    &constraints,
+                                      const bool                 keep_constrained_dofs,
+                                      const types::subdomain_id  subdomain_id)
+  {
+    Assert (
+      (dof.get_triangulation().locally_owned_subdomain() == numbers::invalid_subdomain_id)
+      ||
+      (subdomain_id == numbers::invalid_subdomain_id)
+      ||
+      (subdomain_id == dof.get_triangulation().locally_owned_subdomain()),
+      ExcMessage ("For parallel::distributed::Triangulation objects and "
+                  "associated DoF handler objects, asking for any subdomain other "
+                  "than the locally owned one does not make sense."));
+
+    const types::global_dof_index n_dofs = dof.n_dofs();
+
+    // fill one dynamic sparsity pattern per chunk of cells. these only store
+    // the rows their cells write into, so there is no need for a dynamic
+    // sparsity pattern for the whole matrix: we can compute the exact row
+    // lengths from the chunks and copy their entries directly
+    std::vector<DynamicSparsityPattern> chunk_sparsities;
+    internal::make_sparsity_patterns_on_chunks<DoFHandlerType>
+    (internal::get_cells_for_sparsity_pattern (dof, subdomain_id),
+     constraints, keep_constrained_dofs, std::vector<Table<2,bool> >(),
+     chunk_sparsities);
+
+    std::vector<unsigned int> row_lengths (n_dofs);
+    parallel::apply_to_subranges (static_cast<types::global_dof_index>(0), n_dofs,
+                                  std_cxx11::bind (&internal::compute_merged_row_lengths,
+                                                   std_cxx11::_1, std_cxx11::_2,
+                                                   std_cxx11::cref(chunk_sparsities),
+                                                   std_cxx11::ref(row_lengths)),
+                                  256);
+    sparsity.reinit (n_dofs, n_dofs, row_lengths);
+
+    // every row of the SparsityPattern is written by only one thread
+    parallel::apply_to_subranges (static_cast<types::global_dof_index>(0), n_dofs,
+                                  std_cxx11::bind (&internal::copy_merged_rows,
+                                                   std_cxx11::_1, std_cxx11::_2,
+                                                   std_cxx11::cref(chunk_sparsities),
+                                                   std_cxx11::ref(sparsity)),
+                                  256);
+    sparsity.compress ();
+  }
+
+
+
   template <typename DoFHandlerType, typename SparsityPatternType>
   void
   make_sparsity_pattern (const DoFHandlerType      &dof,
@@ -191,6 +536,12 @@ namespace DoFTools
         }
 
 
+    if (internal::make_sparsity_pattern_in_parallel (dof, sparsity, constraints,
+                                                     keep_constrained_dofs,
+                                                     dof_mask,
+                                                     subdomain_id))
+      return;
+
     std::vector<types::global_dof_index> dofs_on_this_cell(fe_collection.max_dofs_per_cell());
     typename DoFHandlerType::active_cell_iterator cell = dof.begin_active(),
                                                   endc = dof.end();
@@ -18,6 +18,8 @@
 #include <deal.II/base/quadrature.h>
 #include <deal.II/base/signaling_nan.h>
 #include <deal.II/base/std_cxx11/unique_ptr.h>
+#include <deal.II/base/array_view.h>
+#include <deal.II/base/tensor_product_polynomials.h>
 #include <deal.II/lac/vector.h>
 #include <deal.II/lac/block_vector.h>
 #include <deal.II/lac/la_parallel_vector.h>
@@ -33,6 +35,8 @@
 #include <deal.II/fe/mapping_q1.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/fe/fe.h>
+#include <deal.II/fe/fe_poly.h>
+#include <deal.II/matrix_free/shape_info.h>
 
 #include <iomanip>
 
@@ -2705,6 +2709,534 @@ namespace internal
 
 
 
+namespace internal
+{
+  namespace FEValues
+  {
+    /**
+     * A class that evaluates scalar finite element functions in the
+     * quadrature points by sum factorization, i.e., by applying the
+     * one-dimensional shape functions direction by direction. This is used
+     * by FEValues for tensor product elements such as FE_Q and FE_DGQ on
+     * tensor product quadrature formulas such as QGauss, and needs
+     * O(p^(dim+1)) rather than O(p^(2 dim)) operations per cell for
+     * polynomial degree p.
+     */
+    template <int dim, int spacedim>
+    class TensorProductEvaluation
+    {
+    public:
+      /**
+       * Return a new object if @p fe is a scalar tensor product element and
+       * the points of @p quadrature are the tensor product of a
+       * one-dimensional point set with the first coordinate running fastest,
+       * as for QGauss. Return a null pointer otherwise.
+       */
+      static
+      TensorProductEvaluation *
+      create (const FiniteElement<dim,spacedim> &fe,
+              const Quadrature<dim>             &quadrature);
+
+      /**
+       * Compute the values of the function given by @p dof_values in the
+       * quadrature points.
+       */
+      template <typename Number>
+      void
+      get_function_values (const Number        *dof_values,
+                           std::vector<Number> &values) const;
+
+      /**
+       * Compute the gradients of the function given by @p dof_values in the
+       * quadrature points. The gradients on the reference cell are
+       * transformed to real space by @p mapping, the same way as
+       * FE_Poly::fill_fe_values() transforms the gradients of the shape
+       * functions.
+       */
+      template <typename Number>
+      void
+      get_function_gradients (const Number                                           *dof_values,
+                              const Mapping<dim,spacedim>                            &mapping,
+                              const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                              std::vector<Tensor<1,spacedim,Number> >                &gradients) const;
+
+      /**
+       * Compute the Hessians of the function given by @p dof_values in the
+       * quadrature points, again transformed to real space like in
+       * FE_Poly::fill_fe_values().
+       */
+      template <typename Number>
+      void
+      get_function_hessians (const Number                                           *dof_values,
+                             const Mapping<dim,spacedim>                            &mapping,
+                             const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                             const MappingRelatedData<dim,spacedim>                 &mapping_output,
+                             std::vector<Tensor<2,spacedim,Number> >                &hessians) const;
+
+    private:
+      TensorProductEvaluation ();
+
+      /**
+       * Fill the arrays of values, gradients on the reference cell, and
+       * Hessians on the reference cell for the requested quantities.
+       */
+      template <typename Number>
+      void evaluate (const Number *dof_values,
+                     const bool    evaluate_values,
+                     const bool    evaluate_gradients,
+                     const bool    evaluate_hessians) const;
+
+      /**
+       * Apply the one-dimensional shape values (0), gradients (1) or second
+       * derivatives (2) as given by @p derivative_orders direction by
+       * direction to the lexicographic dof values and write the result in
+       * the quadrature points into @p out.
+       */
+      void apply (const unsigned int *derivative_orders,
+                  double             *out) const;
+
+      unsigned int n_dofs_1d;
+      unsigned int n_q_points_1d;
+      unsigned int n_q_points;
+
+      /**
+       * The one-dimensional shape functions, their first and their second
+       * derivatives evaluated in the one-dimensional quadrature points, with
+       * the quadrature points running fastest.
+       */
+      std::vector<double> shape_data[3];
+
+      /**
+       * The number of the shape function of the element for each
+       * lexicographic position in the tensor product.
+       */
+      std::vector<unsigned int> lexicographic_numbering;
+
+      /**
+       * Temporary arrays. Like the rest of FEValues, an object of this class
+       * must not be used from several threads at the same time.
+       */
+      mutable std::vector<double> dof_values_lexicographic;
+      mutable std::vector<double> scratch[2];
+      mutable std::vector<double> quadrature_values;
+      mutable std::vector<double> values;
+      mutable std::vector<Tensor<1,dim> > reference_gradients;
+      mutable std::vector<Tensor<2,dim> > reference_hessians;
+      mutable std::vector<Tensor<1,spacedim> > real_gradients;
+      mutable std::vector<Tensor<2,spacedim> > real_hessians;
+    };
+
+
+
+    template <int dim, int spacedim>
+    TensorProductEvaluation<dim,spacedim>::TensorProductEvaluation ()
+      :
+      n_dofs_1d (0),
+      n_q_points_1d (0),
+      n_q_points (0)
+    {}
+
+
+
+    // the one-dimensional shape functions are set up by the matrix-free
+    // framework, which only deals with the case dim==spacedim
+    template <int dim, int spacedim>
+    bool
+    get_tensor_product_shape_info (const FiniteElement<dim,spacedim> &,
+                                   const Quadrature<1> &,
+                                   MatrixFreeFunctions::ShapeInfo<double> &)
+    {
+      return false;
+    }
+
+
+
+    template <int dim>
+    bool
+    get_tensor_product_shape_info (const FiniteElement<dim,dim>           &fe,
+                                   const Quadrature<1>                    &quadrature_1d,
+                                   MatrixFreeFunctions::ShapeInfo<double> &shape_info)
+    {
+      const FE_Poly<TensorProductPolynomials<dim>,dim,dim> *fe_poly =
+        dynamic_cast<const FE_Poly<TensorProductPolynomials<dim>,dim,dim>*>(&fe);
+      if (fe_poly == 0 || fe.n_components() != 1 ||
+          fe.dofs_per_cell != Utilities::fixed_power<dim>(fe.degree+1))
+        return false;
+
+      // ShapeInfo extracts the one-dimensional shape functions along the
+      // line y=z=0, which requires the first shape function in
+      // lexicographic order to be one at the origin. this is not the case
+      // e.g. for FE_DGQArbitraryNodes on Gauss points
+      const std::vector<unsigned int> lexicographic =
+        fe_poly->get_poly_space_numbering_inverse();
+      if (std::fabs(fe.shape_value(lexicographic[0], Point<dim>()) - 1.) > 1e-13)
+        return false;
+
+      shape_info.reinit (quadrature_1d, fe);
+      return true;
+    }
+
+
+
+    template <int dim, int spacedim>
+    TensorProductEvaluation<dim,spacedim> *
+    TensorProductEvaluation<dim,spacedim>::create (const FiniteElement<dim,spacedim> &fe,
+                                                   const Quadrature<dim>             &quadrature)
+    {
+      // find the number of points per direction and check that the points
+      // form a tensor product with the first coordinate running fastest.
+      // only the points enter the evaluation, so the weights do not matter
+      const unsigned int n_q_points = quadrature.size();
+      unsigned int n_q_points_1d = 1;
+      while (Utilities::fixed_power<dim>(n_q_points_1d) < n_q_points)
+        ++n_q_points_1d;
+      if (Utilities::fixed_power<dim>(n_q_points_1d) != n_q_points)
+        return 0;
+
+      std::vector<Point<1> > points_1d (n_q_points_1d);
+      for (unsigned int q=0; q<n_q_points_1d; ++q)
+        points_1d[q][0] = quadrature.point(q)[0];
+      for (unsigned int q=0; q<n_q_points; ++q)
+        for (unsigned int d=0, stride=1; d<dim; ++d, stride*=n_q_points_1d)
+          if (std::fabs(quadrature.point(q)[d] -
+                        points_1d[(q/stride)%n_q_points_1d][0]) > 1e-14)
+            return 0;
+
+      MatrixFreeFunctions::ShapeInfo<double> shape_info;
+      if (get_tensor_product_shape_info (fe, Quadrature<1>(points_1d),
+                                         shape_info) == false)
+        return 0;
+
+      TensorProductEvaluation<dim,spacedim> *evaluation
+        = new TensorProductEvaluation<dim,spacedim>();
+      evaluation->n_dofs_1d = fe.degree+1;
+      evaluation->n_q_points_1d = n_q_points_1d;
+      evaluation->n_q_points = n_q_points;
+      const unsigned int n_shape_entries = evaluation->n_dofs_1d*n_q_points_1d;
+      for (unsigned int i=0; i<3; ++i)
+        evaluation->shape_data[i].resize (n_shape_entries);
+      for (unsigned int i=0; i<n_shape_entries; ++i)
+        {
+          evaluation->shape_data[0][i] = shape_info.shape_values_number[i];
+          evaluation->shape_data[1][i] = shape_info.shape_gradient_number[i];
+          evaluation->shape_data[2][i] = shape_info.shape_hessians[i][0];
+        }
+      evaluation->lexicographic_numbering = shape_info.lexicographic_numbering;
+
+      const unsigned int max_size
+        = Utilities::fixed_power<dim>(std::max(evaluation->n_dofs_1d, n_q_points_1d));
+      evaluation->dof_values_lexicographic.resize (fe.dofs_per_cell);
+      evaluation->scratch[0].resize (max_size);
+      evaluation->scratch[1].resize (max_size);
+      evaluation->quadrature_values.resize (n_q_points);
+      evaluation->values.resize (n_q_points);
+      evaluation->reference_gradients.resize (n_q_points);
+      evaluation->reference_hessians.resize (n_q_points);
+      evaluation->real_gradients.resize (n_q_points);
+      evaluation->real_hessians.resize (n_q_points);
+      return evaluation;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    TensorProductEvaluation<dim,spacedim>::apply (const unsigned int *derivative_orders,
+                                                  double             *out) const
+    {
+      // work on one direction after the other. after direction d, the
+      // indices in the first d+1 directions run over quadrature points and
+      // the remaining ones over dofs
+      const double *src = &dof_values_lexicographic[0];
+      unsigned int stride = 1;
+      for (unsigned int d=0; d<dim; ++d)
+        {
+          double *dst = (d == dim-1) ? out : &scratch[d%2][0];
+          const double *shape = &shape_data[derivative_orders[d]][0];
+
+          unsigned int n_blocks = 1;
+          for (unsigned int e=d+1; e<dim; ++e)
+            n_blocks *= n_dofs_1d;
+
+          for (unsigned int b=0; b<n_blocks; ++b)
+            {
+              const double *src_block = src + b*n_dofs_1d*stride;
+              double *dst_block = dst + b*n_q_points_1d*stride;
+              for (unsigned int q=0; q<n_q_points_1d; ++q)
+                {
+                  double *dst_line = dst_block + q*stride;
+                  for (unsigned int s=0; s<stride; ++s)
+                    dst_line[s] = 0;
+                  for (unsigned int i=0; i<n_dofs_1d; ++i)
+                    {
+                      const double shape_value = shape[i*n_q_points_1d+q];
+                      const double *src_line = src_block + i*stride;
+                      for (unsigned int s=0; s<stride; ++s)
+                        dst_line[s] += shape_value * src_line[s];
+                    }
+                }
+            }
+
+          src = dst;
+          stride *= n_q_points_1d;
+        }
+    }
+
+
+
+    template <int dim, int spacedim>
+    template <typename Number>
+    void
+    TensorProductEvaluation<dim,spacedim>::evaluate (const Number *dof_values,
+                                                     const bool    evaluate_values,
+                                                     const bool    evaluate_gradients,
+                                                     const bool    evaluate_hessians) const
+    {
+      for (unsigned int i=0; i<dof_values_lexicographic.size(); ++i)
+        dof_values_lexicographic[i] = dof_values[lexicographic_numbering[i]];
+
+      unsigned int derivative_orders[dim];
+      if (evaluate_values)
+        {
+          for (unsigned int d=0; d<dim; ++d)
+            derivative_orders[d] = 0;
+          apply (derivative_orders, &values[0]);
+        }
+
+      if (evaluate_gradients)
+        for (unsigned int c=0; c<dim; ++c)
+          {
+            for (unsigned int d=0; d<dim; ++d)
+              derivative_orders[d] = (d == c);
+            apply (derivative_orders, &quadrature_values[0]);
+            for (unsigned int q=0; q<n_q_points; ++q)
+              reference_gradients[q][c] = quadrature_values[q];
+          }
+
+      if (evaluate_hessians)
+        for (unsigned int c1=0; c1<dim; ++c1)
+          for (unsigned int c2=c1; c2<dim; ++c2)
+            {
+              for (unsigned int d=0; d<dim; ++d)
+                derivative_orders[d] = (d == c1) + (d == c2);
+              apply (derivative_orders, &quadrature_values[0]);
+              for (unsigned int q=0; q<n_q_points; ++q)
+                reference_hessians[q][c1][c2] = reference_hessians[q][c2][c1]
+                                                = quadrature_values[q];
+            }
+    }
+
+
+
+    template <int dim, int spacedim>
+    template <typename Number>
+    void
+    TensorProductEvaluation<dim,spacedim>::
+    get_function_values (const Number        *dof_values,
+                         std::vector<Number> &function_values) const
+    {
+      AssertDimension (function_values.size(), n_q_points);
+      evaluate (dof_values, true, false, false);
+      for (unsigned int q=0; q<n_q_points; ++q)
+        function_values[q] = values[q];
+    }
+
+
+
+    template <int dim, int spacedim>
+    template <typename Number>
+    void
+    TensorProductEvaluation<dim,spacedim>::
+    get_function_gradients (const Number                                           *dof_values,
+                            const Mapping<dim,spacedim>                            &mapping,
+                            const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                            std::vector<Tensor<1,spacedim,Number> >                &gradients) const
+    {
+      AssertDimension (gradients.size(), n_q_points);
+      evaluate (dof_values, false, true, false);
+      mapping.transform (make_array_view(reference_gradients),
+                         mapping_covariant,
+                         mapping_data,
+                         make_array_view(real_gradients));
+      for (unsigned int q=0; q<n_q_points; ++q)
+        gradients[q] = Tensor<1,spacedim,Number>(real_gradients[q]);
+    }
+
+
+
+    template <int dim, int spacedim>
+    template <typename Number>
+    void
+    TensorProductEvaluation<dim,spacedim>::
+    get_function_hessians (const Number                                           *dof_values,
+                           const Mapping<dim,spacedim>                            &mapping,
+                           const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                           const MappingRelatedData<dim,spacedim>                 &mapping_output,
+                           std::vector<Tensor<2,spacedim,Number> >                &hessians) const
+    {
+      AssertDimension (hessians.size(), n_q_points);
+      evaluate (dof_values, false, true, true);
+      mapping.transform (make_array_view(reference_gradients),
+                         mapping_covariant,
+                         mapping_data,
+                         make_array_view(real_gradients));
+      mapping.transform (make_array_view(reference_hessians),
+                         mapping_covariant_gradient,
+                         mapping_data,
+                         make_array_view(real_hessians));
+      for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          for (unsigned int j=0; j<spacedim; ++j)
+            real_hessians[q] -= mapping_output.jacobian_pushed_forward_grads[q][j]
+                                * real_gradients[q][j];
+          hessians[q] = Tensor<2,spacedim,Number>(real_hessians[q]);
+        }
+    }
+
+
+
+    // the get_function_xxx methods of FEValuesBase call these functions,
+    // which return false if no TensorProductEvaluation object is given and
+    // the precomputed shape function tables must be used instead. the
+    // evaluation works on real numbers, so complex-valued vectors always
+    // take the latter path
+    template <bool is_complex>
+    struct TensorProductFunctionEvaluation
+    {
+      template <int dim, int spacedim, typename Number>
+      static
+      bool
+      values (const TensorProductEvaluation<dim,spacedim> *evaluation,
+              const Number                                *dof_values,
+              std::vector<Number>                         &values)
+      {
+        if (evaluation == 0)
+          return false;
+        evaluation->get_function_values (dof_values, values);
+        return true;
+      }
+
+      template <int dim, int spacedim, typename Number>
+      static
+      bool
+      gradients (const TensorProductEvaluation<dim,spacedim>            *evaluation,
+                 const Number                                           *dof_values,
+                 const Mapping<dim,spacedim>                            &mapping,
+                 const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                 std::vector<Tensor<1,spacedim,Number> >                &gradients)
+      {
+        if (evaluation == 0)
+          return false;
+        evaluation->get_function_gradients (dof_values, mapping, mapping_data,
+                                            gradients);
+        return true;
+      }
+
+      template <int dim, int spacedim, typename Number>
+      static
+      bool
+      hessians (const TensorProductEvaluation<dim,spacedim>            *evaluation,
+                const Number                                           *dof_values,
+                const Mapping<dim,spacedim>                            &mapping,
+                const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                const MappingRelatedData<dim,spacedim>                 &mapping_output,
+                std::vector<Tensor<2,spacedim,Number> >                &hessians)
+      {
+        if (evaluation == 0)
+          return false;
+        evaluation->get_function_hessians (dof_values, mapping, mapping_data,
+                                           mapping_output, hessians);
+        return true;
+      }
+    };
+
+
+
+    template <>
+    struct TensorProductFunctionEvaluation<true>
+    {
+      template <int dim, int spacedim, typename Number>
+      static
+      bool
+      values (const TensorProductEvaluation<dim,spacedim> *,
+              const Number *,
+              std::vector<Number> &)
+      {
+        return false;
+      }
+
+      template <int dim, int spacedim, typename Number>
+      static
+      bool
+      gradients (const TensorProductEvaluation<dim,spacedim> *,
+                 const Number *,
+                 const Mapping<dim,spacedim> &,
+                 const typename Mapping<dim,spacedim>::InternalDataBase &,
+                 std::vector<Tensor<1,spacedim,Number> > &)
+      {
+        return false;
+      }
+
+      template <int dim, int spacedim, typename Number>
+      static
+      bool
+      hessians (const TensorProductEvaluation<dim,spacedim> *,
+                const Number *,
+                const Mapping<dim,spacedim> &,
+                const typename Mapping<dim,spacedim>::InternalDataBase &,
+                const MappingRelatedData<dim,spacedim> &,
+                std::vector<Tensor<2,spacedim,Number> > &)
+      {
+        return false;
+      }
+    };
+
+
+
+    template <int dim, int spacedim, typename Number>
+    bool
+    do_function_values_tensor_product (const TensorProductEvaluation<dim,spacedim> *evaluation,
+                                       const Number                                *dof_values,
+                                       std::vector<Number>                         &values)
+    {
+      return TensorProductFunctionEvaluation<numbers::NumberTraits<Number>::is_complex>::
+             values (evaluation, dof_values, values);
+    }
+
+
+
+    template <int dim, int spacedim, typename Number>
+    bool
+    do_function_gradients_tensor_product (const TensorProductEvaluation<dim,spacedim>            *evaluation,
+                                          const Number                                           *dof_values,
+                                          const Mapping<dim,spacedim>                            &mapping,
+                                          const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                                          std::vector<Tensor<1,spacedim,Number> >                &gradients)
+    {
+      return TensorProductFunctionEvaluation<numbers::NumberTraits<Number>::is_complex>::
+             gradients (evaluation, dof_values, mapping, mapping_data, gradients);
+    }
+
+
+
+    template <int dim, int spacedim, typename Number>
+    bool
+    do_function_hessians_tensor_product (const TensorProductEvaluation<dim,spacedim>            *evaluation,
+                                         const Number                                           *dof_values,
+                                         const Mapping<dim,spacedim>                            &mapping,
+                                         const typename Mapping<dim,spacedim>::InternalDataBase &mapping_data,
+                                         const MappingRelatedData<dim,spacedim>                 &mapping_output,
+                                         std::vector<Tensor<2,spacedim,Number> >                &hessians)
+    {
+      return TensorProductFunctionEvaluation<numbers::NumberTraits<Number>::is_complex>::
+             hessians (evaluation, dof_values, mapping, mapping_data, mapping_output,
+                       hessians);
+    }
+  }
+}
+
+
+
 template <int dim, int spacedim>
 template <class InputVector>
 void FEValuesBase<dim,spacedim>::get_function_values (
@@ -2723,8 +3255,10 @@ void FEValuesBase<dim,spacedim>::get_function_values (
   // get function values of dofs on this cell
   Vector<Number> dof_values (dofs_per_cell);
   present_cell->get_interpolated_dof_values(fe_function, dof_values);
-  internal::do_function_values (dof_values.begin(), this->finite_element_output.shape_values,
-                                values);
+  if (internal::FEValues::do_function_values_tensor_product
+      (tensor_product_evaluation.get(), dof_values.begin(), values) == false)
+    internal::do_function_values (dof_values.begin(), this->finite_element_output.shape_values,
+                                  values);
 }
 
 
@@ -2748,15 +3282,19 @@ void FEValuesBase<dim,spacedim>::get_function_values (
       Number dof_values[100];
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
-      internal::do_function_values(&dof_values[0], this->finite_element_output.shape_values, values);
+      if (internal::FEValues::do_function_values_tensor_product
+          (tensor_product_evaluation.get(), &dof_values[0], values) == false)
+        internal::do_function_values(&dof_values[0], this->finite_element_output.shape_values, values);
     }
   else
     {
       Vector<Number> dof_values(dofs_per_cell);
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
-      internal::do_function_values(dof_values.begin(), this->finite_element_output.shape_values,
-                                   values);
+      if (internal::FEValues::do_function_values_tensor_product
+          (tensor_product_evaluation.get(), dof_values.begin(), values) == false)
+        internal::do_function_values(dof_values.begin(), this->finite_element_output.shape_values,
+                                     values);
     }
 }
 
@@ -2883,8 +3421,11 @@ FEValuesBase<dim,spacedim>::get_function_gradients (
   // get function values of dofs on this cell
   Vector<Number> dof_values (dofs_per_cell);
   present_cell->get_interpolated_dof_values(fe_function, dof_values);
-  internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_gradients,
-                                    gradients);
+  if (internal::FEValues::do_function_gradients_tensor_product
+      (tensor_product_evaluation.get(), dof_values.begin(), *mapping, *mapping_data,
+       gradients) == false)
+    internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_gradients,
+                                      gradients);
 }
 
 
@@ -2906,16 +3447,22 @@ void FEValuesBase<dim,spacedim>::get_function_gradients (
       Number dof_values[100];
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
-      internal::do_function_derivatives(&dof_values[0], this->finite_element_output.shape_gradients,
-                                        gradients);
+      if (internal::FEValues::do_function_gradients_tensor_product
+          (tensor_product_evaluation.get(), &dof_values[0], *mapping, *mapping_data,
+           gradients) == false)
+        internal::do_function_derivatives(&dof_values[0], this->finite_element_output.shape_gradients,
+                                          gradients);
     }
   else
     {
       Vector<Number> dof_values(dofs_per_cell);
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
-      internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_gradients,
-                                        gradients);
+      if (internal::FEValues::do_function_gradients_tensor_product
+          (tensor_product_evaluation.get(), dof_values.begin(), *mapping, *mapping_data,
+           gradients) == false)
+        internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_gradients,
+                                          gradients);
     }
 }
 
@@ -3005,8 +3552,11 @@ get_function_hessians (const InputVector                &fe_function,
   // get function values of dofs on this cell
   Vector<Number> dof_values (dofs_per_cell);
   present_cell->get_interpolated_dof_values(fe_function, dof_values);
-  internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_hessians,
-                                    hessians);
+  if (internal::FEValues::do_function_hessians_tensor_product
+      (tensor_product_evaluation.get(), dof_values.begin(), *mapping, *mapping_data, this->mapping_output,
+       hessians) == false)
+    internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_hessians,
+                                      hessians);
 }
 
 
@@ -3028,16 +3578,22 @@ void FEValuesBase<dim,spacedim>::get_function_hessians (
       Number dof_values[100];
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
-      internal::do_function_derivatives(&dof_values[0], this->finite_element_output.shape_hessians,
-                                        hessians);
+      if (internal::FEValues::do_function_hessians_tensor_product
+          (tensor_product_evaluation.get(), &dof_values[0], *mapping, *mapping_data, this->mapping_output,
+           hessians) == false)
+        internal::do_function_derivatives(&dof_values[0], this->finite_element_output.shape_hessians,
+                                          hessians);
     }
   else
     {
       Vector<Number> dof_values(dofs_per_cell);
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
-      internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_hessians,
-                                        hessians);
+      if (internal::FEValues::do_function_hessians_tensor_product
+          (tensor_product_evaluation.get(), dof_values.begin(), *mapping, *mapping_data, this->mapping_output,
+           hessians) == false)
+        internal::do_function_derivatives(dof_values.begin(), this->finite_element_output.shape_hessians,
+                                          hessians);
     }
 }
 
@@ -3484,6 +4040,7 @@ FEValuesBase< dim, spacedim >::invalidate_present_cell ()
   // it
   tria_listener.disconnect ();
   present_cell.reset ();
+  similarity_reference_cell = typename Triangulation<dim,spacedim>::cell_iterator();
 }
 
 
@@ -3537,35 +4094,44 @@ FEValuesBase<dim,spacedim>::check_cell_similarity
   // initialized to the first cell the thread sees. As this number might
   // different between different runs (after all, the tasks are scheduled
   // dynamically onto threads), this slight deviation leads to difference in
-  // roundoff errors that propagate through the program. Therefore, we need to
-  // disable CellSimilarity in case there is more than one thread in the
-  // problem. This will likely not affect many MPI test cases as there
-  // multithreading is disabled on default, but in many other situations
-  // because we rarely explicitly set the number of threads.
-  //
-  // TODO: Is it reasonable to introduce a flag "unsafe" in the constructor of
-  // FEValues to re-enable this feature?
+  // roundoff errors that propagate through the program. Therefore, we only
+  // reuse data when using more than one thread if they were computed on a
+  // cell that only depends on the present one, namely the first of its
+  // siblings. if these data are not available, FEValues::reinit computes
+  // them first
   if (MultithreadInfo::n_threads() > 1)
     {
-      cell_similarity = CellSimilarity::none;
-      return;
+      const typename Triangulation<dim,spacedim>::cell_iterator
+      reference_cell = get_similarity_reference_cell (cell);
+      if ((this->present_cell.get() != 0)
+          &&
+          (cell_similarity != CellSimilarity::invalid_next_cell)
+          &&
+          (reference_cell != cell)
+          &&
+          (reference_cell == similarity_reference_cell))
+        cell_similarity = CellSimilarity::translation;
+      else
+        cell_similarity = CellSimilarity::none;
     }
-
-  // case that there has not been any cell before
-  if (this->present_cell.get() == 0)
-    cell_similarity = CellSimilarity::none;
   else
-    // in MappingQ, data can have been modified during the last call. Then, we
-    // can't use that data on the new cell.
-    if (cell_similarity == CellSimilarity::invalid_next_cell)
-      cell_similarity = CellSimilarity::none;
-    else
-      cell_similarity = (cell->is_translation_of
-                         (static_cast<const typename Triangulation<dim,spacedim>::cell_iterator &>(*this->present_cell))
-                         ?
-                         CellSimilarity::translation
-                         :
-                         CellSimilarity::none);
+    {
+      // case that there has not been any cell before
+      if (this->present_cell.get() == 0)
+        cell_similarity = CellSimilarity::none;
+      else
+        // in MappingQ, data can have been modified during the last call. Then, we
+        // can't use that data on the new cell.
+        if (cell_similarity == CellSimilarity::invalid_next_cell)
+          cell_similarity = CellSimilarity::none;
+        else
+          cell_similarity = (cell->is_translation_of
+                             (static_cast<const typename Triangulation<dim,spacedim>::cell_iterator &>(*this->present_cell))
+                             ?
+                             CellSimilarity::translation
+                             :
+                             CellSimilarity::none);
+    }
 
   if ( (dim<spacedim) &&  (cell_similarity == CellSimilarity::translation) )
     {
@@ -3580,6 +4146,27 @@ FEValuesBase<dim,spacedim>::check_cell_similarity
 
 
 
+template <int dim, int spacedim>
+typename Triangulation<dim,spacedim>::cell_iterator
+FEValuesBase<dim,spacedim>::get_similarity_reference_cell
+(const typename Triangulation<dim,spacedim>::cell_iterator &cell)
+{
+  if (cell->level() > 0)
+    {
+      const typename Triangulation<dim,spacedim>::cell_iterator
+      first_sibling = cell->parent()->child(0);
+      if ((first_sibling != cell)
+          &&
+          (first_sibling->has_children() == false)
+          &&
+          cell->is_translation_of (first_sibling))
+        return first_sibling;
+    }
+  return cell;
+}
+
+
+
 template <int dim, int spacedim>
 CellSimilarity::Similarity
 FEValuesBase<dim,spacedim>::get_cell_similarity () const
@@ -3676,6 +4263,11 @@ FEValues<dim,spacedim>::initialize (const UpdateFlags update_flags)
   // then collect answers from the two task above
   this->fe_data.reset (fe_get_data.return_value());
   this->mapping_data.reset (mapping_get_data.return_value());
+
+  // use sum factorization in get_function_values() and friends if the
+  // element and the quadrature formula are of tensor product form
+  this->tensor_product_evaluation.reset
+  (internal::FEValues::TensorProductEvaluation<dim,spacedim>::create (*this->fe, quadrature));
 }
 
 
@@ -3718,6 +4310,7 @@ void FEValues<dim,spacedim>::reinit (const typename Triangulation<dim,spacedim>:
   // necessary here
   this->maybe_invalidate_previous_present_cell (cell);
   this->check_cell_similarity(cell);
+  const bool reference_cell_computed = reinit_similarity_reference_cell (cell);
 
   reset_pointer_in_place_if_possible<typename FEValuesBase<dim,spacedim>::TriaCellIterator>
   (this->present_cell, cell);
@@ -3728,6 +4321,11 @@ void FEValues<dim,spacedim>::reinit (const typename Triangulation<dim,spacedim>:
   // pass on to the function doing
   // the real work.
   do_reinit ();
+
+  // to the outside, the present cell is not similar to the previous one if
+  // we had to visit another cell in between
+  if (reference_cell_computed)
+    this->cell_similarity = CellSimilarity::none;
 }
 
 
@@ -3749,6 +4347,7 @@ FEValues<dim,spacedim>::reinit
 
   this->maybe_invalidate_previous_present_cell (cell);
   this->check_cell_similarity(cell);
+  const bool reference_cell_computed = reinit_similarity_reference_cell (cell);
 
   reset_pointer_in_place_if_possible<typename FEValuesBase<dim,spacedim>::template
   CellIterator<TriaIterator<DoFCellAccessor<DoFHandlerType<dim,spacedim>,
@@ -3761,6 +4360,45 @@ FEValues<dim,spacedim>::reinit
   // pass on to the function doing
   // the real work.
   do_reinit ();
+
+  // to the outside, the present cell is not similar to the previous one if
+  // we had to visit another cell in between
+  if (reference_cell_computed)
+    this->cell_similarity = CellSimilarity::none;
+}
+
+
+
+template <int dim, int spacedim>
+bool
+FEValues<dim,spacedim>::reinit_similarity_reference_cell
+(const typename Triangulation<dim,spacedim>::cell_iterator &cell)
+{
+  if ((MultithreadInfo::n_threads() == 1)
+      ||
+      (this->cell_similarity != CellSimilarity::none))
+    return false;
+
+  const typename Triangulation<dim,spacedim>::cell_iterator
+  reference_cell = this->get_similarity_reference_cell (cell);
+  if (reference_cell == cell)
+    return false;
+
+  // compute the data on the reference cell from scratch, then tell the
+  // caller to reuse them on the present cell
+  reset_pointer_in_place_if_possible<typename FEValuesBase<dim,spacedim>::TriaCellIterator>
+  (this->present_cell, reference_cell);
+  do_reinit ();
+
+  if (this->cell_similarity == CellSimilarity::invalid_next_cell)
+    this->cell_similarity = CellSimilarity::none;
+  else
+    {
+      this->cell_similarity = CellSimilarity::translation;
+      if ( (dim<spacedim) && (reference_cell->direction_flag() != cell->direction_flag()) )
+        this->cell_similarity = CellSimilarity::inverted_translation;
+    }
+  return true;
 }
 
 
@@ -3768,6 +4406,8 @@ FEValues<dim,spacedim>::reinit
 template <int dim, int spacedim>
 void FEValues<dim,spacedim>::do_reinit ()
 {
+  const CellSimilarity::Similarity requested_cell_similarity = this->cell_similarity;
+
   // first call the mapping and let it generate the data
   // specific to the mapping. also let it inspect the
   // cell similarity flag and, if necessary, update
@@ -3791,6 +4431,19 @@ void FEValues<dim,spacedim>::do_reinit ()
                                 this->mapping_output,
                                 *this->fe_data,
                                 this->finite_element_output);
+
+  // with more than one thread, remember whether the data just computed can
+  // be reused on other cells, see check_cell_similarity()
+  if (MultithreadInfo::n_threads() > 1)
+    {
+      if (this->cell_similarity == CellSimilarity::invalid_next_cell)
+        this->similarity_reference_cell = typename Triangulation<dim,spacedim>::cell_iterator();
+      else if (requested_cell_similarity == CellSimilarity::none)
+        this->similarity_reference_cell
+          = static_cast<const typename Triangulation<dim,spacedim>::cell_iterator &>(*this->present_cell);
+    }
+  else
+    this->similarity_reference_cell = typename Triangulation<dim,spacedim>::cell_iterator();
 }
 
 
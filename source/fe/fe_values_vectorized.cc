@@ -0,0 +1,225 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#include <deal.II/base/geometry_info.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/fe/fe_values_vectorized.h>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+template <int dim, typename Number>
+const unsigned int FEValuesVectorized<dim,Number>::n_lanes;
+
+
+
+template <int dim, typename Number>
+FEValuesVectorized<dim,Number>::FEValuesVectorized (const FiniteElement<dim> &fe,
+                                                    const Quadrature<dim>    &quadrature,
+                                                    const UpdateFlags         update_flags)
+  :
+  n_quadrature_points (quadrature.size()),
+  dofs_per_cell (fe.dofs_per_cell),
+  fe (&fe, typeid(*this).name()),
+  quadrature (quadrature),
+  update_flags (update_flags)
+{
+  Assert (fe.is_primitive(), ExcNotImplemented());
+  Assert ((update_flags & ~(update_values | update_gradients |
+                            update_quadrature_points | update_JxW_values))
+          == 0,
+          ExcMessage ("This class only supports the flags update_values, "
+                      "update_gradients, update_quadrature_points, and "
+                      "update_JxW_values."));
+
+  // the data on the reference cell that is the same for all cells
+  if (update_flags & update_values)
+    {
+      shape_values.reinit (dofs_per_cell, n_quadrature_points);
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        for (unsigned int q=0; q<n_quadrature_points; ++q)
+          shape_values(i,q) = fe.shape_value (i, quadrature.point(q));
+    }
+
+  if (update_flags & update_gradients)
+    {
+      reference_shape_gradients.reinit (dofs_per_cell, n_quadrature_points);
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        for (unsigned int q=0; q<n_quadrature_points; ++q)
+          reference_shape_gradients(i,q) = fe.shape_grad (i, quadrature.point(q));
+      shape_gradients.reinit (dofs_per_cell, n_quadrature_points);
+    }
+
+  vertex_shape_values.reinit (GeometryInfo<dim>::vertices_per_cell,
+                              n_quadrature_points);
+  vertex_shape_gradients.reinit (GeometryInfo<dim>::vertices_per_cell,
+                                 n_quadrature_points);
+  for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+    for (unsigned int q=0; q<n_quadrature_points; ++q)
+      {
+        vertex_shape_values(v,q)
+          = GeometryInfo<dim>::d_linear_shape_function (quadrature.point(q), v);
+        vertex_shape_gradients(v,q)
+          = GeometryInfo<dim>::d_linear_shape_function_gradient (quadrature.point(q), v);
+      }
+
+  if (update_flags & update_JxW_values)
+    JxW_values.resize (n_quadrature_points);
+  if (update_flags & update_quadrature_points)
+    quadrature_points.resize (n_quadrature_points);
+}
+
+
+
+template <int dim, typename Number>
+void
+FEValuesVectorized<dim,Number>::
+reinit (const std::vector<typename DoFHandler<dim>::active_cell_iterator> &cells)
+{
+  Assert ((cells.size() > 0) && (cells.size() <= n_lanes),
+          ExcInvalidNumberOfCells (cells.size(), n_lanes));
+  for (unsigned int lane=0; lane<cells.size(); ++lane)
+    Assert (static_cast<const FiniteElementData<dim>&>(*fe) ==
+            static_cast<const FiniteElementData<dim>&>(cells[lane]->get_fe()),
+            ExcMessage ("The finite element of the cells must be the one "
+                        "given to the constructor."));
+  this->cells = cells;
+
+  // gather the vertices of the cells, one cell per lane. fill unused lanes
+  // with the last cell so that all lanes describe valid cells
+  Point<dim,VectorizedArray<Number> > vertices[GeometryInfo<dim>::vertices_per_cell];
+  for (unsigned int lane=0; lane<n_lanes; ++lane)
+    {
+      const typename DoFHandler<dim>::active_cell_iterator &
+      cell = cells[std::min<unsigned int>(lane, cells.size()-1)];
+      for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+        for (unsigned int d=0; d<dim; ++d)
+          vertices[v][d][lane] = cell->vertex(v)[d];
+    }
+
+  for (unsigned int q=0; q<n_quadrature_points; ++q)
+    {
+      if (update_flags & update_quadrature_points)
+        {
+          Point<dim,VectorizedArray<Number> > point;
+          for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+            for (unsigned int d=0; d<dim; ++d)
+              point[d] += vertices[v][d] * vertex_shape_values(v,q);
+          quadrature_points[q] = point;
+        }
+
+      if ((update_flags & (update_gradients | update_JxW_values)) == 0)
+        continue;
+
+      // the Jacobian of the d-linear map, jacobian[d][e] = dx_d/dxi_e
+      VectorizedArray<Number> jacobian[dim][dim];
+      for (unsigned int d=0; d<dim; ++d)
+        for (unsigned int e=0; e<dim; ++e)
+          jacobian[d][e] = VectorizedArray<Number>();
+      for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+        for (unsigned int d=0; d<dim; ++d)
+          for (unsigned int e=0; e<dim; ++e)
+            jacobian[d][e] += vertices[v][d] * vertex_shape_gradients(v,q)[e];
+
+      // determinant and inverse
+      VectorizedArray<Number> inverse_jacobian[dim][dim];
+      VectorizedArray<Number> determinant;
+      switch (dim)
+        {
+        case 1:
+          determinant = jacobian[0][0];
+          inverse_jacobian[0][0] = Number(1.)/determinant;
+          break;
+
+        case 2:
+        {
+          determinant = (jacobian[0][0]*jacobian[1][1] -
+                         jacobian[0][1]*jacobian[1][0]);
+          const VectorizedArray<Number> inverse_determinant = Number(1.)/determinant;
+          inverse_jacobian[0][0] =  jacobian[1][1] * inverse_determinant;
+          inverse_jacobian[0][1] = -jacobian[0][1] * inverse_determinant;
+          inverse_jacobian[1][0] = -jacobian[1][0] * inverse_determinant;
+          inverse_jacobian[1][1] =  jacobian[0][0] * inverse_determinant;
+          break;
+        }
+
+        case 3:
+        {
+          // cofactors, transposed
+          for (unsigned int d=0; d<dim; ++d)
+            for (unsigned int e=0; e<dim; ++e)
+              inverse_jacobian[e][d]
+                = (jacobian[(d+1)%dim][(e+1)%dim] * jacobian[(d+2)%dim][(e+2)%dim] -
+                   jacobian[(d+1)%dim][(e+2)%dim] * jacobian[(d+2)%dim][(e+1)%dim]);
+          determinant = (jacobian[0][0] * inverse_jacobian[0][0] +
+                         jacobian[0][1] * inverse_jacobian[1][0] +
+                         jacobian[0][2] * inverse_jacobian[2][0]);
+          const VectorizedArray<Number> inverse_determinant = Number(1.)/determinant;
+          for (unsigned int d=0; d<dim; ++d)
+            for (unsigned int e=0; e<dim; ++e)
+              inverse_jacobian[d][e] *= inverse_determinant;
+          break;
+        }
+
+        default:
+          Assert (false, ExcNotImplemented());
+        }
+
+      if (update_flags & update_JxW_values)
+        JxW_values[q] = determinant * Number(quadrature.weight(q));
+
+      // gradients in real space are the reference gradients multiplied by
+      // the transpose of the inverse Jacobian
+      if (update_flags & update_gradients)
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          {
+            const Tensor<1,dim,Number> &reference_gradient = reference_shape_gradients(i,q);
+            Tensor<1,dim,VectorizedArray<Number> > &gradient = shape_gradients(i,q);
+            for (unsigned int d=0; d<dim; ++d)
+              {
+                gradient[d] = inverse_jacobian[0][d] * reference_gradient[0];
+                for (unsigned int e=1; e<dim; ++e)
+                  gradient[d] += inverse_jacobian[e][d] * reference_gradient[e];
+              }
+          }
+    }
+}
+
+
+
+template <int dim, typename Number>
+std::size_t
+FEValuesVectorized<dim,Number>::memory_consumption () const
+{
+  return (sizeof(*this) +
+          MemoryConsumption::memory_consumption (quadrature) +
+          MemoryConsumption::memory_consumption (cells) +
+          MemoryConsumption::memory_consumption (shape_values) +
+          MemoryConsumption::memory_consumption (reference_shape_gradients) +
+          MemoryConsumption::memory_consumption (vertex_shape_values) +
+          MemoryConsumption::memory_consumption (vertex_shape_gradients) +
+          MemoryConsumption::memory_consumption (shape_gradients) +
+          MemoryConsumption::memory_consumption (JxW_values) +
+          MemoryConsumption::memory_consumption (quadrature_points));
+}
+
+
+// explicit instantiations
+#include "fe_values_vectorized.inst"
+
+DEAL_II_NAMESPACE_CLOSE
@@ -19,9 +19,13 @@
 #include <deal.II/base/qprojector.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/tensor_product_polynomials.h>
+#include <deal.II/base/vectorization.h>
+#include <deal.II/base/aligned_vector.h>
 #include <deal.II/base/memory_consumption.h>
 #include <deal.II/base/std_cxx11/array.h>
 #include <deal.II/base/std_cxx11/unique_ptr.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/base/parallel.h>
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/grid/tria.h>
 #include <deal.II/grid/tria_iterator.h>
@@ -36,6 +40,7 @@
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <limits>
 
 
 DEAL_II_NAMESPACE_OPEN
@@ -1172,7 +1177,9 @@ MappingQGeneric<dim,spacedim>::MappingQGeneric (const unsigned int p)
   line_support_points(this->polynomial_degree+1),
   fe_q(dim == 3 ? new FE_Q<dim>(this->polynomial_degree) : 0),
   support_point_weights_on_quad (compute_support_point_weights_on_quad<dim>(this->polynomial_degree)),
-  support_point_weights_on_hex (compute_support_point_weights_on_hex<dim>(this->polynomial_degree))
+  support_point_weights_on_hex (compute_support_point_weights_on_hex<dim>(this->polynomial_degree)),
+  cached_triangulation (0, typeid(*this).name()),
+  n_cached_cells (0)
 {
   Assert (p >= 1, ExcMessage ("It only makes sense to create polynomial mappings "
                               "with a polynomial degree greater or equal to one."));
@@ -1187,11 +1194,21 @@ MappingQGeneric<dim,spacedim>::MappingQGeneric (const MappingQGeneric<dim,spaced
   line_support_points(mapping.line_support_points),
   fe_q(dim == 3 ? new FE_Q<dim>(*mapping.fe_q) : 0),
   support_point_weights_on_quad (mapping.support_point_weights_on_quad),
-  support_point_weights_on_hex (mapping.support_point_weights_on_hex)
+  support_point_weights_on_hex (mapping.support_point_weights_on_hex),
+  cached_triangulation (0, typeid(*this).name()),
+  n_cached_cells (0)
 {}
 
 
 
+template<int dim, int spacedim>
+MappingQGeneric<dim,spacedim>::~MappingQGeneric ()
+{
+  clear_support_point_cache ();
+}
+
+
+
 
 template<int dim, int spacedim>
 Mapping<dim,spacedim> *
@@ -1212,6 +1229,131 @@ MappingQGeneric<dim,spacedim>::get_degree() const
 
 
 
+template<int dim, int spacedim>
+void
+MappingQGeneric<dim,spacedim>::
+cache_support_points (const Triangulation<dim,spacedim> &triangulation,
+                      const std::size_t                  memory_budget)
+{
+  clear_support_point_cache ();
+
+  const unsigned int n_points_per_cell
+    = Utilities::fixed_power<dim>(polynomial_degree+1);
+  const std::size_t max_cells
+    = memory_budget / (n_points_per_cell * sizeof(Point<spacedim>));
+  const unsigned int n_cells
+    = std::min<std::size_t> (triangulation.n_active_cells(), max_cells);
+  if (n_cells == 0)
+    return;
+
+  std::vector<typename Triangulation<dim,spacedim>::active_cell_iterator> cells;
+  cells.reserve (n_cells);
+  for (typename Triangulation<dim,spacedim>::active_cell_iterator
+       cell = triangulation.begin_active();
+       cell != triangulation.end() && cells.size() < n_cells; ++cell)
+    cells.push_back (cell);
+
+  // computing the support points involves queries to the manifolds, which
+  // are independent for each cell, so work on chunks of cells in parallel
+  cached_support_points.resize (static_cast<std::size_t>(n_cells) *
+                                n_points_per_cell);
+  parallel::apply_to_subranges (0U, n_cells,
+                                std_cxx11::bind (&MappingQGeneric<dim,spacedim>::fill_support_point_cache,
+                                                 this,
+                                                 std_cxx11::cref(cells),
+                                                 std_cxx11::_1,
+                                                 std_cxx11::_2),
+                                64);
+
+  cached_triangulation = &triangulation;
+  n_cached_cells = n_cells;
+  tria_listener = triangulation.signals.any_change.connect
+                  (std_cxx11::bind (&MappingQGeneric<dim,spacedim>::tria_change_listener,
+                                    std_cxx11::ref(*this)));
+}
+
+
+
+template<int dim, int spacedim>
+void
+MappingQGeneric<dim,spacedim>::
+fill_support_point_cache
+(const std::vector<typename Triangulation<dim,spacedim>::active_cell_iterator> &cells,
+ const unsigned int begin,
+ const unsigned int end)
+{
+  const unsigned int n_points_per_cell
+    = Utilities::fixed_power<dim>(polynomial_degree+1);
+  for (unsigned int c=begin; c<end; ++c)
+    {
+      const std::vector<Point<spacedim> > support_points
+        = this->compute_mapping_support_points (cells[c]);
+      AssertDimension (support_points.size(), n_points_per_cell);
+      std::copy (support_points.begin(), support_points.end(),
+                 cached_support_points.begin() +
+                 static_cast<std::size_t>(c) * n_points_per_cell);
+    }
+}
+
+
+
+template<int dim, int spacedim>
+void
+MappingQGeneric<dim,spacedim>::clear_support_point_cache ()
+{
+  tria_listener.disconnect ();
+  cached_triangulation = 0;
+  n_cached_cells = 0;
+  std::vector<Point<spacedim> >().swap (cached_support_points);
+}
+
+
+
+template<int dim, int spacedim>
+unsigned int
+MappingQGeneric<dim,spacedim>::n_cells_with_cached_support_points () const
+{
+  return n_cached_cells;
+}
+
+
+
+template<int dim, int spacedim>
+void
+MappingQGeneric<dim,spacedim>::tria_change_listener ()
+{
+  clear_support_point_cache ();
+}
+
+
+
+template<int dim, int spacedim>
+void
+MappingQGeneric<dim,spacedim>::
+get_mapping_support_points (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+                            std::vector<Point<spacedim> > &support_points) const
+{
+  if (n_cached_cells > 0
+      &&
+      &cell->get_triangulation() == &*cached_triangulation
+      &&
+      cell->active()
+      &&
+      cell->active_cell_index() < n_cached_cells)
+    {
+      const unsigned int n_points_per_cell
+        = Utilities::fixed_power<dim>(polynomial_degree+1);
+      const typename std::vector<Point<spacedim> >::const_iterator
+      begin = cached_support_points.begin() +
+              static_cast<std::size_t>(cell->active_cell_index()) * n_points_per_cell;
+      support_points.assign (begin, begin + n_points_per_cell);
+    }
+  else
+    support_points = this->compute_mapping_support_points (cell);
+}
+
+
+
 template<int dim, int spacedim>
 Point<spacedim>
 MappingQGeneric<dim,spacedim>::
@@ -1232,8 +1374,8 @@ transform_unit_to_real_cell (const typename Triangulation<dim,spacedim>::cell_it
               FiniteElementData<dim> (get_dpo_vector<dim>(polynomial_degree), 1,
                                       polynomial_degree)));
 
-  const std::vector<Point<spacedim> > support_points
-    = this->compute_mapping_support_points(cell);
+  std::vector<Point<spacedim> > support_points;
+  this->get_mapping_support_points (cell, support_points);
 
   Point<spacedim> mapped_point;
   for (unsigned int i=0; i<tensor_pols.n(); ++i)
@@ -1570,6 +1712,280 @@ namespace
   }
 
 
+
+  /**
+   * Evaluate the Lagrange polynomials associated with the points
+   * @p line_points, written as
+   * $w_i \prod_{j\neq i} (x-x_j)$ with the weights @p lagrange_weights, and
+   * their first derivatives for a batch of coordinates @p x.
+   */
+  void
+  evaluate_lagrange_polynomials (const std::vector<double>     &line_points,
+                                 const std::vector<double>     &lagrange_weights,
+                                 const VectorizedArray<double> &x,
+                                 VectorizedArray<double>       *values,
+                                 VectorizedArray<double>       *derivatives)
+  {
+    const unsigned int n = line_points.size();
+    for (unsigned int i=0; i<n; ++i)
+      {
+        VectorizedArray<double> value = make_vectorized_array (lagrange_weights[i]);
+        VectorizedArray<double> derivative = VectorizedArray<double>();
+        for (unsigned int j=0; j<n; ++j)
+          if (j != i)
+            {
+              // product rule for multiplying by the next linear factor
+              const VectorizedArray<double> factor = x - line_points[j];
+              derivative = derivative * factor + value;
+              value *= factor;
+            }
+        values[i] = value;
+        derivatives[i] = derivative;
+      }
+  }
+
+
+
+  /**
+   * For a batch of points @p p_unit on the reference cell, compute the
+   * mapped location of the points and the Jacobian of the mapping at these
+   * points. The mapping is given by the tensor product of the Lagrange
+   * polynomials in @p line_points and the mapping support points
+   * @p support_points in lexicographic order. The arrays
+   * @p shape_values and @p shape_derivatives are scratch arrays of length
+   * <tt>dim*line_points.size()</tt>.
+   */
+  template <int dim>
+  void
+  compute_mapped_location_and_jacobian
+  (const std::vector<Point<dim> >               &support_points,
+   const std::vector<double>                    &line_points,
+   const std::vector<double>                    &lagrange_weights,
+   const Point<dim,VectorizedArray<double> >    &p_unit,
+   AlignedVector<VectorizedArray<double> >      &shape_values,
+   AlignedVector<VectorizedArray<double> >      &shape_derivatives,
+   Point<dim,VectorizedArray<double> >          &p_real,
+   Tensor<2,dim,VectorizedArray<double> >       &jacobian)
+  {
+    const unsigned int n = line_points.size();
+    for (unsigned int d=0; d<dim; ++d)
+      evaluate_lagrange_polynomials (line_points, lagrange_weights, p_unit[d],
+                                     &shape_values[d*n],
+                                     &shape_derivatives[d*n]);
+
+    p_real = Point<dim,VectorizedArray<double> >();
+    jacobian = Tensor<2,dim,VectorizedArray<double> >();
+    for (unsigned int i=0; i<support_points.size(); ++i)
+      {
+        unsigned int index[dim];
+        for (unsigned int d=0, tmp=i; d<dim; ++d, tmp/=n)
+          index[d] = d*n + tmp%n;
+
+        VectorizedArray<double> value = shape_values[index[0]];
+        for (unsigned int d=1; d<dim; ++d)
+          value *= shape_values[index[d]];
+
+        Tensor<1,dim,VectorizedArray<double> > gradient;
+        for (unsigned int d=0; d<dim; ++d)
+          {
+            gradient[d] = shape_derivatives[index[d]];
+            for (unsigned int e=0; e<dim; ++e)
+              if (e != d)
+                gradient[d] *= shape_values[index[e]];
+          }
+
+        for (unsigned int c=0; c<dim; ++c)
+          {
+            p_real[c] += value * support_points[i][c];
+            for (unsigned int d=0; d<dim; ++d)
+              jacobian[c][d] += gradient[d] * support_points[i][c];
+          }
+      }
+  }
+
+
+
+  /**
+   * Implementation of transform_points_real_to_unit_cell for
+   * dim!=spacedim: simply call transform_real_to_unit_cell for each point.
+   */
+  template <int dim, int spacedim>
+  void
+  do_transform_points_real_to_unit_cell
+  (const MappingQGeneric<dim,spacedim>                       &mapping,
+   const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+   const std::vector<Point<spacedim> >                       &,
+   const ArrayView<const Point<spacedim> >                   &real_points,
+   const ArrayView<Point<dim> >                              &unit_points)
+  {
+    for (unsigned int i=0; i<real_points.size(); ++i)
+      try
+        {
+          unit_points[i] = mapping.transform_real_to_unit_cell (cell, real_points[i]);
+        }
+      catch (const typename Mapping<dim,spacedim>::ExcTransformationFailed &)
+        {
+          unit_points[i] = Point<dim>();
+          unit_points[i][0] = std::numeric_limits<double>::infinity();
+        }
+  }
+
+
+
+  /**
+   * Implementation of transform_points_real_to_unit_cell for
+   * dim==spacedim. The initial guess is obtained from the least squares
+   * affine approximation of the mapping through the vertices of the cell
+   * as in transform_real_to_unit_cell_initial_guess(), which is set up and
+   * inverted only once for all points. The Newton iteration then works on
+   * batches of VectorizedArray::n_array_elements points, with the mapping
+   * and its Jacobian evaluated from the tensor product form of the
+   * polynomial space. Unlike in do_transform_real_to_unit_cell_internal(),
+   * there is no line search; points for which the full Newton steps do not
+   * converge are given to the scalar function that does one.
+   */
+  template <int dim>
+  void
+  do_transform_points_real_to_unit_cell
+  (const MappingQGeneric<dim,dim>                       &mapping,
+   const typename Triangulation<dim,dim>::cell_iterator &cell,
+   const std::vector<Point<dim> >                       &support_points,
+   const ArrayView<const Point<dim> >                   &real_points,
+   const ArrayView<Point<dim> >                         &unit_points)
+  {
+    const unsigned int degree = mapping.get_degree();
+    const unsigned int n_lanes = VectorizedArray<double>::n_array_elements;
+
+    // set up the affine approximation A x + b of the mapping and invert it
+    Tensor<2,dim> A;
+    Tensor<1,dim> b;
+    for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+      for (unsigned int i=0; i<dim; ++i)
+        {
+          for (unsigned int j=0; j<dim; ++j)
+            A[i][j] += support_points[v][i] *
+                       internal::MappingQ1::TransformR2UInitialGuess<dim>::KA[v][j];
+          b[i] += support_points[v][i] *
+                  internal::MappingQ1::TransformR2UInitialGuess<dim>::Kb[v];
+        }
+    const bool affine_approximation_invertible
+      = (std::abs(determinant(A)) > 1e-12 * std::pow(cell->diameter(), 1.*dim));
+    const Tensor<2,dim> A_inverse
+      = (affine_approximation_invertible ? invert(A) : Tensor<2,dim>());
+
+    // then bring the support points into lexicographic order and set up
+    // the one-dimensional Lagrange polynomials of the mapping
+    const std::vector<unsigned int>
+    renumber (FETools::
+              lexicographic_to_hierarchic_numbering (
+                FiniteElementData<dim> (get_dpo_vector<dim>(degree), 1,
+                                        degree)));
+    std::vector<Point<dim> > lexicographic_support_points (support_points.size());
+    for (unsigned int i=0; i<support_points.size(); ++i)
+      lexicographic_support_points[i] = support_points[renumber[i]];
+
+    const QGaussLobatto<1> line_support_points (degree + 1);
+    std::vector<double> line_points (degree + 1), lagrange_weights (degree + 1);
+    for (unsigned int i=0; i<=degree; ++i)
+      line_points[i] = line_support_points.point(i)[0];
+    for (unsigned int i=0; i<=degree; ++i)
+      {
+        lagrange_weights[i] = 1.;
+        for (unsigned int j=0; j<=degree; ++j)
+          if (j != i)
+            lagrange_weights[i] /= (line_points[i] - line_points[j]);
+      }
+
+    AlignedVector<VectorizedArray<double> > shape_values (dim*(degree+1));
+    AlignedVector<VectorizedArray<double> > shape_derivatives (dim*(degree+1));
+
+    // use the same tolerance and iteration limit as the scalar code
+    const double eps = 1.e-11;
+    const unsigned int newton_iteration_limit = 20;
+
+    for (unsigned int begin=0; begin<real_points.size(); begin+=n_lanes)
+      {
+        const unsigned int n_points = std::min<unsigned int> (n_lanes,
+                                                              real_points.size()-begin);
+
+        // fill the batch, duplicating the last point into unused lanes
+        Point<dim,VectorizedArray<double> > p, p_unit;
+        bool converged[n_lanes];
+        for (unsigned int v=0; v<n_lanes; ++v)
+          {
+            const Point<dim> &p_v = real_points[begin + std::min(v, n_points-1)];
+
+            Point<dim> initial_p_unit;
+            if (affine_approximation_invertible)
+              {
+                initial_p_unit = Point<dim>(A_inverse * (p_v - b));
+                // as in transform_real_to_unit_cell(), project the initial
+                // guess into the reference cell for higher order mappings
+                if (degree > 1)
+                  initial_p_unit = GeometryInfo<dim>::project_to_unit_cell(initial_p_unit);
+              }
+            else
+              for (unsigned int d=0; d<dim; ++d)
+                initial_p_unit[d] = 0.5;
+
+            for (unsigned int d=0; d<dim; ++d)
+              {
+                p[d][v] = p_v[d];
+                p_unit[d][v] = initial_p_unit[d];
+              }
+            converged[v] = (v >= n_points);
+          }
+
+        for (unsigned int newton_iteration=0;
+             newton_iteration<newton_iteration_limit; ++newton_iteration)
+          {
+            Point<dim,VectorizedArray<double> > p_real;
+            Tensor<2,dim,VectorizedArray<double> > jacobian;
+            compute_mapped_location_and_jacobian (lexicographic_support_points,
+                                                  line_points, lagrange_weights,
+                                                  p_unit, shape_values,
+                                                  shape_derivatives,
+                                                  p_real, jacobian);
+
+            // solve [f'(x)] delta = f(x). the norm of delta is the norm of
+            // the residual weighted by the Jacobian as in the scalar code
+            const Tensor<1,dim,VectorizedArray<double> > delta
+              = invert(jacobian) * (p_real - p);
+
+            bool all_converged = true;
+            for (unsigned int v=0; v<n_lanes; ++v)
+              if (converged[v] == false)
+                {
+                  double delta_norm_square = 0;
+                  for (unsigned int d=0; d<dim; ++d)
+                    {
+                      p_unit[d][v] -= delta[d][v];
+                      delta_norm_square += delta[d][v] * delta[d][v];
+                    }
+                  // note that this comparison is false for NaN, e.g. when
+                  // the Jacobian is singular
+                  if (delta_norm_square < eps*eps)
+                    converged[v] = true;
+                  else
+                    all_converged = false;
+                }
+            if (all_converged)
+              break;
+          }
+
+        for (unsigned int v=0; v<n_points; ++v)
+          if (converged[v])
+            for (unsigned int d=0; d<dim; ++d)
+              unit_points[begin+v][d] = p_unit[d][v];
+          else
+            do_transform_points_real_to_unit_cell<dim,dim>
+            (mapping, cell, support_points,
+             ArrayView<const Point<dim> >(&real_points[begin+v], 1),
+             ArrayView<Point<dim> >(&unit_points[begin+v], 1));
+      }
+  }
+
+
 }
 
 
@@ -1612,7 +2028,7 @@ transform_real_to_unit_cell_internal
   std_cxx11::unique_ptr<InternalData> mdata (get_data(update_flags,
                                                       point_quadrature));
 
-  mdata->mapping_support_points = this->compute_mapping_support_points (cell);
+  this->get_mapping_support_points (cell, mdata->mapping_support_points);
 
   // dispatch to the various specializations for spacedim=dim,
   // spacedim=dim+1, etc
@@ -1638,7 +2054,7 @@ transform_real_to_unit_cell_internal
   std_cxx11::unique_ptr<InternalData> mdata (get_data(update_flags,
                                                       point_quadrature));
 
-  mdata->mapping_support_points = this->compute_mapping_support_points (cell);
+  this->get_mapping_support_points (cell, mdata->mapping_support_points);
 
   // dispatch to the various specializations for spacedim=dim,
   // spacedim=dim+1, etc
@@ -1664,7 +2080,7 @@ transform_real_to_unit_cell_internal
   std_cxx11::unique_ptr<InternalData> mdata (get_data(update_flags,
                                                       point_quadrature));
 
-  mdata->mapping_support_points = this->compute_mapping_support_points (cell);
+  this->get_mapping_support_points (cell, mdata->mapping_support_points);
 
   // dispatch to the various specializations for spacedim=dim,
   // spacedim=dim+1, etc
@@ -1690,7 +2106,7 @@ transform_real_to_unit_cell_internal
   std_cxx11::unique_ptr<InternalData> mdata (get_data(update_flags,
                                                       point_quadrature));
 
-  mdata->mapping_support_points = this->compute_mapping_support_points (cell);
+  this->get_mapping_support_points (cell, mdata->mapping_support_points);
 
   // dispatch to the various specializations for spacedim=dim,
   // spacedim=dim+1, etc
@@ -1716,7 +2132,7 @@ transform_real_to_unit_cell_internal
   std_cxx11::unique_ptr<InternalData> mdata (get_data(update_flags,
                                                       point_quadrature));
 
-  mdata->mapping_support_points = this->compute_mapping_support_points (cell);
+  this->get_mapping_support_points (cell, mdata->mapping_support_points);
 
   // dispatch to the various specializations for spacedim=dim,
   // spacedim=dim+1, etc
@@ -1832,8 +2248,8 @@ transform_real_to_unit_cell (const typename Triangulation<dim,spacedim>::cell_it
       // Find the initial value for the Newton iteration by a normal
       // projection to the least square plane determined by the vertices
       // of the cell
-      const std::vector<Point<spacedim> > a
-        = this->compute_mapping_support_points (cell);
+      std::vector<Point<spacedim> > a;
+      this->get_mapping_support_points (cell, a);
       Assert(a.size() == GeometryInfo<dim>::vertices_per_cell,
              ExcInternalError());
       initial_p_unit = internal::MappingQ1::transform_real_to_unit_cell_initial_guess<dim,spacedim>(a,p);
@@ -1849,8 +2265,8 @@ transform_real_to_unit_cell (const typename Triangulation<dim,spacedim>::cell_it
           // we do this by first getting all support points, then
           // throwing away all but the vertices, and finally calling
           // the same function as above
-          std::vector<Point<spacedim> > a
-            = this->compute_mapping_support_points (cell);
+          std::vector<Point<spacedim> > a;
+          this->get_mapping_support_points (cell, a);
           a.resize(GeometryInfo<dim>::vertices_per_cell);
           initial_p_unit = internal::MappingQ1::transform_real_to_unit_cell_initial_guess<dim,spacedim>(a,p);
         }
@@ -1878,6 +2294,28 @@ transform_real_to_unit_cell (const typename Triangulation<dim,spacedim>::cell_it
 
 
 
+template<int dim, int spacedim>
+void
+MappingQGeneric<dim,spacedim>::
+transform_points_real_to_unit_cell (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+                                    const ArrayView<const Point<spacedim> >                   &real_points,
+                                    const ArrayView<Point<dim> >                              &unit_points) const
+{
+  AssertDimension (real_points.size(), unit_points.size());
+  if (real_points.size() == 0)
+    return;
+
+  std::vector<Point<spacedim> > support_points;
+  this->get_mapping_support_points (cell, support_points);
+
+  // dispatch to the various specializations for spacedim=dim and
+  // spacedim>dim
+  do_transform_points_real_to_unit_cell (*this, cell, support_points,
+                                         real_points, unit_points);
+}
+
+
+
 template<int dim, int spacedim>
 UpdateFlags
 MappingQGeneric<dim,spacedim>::requires_update_flags (const UpdateFlags in) const
@@ -2553,7 +2991,7 @@ fill_fe_values (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
       ||
       (cell != data.cell_of_current_support_points))
     {
-      data.mapping_support_points = this->compute_mapping_support_points(cell);
+      this->get_mapping_support_points (cell, data.mapping_support_points);
       data.cell_of_current_support_points = cell;
     }
 
@@ -2945,7 +3383,7 @@ fill_fe_face_values (const typename Triangulation<dim,spacedim>::cell_iterator &
       ||
       (cell != data.cell_of_current_support_points))
     {
-      data.mapping_support_points = this->compute_mapping_support_points(cell);
+      this->get_mapping_support_points (cell, data.mapping_support_points);
       data.cell_of_current_support_points = cell;
     }
 
@@ -2990,7 +3428,7 @@ fill_fe_subface_values (const typename Triangulation<dim,spacedim>::cell_iterato
       ||
       (cell != data.cell_of_current_support_points))
     {
-      data.mapping_support_points = this->compute_mapping_support_points(cell);
+      this->get_mapping_support_points (cell, data.mapping_support_points);
       data.cell_of_current_support_points = cell;
     }
 
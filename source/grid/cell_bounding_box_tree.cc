@@ -0,0 +1,583 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/fe/mapping_q.h>
+#include <deal.II/fe/mapping_q_generic.h>
+#include <deal.II/grid/cell_bounding_box_tree.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+
+#include <algorithm>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace
+{
+  /**
+   * Comparison of the bounding boxes with the given indices by their
+   * centers in the given coordinate direction.
+   */
+  template <int spacedim>
+  struct CompareBoxCenters
+  {
+    CompareBoxCenters (const std::vector<std::pair<Point<spacedim>,Point<spacedim> > > &boxes,
+                       const unsigned int                                               direction)
+      :
+      boxes (boxes),
+      direction (direction)
+    {}
+
+    bool operator () (const unsigned int a,
+                      const unsigned int b) const
+    {
+      return (boxes[a].first[direction] + boxes[a].second[direction] <
+              boxes[b].first[direction] + boxes[b].second[direction]);
+    }
+
+    const std::vector<std::pair<Point<spacedim>,Point<spacedim> > > &boxes;
+    const unsigned int direction;
+  };
+
+
+
+  /**
+   * Return whether the point is inside the box given by its lower and upper
+   * corner, including the boundary of the box.
+   */
+  template <int spacedim>
+  inline
+  bool
+  box_contains_point (const Point<spacedim> &lower_corner,
+                      const Point<spacedim> &upper_corner,
+                      const Point<spacedim> &p)
+  {
+    for (unsigned int d=0; d<spacedim; ++d)
+      if (p[d] < lower_corner[d] || p[d] > upper_corner[d])
+        return false;
+    return true;
+  }
+}
+
+
+
+template <int dim, int spacedim>
+const unsigned int CellBoundingBoxTree<dim,spacedim>::max_cells_per_leaf;
+
+
+
+template <int dim, int spacedim>
+CellBoundingBoxTree<dim,spacedim>::CellBoundingBoxTree ()
+  :
+  tria (0, typeid(*this).name()),
+  mapping (0, typeid(*this).name()),
+  boxes_are_exact (true),
+  is_built (false)
+{}
+
+
+
+template <int dim, int spacedim>
+CellBoundingBoxTree<dim,spacedim>::
+CellBoundingBoxTree (const Triangulation<dim,spacedim> &triangulation,
+                     const Mapping<dim,spacedim>       &mapping)
+  :
+  tria (0, typeid(*this).name()),
+  mapping (0, typeid(*this).name()),
+  boxes_are_exact (true),
+  is_built (false)
+{
+  initialize (triangulation, mapping);
+}
+
+
+
+template <int dim, int spacedim>
+CellBoundingBoxTree<dim,spacedim>::~CellBoundingBoxTree ()
+{
+  clear ();
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::
+initialize (const Triangulation<dim,spacedim> &triangulation,
+            const Mapping<dim,spacedim>       &mapping)
+{
+  clear ();
+
+  tria = &triangulation;
+  this->mapping = &mapping;
+  tria_listener = triangulation.signals.any_change.connect
+                  (std_cxx11::bind (&CellBoundingBoxTree<dim,spacedim>::tria_change_listener,
+                                    std_cxx11::ref(*this)));
+
+  build ();
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::clear ()
+{
+  tria_listener.disconnect ();
+  tria = 0;
+  mapping = 0;
+  is_built = false;
+  std::vector<std::pair<int,int> >().swap (cells);
+  std::vector<std::pair<Point<spacedim>,Point<spacedim> > >().swap (cell_boxes);
+  std::vector<Node>().swap (nodes);
+  std::vector<Point<dim> >().swap (unit_points);
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::tria_change_listener ()
+{
+  is_built = false;
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::build_if_necessary () const
+{
+  Assert (tria != 0, ExcNotInitialized());
+
+  Threads::Mutex::ScopedLock lock (mutex);
+  if (is_built == false)
+    build ();
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::build () const
+{
+  // the bounding box of the vertices contains the whole cell only for
+  // (bi-, tri-)linear mappings. for all others, sample the cell at a
+  // lattice of points that is twice as fine as the support points of the
+  // mapping
+  unsigned int degree = numbers::invalid_unsigned_int;
+  if (const MappingQGeneric<dim,spacedim> *mapping_q_generic
+      = dynamic_cast<const MappingQGeneric<dim,spacedim> *>(&*mapping))
+    degree = mapping_q_generic->get_degree();
+  else if (const MappingQ<dim,spacedim> *mapping_q
+           = dynamic_cast<const MappingQ<dim,spacedim> *>(&*mapping))
+    degree = mapping_q->get_degree();
+
+  boxes_are_exact = (degree == 1);
+  unit_points = (boxes_are_exact
+                 ?
+                 std::vector<Point<dim> >()
+                 :
+                 QIterated<dim>(QTrapez<1>(),
+                                degree == numbers::invalid_unsigned_int ? 4 : 2*degree).get_points());
+
+  cells.clear ();
+  cells.reserve (tria->n_active_cells());
+  for (active_cell_iterator cell = tria->begin_active(); cell != tria->end(); ++cell)
+    cells.push_back (std::make_pair (cell->level(), cell->index()));
+
+  cell_boxes.resize (cells.size());
+  parallel::apply_to_subranges (0U, static_cast<unsigned int>(cells.size()),
+                                std_cxx11::bind (&CellBoundingBoxTree<dim,spacedim>::compute_cell_boxes,
+                                                 this,
+                                                 std_cxx11::_1, std_cxx11::_2),
+                                64);
+
+  // build the tree on a permutation of the cells, and then sort the cells
+  // and their boxes into the order of the leaves of the tree
+  std::vector<unsigned int> order (cells.size());
+  for (unsigned int i=0; i<order.size(); ++i)
+    order[i] = i;
+
+  nodes.clear ();
+  if (cells.size() > 0)
+    {
+      nodes.reserve (2*(cells.size()/max_cells_per_leaf+1));
+      nodes.push_back (Node());
+      build_node (0, 0, cells.size(), order);
+    }
+
+  std::vector<std::pair<int,int> > sorted_cells (cells.size());
+  std::vector<std::pair<Point<spacedim>,Point<spacedim> > > sorted_boxes (cells.size());
+  for (unsigned int i=0; i<order.size(); ++i)
+    {
+      sorted_cells[i] = cells[order[i]];
+      sorted_boxes[i] = cell_boxes[order[i]];
+    }
+  cells.swap (sorted_cells);
+  cell_boxes.swap (sorted_boxes);
+
+  is_built = true;
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::
+compute_cell_boxes (const unsigned int begin,
+                    const unsigned int end) const
+{
+  for (unsigned int i=begin; i<end; ++i)
+    compute_cell_box (active_cell_iterator (&*tria, cells[i].first, cells[i].second),
+                      cell_boxes[i].first, cell_boxes[i].second);
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::
+compute_cell_box (const active_cell_iterator &cell,
+                  Point<spacedim>            &lower_corner,
+                  Point<spacedim>            &upper_corner) const
+{
+  if (boxes_are_exact)
+    {
+      const std_cxx11::array<Point<spacedim>, GeometryInfo<dim>::vertices_per_cell>
+      vertices = mapping->get_vertices (cell);
+      lower_corner = upper_corner = vertices[0];
+      for (unsigned int v=1; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+        for (unsigned int d=0; d<spacedim; ++d)
+          {
+            lower_corner[d] = std::min (lower_corner[d], vertices[v][d]);
+            upper_corner[d] = std::max (upper_corner[d], vertices[v][d]);
+          }
+    }
+  else
+    for (unsigned int q=0; q<unit_points.size(); ++q)
+      {
+        const Point<spacedim> point
+          = mapping->transform_unit_to_real_cell (cell, unit_points[q]);
+        if (q == 0)
+          lower_corner = upper_corner = point;
+        else
+          for (unsigned int d=0; d<spacedim; ++d)
+            {
+              lower_corner[d] = std::min (lower_corner[d], point[d]);
+              upper_corner[d] = std::max (upper_corner[d], point[d]);
+            }
+      }
+
+  // enlarge the box slightly to account for roundoff in the transformation
+  // to the reference cell, or by a larger amount if the box has only been
+  // sampled and the cell may bulge out of it
+  double extent = 0;
+  for (unsigned int d=0; d<spacedim; ++d)
+    extent = std::max (extent, upper_corner[d] - lower_corner[d]);
+  const double padding = (boxes_are_exact ? 1e-8 : 0.1) * extent;
+  for (unsigned int d=0; d<spacedim; ++d)
+    {
+      lower_corner[d] -= padding;
+      upper_corner[d] += padding;
+    }
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::
+build_node (const unsigned int         node,
+            const unsigned int         begin,
+            const unsigned int         end,
+            std::vector<unsigned int> &order) const
+{
+  Assert (end > begin, ExcInternalError());
+
+  nodes[node].begin = begin;
+  nodes[node].end = end;
+  nodes[node].second_child = numbers::invalid_unsigned_int;
+  nodes[node].lower_corner = cell_boxes[order[begin]].first;
+  nodes[node].upper_corner = cell_boxes[order[begin]].second;
+  for (unsigned int i=begin+1; i<end; ++i)
+    for (unsigned int d=0; d<spacedim; ++d)
+      {
+        nodes[node].lower_corner[d] = std::min (nodes[node].lower_corner[d],
+                                                cell_boxes[order[i]].first[d]);
+        nodes[node].upper_corner[d] = std::max (nodes[node].upper_corner[d],
+                                                cell_boxes[order[i]].second[d]);
+      }
+
+  if (end - begin <= max_cells_per_leaf)
+    return;
+
+  // split the cells at the median of their centers in the direction in
+  // which the box of the node is largest
+  unsigned int direction = 0;
+  for (unsigned int d=1; d<spacedim; ++d)
+    if (nodes[node].upper_corner[d] - nodes[node].lower_corner[d] >
+        nodes[node].upper_corner[direction] - nodes[node].lower_corner[direction])
+      direction = d;
+
+  const unsigned int middle = begin + (end - begin) / 2;
+  std::nth_element (order.begin()+begin, order.begin()+middle, order.begin()+end,
+                    CompareBoxCenters<spacedim> (cell_boxes, direction));
+
+  // the first child directly follows its parent, the second one comes after
+  // all descendants of the first child
+  nodes.push_back (Node());
+  build_node (node+1, begin, middle, order);
+
+  nodes[node].second_child = nodes.size();
+  nodes.push_back (Node());
+  build_node (nodes[node].second_child, middle, end, order);
+}
+
+
+
+template <int dim, int spacedim>
+bool
+CellBoundingBoxTree<dim,spacedim>::
+find_cell_in_tree (const Point<spacedim>                       &p,
+                   std::pair<active_cell_iterator, Point<dim> > &result) const
+{
+  // as in GridTools::find_active_cell_around_point, accept points at a
+  // distance of up to 1e-10 outside of the reference cell
+  double best_distance = 1e-10;
+  int    best_level = -1;
+  int    best_index = -1;
+
+  if (nodes.size() == 0)
+    return false;
+
+  // traverse the tree depth first. since the tree is balanced, its depth is
+  // bounded by the logarithm of the number of cells
+  unsigned int stack[64];
+  unsigned int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0)
+    {
+      const Node &node = nodes[stack[--stack_size]];
+      if (!box_contains_point (node.lower_corner, node.upper_corner, p))
+        continue;
+
+      if (node.second_child != numbers::invalid_unsigned_int)
+        {
+          Assert (stack_size+2 <= 64, ExcInternalError());
+          stack[stack_size++] = node.second_child;
+          stack[stack_size++] = &node - &nodes[0] + 1;
+          continue;
+        }
+
+      for (unsigned int i=node.begin; i<node.end; ++i)
+        if (box_contains_point (cell_boxes[i].first, cell_boxes[i].second, p))
+          {
+            const active_cell_iterator cell (&*tria, cells[i].first, cells[i].second);
+            try
+              {
+                const Point<dim> p_cell = mapping->transform_real_to_unit_cell (cell, p);
+                const double distance = GeometryInfo<dim>::distance_to_unit_cell (p_cell);
+
+                if ((distance < best_distance)
+                    ||
+                    ((distance == best_distance)
+                     &&
+                     ((cell->level() > best_level)
+                      ||
+                      ((cell->level() == best_level) && (cell->index() < best_index)))))
+                  {
+                    best_distance = distance;
+                    best_level    = cell->level();
+                    best_index    = cell->index();
+                    result        = std::make_pair (cell, p_cell);
+                  }
+              }
+            catch (const typename Mapping<dim,spacedim>::ExcTransformationFailed &)
+              {
+                // the point is far outside of this cell, so the cell can not
+                // be the one we are looking for
+              }
+          }
+    }
+
+  return (best_level != -1);
+}
+
+
+
+template <int dim, int spacedim>
+bool
+CellBoundingBoxTree<dim,spacedim>::
+fallback_is_necessary (const Point<spacedim> &p) const
+{
+  return (boxes_are_exact == false &&
+          nodes.size() > 0 &&
+          box_contains_point (nodes[0].lower_corner, nodes[0].upper_corner, p));
+}
+
+
+
+template <int dim, int spacedim>
+std::pair<typename CellBoundingBoxTree<dim,spacedim>::active_cell_iterator, Point<dim> >
+CellBoundingBoxTree<dim,spacedim>::
+find_active_cell_around_point (const Point<spacedim> &p) const
+{
+  build_if_necessary ();
+
+  std::pair<active_cell_iterator, Point<dim> > result;
+  if (find_cell_in_tree (p, result))
+    return result;
+
+  // if the boxes are only approximate, the point might still be in a cell
+  // that bulges out of its box. we do not expect cells to bulge out of the
+  // (enlarged) box around the whole mesh, though
+  if (fallback_is_necessary (p))
+    return GridTools::find_active_cell_around_point (*mapping, *tria, p);
+
+  AssertThrow (false, GridTools::ExcPointNotFound<spacedim>(p));
+  return result;
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::
+find_cells_on_subrange (const std::vector<Point<spacedim> > *points,
+                        std::vector<active_cell_iterator>   *cells,
+                        std::vector<Point<dim> >            *reference_points,
+                        const unsigned int                   begin,
+                        const unsigned int                   end) const
+{
+  for (unsigned int i=begin; i<end; ++i)
+    {
+      std::pair<active_cell_iterator, Point<dim> > result;
+      if (find_cell_in_tree ((*points)[i], result) == false)
+        {
+          result.first = tria->end();
+          if (fallback_is_necessary ((*points)[i]))
+            try
+              {
+                result = GridTools::find_active_cell_around_point (*mapping, *tria,
+                                                                   (*points)[i]);
+              }
+            catch (const GridTools::ExcPointNotFound<spacedim> &)
+              {
+                result.first = tria->end();
+              }
+        }
+      (*cells)[i] = result.first;
+      (*reference_points)[i] = result.second;
+    }
+}
+
+
+
+template <int dim, int spacedim>
+void
+CellBoundingBoxTree<dim,spacedim>::
+find_active_cells_around_points (const std::vector<Point<spacedim> > &points,
+                                 std::vector<active_cell_iterator>   &cells,
+                                 std::vector<Point<dim> >            &reference_points) const
+{
+  build_if_necessary ();
+
+  cells.resize (points.size());
+  reference_points.resize (points.size());
+  parallel::apply_to_subranges (0U, static_cast<unsigned int>(points.size()),
+                                std_cxx11::bind (&CellBoundingBoxTree<dim,spacedim>::find_cells_on_subrange,
+                                                 this, &points, &cells, &reference_points,
+                                                 std_cxx11::_1, std_cxx11::_2),
+                                32);
+}
+
+
+
+template <int dim, int spacedim>
+std::vector<typename CellBoundingBoxTree<dim,spacedim>::active_cell_iterator>
+CellBoundingBoxTree<dim,spacedim>::
+find_cells_with_bounding_box_around_point (const Point<spacedim> &p) const
+{
+  build_if_necessary ();
+
+  std::vector<active_cell_iterator> result;
+  if (nodes.size() == 0)
+    return result;
+
+  unsigned int stack[64];
+  unsigned int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0)
+    {
+      const unsigned int node = stack[--stack_size];
+      if (!box_contains_point (nodes[node].lower_corner, nodes[node].upper_corner, p))
+        continue;
+
+      if (nodes[node].second_child != numbers::invalid_unsigned_int)
+        {
+          Assert (stack_size+2 <= 64, ExcInternalError());
+          stack[stack_size++] = nodes[node].second_child;
+          stack[stack_size++] = node+1;
+        }
+      else
+        for (unsigned int i=nodes[node].begin; i<nodes[node].end; ++i)
+          if (box_contains_point (cell_boxes[i].first, cell_boxes[i].second, p))
+            result.push_back (active_cell_iterator (&*tria, cells[i].first,
+                                                    cells[i].second));
+    }
+  return result;
+}
+
+
+
+template <int dim, int spacedim>
+std::pair<Point<spacedim>,Point<spacedim> >
+CellBoundingBoxTree<dim,spacedim>::
+get_cell_bounding_box (const active_cell_iterator &cell) const
+{
+  build_if_necessary ();
+  Assert (&cell->get_triangulation() == &*tria,
+          ExcMessage ("The cell must belong to the triangulation of this object."));
+
+  std::pair<Point<spacedim>,Point<spacedim> > box;
+  compute_cell_box (cell, box.first, box.second);
+  return box;
+}
+
+
+
+template <int dim, int spacedim>
+std::size_t
+CellBoundingBoxTree<dim,spacedim>::memory_consumption () const
+{
+  return (sizeof(*this) +
+          MemoryConsumption::memory_consumption (cells) +
+          MemoryConsumption::memory_consumption (cell_boxes) +
+          MemoryConsumption::memory_consumption (unit_points) +
+          nodes.capacity() * sizeof(Node));
+}
+
+
+
+// explicit instantiations
+#include "cell_bounding_box_tree.inst"
+
+DEAL_II_NAMESPACE_CLOSE
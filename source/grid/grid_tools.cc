@@ -532,6 +532,152 @@ namespace GridTools
 
 
 
+  namespace
+  {
+    /**
+     * Transform the integer coordinates @p x, each with @p n_bits bits, into
+     * the transposed form of their index along the Hilbert curve, following
+     * J. Skilling, "Programming the Hilbert curve", AIP Conference
+     * Proceedings 707 (2004), pp. 381-387. Interleaving the bits of the
+     * result yields the Hilbert index.
+     */
+    template <int spacedim>
+    void
+    hilbert_axes_to_transpose (unsigned int       (&x)[spacedim],
+                               const unsigned int   n_bits)
+    {
+      const unsigned int m = 1U << (n_bits-1);
+
+      // undo excess work
+      for (unsigned int q=m; q>1; q>>=1)
+        {
+          const unsigned int p = q-1;
+          for (unsigned int i=0; i<spacedim; ++i)
+            if (x[i] & q)
+              x[0] ^= p;
+            else
+              {
+                const unsigned int t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+              }
+        }
+
+      // Gray encode
+      for (unsigned int i=1; i<spacedim; ++i)
+        x[i] ^= x[i-1];
+      unsigned int t = 0;
+      for (unsigned int q=m; q>1; q>>=1)
+        if (x[spacedim-1] & q)
+          t ^= q-1;
+      for (unsigned int i=0; i<spacedim; ++i)
+        x[i] ^= t;
+    }
+
+
+
+    /**
+     * Interleave the lowest @p n_bits bits of the given integers, starting
+     * with the most significant bit of the first one.
+     */
+    template <int spacedim>
+    unsigned long long int
+    interleave_bits (const unsigned int (&x)[spacedim],
+                     const unsigned int   n_bits)
+    {
+      unsigned long long int key = 0;
+      for (int b=n_bits-1; b>=0; --b)
+        for (unsigned int i=0; i<spacedim; ++i)
+          key = (key << 1) | ((x[i] >> b) & 1U);
+      return key;
+    }
+  }
+
+
+
+  template <int spacedim>
+  std::vector<unsigned int>
+  compute_space_filling_curve_order (const std::vector<Point<spacedim> > &points,
+                                     const SpaceFillingCurve              curve)
+  {
+    Assert (curve == hilbert_curve || curve == morton_curve,
+            ExcNotImplemented());
+
+    if (points.size() == 0)
+      return std::vector<unsigned int>();
+
+    Point<spacedim> lower_corner = points[0],
+                    upper_corner = points[0];
+    for (unsigned int i=1; i<points.size(); ++i)
+      for (unsigned int d=0; d<spacedim; ++d)
+        {
+          lower_corner[d] = std::min (lower_corner[d], points[i][d]);
+          upper_corner[d] = std::max (upper_corner[d], points[i][d]);
+        }
+
+    // the keys have 64 bits, but the integer coordinates are restricted to
+    // 32 bits
+    const unsigned int n_bits = std::min (32, 64/spacedim);
+    const double max_coordinate = std::ldexp (1., n_bits) - 1.;
+
+    std::vector<std::pair<unsigned long long int,unsigned int> > keys (points.size());
+    for (unsigned int i=0; i<points.size(); ++i)
+      {
+        unsigned int x[spacedim];
+        for (unsigned int d=0; d<spacedim; ++d)
+          x[d] = (upper_corner[d] > lower_corner[d]
+                  ?
+                  static_cast<unsigned int>((points[i][d] - lower_corner[d]) /
+                                            (upper_corner[d] - lower_corner[d]) *
+                                            max_coordinate)
+                  :
+                  0);
+
+        // in 1d, both curves simply follow the coordinate axis
+        if (curve == hilbert_curve && spacedim > 1)
+          hilbert_axes_to_transpose<spacedim> (x, n_bits);
+
+        keys[i] = std::make_pair (interleave_bits<spacedim> (x, n_bits), i);
+      }
+
+    std::sort (keys.begin(), keys.end());
+
+    std::vector<unsigned int> order (points.size());
+    for (unsigned int i=0; i<points.size(); ++i)
+      order[i] = keys[i].second;
+    return order;
+  }
+
+
+
+  template <int dim, int spacedim>
+  void
+  reorder_cells_along_space_filling_curve (const std::vector<Point<spacedim> > &all_vertices,
+                                           std::vector<CellData<dim> >         &cells,
+                                           const SpaceFillingCurve              curve)
+  {
+    std::vector<Point<spacedim> > centers (cells.size());
+    for (unsigned int c=0; c<cells.size(); ++c)
+      {
+        for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+          {
+            AssertIndexRange (cells[c].vertices[v], all_vertices.size());
+            centers[c] += all_vertices[cells[c].vertices[v]];
+          }
+        centers[c] /= GeometryInfo<dim>::vertices_per_cell;
+      }
+
+    const std::vector<unsigned int> order
+      = compute_space_filling_curve_order (centers, curve);
+
+    std::vector<CellData<dim> > reordered_cells (cells.size());
+    for (unsigned int c=0; c<cells.size(); ++c)
+      reordered_cells[c] = cells[order[c]];
+    cells.swap (reordered_cells);
+  }
+
+
+
 // define some transformations in an anonymous namespace
   namespace
   {
@@ -2045,6 +2191,19 @@ next_cell:
   void
   partition_triangulation (const unsigned int           n_partitions,
                            Triangulation<dim,spacedim> &triangulation)
+  {
+    partition_triangulation (n_partitions,
+                             std::vector<unsigned int>(),
+                             triangulation);
+  }
+
+
+
+  template <int dim, int spacedim>
+  void
+  partition_triangulation (const unsigned int               n_partitions,
+                           const std::vector<unsigned int> &cell_weights,
+                           Triangulation<dim,spacedim>     &triangulation)
   {
     Assert ((dynamic_cast<parallel::distributed::Triangulation<dim,spacedim>*>
              (&triangulation)
@@ -2074,6 +2233,7 @@ next_cell:
     get_face_connectivity_of_cells (triangulation, cell_connectivity);
 
     partition_triangulation (n_partitions,
+                             cell_weights,
                              cell_connectivity,
                              triangulation);
   }
@@ -2085,6 +2245,21 @@ next_cell:
   partition_triangulation (const unsigned int           n_partitions,
                            const SparsityPattern        &cell_connection_graph,
                            Triangulation<dim,spacedim>  &triangulation)
+  {
+    partition_triangulation (n_partitions,
+                             std::vector<unsigned int>(),
+                             cell_connection_graph,
+                             triangulation);
+  }
+
+
+
+  template <int dim, int spacedim>
+  void
+  partition_triangulation (const unsigned int               n_partitions,
+                           const std::vector<unsigned int> &cell_weights,
+                           const SparsityPattern           &cell_connection_graph,
+                           Triangulation<dim,spacedim>     &triangulation)
   {
     Assert ((dynamic_cast<parallel::distributed::Triangulation<dim,spacedim>*>
              (&triangulation)
@@ -2097,6 +2272,11 @@ next_cell:
             ExcMessage ("Connectivity graph has wrong size"));
     Assert (cell_connection_graph.n_cols() == triangulation.n_active_cells(),
             ExcMessage ("Connectivity graph has wrong size"));
+    Assert ((cell_weights.size() == 0)
+            ||
+            (cell_weights.size() == triangulation.n_active_cells()),
+            ExcDimensionMismatch (cell_weights.size(),
+                                  triangulation.n_active_cells()));
 
     // check for an easy return
     if (n_partitions == 1)
@@ -2113,7 +2293,8 @@ next_cell:
     // of freedom (which is associated with a
     // cell)
     std::vector<unsigned int> partition_indices (triangulation.n_active_cells());
-    SparsityTools::partition (cell_connection_graph, n_partitions,  partition_indices);
+    SparsityTools::partition (cell_connection_graph, cell_weights,
+                              n_partitions, partition_indices);
 
     // finally loop over all cells and set the
     // subdomain ids
@@ -17,6 +17,7 @@
 #include <deal.II/base/memory_consumption.h>
 #include <deal.II/base/table.h>
 #include <deal.II/base/geometry_info.h>
+#include <deal.II/base/parallel.h>
 #include <deal.II/base/std_cxx11/bind.h>
 
 #include <deal.II/grid/tria.h>
@@ -603,6 +604,61 @@ namespace
   }
 
 
+
+  /**
+   * Compute the centers of the objects with indices in the range
+   * [begin,end) of the given list, where the second element of each pair
+   * denotes whether the center is to be computed as a weighted mean of
+   * the vertices and the midpoints of the lower-dimensional objects
+   * (using Laplace weights) rather than by the manifold alone. These are
+   * the locations of the new vertices created when refining the objects.
+   */
+  template <typename Iterator>
+  void
+  compute_new_vertex_locations_on_subrange
+  (const std::vector<std::pair<Iterator,bool> >                            *objects,
+   std::vector<Point<Iterator::AccessorType::space_dimension> >           *locations,
+   const unsigned int                                                      begin,
+   const unsigned int                                                      end)
+  {
+    for (unsigned int i=begin; i<end; ++i)
+      (*locations)[i] = (*objects)[i].first->center (true, (*objects)[i].second);
+  }
+
+
+
+  /**
+   * Compute the locations of the new vertices at the centers of the given
+   * objects, in the same way as they would be computed when the objects
+   * are refined one after the other. Since the manifold may be expensive
+   * to query, the work is split into chunks that are processed in
+   * parallel. This requires the <code>get_new_point*</code> functions of
+   * the manifolds to be thread-safe, as documented in the Manifold class;
+   * calling MultithreadInfo::set_thread_limit(1) makes this function run
+   * sequentially. The objects must already have been refined to the extent
+   * that the midpoints of their bounding lines and faces are available,
+   * and the result only depends on the object itself, so that the
+   * locations are identical to the ones computed sequentially.
+   */
+  template <typename Iterator>
+  void
+  compute_new_vertex_locations
+  (const std::vector<std::pair<Iterator,bool> >                  &objects,
+   std::vector<Point<Iterator::AccessorType::space_dimension> > &locations)
+  {
+    locations.resize (objects.size());
+
+    // evaluating a manifold takes on the order of a microsecond, so chunks
+    // of a few dozen objects already amortize the cost of spawning a task
+    const unsigned int grain_size = 32;
+    parallel::apply_to_subranges (0U, static_cast<unsigned int>(objects.size()),
+                                  std_cxx11::bind (&compute_new_vertex_locations_on_subrange<Iterator>,
+                                                   &objects, &locations,
+                                                   std_cxx11::_1, std_cxx11::_2),
+                                  grain_size);
+  }
+
+
   /**
    * Collect all coarse mesh cells
    * with at least one vertex at
@@ -5004,12 +5060,8 @@ namespace internal
         // use them to flag which lines and quads need refinement
         triangulation.faces->quads.clear_user_data();
 
-        for (typename Triangulation<dim,spacedim>::line_iterator
-             line=triangulation.begin_line(); line!=triangulation.end_line(); ++line)
-          line->clear_user_flag();
-        for (typename Triangulation<dim,spacedim>::quad_iterator
-             quad=triangulation.begin_quad(); quad!=triangulation.end_quad(); ++quad)
-          quad->clear_user_flag();
+        triangulation.faces->lines.clear_user_flags();
+        triangulation.faces->quads.clear_user_flags();
 
         // create an array of face refine cases. User indices of faces
         // will be set to values corresponding with indices in this
@@ -5266,79 +5318,90 @@ namespace internal
         // first for lines
         if (true)
           {
-            // only active objects can be refined further
-            typename Triangulation<dim,spacedim>::active_line_iterator
-            line = triangulation.begin_active_line(),
-            endl = triangulation.end_line();
             typename Triangulation<dim,spacedim>::raw_line_iterator
             next_unused_line = triangulation.begin_raw_line ();
 
-            for (; line!=endl; ++line)
+            // collect the lines to be refined. the midpoints of the
+            // lines only depend on the lines themselves, so they can be
+            // computed up front and in parallel. only active objects can
+            // be refined further
+            std::vector<std::pair<typename Triangulation<dim,spacedim>::line_iterator,bool> >
+            lines_to_refine;
+            for (typename Triangulation<dim,spacedim>::active_line_iterator
+                 line = triangulation.begin_active_line();
+                 line!=triangulation.end_line(); ++line)
               if (line->user_flag_set())
-                {
-                  // this line needs to be refined
-
-                  // find the next unused vertex and set it
-                  // appropriately
-                  while (triangulation.vertices_used[next_unused_vertex] == true)
-                    ++next_unused_vertex;
-                  Assert (next_unused_vertex < triangulation.vertices.size(),
-                          ExcMessage("Internal error: During refinement, the triangulation wants to access an element of the 'vertices' array but it turns out that the array is not large enough."));
-                  triangulation.vertices_used[next_unused_vertex] = true;
-
-                  triangulation.vertices[next_unused_vertex]
-                    = line->center(true);
-
-                  // now that we created the right point, make up the
-                  // two child lines (++ takes care of the end of the
-                  // vector)
-                  next_unused_line=triangulation.faces->lines.next_free_pair_object(triangulation);
-                  Assert(next_unused_line.state() == IteratorState::valid,
-                         ExcInternalError());
-
-                  // now we found two consecutive unused lines, such
-                  // that the children of a line will be consecutive.
-                  // then set the child pointer of the present line
-                  line->set_children (0, next_unused_line->index());
-
-                  // set the two new lines
-                  const typename Triangulation<dim,spacedim>::raw_line_iterator
-                  children[2] = { next_unused_line,
-                                  ++next_unused_line
-                                };
-
-                  // some tests; if any of the iterators should be
-                  // invalid, then already dereferencing will fail
-                  Assert (children[0]->used() == false, ExcMessage("Internal error: We want to use a cell during refinement that should be unused, but turns out not to be."));
-                  Assert (children[1]->used() == false, ExcMessage("Internal error: We want to use a cell during refinement that should be unused, but turns out not to be."));
-
-                  children[0]->set (internal::Triangulation
-                                    ::TriaObject<1>(line->vertex_index(0),
-                                                    next_unused_vertex));
-                  children[1]->set (internal::Triangulation
-                                    ::TriaObject<1>(next_unused_vertex,
-                                                    line->vertex_index(1)));
-
-                  children[0]->set_used_flag();
-                  children[1]->set_used_flag();
-                  children[0]->clear_children();
-                  children[1]->clear_children();
-                  children[0]->clear_user_data();
-                  children[1]->clear_user_data();
-                  children[0]->clear_user_flag();
-                  children[1]->clear_user_flag();
+                lines_to_refine.push_back (std::make_pair (line, false));
 
-                  children[0]->set_boundary_id (line->boundary_id());
-                  children[1]->set_boundary_id (line->boundary_id());
+            std::vector<Point<spacedim> > midpoints;
+            compute_new_vertex_locations (lines_to_refine, midpoints);
 
-                  children[0]->set_manifold_id (line->manifold_id());
-                  children[1]->set_manifold_id (line->manifold_id());
+            for (unsigned int l=0; l<lines_to_refine.size(); ++l)
+              {
+                // this line needs to be refined
+                const typename Triangulation<dim,spacedim>::line_iterator
+                line = lines_to_refine[l].first;
+
+                // find the next unused vertex and set it
+                // appropriately
+                while (triangulation.vertices_used[next_unused_vertex] == true)
+                  ++next_unused_vertex;
+                Assert (next_unused_vertex < triangulation.vertices.size(),
+                        ExcMessage("Internal error: During refinement, the triangulation wants to access an element of the 'vertices' array but it turns out that the array is not large enough."));
+                triangulation.vertices_used[next_unused_vertex] = true;
+
+                triangulation.vertices[next_unused_vertex] = midpoints[l];
+
+                // now that we created the right point, make up the
+                // two child lines (++ takes care of the end of the
+                // vector)
+                next_unused_line=triangulation.faces->lines.next_free_pair_object(triangulation);
+                Assert(next_unused_line.state() == IteratorState::valid,
+                       ExcInternalError());
 
-                  // finally clear flag
-                  // indicating the need
-                  // for refinement
-                  line->clear_user_flag ();
-                }
+                // now we found two consecutive unused lines, such
+                // that the children of a line will be consecutive.
+                // then set the child pointer of the present line
+                line->set_children (0, next_unused_line->index());
+
+                // set the two new lines
+                const typename Triangulation<dim,spacedim>::raw_line_iterator
+                children[2] = { next_unused_line,
+                                ++next_unused_line
+                              };
+
+                // some tests; if any of the iterators should be
+                // invalid, then already dereferencing will fail
+                Assert (children[0]->used() == false, ExcMessage("Internal error: We want to use a cell during refinement that should be unused, but turns out not to be."));
+                Assert (children[1]->used() == false, ExcMessage("Internal error: We want to use a cell during refinement that should be unused, but turns out not to be."));
+
+                children[0]->set (internal::Triangulation
+                                  ::TriaObject<1>(line->vertex_index(0),
+                                                  next_unused_vertex));
+                children[1]->set (internal::Triangulation
+                                  ::TriaObject<1>(next_unused_vertex,
+                                                  line->vertex_index(1)));
+
+                children[0]->set_used_flag();
+                children[1]->set_used_flag();
+                children[0]->clear_children();
+                children[1]->clear_children();
+                children[0]->clear_user_data();
+                children[1]->clear_user_data();
+                children[0]->clear_user_flag();
+                children[1]->clear_user_flag();
+
+                children[0]->set_boundary_id (line->boundary_id());
+                children[1]->set_boundary_id (line->boundary_id());
+
+                children[0]->set_manifold_id (line->manifold_id());
+                children[1]->set_manifold_id (line->manifold_id());
+
+                // finally clear flag
+                // indicating the need
+                // for refinement
+                line->clear_user_flag ();
+              }
           }
 
 
@@ -5365,6 +5428,26 @@ namespace internal
         // anisotropically (this is transformed to case c), however we
         // might have to renumber/rename children...)
 
+        // the centers of the quads that will be refined isotropically
+        // in case a) only depend on the quads and their (already
+        // refined) lines, so compute them up front and in
+        // parallel. quads that end up being refined differently than
+        // predicted here simply do not use their entry
+        std::vector<std::pair<typename Triangulation<dim,spacedim>::quad_iterator,bool> >
+        quads_to_refine;
+        for (typename Triangulation<dim,spacedim>::quad_iterator
+             quad = triangulation.begin_quad(); quad!=triangulation.end_quad(); ++quad)
+          if (quad->user_flag_set() &&
+              quad->refinement_case()==RefinementCase<dim-1>::no_refinement)
+            quads_to_refine.push_back
+            (std::make_pair (quad,
+                             !quad->at_boundary() &&
+                             quad->manifold_id() == numbers::invalid_manifold_id));
+
+        std::vector<Point<spacedim> > quad_centers;
+        compute_new_vertex_locations (quads_to_refine, quad_centers);
+        unsigned int next_quad_center = 0;
+
         // we need a loop in cases c) and d), as the anisotropic
         // children migt have a lower index than the mother quad
         for (unsigned int loop=0; loop<2; ++loop)
@@ -5878,10 +5961,18 @@ namespace internal
                     // isotropic refinement
                     Assert(quad_ref_case==RefinementCase<dim-1>::no_refinement, ExcInternalError());
 
-                    // set the middle vertex
-                    // appropriately
-                    if (quad->at_boundary() ||
-                        (quad->manifold_id() != numbers::invalid_manifold_id) )
+                    // set the middle vertex appropriately, using the
+                    // location computed above if available. it has been
+                    // computed in the same way as below
+                    while (next_quad_center < quads_to_refine.size() &&
+                           quads_to_refine[next_quad_center].first->index() < quad->index())
+                      ++next_quad_center;
+                    if (next_quad_center < quads_to_refine.size() &&
+                        quads_to_refine[next_quad_center].first == quad)
+                      triangulation.vertices[next_unused_vertex]
+                        = quad_centers[next_quad_center];
+                    else if (quad->at_boundary() ||
+                             (quad->manifold_id() != numbers::invalid_manifold_id) )
                       triangulation.vertices[next_unused_vertex]
                         = quad->center(true);
                     else
@@ -6110,6 +6201,22 @@ namespace internal
         typename Triangulation<3,spacedim>::DistortedCellList
         cells_with_distorted_children;
 
+        // all lines and quads are refined now, so the centers of the
+        // isotropically refined hexes can be computed up front and in
+        // parallel, in the order in which the hexes are visited below
+        std::vector<std::pair<typename Triangulation<dim,spacedim>::hex_iterator,bool> >
+        hexes_to_refine;
+        for (unsigned int level=0; level!=triangulation.levels.size()-1; ++level)
+          for (typename Triangulation<dim,spacedim>::active_hex_iterator
+               hex = triangulation.begin_active_hex(level);
+               hex!=triangulation.begin_active_hex(level+1); ++hex)
+            if (hex->refine_flag_set() == RefinementCase<dim>::cut_xyz)
+              hexes_to_refine.push_back (std::make_pair (hex, true));
+
+        std::vector<Point<spacedim> > hex_centers;
+        compute_new_vertex_locations (hexes_to_refine, hex_centers);
+        unsigned int next_hex_center = 0;
+
         for (unsigned int level=0; level!=triangulation.levels.size()-1; ++level)
           {
             // only active objects can be refined further; remember
@@ -8009,11 +8116,14 @@ namespace internal
                       // the new vertex is definitely in the interior,
                       // so we need not worry about the
                       // boundary. However we need to worry about
-                      // Manifolds. Let the cell compute its own
-                      // center, by querying the underlying manifold
+                      // Manifolds. The cell's center has been computed
+                      // above by querying the underlying manifold
                       // object.
+                      Assert (next_hex_center < hexes_to_refine.size() &&
+                              hexes_to_refine[next_hex_center].first == hex,
+                              ExcInternalError());
                       triangulation.vertices[next_unused_vertex] =
-                        hex->center(true, true);
+                        hex_centers[next_hex_center++];
 
                       // set the data of the six lines.  first collect
                       // the indices of the seven vertices (consider
@@ -1612,22 +1612,27 @@ void CellAccessor<dim, spacedim>::set_neighbor (const unsigned int i,
 {
   AssertIndexRange (i, GeometryInfo<dim>::faces_per_cell);
 
+  // the levels of neighbors are stored with an offset of one in two
+  // bytes, see the documentation of TriaLevel::neighbor_levels
   if (pointer.state() == IteratorState::valid)
     {
+      AssertThrow (pointer->present_level < 65535,
+                   ExcMessage ("Neighbor relations can only be stored for "
+                               "cells on the first 65535 levels."));
       this->tria->levels[this->present_level]->
-      neighbors[this->present_index*GeometryInfo<dim>::faces_per_cell+i].first
-        = pointer->present_level;
+      neighbor_levels[this->present_index*GeometryInfo<dim>::faces_per_cell+i]
+        = pointer->present_level + 1;
       this->tria->levels[this->present_level]->
-      neighbors[this->present_index*GeometryInfo<dim>::faces_per_cell+i].second
+      neighbor_indices[this->present_index*GeometryInfo<dim>::faces_per_cell+i]
         = pointer->present_index;
     }
   else
     {
       this->tria->levels[this->present_level]->
-      neighbors[this->present_index*GeometryInfo<dim>::faces_per_cell+i].first
-        = -1;
+      neighbor_levels[this->present_index*GeometryInfo<dim>::faces_per_cell+i]
+        = 0;
       this->tria->levels[this->present_level]->
-      neighbors[this->present_index*GeometryInfo<dim>::faces_per_cell+i].second
+      neighbor_indices[this->present_index*GeometryInfo<dim>::faces_per_cell+i]
         = -1;
     };
 }
@@ -575,6 +575,7 @@ namespace internal
                 dof_handler.levels.push_back (new internal::hp::DoFLevel);
                 std::swap (active_fe_backup[level],
                            dof_handler.levels[level]->active_fe_indices);
+                dof_handler.levels[level]->normalize_active_fe_indices ();
               }
           }
 
@@ -701,6 +702,7 @@ namespace internal
                 dof_handler.levels.push_back (new internal::hp::DoFLevel);
                 std::swap (active_fe_backup[level],
                            dof_handler.levels[level]->active_fe_indices);
+                dof_handler.levels[level]->normalize_active_fe_indices ();
               }
             dof_handler.faces = new internal::hp::DoFIndicesOnFaces<2>;
           }
@@ -1077,6 +1079,7 @@ namespace internal
                 dof_handler.levels.push_back (new internal::hp::DoFLevel);
                 std::swap (active_fe_backup[level],
                            dof_handler.levels[level]->active_fe_indices);
+                dof_handler.levels[level]->normalize_active_fe_indices ();
               }
             dof_handler.faces = new internal::hp::DoFIndicesOnFaces<3>;
           }
@@ -1,6 +1,6 @@
 // ---------------------------------------------------------------------
 //
-// Copyright (C) 2003 - 2015 by the deal.II authors
+// Copyright (C) 2003 - 2016 by the deal.II authors
 //
 // This file is part of the deal.II library.
 //
@@ -28,115 +28,75 @@ namespace internal
     void
     DoFLevel::compress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection)
     {
-      (void)fe_collection;
-      return;
-
       if (dof_offsets.size() == 0 || dof_indices.size()==0)
         return;
 
       // in a first run through, count how many new slots we need in the
-      // dof_indices array after compression. note that the 'cell'
-      // counter is incremented inside the loop
+      // dof_indices array after compression
       unsigned int new_size = 0;
-      for (unsigned int cell=0; cell<dof_offsets.size(); )
+      for (unsigned int cell=0; cell<dof_offsets.size(); ++cell)
         // see if this cell is active on the current level
         if (dof_offsets[cell] != (offset_type)(-1))
           {
-            // find the next cell active on this level
-            unsigned int next_cell = cell+1;
-            while ((next_cell<dof_offsets.size()) &&
-                   (dof_offsets[next_cell] == (offset_type)(-1)))
-              ++next_cell;
-
-            const unsigned int next_offset = (next_cell < dof_offsets.size() ?
-                                              dof_offsets[next_cell] :
-                                              dof_indices.size());
-
-            Assert (next_offset-dof_offsets[cell] == fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>(),
-                    ExcInternalError());
-
-            // see if the range of dofs for this cell can be compressed and if so
-            // how many slots we have to store for them
-            if (next_offset > dof_offsets[cell])
+            // cells that have already been compressed only occupy a single
+            // slot
+            if ((signed_active_fe_index_type)active_fe_indices[cell] < 0)
               {
-                bool compressible = true;
-                for (unsigned int j=dof_offsets[cell]+1; j<next_offset; ++j)
-                  if (dof_indices[j] != dof_indices[j-1]+1)
-                    {
-                      compressible = false;
-                      break;
-                    }
-                if (compressible == true)
-                  new_size += 1;
-                else
-                  new_size += (next_offset-dof_offsets[cell]);
+                ++new_size;
+                continue;
               }
 
-            // then move on to the next cell
-            cell = next_cell;
+            const unsigned int n_dofs
+              = fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>();
+            // cells without dofs on this object are not compressed, see
+            // below
+            new_size += (n_dofs == 0 ?
+                         0 :
+                         (is_compressible (dof_offsets[cell], n_dofs) ? 1 : n_dofs));
           }
-        else
-          ++cell;
 
-      // now allocate the new array and copy into it whatever we need
+      // nothing to gain if no cell can be compressed
+      if (new_size == dof_indices.size())
+        return;
+
+      // now allocate the new arrays and copy into them whatever we need. we
+      // have to build a new array of offsets as well since the sets of dofs
+      // of the cells that are compressed now take up less space
       std::vector<types::global_dof_index> new_dof_indices;
       new_dof_indices.reserve(new_size);
-      for (unsigned int cell=0; cell<dof_offsets.size(); )
-        // see if this cell is active on the current level
+      std::vector<offset_type> new_dof_offsets (dof_offsets.size(), (offset_type)(-1));
+      for (unsigned int cell=0; cell<dof_offsets.size(); ++cell)
         if (dof_offsets[cell] != (offset_type)(-1))
           {
-            // find the next cell active on this level
-            unsigned int next_cell = cell+1;
-            while ((next_cell<dof_offsets.size()) &&
-                   (dof_offsets[next_cell] == (offset_type)(-1)))
-              ++next_cell;
-
-            const unsigned int next_offset = (next_cell < dof_offsets.size() ?
-                                              dof_offsets[next_cell] :
-                                              dof_indices.size());
-
-            Assert (next_offset-dof_offsets[cell] == fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>(),
-                    ExcInternalError());
-
-            // see if the range of dofs for this cell can be compressed and if so
-            // how many slots we have to store for them
-            if (next_offset > dof_offsets[cell])
+            new_dof_offsets[cell] = new_dof_indices.size();
+
+            if ((signed_active_fe_index_type)active_fe_indices[cell] < 0)
               {
-                bool compressible = true;
-                for (unsigned int j=dof_offsets[cell]+1; j<next_offset; ++j)
-                  if (dof_indices[j] != dof_indices[j-1]+1)
-                    {
-                      compressible = false;
-                      break;
-                    }
-
-                // if this cell is compressible, then copy the first index and mark this
-                // in the dof_offsets array
-                if (compressible == true)
-                  {
-                    new_dof_indices.push_back (dof_indices[dof_offsets[cell]]);
-
-                    // make sure that the current active_fe_index indicates
-                    // that this entry hasn't been compressed yet
-                    Assert ((signed_active_fe_index_type)active_fe_indices[cell] >= 0, ExcInternalError());
-
-                    // then mark the compression
-                    active_fe_indices[cell] = (active_fe_index_type)~(signed_active_fe_index_type)active_fe_indices[cell];
-                  }
-                else
-                  for (unsigned int i=dof_offsets[cell]; i<next_offset; ++i)
-                    new_dof_indices.push_back (dof_indices[i]);
+                new_dof_indices.push_back (dof_indices[dof_offsets[cell]]);
+                continue;
               }
 
-            // then move on to the next cell
-            cell = next_cell;
+            const unsigned int n_dofs
+              = fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>();
+
+            // if this cell is compressible, then copy the first index and
+            // mark this by storing the active_fe_index in binary complement
+            if (n_dofs > 0 && is_compressible (dof_offsets[cell], n_dofs))
+              {
+                new_dof_indices.push_back (dof_indices[dof_offsets[cell]]);
+                active_fe_indices[cell]
+                  = (active_fe_index_type)~(signed_active_fe_index_type)active_fe_indices[cell];
+              }
+            else
+              new_dof_indices.insert (new_dof_indices.end(),
+                                      dof_indices.begin()+dof_offsets[cell],
+                                      dof_indices.begin()+dof_offsets[cell]+n_dofs);
           }
-        else
-          ++cell;
 
       // finally swap old and new content
       Assert (new_dof_indices.size() == new_size, ExcInternalError());
       dof_indices.swap (new_dof_indices);
+      dof_offsets.swap (new_dof_offsets);
     }
 
 
@@ -145,66 +105,56 @@ namespace internal
     void
     DoFLevel::uncompress_data(const dealii::hp::FECollection<dim,spacedim> &fe_collection)
     {
-      return;
-
       if (dof_offsets.size() == 0 || dof_indices.size()==0)
         return;
 
       // in a first run through, count how many new slots we need in the
-      // dof_indices array after uncompression.
+      // dof_indices array after uncompression, and whether there is
+      // anything to do at all
       unsigned int new_size = 0;
+      bool has_compressed_cells = false;
       for (unsigned int cell=0; cell<dof_offsets.size(); ++cell)
         if (dof_offsets[cell] != (offset_type)(-1))
           {
             // we know now that the slot for this cell is used. extract the
             // active_fe_index for it and see how many entries we need
             new_size += fe_collection[active_fe_index(cell)].template n_dofs_per_object<dim>();
+            if ((signed_active_fe_index_type)active_fe_indices[cell] < 0)
+              has_compressed_cells = true;
           }
 
+      if (has_compressed_cells == false)
+        return;
+
       // now allocate the new array and copy into it whatever we need
       std::vector<types::global_dof_index> new_dof_indices;
       new_dof_indices.reserve(new_size);
       std::vector<offset_type> new_dof_offsets (dof_offsets.size(), (offset_type)(-1));
-      for (unsigned int cell=0; cell<dof_offsets.size(); )
-        // see if this cell is active on the current level
+      for (unsigned int cell=0; cell<dof_offsets.size(); ++cell)
         if (dof_offsets[cell] != (offset_type)(-1))
           {
-            // find the next cell active on this level
-            unsigned int next_cell = cell+1;
-            while ((next_cell<dof_offsets.size()) &&
-                   (dof_offsets[next_cell] == (offset_type)(-1)))
-              ++next_cell;
-
-            const unsigned int next_offset = (next_cell < dof_offsets.size() ?
-                                              dof_offsets[next_cell] :
-                                              dof_indices.size());
-
             // set offset for this cell
             new_dof_offsets[cell] = new_dof_indices.size();
 
+            const unsigned int n_dofs
+              = fe_collection[active_fe_index(cell)].template n_dofs_per_object<dim>();
+
             // see if we need to uncompress this set of dofs
             if ((signed_active_fe_index_type)active_fe_indices[cell]>=0)
               {
                 // apparently not. simply copy them
-                Assert (next_offset-dof_offsets[cell] == fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>(),
-                        ExcInternalError());
-                for (unsigned int i=dof_offsets[cell]; i<next_offset; ++i)
-                  new_dof_indices.push_back (dof_indices[i]);
+                new_dof_indices.insert (new_dof_indices.end(),
+                                        dof_indices.begin()+dof_offsets[cell],
+                                        dof_indices.begin()+dof_offsets[cell]+n_dofs);
               }
             else
               {
-                // apparently so. uncompress
-                Assert (next_offset-dof_offsets[cell] == 1,
-                        ExcInternalError());
-                for (unsigned int i=0; i<fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>(); ++i)
+                // apparently so. uncompress and remove the mark
+                for (unsigned int i=0; i<n_dofs; ++i)
                   new_dof_indices.push_back (dof_indices[dof_offsets[cell]]+i);
+                active_fe_indices[cell] = active_fe_index(cell);
               }
-
-            // then move on to the next cell
-            cell = next_cell;
           }
-        else
-          ++cell;
 
       // verify correct size, then swap arrays
       Assert (new_dof_indices.size() == new_size, ExcInternalError());
@@ -213,6 +163,30 @@ namespace internal
     }
 
 
+
+    bool
+    DoFLevel::is_compressible (const offset_type  offset,
+                               const unsigned int n_dofs) const
+    {
+      Assert (offset+n_dofs <= dof_indices.size(), ExcInternalError());
+      for (unsigned int j=offset+1; j<offset+n_dofs; ++j)
+        if (dof_indices[j] != dof_indices[j-1]+1)
+          return false;
+      return true;
+    }
+
+
+
+    void
+    DoFLevel::normalize_active_fe_indices ()
+    {
+      for (unsigned int i=0; i<active_fe_indices.size(); ++i)
+        if ((signed_active_fe_index_type)active_fe_indices[i] < 0)
+          active_fe_indices[i] = active_fe_index(i);
+    }
+
+
+
     std::size_t
     DoFLevel::memory_consumption () const
     {
@@ -1,6 +1,6 @@
 // ---------------------------------------------------------------------
 //
-// Copyright (C) 2008 - 2015 by the deal.II authors
+// Copyright (C) 2008 - 2016 by the deal.II authors
 //
 // This file is part of the deal.II library.
 //
@@ -15,6 +15,8 @@
 
 #include <deal.II/lac/dynamic_sparsity_pattern.h>
 #include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/std_cxx11/bind.h>
 
 #include <algorithm>
 #include <cmath>
@@ -396,6 +398,76 @@ DynamicSparsityPattern::symmetrize ()
 
 
 
+void
+DynamicSparsityPattern::merge (const std::vector<const DynamicSparsityPattern *> &sparsity_patterns)
+{
+  for (unsigned int i=0; i<sparsity_patterns.size(); ++i)
+    {
+      Assert (sparsity_patterns[i] != this,
+              ExcMessage ("A sparsity pattern can not be merged with itself."));
+      AssertDimension (sparsity_patterns[i]->n_rows(), n_rows());
+      AssertDimension (sparsity_patterns[i]->n_cols(), n_cols());
+    }
+
+  // every row is only touched by one thread, so no synchronization is
+  // necessary
+  const size_type n_lines = lines.size();
+  parallel::apply_to_subranges (static_cast<size_type>(0), n_lines,
+                                std_cxx11::bind (&DynamicSparsityPattern::merge_rows,
+                                                 this,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 std_cxx11::cref(sparsity_patterns)),
+                                256);
+
+  for (size_type i=0; i<n_lines; ++i)
+    if (lines[i].entries.size() > 0)
+      {
+        have_entries = true;
+        break;
+      }
+}
+
+
+
+void
+DynamicSparsityPattern::merge_rows (const size_type                                    begin,
+                                    const size_type                                    end,
+                                    const std::vector<const DynamicSparsityPattern *> &sparsity_patterns)
+{
+  for (size_type local_row=begin; local_row<end; ++local_row)
+    {
+      const size_type row
+        = (rowset.size() == 0 ? local_row : rowset.nth_index_in_set(local_row));
+
+      for (unsigned int i=0; i<sparsity_patterns.size(); ++i)
+        {
+          const DynamicSparsityPattern &other = *sparsity_patterns[i];
+          if (other.have_entries == false)
+            continue;
+          if (other.rowset.size() > 0 && !other.rowset.is_element(row))
+            continue;
+
+          const std::vector<size_type> &entries
+            = other.lines[other.rowset.size() == 0 ?
+                          row :
+                          other.rowset.index_within_set(row)].entries;
+          if (entries.size() == 0)
+            continue;
+
+          // the common case when the patterns were filled from disjoint sets
+          // of cells is that only one of them has entries in this row. avoid
+          // the merging step then
+          if (lines[local_row].entries.size() == 0)
+            lines[local_row].entries = entries;
+          else
+            lines[local_row].add_entries (&entries[0], &entries[0]+entries.size(),
+                                          true);
+        }
+    }
+}
+
+
+
 void
 DynamicSparsityPattern::print (std::ostream &out) const
 {
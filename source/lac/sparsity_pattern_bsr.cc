@@ -0,0 +1,237 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/lac/sparsity_pattern_bsr.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+
+#include <algorithm>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace SparsityPatternBSR
+  {
+    typedef types::global_dof_index size_type;
+
+    // extract the sorted column indices of a row. we cannot rely on the
+    // order of the entries since SparsityPattern stores the diagonal first
+    template <typename SparsityPatternType>
+    void
+    get_row_columns (const SparsityPatternType &sparsity_pattern,
+                     const size_type            row,
+                     std::vector<size_type>    &columns)
+    {
+      columns.clear();
+      for (typename SparsityPatternType::iterator
+           entry = sparsity_pattern.begin(row);
+           entry != sparsity_pattern.end(row); ++entry)
+        columns.push_back (entry->column());
+      std::sort (columns.begin(), columns.end());
+    }
+  }
+}
+
+
+
+SparsityPatternBSR::SparsityPatternBSR ()
+  :
+  rows (0)
+{}
+
+
+
+SparsityPatternBSR::SparsityPatternBSR (const SparsityPatternBSR &s)
+  :
+  Subscriptor(),
+  rows (0)
+{
+  (void)s;
+  Assert (s.empty(), ExcInvalidConstructorCall());
+}
+
+
+
+SparsityPatternBSR &
+SparsityPatternBSR::operator = (const SparsityPatternBSR &s)
+{
+  (void)s;
+  Assert (s.empty(), ExcInvalidConstructorCall());
+  Assert (empty(), ExcInvalidConstructorCall());
+  return *this;
+}
+
+
+
+void
+SparsityPatternBSR::clear ()
+{
+  rows = 0;
+  std::vector<size_type>().swap (chunk_starts);
+  std::vector<size_type>().swap (index_to_chunk);
+  std::vector<std::size_t>().swap (chunk_row_value_start);
+  chunk_sparsity_pattern.reinit (0, 0, 0);
+}
+
+
+
+template <typename SparsityPatternType>
+void
+SparsityPatternBSR::copy_from (const SparsityPatternType &sparsity_pattern,
+                               const unsigned int         max_chunk_size)
+{
+  Assert (sparsity_pattern.n_rows() == sparsity_pattern.n_cols(),
+          ExcNotQuadratic());
+  Assert (max_chunk_size > 0, ExcMessage ("The chunk size must be positive."));
+
+  clear ();
+  rows = sparsity_pattern.n_rows();
+
+  // start a new chunk whenever the column indices of a row differ from the
+  // ones of the previous row or the chunk has reached its maximal size
+  chunk_starts.push_back (0);
+  std::vector<size_type> columns, previous_columns;
+  for (size_type row=0; row<rows; ++row)
+    {
+      internal::SparsityPatternBSR::get_row_columns (sparsity_pattern, row,
+                                                     columns);
+      if (row > 0 &&
+          (columns != previous_columns ||
+           row - chunk_starts.back() >= max_chunk_size))
+        chunk_starts.push_back (row);
+      columns.swap (previous_columns);
+    }
+  chunk_starts.push_back (rows);
+
+  index_to_chunk.resize (rows);
+  for (size_type chunk=0; chunk<n_chunks(); ++chunk)
+    for (size_type row=chunk_starts[chunk]; row<chunk_starts[chunk+1]; ++row)
+      index_to_chunk[row] = chunk;
+
+  // all rows of a chunk have the same entries, so the first row determines
+  // the pattern of the chunk row
+  DynamicSparsityPattern chunk_dsp (n_chunks(), n_chunks());
+  for (size_type chunk=0; chunk<n_chunks(); ++chunk)
+    for (typename SparsityPatternType::iterator
+         entry = sparsity_pattern.begin(chunk_starts[chunk]);
+         entry != sparsity_pattern.end(chunk_starts[chunk]); ++entry)
+      chunk_dsp.add (chunk, index_to_chunk[entry->column()]);
+
+  setup_chunks (chunk_dsp);
+}
+
+
+
+template <typename SparsityPatternType>
+void
+SparsityPatternBSR::copy_from (const SparsityPatternType       &sparsity_pattern,
+                               const std::vector<unsigned int> &chunk_sizes)
+{
+  Assert (sparsity_pattern.n_rows() == sparsity_pattern.n_cols(),
+          ExcNotQuadratic());
+
+  clear ();
+  rows = sparsity_pattern.n_rows();
+
+  chunk_starts.resize (chunk_sizes.size()+1);
+  chunk_starts[0] = 0;
+  for (unsigned int chunk=0; chunk<chunk_sizes.size(); ++chunk)
+    {
+      Assert (chunk_sizes[chunk] > 0,
+              ExcMessage ("The chunk sizes must be positive."));
+      chunk_starts[chunk+1] = chunk_starts[chunk] + chunk_sizes[chunk];
+    }
+  AssertThrow (chunk_starts.back() == rows,
+               ExcInvalidChunkSizes (chunk_starts.back(), rows));
+
+  index_to_chunk.resize (rows);
+  for (size_type chunk=0; chunk<n_chunks(); ++chunk)
+    for (size_type row=chunk_starts[chunk]; row<chunk_starts[chunk+1]; ++row)
+      index_to_chunk[row] = chunk;
+
+  DynamicSparsityPattern chunk_dsp (n_chunks(), n_chunks());
+  for (size_type row=0; row<rows; ++row)
+    for (typename SparsityPatternType::iterator
+         entry = sparsity_pattern.begin(row);
+         entry != sparsity_pattern.end(row); ++entry)
+      chunk_dsp.add (index_to_chunk[row], index_to_chunk[entry->column()]);
+
+  setup_chunks (chunk_dsp);
+}
+
+
+
+void
+SparsityPatternBSR::setup_chunks (DynamicSparsityPattern &chunk_dsp)
+{
+  // the matrix relies on the diagonal chunk being present and stored first
+  // in each chunk row, which SparsityPattern does for square patterns
+  for (size_type chunk=0; chunk<n_chunks(); ++chunk)
+    chunk_dsp.add (chunk, chunk);
+  chunk_sparsity_pattern.copy_from (chunk_dsp);
+
+  chunk_row_value_start.resize (n_chunks()+1);
+  chunk_row_value_start[0] = 0;
+  for (size_type chunk=0; chunk<n_chunks(); ++chunk)
+    {
+      size_type row_width = 0;
+      for (SparsityPattern::iterator entry = chunk_sparsity_pattern.begin(chunk);
+           entry != chunk_sparsity_pattern.end(chunk); ++entry)
+        row_width += chunk_size (entry->column());
+      chunk_row_value_start[chunk+1] = chunk_row_value_start[chunk] +
+                                       static_cast<std::size_t>(chunk_size(chunk)) *
+                                       row_width;
+    }
+}
+
+
+
+bool
+SparsityPatternBSR::exists (const size_type i,
+                            const size_type j) const
+{
+  AssertIndexRange (i, rows);
+  AssertIndexRange (j, rows);
+  return chunk_sparsity_pattern.exists (index_to_chunk[i], index_to_chunk[j]);
+}
+
+
+
+std::size_t
+SparsityPatternBSR::memory_consumption () const
+{
+  return (sizeof(*this) +
+          MemoryConsumption::memory_consumption (chunk_starts) +
+          MemoryConsumption::memory_consumption (index_to_chunk) +
+          MemoryConsumption::memory_consumption (chunk_row_value_start) +
+          chunk_sparsity_pattern.memory_consumption() -
+          sizeof(chunk_sparsity_pattern));
+}
+
+
+
+// explicit instantiations
+template void SparsityPatternBSR::copy_from<DynamicSparsityPattern>
+(const DynamicSparsityPattern &, const unsigned int);
+template void SparsityPatternBSR::copy_from<SparsityPattern>
+(const SparsityPattern &, const unsigned int);
+template void SparsityPatternBSR::copy_from<DynamicSparsityPattern>
+(const DynamicSparsityPattern &, const std::vector<unsigned int> &);
+template void SparsityPatternBSR::copy_from<SparsityPattern>
+(const SparsityPattern &, const std::vector<unsigned int> &);
+
+DEAL_II_NAMESPACE_CLOSE
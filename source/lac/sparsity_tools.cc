@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <list>
 #include <set>
 
 #ifdef DEAL_II_WITH_MPI
@@ -48,6 +49,17 @@ namespace SparsityTools
   void partition (const SparsityPattern     &sparsity_pattern,
                   const unsigned int         n_partitions,
                   std::vector<unsigned int> &partition_indices)
+  {
+    partition (sparsity_pattern, std::vector<unsigned int>(),
+               n_partitions, partition_indices);
+  }
+
+
+
+  void partition (const SparsityPattern           &sparsity_pattern,
+                  const std::vector<unsigned int> &node_weights,
+                  const unsigned int               n_partitions,
+                  std::vector<unsigned int>       &partition_indices)
   {
     Assert (sparsity_pattern.n_rows()==sparsity_pattern.n_cols(),
             ExcNotQuadratic());
@@ -58,6 +70,11 @@ namespace SparsityTools
     Assert (partition_indices.size() == sparsity_pattern.n_rows(),
             ExcInvalidArraySize (partition_indices.size(),
                                  sparsity_pattern.n_rows()));
+    Assert ((node_weights.size() == 0)
+            ||
+            (node_weights.size() == sparsity_pattern.n_rows()),
+            ExcInvalidArraySize (node_weights.size(),
+                                 sparsity_pattern.n_rows()));
 
     // check for an easy return
     if (n_partitions == 1 || (sparsity_pattern.n_rows()==1))
@@ -66,11 +83,10 @@ namespace SparsityTools
         return;
       }
 
-    // Make sure that METIS is actually
-    // installed and detected
+    // without METIS, use the partitioner of our own
 #ifndef DEAL_II_WITH_METIS
-    (void)sparsity_pattern;
-    AssertThrow (false, ExcMETISNotInstalled());
+    partition_multilevel (sparsity_pattern, node_weights,
+                          n_partitions, partition_indices);
 #else
 
     // generate the data structures for
@@ -110,6 +126,9 @@ namespace SparsityTools
         int_rowstart.push_back(int_colnums.size());
       }
 
+    std::vector<idx_t> int_node_weights (node_weights.begin(), node_weights.end());
+    idx_t *vwgt = (node_weights.size() > 0 ? &int_node_weights[0] : NULL);
+
     std::vector<idx_t> int_partition_indices (sparsity_pattern.n_rows());
 
     // Make use of METIS' error code.
@@ -120,14 +139,14 @@ namespace SparsityTools
     // Use recursive if the number of partitions is less than or equal to 8
     if (nparts <= 8)
       ierr = METIS_PartGraphRecursive(&n, &ncon, &int_rowstart[0], &int_colnums[0],
-                                      NULL, NULL, NULL,
+                                      vwgt, NULL, NULL,
                                       &nparts,NULL,NULL,&options[0],
                                       &dummy,&int_partition_indices[0]);
 
     // Otherwise use kway
     else
       ierr = METIS_PartGraphKway(&n, &ncon, &int_rowstart[0], &int_colnums[0],
-                                 NULL, NULL, NULL,
+                                 vwgt, NULL, NULL,
                                  &nparts,NULL,NULL,&options[0],
                                  &dummy,&int_partition_indices[0]);
 
@@ -143,6 +162,731 @@ namespace SparsityTools
   }
 
 
+  namespace internal
+  {
+    namespace Partitioning
+    {
+      /**
+       * An undirected graph with weights on nodes and edges, stored in
+       * compressed row format. Edges from a node to itself are not stored.
+       */
+      struct Graph
+      {
+        std::vector<unsigned int> row_start;
+        std::vector<unsigned int> neighbors;
+        std::vector<unsigned int> edge_weights;
+        std::vector<unsigned int> node_weights;
+
+        unsigned int n_nodes () const
+        {
+          return node_weights.size();
+        }
+
+        std::size_t total_node_weight () const
+        {
+          std::size_t sum = 0;
+          for (unsigned int i=0; i<node_weights.size(); ++i)
+            sum += node_weights[i];
+          return sum;
+        }
+
+        unsigned int max_node_weight () const
+        {
+          unsigned int max_weight = 0;
+          for (unsigned int i=0; i<node_weights.size(); ++i)
+            max_weight = std::max (max_weight, node_weights[i]);
+          return max_weight;
+        }
+      };
+
+
+      /**
+       * Coarsening stops once a graph has no more than this many nodes.
+       */
+      const unsigned int coarsest_graph_size = 100;
+
+      /**
+       * The relative amount by which the weight of a part may exceed its
+       * target weight in a bisection.
+       */
+      const double imbalance_tolerance = 0.01;
+
+
+      /**
+       * Collapse pairs of nodes connected by heavy edges (heavy-edge
+       * matching) into the nodes of a coarser graph. Nodes are visited in the
+       * order of increasing degree, so that poorly connected nodes find a
+       * partner first, and no coarse node gets heavier than @p
+       * max_node_weight. On return, @p fine_to_coarse contains the coarse
+       * node for each node of @p fine.
+       */
+      void
+      coarsen (const Graph               &fine,
+               const std::size_t          max_node_weight,
+               Graph                     &coarse,
+               std::vector<unsigned int> &fine_to_coarse)
+      {
+        const unsigned int n = fine.n_nodes();
+        const unsigned int invalid = numbers::invalid_unsigned_int;
+
+        std::vector<std::pair<unsigned int,unsigned int> > degrees (n);
+        for (unsigned int i=0; i<n; ++i)
+          degrees[i] = std::make_pair (fine.row_start[i+1]-fine.row_start[i], i);
+        std::sort (degrees.begin(), degrees.end());
+
+        std::vector<unsigned int> match (n, invalid);
+        for (unsigned int k=0; k<n; ++k)
+          {
+            const unsigned int node = degrees[k].second;
+            if (match[node] != invalid)
+              continue;
+
+            unsigned int partner = node, heaviest_edge = 0;
+            for (unsigned int j=fine.row_start[node]; j<fine.row_start[node+1]; ++j)
+              {
+                const unsigned int neighbor = fine.neighbors[j];
+                if ((match[neighbor] == invalid)
+                    &&
+                    (fine.edge_weights[j] > heaviest_edge)
+                    &&
+                    (static_cast<std::size_t>(fine.node_weights[node]) +
+                     fine.node_weights[neighbor] <= max_node_weight))
+                  {
+                    partner = neighbor;
+                    heaviest_edge = fine.edge_weights[j];
+                  }
+              }
+            match[node] = partner;
+            match[partner] = node;
+          }
+
+        // number the coarse nodes in the order of their first fine node
+        fine_to_coarse.assign (n, invalid);
+        std::vector<std::pair<unsigned int,unsigned int> > coarse_to_fine;
+        coarse_to_fine.reserve (n);
+        for (unsigned int i=0; i<n; ++i)
+          if (fine_to_coarse[i] == invalid)
+            {
+              fine_to_coarse[i] = fine_to_coarse[match[i]] = coarse_to_fine.size();
+              coarse_to_fine.push_back (std::make_pair (i, match[i]));
+            }
+
+        const unsigned int n_coarse = coarse_to_fine.size();
+        coarse.row_start.resize (n_coarse+1);
+        coarse.row_start[0] = 0;
+        coarse.node_weights.resize (n_coarse);
+        coarse.neighbors.clear ();
+        coarse.edge_weights.clear ();
+
+        // merge the edges of the two fine nodes making up each coarse
+        // node. position[] points to the entry of a coarse neighbor in the row
+        // currently being built
+        std::vector<unsigned int> position (n_coarse, invalid);
+        for (unsigned int c=0; c<n_coarse; ++c)
+          {
+            const unsigned int fine_nodes[2] = { coarse_to_fine[c].first,
+                                                 coarse_to_fine[c].second
+                                               };
+            const unsigned int n_fine_nodes = (fine_nodes[0] == fine_nodes[1] ? 1 : 2);
+
+            coarse.node_weights[c] = 0;
+            for (unsigned int f=0; f<n_fine_nodes; ++f)
+              {
+                const unsigned int node = fine_nodes[f];
+                coarse.node_weights[c] += fine.node_weights[node];
+                for (unsigned int j=fine.row_start[node]; j<fine.row_start[node+1]; ++j)
+                  {
+                    const unsigned int neighbor = fine_to_coarse[fine.neighbors[j]];
+                    if (neighbor == c)
+                      continue;
+                    if (position[neighbor] == invalid)
+                      {
+                        position[neighbor] = coarse.neighbors.size();
+                        coarse.neighbors.push_back (neighbor);
+                        coarse.edge_weights.push_back (fine.edge_weights[j]);
+                      }
+                    else
+                      coarse.edge_weights[position[neighbor]] += fine.edge_weights[j];
+                  }
+              }
+
+            coarse.row_start[c+1] = coarse.neighbors.size();
+            for (unsigned int j=coarse.row_start[c]; j<coarse.row_start[c+1]; ++j)
+              position[coarse.neighbors[j]] = invalid;
+          }
+      }
+
+
+      /**
+       * Return the total weight of the edges between nodes on different
+       * sides of a bisection.
+       */
+      std::size_t
+      compute_cut (const Graph                     &graph,
+                   const std::vector<unsigned int> &side)
+      {
+        std::size_t cut = 0;
+        for (unsigned int i=0; i<graph.n_nodes(); ++i)
+          for (unsigned int j=graph.row_start[i]; j<graph.row_start[i+1]; ++j)
+            if (side[graph.neighbors[j]] != side[i])
+              cut += graph.edge_weights[j];
+        return cut/2;
+      }
+
+
+      /**
+       * Return by how much the weights of the two sides of a bisection
+       * exceed the given maximal weights.
+       */
+      std::size_t
+      compute_excess_weight (const std::size_t weights[2],
+                             const std::size_t max_weights[2])
+      {
+        std::size_t excess = 0;
+        for (unsigned int s=0; s<2; ++s)
+          if (weights[s] > max_weights[s])
+            excess += weights[s] - max_weights[s];
+        return excess;
+      }
+
+
+      /**
+       * Improve a bisection of a graph by the Fiduccia-Mattheyses
+       * algorithm: in each pass, repeatedly move the node with the largest
+       * gain (the reduction of the edge cut) that does not violate the
+       * maximal weights of the two sides to the other side, and lock it. At
+       * the end of the pass, undo all moves after the best state
+       * encountered. A state is better than another if it exceeds the
+       * maximal weights by less, or equally much and has a smaller edge cut.
+       */
+      void
+      refine_bisection (const Graph               &graph,
+                        const std::size_t          max_weights[2],
+                        std::vector<unsigned int> &side)
+      {
+        const unsigned int n = graph.n_nodes();
+        const unsigned int max_passes = 8;
+
+        for (unsigned int pass=0; pass<max_passes; ++pass)
+          {
+            std::size_t weights[2] = { 0, 0 };
+            for (unsigned int i=0; i<n; ++i)
+              weights[side[i]] += graph.node_weights[i];
+
+            // the gain of moving a node is the weight of its edges to the
+            // other side minus the weight of its edges to its own side. only
+            // nodes on the boundary between the sides are candidates for
+            // moving
+            std::vector<long int> gain (n, 0);
+            std::vector<bool>     is_boundary (n, false);
+            for (unsigned int i=0; i<n; ++i)
+              for (unsigned int j=graph.row_start[i]; j<graph.row_start[i+1]; ++j)
+                if (side[graph.neighbors[j]] != side[i])
+                  {
+                    gain[i] += graph.edge_weights[j];
+                    is_boundary[i] = true;
+                  }
+                else
+                  gain[i] -= graph.edge_weights[j];
+
+            // the queues of candidates on each side, sorted by decreasing
+            // gain and then by increasing index for determinism. a node has
+            // at most one entry, and is_queued records whether it has one
+            std::set<std::pair<long int,unsigned int> > queues[2];
+            std::vector<bool> is_queued (n, false);
+            for (unsigned int i=0; i<n; ++i)
+              if (is_boundary[i] || (weights[side[i]] > max_weights[side[i]]))
+                {
+                  queues[side[i]].insert (std::make_pair (-gain[i], i));
+                  is_queued[i] = true;
+                }
+
+            // allow moves that make the other side too heavy by at most
+            // one node, so that the next move can restore the balance. this
+            // way, we can exchange nodes between the sides even if both are
+            // already at their maximal weights
+            const std::size_t         move_slack = graph.max_node_weight();
+            std::vector<bool>         locked (n, false);
+            std::vector<unsigned int> moves;
+            std::size_t               cut = compute_cut (graph, side);
+            std::size_t               best_cut = cut;
+            std::size_t               best_excess = compute_excess_weight (weights, max_weights);
+            unsigned int              n_best_moves = 0;
+            const unsigned int        max_moves_without_improvement
+              = std::max (25U, n/20);
+
+            while (moves.size() - n_best_moves < max_moves_without_improvement)
+              {
+                // a node that has already been moved in this pass must never
+                // be moved again
+                for (unsigned int s=0; s<2; ++s)
+                  while (!queues[s].empty() && locked[queues[s].begin()->second])
+                    queues[s].erase (queues[s].begin());
+
+                // find the side to move a node from. if one side is too
+                // heavy, we have to move from there. otherwise take the
+                // candidate with the larger gain whose move does not make the
+                // other side too heavy
+                int from = -1;
+                for (unsigned int s=0; s<2; ++s)
+                  if (!queues[s].empty())
+                    {
+                      const unsigned int node = queues[s].begin()->second;
+                      const bool overweight = (weights[s] > max_weights[s]);
+                      const bool fits = (weights[1-s] + graph.node_weights[node]
+                                         <= max_weights[1-s] + move_slack);
+                      if (!overweight && !fits)
+                        continue;
+                      if ((from == -1)
+                          ||
+                          (overweight && (weights[from] <= max_weights[from]))
+                          ||
+                          ((overweight == (weights[from] > max_weights[from]))
+                           &&
+                           (queues[s].begin()->first < queues[from].begin()->first)))
+                        from = s;
+                    }
+                if (from == -1)
+                  break;
+
+                const unsigned int node = queues[from].begin()->second;
+                queues[from].erase (queues[from].begin());
+                is_queued[node] = false;
+                const unsigned int to = 1-from;
+
+                side[node] = to;
+                locked[node] = true;
+                weights[from] -= graph.node_weights[node];
+                weights[to]   += graph.node_weights[node];
+                cut = static_cast<std::size_t>(static_cast<long int>(cut) - gain[node]);
+                moves.push_back (node);
+
+                // update the gains of the unlocked neighbors
+                for (unsigned int j=graph.row_start[node]; j<graph.row_start[node+1]; ++j)
+                  {
+                    const unsigned int neighbor = graph.neighbors[j];
+                    if (locked[neighbor])
+                      continue;
+
+                    const unsigned int neighbor_side = side[neighbor];
+                    if (is_queued[neighbor])
+                      queues[neighbor_side].erase (std::make_pair (-gain[neighbor], neighbor));
+
+                    if (neighbor_side == to)
+                      gain[neighbor] -= 2*static_cast<long int>(graph.edge_weights[j]);
+                    else
+                      gain[neighbor] += 2*static_cast<long int>(graph.edge_weights[j]);
+
+                    is_boundary[neighbor] = true;
+                    queues[neighbor_side].insert (std::make_pair (-gain[neighbor], neighbor));
+                    is_queued[neighbor] = true;
+                  }
+
+                const std::size_t excess = compute_excess_weight (weights, max_weights);
+                if ((excess < best_excess)
+                    ||
+                    ((excess == best_excess) && (cut < best_cut)))
+                  {
+                    best_excess  = excess;
+                    best_cut     = cut;
+                    n_best_moves = moves.size();
+                  }
+              }
+
+#ifdef DEBUG
+            // the weights and the cut updated with each move must agree
+            // with the ones of the final state of this pass
+            std::size_t final_weights[2] = { 0, 0 };
+            for (unsigned int i=0; i<n; ++i)
+              final_weights[side[i]] += graph.node_weights[i];
+            Assert ((final_weights[0] == weights[0]) &&
+                    (final_weights[1] == weights[1]),
+                    ExcInternalError());
+            Assert (cut == compute_cut (graph, side), ExcInternalError());
+#endif
+
+            // undo the moves after the best state
+            for (unsigned int m=n_best_moves; m<moves.size(); ++m)
+              side[moves[m]] = 1-side[moves[m]];
+
+            if (n_best_moves == 0)
+              break;
+          }
+      }
+
+
+      /**
+       * Compute the maximal weights of the two sides of a bisection in
+       * which side 0 should have the fraction @p fraction_0 of the total
+       * weight of the graph. On coarse graphs, we need to allow for almost
+       * the weight of the heaviest node, or balancing may be impossible.
+       */
+      void
+      compute_max_weights (const Graph       &graph,
+                           const double       fraction_0,
+                           std::size_t        max_weights[2])
+      {
+        const std::size_t total_weight = graph.total_node_weight();
+        const std::size_t target_weights[2]
+          = { static_cast<std::size_t>(fraction_0 * total_weight + 0.5),
+              total_weight - static_cast<std::size_t>(fraction_0 * total_weight + 0.5)
+            };
+        for (unsigned int s=0; s<2; ++s)
+          max_weights[s] = target_weights[s] +
+                           std::max (static_cast<std::size_t>(imbalance_tolerance *
+                                                              target_weights[s]),
+                                     static_cast<std::size_t>(std::max(graph.max_node_weight(),1U)-1));
+      }
+
+
+      /**
+       * Bisect a small graph by growing side 0 from the given seed node,
+       * always adding the node with the largest gain next, until side 0 has
+       * reached its target weight. All other nodes end up on side 1.
+       */
+      void
+      grow_bisection (const Graph               &graph,
+                      const unsigned int         seed,
+                      const std::size_t          target_weight_0,
+                      std::vector<unsigned int> &side)
+      {
+        const unsigned int n = graph.n_nodes();
+        side.assign (n, 1);
+
+        // the connection of each node outside the grown region to it
+        std::vector<long int> connection (n, 0);
+        std::vector<bool>     is_frontier (n, false);
+
+        std::size_t weight_0 = 0;
+        unsigned int next = seed;
+        while (next != numbers::invalid_unsigned_int)
+          {
+            // stop if adding the next node gets us farther away from the
+            // target than we are now
+            if ((weight_0 > 0)
+                &&
+                (weight_0 + graph.node_weights[next] > target_weight_0)
+                &&
+                (weight_0 + graph.node_weights[next] - target_weight_0
+                 > target_weight_0 - weight_0))
+              break;
+
+            side[next] = 0;
+            is_frontier[next] = false;
+            weight_0 += graph.node_weights[next];
+            if (weight_0 >= target_weight_0)
+              break;
+
+            for (unsigned int j=graph.row_start[next]; j<graph.row_start[next+1]; ++j)
+              if (side[graph.neighbors[j]] == 1)
+                {
+                  connection[graph.neighbors[j]] += graph.edge_weights[j];
+                  is_frontier[graph.neighbors[j]] = true;
+                }
+
+            // pick the frontier node that is most strongly connected to the
+            // region relative to its other edges. if the frontier is empty
+            // (the graph is not connected), continue with the first node
+            // not yet in the region
+            next = numbers::invalid_unsigned_int;
+            long int best_gain = 0;
+            for (unsigned int i=0; i<n; ++i)
+              if (is_frontier[i])
+                {
+                  long int node_gain = 0;
+                  for (unsigned int j=graph.row_start[i]; j<graph.row_start[i+1]; ++j)
+                    node_gain += (side[graph.neighbors[j]] == 0 ? 1 : -1) *
+                                 static_cast<long int>(graph.edge_weights[j]);
+                  if ((next == numbers::invalid_unsigned_int) || (node_gain > best_gain))
+                    {
+                      next = i;
+                      best_gain = node_gain;
+                    }
+                }
+            if (next == numbers::invalid_unsigned_int)
+              for (unsigned int i=0; i<n; ++i)
+                if (side[i] == 1)
+                  {
+                    next = i;
+                    break;
+                  }
+          }
+      }
+
+
+      /**
+       * Return a node that is far away from node 0 in the graph (a
+       * pseudo-peripheral node), found by a breadth-first search.
+       */
+      unsigned int
+      find_peripheral_node (const Graph &graph)
+      {
+        std::vector<bool> visited (graph.n_nodes(), false);
+        std::vector<unsigned int> queue (1, 0);
+        visited[0] = true;
+        for (unsigned int q=0; q<queue.size(); ++q)
+          for (unsigned int j=graph.row_start[queue[q]]; j<graph.row_start[queue[q]+1]; ++j)
+            if (!visited[graph.neighbors[j]])
+              {
+                visited[graph.neighbors[j]] = true;
+                queue.push_back (graph.neighbors[j]);
+              }
+        return queue.back();
+      }
+
+
+      /**
+       * Bisect a graph such that side 0 has about the fraction @p fraction_0
+       * of the total node weight and the edge cut is small, using a
+       * multilevel scheme: coarsen the graph by heavy-edge matching, bisect
+       * the coarsest graph by greedy growing from several seeds, and project
+       * the bisection back to the finer graphs, improving it on each level
+       * with the Fiduccia-Mattheyses algorithm.
+       */
+      void
+      bisect (const Graph               &graph,
+              const double               fraction_0,
+              std::vector<unsigned int> &side)
+      {
+        const std::size_t max_coarse_node_weight
+          = std::max (static_cast<std::size_t>(graph.max_node_weight()),
+                      static_cast<std::size_t>(1.5 * graph.total_node_weight() /
+                                               coarsest_graph_size));
+
+        // coarsen. the std::list keeps the addresses of its elements stable
+        std::list<Graph>                        coarse_graphs;
+        std::vector<const Graph *>              levels (1, &graph);
+        std::vector<std::vector<unsigned int> > fine_to_coarse;
+        while (levels.back()->n_nodes() > coarsest_graph_size)
+          {
+            coarse_graphs.push_back (Graph());
+            fine_to_coarse.push_back (std::vector<unsigned int>());
+            coarsen (*levels.back(), max_coarse_node_weight,
+                     coarse_graphs.back(), fine_to_coarse.back());
+
+            // stop if the matching does not make enough progress any more
+            if (coarse_graphs.back().n_nodes() > 0.95 * levels.back()->n_nodes())
+              {
+                coarse_graphs.pop_back ();
+                fine_to_coarse.pop_back ();
+                break;
+              }
+            levels.push_back (&coarse_graphs.back());
+          }
+
+        // bisect the coarsest graph, trying several seeds and keeping the
+        // best result
+        const Graph &coarsest = *levels.back();
+        std::size_t max_weights[2];
+        compute_max_weights (coarsest, fraction_0, max_weights);
+        const std::size_t target_weight_0
+          = static_cast<std::size_t>(fraction_0 * coarsest.total_node_weight() + 0.5);
+
+        std::vector<unsigned int> seeds (1, find_peripheral_node (coarsest));
+        for (unsigned int s=1; s<4; ++s)
+          seeds.push_back (s * coarsest.n_nodes() / 4);
+
+        std::size_t best_excess = 0, best_cut = 0;
+        std::vector<unsigned int> trial_side;
+        for (unsigned int s=0; s<seeds.size(); ++s)
+          {
+            grow_bisection (coarsest, seeds[s], target_weight_0, trial_side);
+            refine_bisection (coarsest, max_weights, trial_side);
+
+            std::size_t weights[2] = { 0, 0 };
+            for (unsigned int i=0; i<coarsest.n_nodes(); ++i)
+              weights[trial_side[i]] += coarsest.node_weights[i];
+            const std::size_t excess = compute_excess_weight (weights, max_weights);
+            const std::size_t cut    = compute_cut (coarsest, trial_side);
+            if ((s == 0)
+                ||
+                (excess < best_excess)
+                ||
+                ((excess == best_excess) && (cut < best_cut)))
+              {
+                best_excess = excess;
+                best_cut = cut;
+                side.swap (trial_side);
+              }
+          }
+
+        // project back to the finer graphs and refine there
+        for (int level=levels.size()-2; level>=0; --level)
+          {
+            std::vector<unsigned int> fine_side (levels[level]->n_nodes());
+            for (unsigned int i=0; i<fine_side.size(); ++i)
+              fine_side[i] = side[fine_to_coarse[level][i]];
+            side.swap (fine_side);
+
+            compute_max_weights (*levels[level], fraction_0, max_weights);
+            refine_bisection (*levels[level], max_weights, side);
+          }
+      }
+
+
+      /**
+       * Return the subgraph of the nodes on the given side of a bisection,
+       * along with the indices these nodes have in @p graph.
+       */
+      void
+      extract_subgraph (const Graph                     &graph,
+                        const std::vector<unsigned int> &side,
+                        const unsigned int               which_side,
+                        Graph                           &subgraph,
+                        std::vector<unsigned int>       &subgraph_to_graph)
+      {
+        std::vector<unsigned int> graph_to_subgraph (graph.n_nodes(),
+                                                     numbers::invalid_unsigned_int);
+        subgraph_to_graph.clear ();
+        for (unsigned int i=0; i<graph.n_nodes(); ++i)
+          if (side[i] == which_side)
+            {
+              graph_to_subgraph[i] = subgraph_to_graph.size();
+              subgraph_to_graph.push_back (i);
+            }
+
+        subgraph.row_start.assign (1, 0);
+        subgraph.node_weights.clear ();
+        subgraph.neighbors.clear ();
+        subgraph.edge_weights.clear ();
+        for (unsigned int k=0; k<subgraph_to_graph.size(); ++k)
+          {
+            const unsigned int i = subgraph_to_graph[k];
+            subgraph.node_weights.push_back (graph.node_weights[i]);
+            for (unsigned int j=graph.row_start[i]; j<graph.row_start[i+1]; ++j)
+              if (side[graph.neighbors[j]] == which_side)
+                {
+                  subgraph.neighbors.push_back (graph_to_subgraph[graph.neighbors[j]]);
+                  subgraph.edge_weights.push_back (graph.edge_weights[j]);
+                }
+            subgraph.row_start.push_back (subgraph.neighbors.size());
+          }
+      }
+
+
+      /**
+       * Partition @p graph into @p n_parts parts numbered starting at @p
+       * first_part by recursive bisection, and write the result into the
+       * entries of @p partition_indices given by @p graph_to_global.
+       */
+      void
+      partition_recursively (const Graph                     &graph,
+                             const std::vector<unsigned int> &graph_to_global,
+                             const unsigned int               first_part,
+                             const unsigned int               n_parts,
+                             std::vector<unsigned int>       &partition_indices)
+      {
+        if ((n_parts == 1) || (graph.n_nodes() <= 1))
+          {
+            for (unsigned int i=0; i<graph.n_nodes(); ++i)
+              partition_indices[graph_to_global[i]] = first_part;
+            return;
+          }
+
+        const unsigned int n_parts_0 = n_parts/2;
+        std::vector<unsigned int> side;
+        bisect (graph, 1.*n_parts_0/n_parts, side);
+
+        for (unsigned int s=0; s<2; ++s)
+          {
+            Graph subgraph;
+            std::vector<unsigned int> subgraph_to_graph;
+            extract_subgraph (graph, side, s, subgraph, subgraph_to_graph);
+            for (unsigned int i=0; i<subgraph_to_graph.size(); ++i)
+              subgraph_to_graph[i] = graph_to_global[subgraph_to_graph[i]];
+
+            partition_recursively (subgraph, subgraph_to_graph,
+                                   (s == 0 ? first_part : first_part+n_parts_0),
+                                   (s == 0 ? n_parts_0 : n_parts-n_parts_0),
+                                   partition_indices);
+          }
+      }
+
+
+
+      /**
+       * Set up the graph of a sparsity pattern, with unit weights for edges
+       * and, unless given, nodes. The diagonal is left out.
+       */
+      void
+      build_graph (const SparsityPattern           &sparsity_pattern,
+                   const std::vector<unsigned int> &node_weights,
+                   Graph                           &graph)
+      {
+        const unsigned int n = sparsity_pattern.n_rows();
+        graph.row_start.reserve (n+1);
+        graph.row_start.push_back (0);
+        graph.neighbors.reserve (sparsity_pattern.n_nonzero_elements());
+        for (unsigned int row=0; row<n; ++row)
+          {
+            for (SparsityPattern::iterator col=sparsity_pattern.begin(row);
+                 col < sparsity_pattern.end(row); ++col)
+              if (col->column() != row)
+                graph.neighbors.push_back (col->column());
+            graph.row_start.push_back (graph.neighbors.size());
+          }
+        graph.edge_weights.resize (graph.neighbors.size(), 1U);
+        if (node_weights.size() > 0)
+          graph.node_weights = node_weights;
+        else
+          graph.node_weights.resize (n, 1U);
+      }
+
+
+
+      void
+      refine_bisection (const SparsityPattern           &sparsity_pattern,
+                        const std::vector<unsigned int> &node_weights,
+                        const double                     fraction_0,
+                        std::vector<unsigned int>       &side)
+      {
+        Assert (side.size() == sparsity_pattern.n_rows(),
+                ExcInvalidArraySize (side.size(), sparsity_pattern.n_rows()));
+
+        Graph graph;
+        build_graph (sparsity_pattern, node_weights, graph);
+
+        std::size_t max_weights[2];
+        compute_max_weights (graph, fraction_0, max_weights);
+        refine_bisection (graph, max_weights, side);
+      }
+    }
+  }
+
+
+
+  void partition_multilevel (const SparsityPattern           &sparsity_pattern,
+                             const std::vector<unsigned int> &node_weights,
+                             const unsigned int               n_partitions,
+                             std::vector<unsigned int>       &partition_indices)
+  {
+    Assert (sparsity_pattern.n_rows()==sparsity_pattern.n_cols(),
+            ExcNotQuadratic());
+    Assert (sparsity_pattern.is_compressed(),
+            SparsityPattern::ExcNotCompressed());
+    Assert (n_partitions > 0, ExcInvalidNumberOfPartitions(n_partitions));
+    Assert (partition_indices.size() == sparsity_pattern.n_rows(),
+            ExcInvalidArraySize (partition_indices.size(),
+                                 sparsity_pattern.n_rows()));
+    Assert ((node_weights.size() == 0)
+            ||
+            (node_weights.size() == sparsity_pattern.n_rows()),
+            ExcInvalidArraySize (node_weights.size(),
+                                 sparsity_pattern.n_rows()));
+
+    internal::Partitioning::Graph graph;
+    internal::Partitioning::build_graph (sparsity_pattern, node_weights, graph);
+
+    const unsigned int n = sparsity_pattern.n_rows();
+    std::vector<unsigned int> identity (n);
+    for (unsigned int i=0; i<n; ++i)
+      identity[i] = i;
+
+    internal::Partitioning::partition_recursively (graph, identity, 0, n_partitions,
+                                                   partition_indices);
+  }
+
+
   namespace internal
   {
     /**
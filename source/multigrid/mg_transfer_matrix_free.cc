@@ -16,6 +16,7 @@
 
 #include <deal.II/base/logstream.h>
 #include <deal.II/base/function.h>
+#include <deal.II/base/parallel.h>
 
 #include <deal.II/lac/la_parallel_vector.h>
 #include <deal.II/grid/tria.h>
@@ -26,6 +27,7 @@
 #include <deal.II/dofs/dof_accessor.h>
 #include <deal.II/multigrid/mg_tools.h>
 #include <deal.II/multigrid/mg_transfer_matrix_free.h>
+#include <deal.II/multigrid/mg_transfer.templates.h>
 
 #include <deal.II/matrix_free/shape_info.h>
 #include <deal.II/matrix_free/fe_evaluation.h>
@@ -622,6 +624,16 @@ void MGTransferMatrixFree<dim,Number>
                   dst.local_size());
 
   this->ghosted_level_vector[from_level] = src;
+  restrict_ghosted_and_add (from_level, dst);
+}
+
+
+
+template <int dim, typename Number>
+void MGTransferMatrixFree<dim,Number>
+::restrict_ghosted_and_add (const unsigned int                      from_level,
+                            LinearAlgebra::distributed::Vector<Number> &dst) const
+{
   this->ghosted_level_vector[from_level].update_ghost_values();
   this->ghosted_level_vector[from_level-1] = 0.;
 
@@ -667,6 +679,77 @@ void MGTransferMatrixFree<dim,Number>
 
 
 
+namespace
+{
+  // convert the locally owned range [begin,end) of the vector src to the
+  // number type of the level vectors and write it into both dst1 and dst2
+  template <typename Number, typename Number2>
+  void copy_convert_twice (const Number2     *src,
+                           Number            *dst1,
+                           Number            *dst2,
+                           const std::size_t  begin,
+                           const std::size_t  end)
+  {
+    DEAL_II_OPENMP_SIMD_PRAGMA
+    for (std::size_t i=begin; i<end; ++i)
+      {
+        const Number value = static_cast<Number>(src[i]);
+        dst1[i] = value;
+        dst2[i] = value;
+      }
+  }
+}
+
+
+
+template <int dim, typename Number>
+template <typename Number2>
+void MGTransferMatrixFree<dim,Number>
+::copy_to_mg (const DoFHandler<dim,dim>                                  &mg_dof,
+              MGLevelObject<LinearAlgebra::distributed::Vector<Number> > &dst,
+              const LinearAlgebra::distributed::Vector<Number2>          &src) const
+{
+  // the fused variant is only possible when the finest level vector is a
+  // plain copy of the global vector and there is at least one restriction
+  // to perform. Otherwise, the base class already converts the numbers when
+  // importing the global vector into its ghosted vector
+  if (!this->perform_plain_copy || dst.max_level() == dst.min_level())
+    {
+      MGLevelGlobalTransfer<LinearAlgebra::distributed::Vector<Number> >::
+      copy_to_mg(mg_dof, dst, src);
+      return;
+    }
+
+  AssertIndexRange(dst.max_level(), mg_dof.get_triangulation().n_global_levels());
+  AssertIndexRange(dst.min_level(), dst.max_level()+1);
+  reinit_vector(mg_dof, this->component_to_block_map, dst);
+
+  const unsigned int max_level = dst.max_level();
+  AssertDimension(dst[max_level].local_size(), src.local_size());
+  AssertDimension(this->ghosted_level_vector[max_level].local_size(),
+                  src.local_size());
+
+  // write the converted values into the finest level vector as well as into
+  // the ghosted vector used for the restriction to the next coarser level
+  parallel::apply_to_subranges (std::size_t(0), std::size_t(src.local_size()),
+                                std_cxx11::bind(&copy_convert_twice<Number,Number2>,
+                                                src.begin(),
+                                                dst[max_level].begin(),
+                                                this->ghosted_level_vector[max_level].begin(),
+                                                std_cxx11::_1, std_cxx11::_2),
+                                internal::Vector::minimum_parallel_grain_size);
+  restrict_ghosted_and_add (max_level, dst[max_level-1]);
+
+  // do the remaining restrictions to the coarser levels
+  for (unsigned int level=max_level-1; level != dst.min_level(); )
+    {
+      --level;
+      restrict_and_add (level+1, dst[level], dst[level+1]);
+    }
+}
+
+
+
 namespace
 {
   template <int dim, typename Eval, typename Number, bool prolongate>
@@ -0,0 +1,169 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// the list functions of FEFieldFunction locate many points at once and
+// evaluate the function on the cells in parallel. check that they give the
+// same results as evaluating the function point by point, both for
+// elements whose values are computed directly from the shape functions and
+// for elements that need the mapping, on a curved mesh, for DoFHandler and
+// hp::DoFHandler, and that points outside the domain are reported
+
+#include "../tests.h"
+
+#include <deal.II/base/utilities.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/manifold_lib.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/fe/mapping_q.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_raviart_thomas.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/numerics/fe_field_function.h>
+
+#include <fstream>
+
+
+template <int dim, typename DoFHandlerType>
+void check (const DoFHandlerType &dof_handler,
+            const Mapping<dim>   &mapping)
+{
+  Vector<double> solution (dof_handler.n_dofs());
+  for (unsigned int i=0; i<solution.size(); ++i)
+    solution(i) = Testing::rand()/(double)RAND_MAX;
+
+  const unsigned int n_components = dof_handler.get_fe().n_components();
+  Functions::FEFieldFunction<dim,DoFHandlerType> fe_function (dof_handler, solution,
+      mapping);
+
+  // points inside the ball of radius 0.95
+  std::vector<Point<dim> > points;
+  while (points.size() < 1000)
+    {
+      Point<dim> p;
+      for (unsigned int d=0; d<dim; ++d)
+        p[d] = 2. * (Testing::rand()/(double)RAND_MAX - 0.5);
+      if (p.norm() < 0.95)
+        points.push_back (p);
+    }
+
+  std::vector<Vector<double> > values (points.size(), Vector<double>(n_components));
+  fe_function.vector_value_list (points, values);
+
+  std::vector<std::vector<Tensor<1,dim> > >
+  gradients (points.size(), std::vector<Tensor<1,dim> >(n_components));
+  fe_function.vector_gradient_list (points, gradients);
+
+  std::vector<double> component_values (points.size());
+  fe_function.value_list (points, component_values, n_components-1);
+
+  double max_value_error = 0, max_gradient_error = 0;
+  for (unsigned int i=0; i<points.size(); ++i)
+    {
+      Vector<double> value (n_components);
+      fe_function.vector_value (points[i], value);
+      std::vector<Tensor<1,dim> > gradient (n_components);
+      fe_function.vector_gradient (points[i], gradient);
+
+      for (unsigned int c=0; c<n_components; ++c)
+        {
+          max_value_error = std::max (max_value_error,
+                                      std::fabs (values[i](c) - value(c)));
+          max_gradient_error = std::max (max_gradient_error,
+                                         (gradients[i][c] - gradient[c]).norm());
+        }
+      max_value_error = std::max (max_value_error,
+                                  std::fabs (component_values[i] - value(n_components-1)));
+    }
+
+  deallog << dof_handler.get_fe()[0].get_name()
+          << ": value error " << (max_value_error < 1e-12 ? "ok" : "too large")
+          << ", gradient error " << (max_gradient_error < 1e-10 ? "ok" : "too large")
+          << std::endl;
+
+  // a point outside the domain
+  points.back() = Point<dim>::unit_vector(0) * 1.5;
+  try
+    {
+      fe_function.vector_value_list (points, values);
+    }
+  catch (const GridTools::ExcPointNotFound<dim> &)
+    {
+      deallog << "point outside the domain not found" << std::endl;
+    }
+}
+
+
+
+template <int dim>
+void test ()
+{
+  deallog << "dim=" << dim << std::endl;
+
+  Triangulation<dim> triangulation;
+  GridGenerator::hyper_ball (triangulation);
+  static const SphericalManifold<dim> manifold;
+  triangulation.set_all_manifold_ids_on_boundary (0);
+  triangulation.set_manifold (0, manifold);
+  triangulation.refine_global (dim == 2 ? 3 : 1);
+
+  const MappingQ<dim> mapping (2);
+
+  {
+    const FESystem<dim> fe (FE_Q<dim>(2), 2, FE_DGQ<dim>(1), 1);
+    DoFHandler<dim> dof_handler (triangulation);
+    dof_handler.distribute_dofs (fe);
+    check (dof_handler, mapping);
+  }
+
+  {
+    const FE_RaviartThomas<dim> fe (1);
+    DoFHandler<dim> dof_handler (triangulation);
+    dof_handler.distribute_dofs (fe);
+    check (dof_handler, mapping);
+  }
+
+  {
+    hp::FECollection<dim> fe_collection;
+    fe_collection.push_back (FE_Q<dim>(1));
+    fe_collection.push_back (FE_Q<dim>(3));
+    hp::DoFHandler<dim> dof_handler (triangulation);
+    unsigned int index = 0;
+    for (typename hp::DoFHandler<dim>::active_cell_iterator
+         cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell, ++index)
+      cell->set_active_fe_index (index % 2);
+    dof_handler.distribute_dofs (fe_collection);
+    check (dof_handler, mapping);
+  }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+
+  test<2>();
+  test<3>();
+
+  return 0;
+}
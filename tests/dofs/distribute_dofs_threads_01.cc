@@ -0,0 +1,122 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// with several threads, DoFHandler::distribute_dofs() and renumber_dofs()
+// work on chunks of cells and dof indices in parallel. check that the
+// numbering is the same as with a single thread, on adaptively refined
+// meshes and for elements with dofs on all kinds of objects. the meshes are
+// large enough for the finest levels to be split into several chunks
+
+#include "../tests.h"
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/base/logstream.h>
+
+#include <fstream>
+
+
+template <int dim>
+void create_mesh (Triangulation<dim> &tria)
+{
+  GridGenerator::hyper_ball (tria);
+  tria.refine_global (dim == 2 ? 4 : 2);
+  for (unsigned int cycle=0; cycle<2; ++cycle)
+    {
+      unsigned int index = 0;
+      for (typename Triangulation<dim>::active_cell_iterator cell = tria.begin_active();
+           cell != tria.end(); ++cell, ++index)
+        if (index % 5 == 0)
+          cell->set_refine_flag ();
+        else if (index % 7 == 0)
+          cell->set_coarsen_flag ();
+      tria.execute_coarsening_and_refinement ();
+    }
+}
+
+
+
+template <int dim>
+std::vector<types::global_dof_index>
+get_all_dof_indices (const DoFHandler<dim> &dof_handler)
+{
+  std::vector<types::global_dof_index> all_indices, local_indices;
+  for (typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active();
+       cell != dof_handler.end(); ++cell)
+    {
+      local_indices.resize (cell->get_fe().dofs_per_cell);
+      cell->get_dof_indices (local_indices);
+      all_indices.insert (all_indices.end(), local_indices.begin(), local_indices.end());
+    }
+  return all_indices;
+}
+
+
+
+template <int dim>
+void check (const FiniteElement<dim> &fe)
+{
+  Triangulation<dim> tria;
+  create_mesh (tria);
+  DoFHandler<dim> dof_handler (tria);
+
+  MultithreadInfo::set_thread_limit (1);
+  dof_handler.distribute_dofs (fe);
+  const std::vector<types::global_dof_index> serial = get_all_dof_indices (dof_handler);
+  DoFRenumbering::Cuthill_McKee (dof_handler);
+  const std::vector<types::global_dof_index> serial_renumbered
+    = get_all_dof_indices (dof_handler);
+
+  MultithreadInfo::set_thread_limit (4);
+  AssertThrow (MultithreadInfo::n_threads() > 1, ExcInternalError());
+  dof_handler.distribute_dofs (fe);
+  const std::vector<types::global_dof_index> parallel = get_all_dof_indices (dof_handler);
+  DoFRenumbering::Cuthill_McKee (dof_handler);
+  const std::vector<types::global_dof_index> parallel_renumbered
+    = get_all_dof_indices (dof_handler);
+
+  deallog << fe.get_name() << ": same numbering: "
+          << (serial == parallel ? "yes" : "no")
+          << ", same renumbering: "
+          << (serial_renumbered == parallel_renumbered ? "yes" : "no")
+          << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  check (FE_Q<2>(1));
+  check (FE_Q<2>(3));
+  check (FE_DGQ<2>(2));
+  check (FESystem<2>(FE_Q<2>(2), 2, FE_Q<2>(1), 1));
+  check (FE_Q<3>(1));
+  check (FE_Q<3>(3));
+  check (FESystem<3>(FE_Q<3>(2), 3));
+}
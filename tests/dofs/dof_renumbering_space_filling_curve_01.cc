@@ -0,0 +1,156 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check DoFRenumbering::space_filling_curve: for piecewise constants on a
+// uniform mesh, consecutive degrees of freedom along the Hilbert curve must
+// be on neighboring cells. for continuous elements, the degrees of freedom
+// of each cell must be numbered in the first-touch order of the cells, for
+// DoFHandler and hp::DoFHandler alike
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <fstream>
+
+
+template <int dim>
+void test ()
+{
+  deallog << "dim=" << dim << std::endl;
+
+  Triangulation<dim> tria;
+  GridGenerator::subdivided_hyper_cube (tria, 4);
+  tria.refine_global (1);
+
+  // piecewise constants: each cell has one degree of freedom, and cells
+  // with consecutive indices share a face
+  {
+    FE_DGQ<dim> fe (0);
+    DoFHandler<dim> dof_handler (tria);
+    dof_handler.distribute_dofs (fe);
+    DoFRenumbering::space_filling_curve (dof_handler);
+
+    std::vector<Point<dim> > centers (dof_handler.n_dofs());
+    std::vector<types::global_dof_index> dof_indices (1);
+    for (typename DoFHandler<dim>::active_cell_iterator
+         cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+      {
+        cell->get_dof_indices (dof_indices);
+        centers[dof_indices[0]] = cell->center();
+      }
+    unsigned int n_jumps = 0;
+    for (unsigned int i=1; i<centers.size(); ++i)
+      if (std::fabs (centers[i].distance (centers[i-1]) - 0.125) > 1e-12)
+        ++n_jumps;
+    deallog << "DGQ0: first cell " << centers[0] << ", jumps " << n_jumps
+            << std::endl;
+
+    // the Morton curve jumps
+    DoFRenumbering::space_filling_curve (dof_handler, GridTools::morton_curve);
+    for (typename DoFHandler<dim>::active_cell_iterator
+         cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+      {
+        cell->get_dof_indices (dof_indices);
+        centers[dof_indices[0]] = cell->center();
+      }
+    n_jumps = 0;
+    for (unsigned int i=1; i<centers.size(); ++i)
+      if (std::fabs (centers[i].distance (centers[i-1]) - 0.125) > 1e-12)
+        ++n_jumps;
+    deallog << "DGQ0 Morton: first cell " << centers[0] << ", jumps " << n_jumps
+            << std::endl;
+  }
+
+  // continuous elements: since every cell has interior degrees of freedom,
+  // sorting the cells by their largest index gives the order in which they
+  // were visited. each cell may then only add new indices directly after
+  // the largest index used so far
+  FESystem<dim> fe (FE_Q<dim>(2), 2);
+  DoFHandler<dim> dof_handler (tria);
+  dof_handler.distribute_dofs (fe);
+  DoFRenumbering::space_filling_curve (dof_handler);
+
+  hp::FECollection<dim> fe_collection (fe);
+  hp::DoFHandler<dim> hp_dof_handler (tria);
+  hp_dof_handler.distribute_dofs (fe_collection);
+  DoFRenumbering::space_filling_curve (hp_dof_handler);
+
+  std::vector<std::pair<types::global_dof_index,unsigned int> > cell_order;
+  std::vector<std::vector<types::global_dof_index> >
+  dof_indices (tria.n_active_cells(),
+               std::vector<types::global_dof_index>(fe.dofs_per_cell));
+  unsigned int n_different_hp = 0;
+  {
+    typename hp::DoFHandler<dim>::active_cell_iterator
+    hp_cell = hp_dof_handler.begin_active();
+    unsigned int index = 0;
+    std::vector<types::global_dof_index> hp_dof_indices (fe.dofs_per_cell);
+    for (typename DoFHandler<dim>::active_cell_iterator
+         cell = dof_handler.begin_active(); cell != dof_handler.end();
+         ++cell, ++hp_cell, ++index)
+      {
+        cell->get_dof_indices (dof_indices[index]);
+        hp_cell->get_dof_indices (hp_dof_indices);
+        if (hp_dof_indices != dof_indices[index])
+          ++n_different_hp;
+        cell_order.push_back (std::make_pair (*std::max_element (dof_indices[index].begin(),
+                                                                 dof_indices[index].end()),
+                                              index));
+      }
+  }
+  std::sort (cell_order.begin(), cell_order.end());
+
+  types::global_dof_index n_numbered = 0;
+  unsigned int n_violations = 0;
+  for (unsigned int c=0; c<cell_order.size(); ++c)
+    {
+      std::vector<types::global_dof_index> indices = dof_indices[cell_order[c].second];
+      std::sort (indices.begin(), indices.end());
+      for (unsigned int i=0; i<indices.size(); ++i)
+        if (indices[i] >= n_numbered)
+          {
+            if (indices[i] != n_numbered)
+              ++n_violations;
+            ++n_numbered;
+          }
+    }
+  deallog << fe.get_name() << ": " << n_numbered << " of " << dof_handler.n_dofs()
+          << " dofs numbered in first-touch order, violations " << n_violations
+          << ", differences to hp " << n_different_hp << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+
+  test<2> ();
+  test<3> ();
+}
@@ -0,0 +1,166 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// with several threads, DoFTools::make_sparsity_pattern() fills separate
+// dynamic sparsity patterns on chunks of cells and merges them. check that
+// the result is the same as with a single thread, with and without
+// constraints and couplings, and that
+// DoFTools::make_and_compress_sparsity_pattern() creates the same pattern as
+// copying the dynamic sparsity pattern into a SparsityPattern. the meshes
+// have enough active cells to be split into several chunks
+
+#include "../tests.h"
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/base/logstream.h>
+
+#include <fstream>
+
+
+template <int dim>
+void create_mesh (Triangulation<dim> &tria)
+{
+  GridGenerator::hyper_ball (tria);
+  tria.refine_global (dim == 2 ? 4 : 2);
+  for (unsigned int cycle=0; cycle<2; ++cycle)
+    {
+      unsigned int index = 0;
+      for (typename Triangulation<dim>::active_cell_iterator cell = tria.begin_active();
+           cell != tria.end(); ++cell, ++index)
+        if (index % 5 == 0)
+          cell->set_refine_flag ();
+      tria.execute_coarsening_and_refinement ();
+    }
+}
+
+
+
+template <typename SparsityPatternType>
+std::vector<std::vector<types::global_dof_index> >
+get_rows (const SparsityPatternType &sparsity)
+{
+  std::vector<std::vector<types::global_dof_index> > rows (sparsity.n_rows());
+  for (types::global_dof_index row=0; row<sparsity.n_rows(); ++row)
+    {
+      for (typename SparsityPatternType::iterator p = sparsity.begin(row);
+           p != sparsity.end(row); ++p)
+        rows[row].push_back (p->column());
+      std::sort (rows[row].begin(), rows[row].end());
+    }
+  return rows;
+}
+
+
+
+template <int dim>
+void check (const FiniteElement<dim> &fe,
+            const bool                keep_constrained_dofs,
+            const bool                use_couplings)
+{
+  Triangulation<dim> tria;
+  create_mesh (tria);
+  DoFHandler<dim> dof_handler (tria);
+  dof_handler.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof_handler, constraints);
+  constraints.close ();
+
+  // only let the first component couple with itself and with the last one
+  Table<2,DoFTools::Coupling> couplings (fe.n_components(), fe.n_components());
+  couplings.fill (DoFTools::none);
+  couplings(0,0) = couplings(0,fe.n_components()-1)
+                   = couplings(fe.n_components()-1,0) = DoFTools::always;
+
+  std::vector<DynamicSparsityPattern> dsp (2);
+  for (unsigned int i=0; i<2; ++i)
+    {
+      if (i == 0)
+        MultithreadInfo::set_thread_limit (1);
+      else
+        {
+          MultithreadInfo::set_thread_limit (4);
+          AssertThrow (MultithreadInfo::n_threads() > 1, ExcInternalError());
+        }
+
+      dsp[i].reinit (dof_handler.n_dofs(), dof_handler.n_dofs());
+      if (use_couplings)
+        DoFTools::make_sparsity_pattern (dof_handler, couplings, dsp[i],
+                                         constraints, keep_constrained_dofs);
+      else
+        DoFTools::make_sparsity_pattern (dof_handler, dsp[i],
+                                         constraints, keep_constrained_dofs);
+    }
+
+  deallog << fe.get_name()
+          << (keep_constrained_dofs ? ", keep constrained dofs" : "")
+          << (use_couplings ? ", with couplings" : "")
+          << ": same pattern: "
+          << (get_rows(dsp[0]) == get_rows(dsp[1]) ? "yes" : "no");
+
+  if (use_couplings == false)
+    {
+      SparsityPattern copied, direct;
+      copied.copy_from (dsp[0]);
+      DoFTools::make_and_compress_sparsity_pattern (dof_handler, direct,
+                                                    constraints,
+                                                    keep_constrained_dofs);
+      deallog << ", same direct pattern: "
+              << (get_rows(copied) == get_rows(direct) ? "yes" : "no");
+    }
+  deallog << std::endl;
+}
+
+
+
+template <int dim>
+void check (const FiniteElement<dim> &fe)
+{
+  check (fe, true, false);
+  check (fe, false, false);
+  if (fe.n_components() > 1)
+    {
+      check (fe, true, true);
+      check (fe, false, true);
+    }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  check (FE_Q<2>(1));
+  check (FE_DGQ<2>(1));
+  check (FESystem<2>(FE_Q<2>(2), 2, FE_Q<2>(1), 1));
+  check (FE_Q<3>(2));
+}
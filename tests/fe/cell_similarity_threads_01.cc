@@ -0,0 +1,151 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// with more than one thread, FEValues only reuses data on a cell that is a
+// translation of another if the data were computed on the first sibling of
+// the cell. check that the values computed on each cell are then exactly the
+// same regardless of the order in which cells are visited, as happens in
+// WorkStream, and that similarity is actually used
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <fstream>
+
+
+template <int dim>
+std::vector<std::vector<double> >
+get_values (const DoFHandler<dim>                                          &dof_handler,
+            const std::vector<typename DoFHandler<dim>::active_cell_iterator> &cells,
+            unsigned int                                                    &n_translations)
+{
+  FEValues<dim> fe_values (dof_handler.get_fe(), QGauss<dim>(3),
+                           update_gradients | update_jacobians |
+                           update_JxW_values | update_quadrature_points);
+
+  std::vector<std::vector<double> >
+  values (dof_handler.get_triangulation().n_active_cells());
+  n_translations = 0;
+  for (unsigned int c=0; c<cells.size(); ++c)
+    {
+      fe_values.reinit (cells[c]);
+      if (fe_values.get_cell_similarity() == CellSimilarity::translation)
+        ++n_translations;
+
+      std::vector<double> &cell_values = values[cells[c]->active_cell_index()];
+      for (unsigned int q=0; q<fe_values.n_quadrature_points; ++q)
+        {
+          cell_values.push_back (fe_values.JxW(q));
+          for (unsigned int d=0; d<dim; ++d)
+            {
+              cell_values.push_back (fe_values.quadrature_point(q)[d]);
+              for (unsigned int e=0; e<dim; ++e)
+                cell_values.push_back (fe_values.jacobian(q)[d][e]);
+            }
+          for (unsigned int i=0; i<fe_values.dofs_per_cell; ++i)
+            for (unsigned int d=0; d<dim; ++d)
+              cell_values.push_back (fe_values.shape_grad(i,q)[d]);
+        }
+    }
+  return values;
+}
+
+
+
+template <int dim>
+void test ()
+{
+  // choose the corners of the domain such that the vertex coordinates are
+  // not exactly representable and round-off differs between cells
+  Point<dim> p1, p2;
+  for (unsigned int d=0; d<dim; ++d)
+    {
+      p1[d] = 1./(d+3);
+      p2[d] = p1[d] + std::sqrt(d+2.);
+    }
+  Triangulation<dim> tria;
+  GridGenerator::hyper_rectangle (tria, p1, p2);
+  tria.refine_global (2);
+  for (typename Triangulation<dim>::active_cell_iterator cell=tria.begin_active();
+       cell != tria.end(); ++cell)
+    if (cell->active_cell_index() % 5 == 0)
+      cell->set_refine_flag ();
+  tria.execute_coarsening_and_refinement ();
+
+  FE_Q<dim> fe (2);
+  DoFHandler<dim> dof_handler (tria);
+  dof_handler.distribute_dofs (fe);
+
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+  for (typename DoFHandler<dim>::active_cell_iterator cell=dof_handler.begin_active();
+       cell != dof_handler.end(); ++cell)
+    cells.push_back (cell);
+
+  // visit the cells in their natural order, backward, and by taking every
+  // seventh cell in turn
+  unsigned int n_translations[3];
+  const std::vector<std::vector<double> >
+  values_forward = get_values (dof_handler, cells, n_translations[0]);
+
+  std::reverse (cells.begin(), cells.end());
+  const std::vector<std::vector<double> >
+  values_backward = get_values (dof_handler, cells, n_translations[1]);
+
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> shuffled_cells;
+  for (unsigned int start=0; start<7; ++start)
+    for (unsigned int c=start; c<cells.size(); c+=7)
+      shuffled_cells.push_back (cells[c]);
+  const std::vector<std::vector<double> >
+  values_shuffled = get_values (dof_handler, shuffled_cells, n_translations[2]);
+
+  deallog << "same values in all orders: "
+          << ((values_forward == values_backward) &&
+              (values_forward == values_shuffled) ? "yes" : "no")
+          << std::endl;
+  deallog << "similarity used: "
+          << ((n_translations[0] > 0) && (n_translations[1] > 0) ? "yes" : "no")
+          << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  MultithreadInfo::set_thread_limit (2);
+
+  deallog.push ("2d");
+  test<2> ();
+  deallog.pop ();
+
+  deallog.push ("3d");
+  test<3> ();
+  deallog.pop ();
+}
@@ -0,0 +1,148 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// FEValues evaluates finite element functions by sum factorization for
+// FE_Q and FE_DGQ on tensor product quadrature formulas. check that
+// get_function_values/gradients/hessians agree with summing up the shape
+// function values and derivatives on a curved mesh, for double and float
+// vectors and with and without explicit dof indices
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/tria_boundary_lib.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/fe/mapping_q_generic.h>
+#include <deal.II/lac/vector.h>
+
+#include <fstream>
+
+
+template <int dim, typename Number>
+void
+check (const FiniteElement<dim> &fe,
+       const Quadrature<dim>    &quadrature)
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_ball (tria);
+  static const HyperBallBoundary<dim> boundary;
+  tria.set_boundary (0, boundary);
+  tria.refine_global (1);
+
+  DoFHandler<dim> dof_handler (tria);
+  dof_handler.distribute_dofs (fe);
+
+  Vector<Number> solution (dof_handler.n_dofs());
+  for (unsigned int i=0; i<solution.size(); ++i)
+    solution(i) = Testing::rand() / (Number)RAND_MAX;
+
+  MappingQGeneric<dim> mapping (2);
+  FEValues<dim> fe_values (mapping, fe, quadrature,
+                           update_values | update_gradients | update_hessians);
+
+  const unsigned int n_q_points = quadrature.size();
+  std::vector<Number> values (n_q_points), values_indices (n_q_points);
+  std::vector<Tensor<1,dim,Number> > gradients (n_q_points),
+      gradients_indices (n_q_points);
+  std::vector<Tensor<2,dim,Number> > hessians (n_q_points),
+      hessians_indices (n_q_points);
+  std::vector<types::global_dof_index> dof_indices (fe.dofs_per_cell);
+
+  double max_error = 0, max_size = 0;
+  for (typename DoFHandler<dim>::active_cell_iterator cell=dof_handler.begin_active();
+       cell!=dof_handler.end(); ++cell)
+    {
+      fe_values.reinit (cell);
+      cell->get_dof_indices (dof_indices);
+
+      fe_values.get_function_values (solution, values);
+      fe_values.get_function_gradients (solution, gradients);
+      fe_values.get_function_hessians (solution, hessians);
+      fe_values.get_function_values (solution, make_slice(dof_indices),
+                                     values_indices);
+      fe_values.get_function_gradients (solution, make_slice(dof_indices),
+                                        gradients_indices);
+      fe_values.get_function_hessians (solution, make_slice(dof_indices),
+                                       hessians_indices);
+
+      for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          double value = 0;
+          Tensor<1,dim> gradient;
+          Tensor<2,dim> hessian;
+          for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+            {
+              value += solution(dof_indices[i]) * fe_values.shape_value(i,q);
+              gradient += solution(dof_indices[i]) * fe_values.shape_grad(i,q);
+              hessian += solution(dof_indices[i]) * fe_values.shape_hessian(i,q);
+            }
+
+          max_size = std::max (max_size, std::fabs(value));
+          max_size = std::max (max_size, gradient.norm());
+          max_size = std::max (max_size, hessian.norm());
+
+          max_error = std::max (max_error, std::fabs(values[q] - value));
+          max_error = std::max (max_error, std::fabs(values_indices[q] - value));
+          max_error = std::max (max_error, (Tensor<1,dim>(gradients[q]) - gradient).norm());
+          max_error = std::max (max_error, (Tensor<1,dim>(gradients_indices[q]) - gradient).norm());
+          max_error = std::max (max_error, (Tensor<2,dim>(hessians[q]) - hessian).norm());
+          max_error = std::max (max_error, (Tensor<2,dim>(hessians_indices[q]) - hessian).norm());
+        }
+    }
+
+  const double tolerance = (sizeof(Number) == sizeof(float) ? 1e-4 : 1e-10);
+  deallog << fe.get_name() << ", " << n_q_points << " points, "
+          << (sizeof(Number) == sizeof(float) ? "float" : "double")
+          << ": results agree: "
+          << (max_error < tolerance * max_size ? "yes" : "no")
+          << std::endl;
+}
+
+
+
+template <int dim>
+void
+check ()
+{
+  check<dim,double> (FE_Q<dim>(1), QGauss<dim>(2));
+  check<dim,double> (FE_Q<dim>(3), QGauss<dim>(4));
+  check<dim,double> (FE_Q<dim>(3), QGauss<dim>(2));
+  check<dim,double> (FE_Q<dim>(2), QGaussLobatto<dim>(3));
+  check<dim,double> (FE_DGQ<dim>(2), QGauss<dim>(3));
+  check<dim,float>  (FE_Q<dim>(2), QGauss<dim>(3));
+  check<dim,float>  (FE_DGQ<dim>(3), QGauss<dim>(4));
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  check<2> ();
+  check<3> ();
+}
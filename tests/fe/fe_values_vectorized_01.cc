@@ -0,0 +1,198 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// assemble a Laplace plus mass matrix and a right hand side on a distorted,
+// adaptively refined mesh once with FEValues and once with FEValuesVectorized
+// working on batches of cells, and check that the results agree
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/fe/fe_values_vectorized.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <fstream>
+
+
+template <int dim>
+void
+assemble_scalar (const DoFHandler<dim>  &dof_handler,
+                 const ConstraintMatrix &constraints,
+                 SparseMatrix<double>   &matrix,
+                 Vector<double>         &rhs)
+{
+  const FiniteElement<dim> &fe = dof_handler.get_fe();
+  const QGauss<dim> quadrature (fe.degree+1);
+  FEValues<dim> fe_values (fe, quadrature,
+                           update_values | update_gradients |
+                           update_quadrature_points | update_JxW_values);
+
+  FullMatrix<double> cell_matrix (fe.dofs_per_cell, fe.dofs_per_cell);
+  Vector<double>     cell_rhs (fe.dofs_per_cell);
+  std::vector<types::global_dof_index> local_dof_indices (fe.dofs_per_cell);
+  for (typename DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+    {
+      fe_values.reinit (cell);
+      cell_matrix = 0;
+      cell_rhs = 0;
+      for (unsigned int q=0; q<quadrature.size(); ++q)
+        for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+          {
+            for (unsigned int j=0; j<fe.dofs_per_cell; ++j)
+              cell_matrix(i,j) += ((fe_values.shape_grad(i,q) *
+                                    fe_values.shape_grad(j,q)
+                                    +
+                                    fe_values.shape_value(i,q) *
+                                    fe_values.shape_value(j,q)) *
+                                   fe_values.JxW(q));
+            cell_rhs(i) += (fe_values.shape_value(i,q) *
+                            fe_values.quadrature_point(q)[0] *
+                            fe_values.JxW(q));
+          }
+
+      cell->get_dof_indices (local_dof_indices);
+      constraints.distribute_local_to_global (cell_matrix, cell_rhs,
+                                              local_dof_indices,
+                                              matrix, rhs);
+    }
+}
+
+
+
+template <int dim>
+void
+assemble_vectorized (const DoFHandler<dim>  &dof_handler,
+                     const ConstraintMatrix &constraints,
+                     SparseMatrix<double>   &matrix,
+                     Vector<double>         &rhs)
+{
+  const FiniteElement<dim> &fe = dof_handler.get_fe();
+  const QGauss<dim> quadrature (fe.degree+1);
+  FEValuesVectorized<dim> fe_values (fe, quadrature,
+                                     update_values | update_gradients |
+                                     update_quadrature_points | update_JxW_values);
+
+  Table<2,VectorizedArray<double> >        cell_matrix (fe.dofs_per_cell, fe.dofs_per_cell);
+  AlignedVector<VectorizedArray<double> >  cell_rhs (fe.dofs_per_cell);
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+  for (typename DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+    {
+      cells.push_back (cell);
+      if ((cells.size() < FEValuesVectorized<dim>::n_lanes)
+          &&
+          (cell->active_cell_index()+1 < dof_handler.get_triangulation().n_active_cells()))
+        continue;
+
+      fe_values.reinit (cells);
+      cell_matrix.reset_values ();
+      for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+        cell_rhs[i] = 0.;
+      for (unsigned int q=0; q<quadrature.size(); ++q)
+        for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+          {
+            for (unsigned int j=0; j<fe.dofs_per_cell; ++j)
+              cell_matrix(i,j) += ((fe_values.shape_grad(i,q) *
+                                    fe_values.shape_grad(j,q)
+                                    +
+                                    fe_values.shape_value(i,q) *
+                                    fe_values.shape_value(j,q)) *
+                                   fe_values.JxW(q));
+            cell_rhs[i] += (fe_values.shape_value(i,q) *
+                            fe_values.quadrature_point(q)[0] *
+                            fe_values.JxW(q));
+          }
+
+      fe_values.distribute_local_to_global (cell_matrix, cell_rhs, constraints,
+                                            matrix, rhs);
+      cells.clear ();
+    }
+}
+
+
+
+template <int dim>
+void test (const unsigned int degree)
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (dim == 2 ? 3 : 2);
+  GridTools::distort_random (0.2, tria);
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = tria.begin_active(); cell != tria.end(); ++cell)
+    if (cell->active_cell_index() % 3 == 0)
+      cell->set_refine_flag ();
+  tria.execute_coarsening_and_refinement ();
+
+  FE_Q<dim> fe (degree);
+  DoFHandler<dim> dof_handler (tria);
+  dof_handler.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof_handler, constraints);
+  constraints.close ();
+
+  DynamicSparsityPattern dsp (dof_handler.n_dofs());
+  DoFTools::make_sparsity_pattern (dof_handler, dsp, constraints, false);
+  SparsityPattern sparsity;
+  sparsity.copy_from (dsp);
+
+  SparseMatrix<double> matrix (sparsity), matrix_vectorized (sparsity);
+  Vector<double> rhs (dof_handler.n_dofs()), rhs_vectorized (dof_handler.n_dofs());
+  assemble_scalar (dof_handler, constraints, matrix, rhs);
+  assemble_vectorized (dof_handler, constraints, matrix_vectorized, rhs_vectorized);
+
+  const double matrix_norm = matrix.frobenius_norm();
+  const double rhs_norm = rhs.l2_norm();
+  matrix_vectorized.add (-1., matrix);
+  rhs_vectorized -= rhs;
+
+  deallog << fe.get_name() << ": matrices agree: "
+          << (matrix_vectorized.frobenius_norm() < 1e-12 * matrix_norm ? "yes" : "no")
+          << ", right hand sides agree: "
+          << (rhs_vectorized.l2_norm() < 1e-12 * rhs_norm ? "yes" : "no")
+          << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  test<2> (1);
+  test<2> (2);
+  test<3> (1);
+  test<3> (2);
+}
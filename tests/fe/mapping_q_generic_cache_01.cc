@@ -0,0 +1,141 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check MappingQGeneric::cache_support_points(): the mapped quadrature
+// points, Jacobians and JxW values as well as the transformation of points
+// between real and unit cell must be the same with and without the cache, a
+// memory budget must limit the number of cached cells, and refinement must
+// invalidate the cache
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/manifold_lib.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/fe/mapping_q_generic.h>
+
+#include <fstream>
+
+
+template <int dim>
+std::vector<double>
+get_mapping_data (const Triangulation<dim>    &tria,
+                  const MappingQGeneric<dim> &mapping)
+{
+  const FE_Q<dim> fe (1);
+  const QGauss<dim> quadrature (3);
+  FEValues<dim> fe_values (mapping, fe, quadrature,
+                           update_quadrature_points | update_jacobians |
+                           update_JxW_values);
+
+  std::vector<double> data;
+  for (typename Triangulation<dim>::active_cell_iterator cell=tria.begin_active();
+       cell!=tria.end(); ++cell)
+    {
+      fe_values.reinit (cell);
+      for (unsigned int q=0; q<quadrature.size(); ++q)
+        {
+          for (unsigned int d=0; d<dim; ++d)
+            data.push_back (fe_values.quadrature_point(q)[d]);
+          for (unsigned int d=0; d<dim; ++d)
+            for (unsigned int e=0; e<dim; ++e)
+              data.push_back (fe_values.jacobian(q)[d][e]);
+          data.push_back (fe_values.JxW(q));
+        }
+
+      const Point<dim> p_unit = mapping.transform_real_to_unit_cell
+                                (cell, fe_values.quadrature_point(0));
+      for (unsigned int d=0; d<dim; ++d)
+        data.push_back (p_unit[d]);
+    }
+  return data;
+}
+
+
+
+template <int dim>
+void
+test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_shell (tria, Point<dim>(), 0.5, 1.);
+  static const SphericalManifold<dim> manifold;
+  tria.set_all_manifold_ids (0);
+  tria.set_manifold (0, manifold);
+  tria.refine_global (1);
+
+  MappingQGeneric<dim> mapping (3);
+  const std::vector<double> reference = get_mapping_data (tria, mapping);
+
+  mapping.cache_support_points (tria);
+  deallog << "cached all cells: "
+          << (mapping.n_cells_with_cached_support_points() == tria.n_active_cells() ?
+              "yes" : "no")
+          << ", same data: "
+          << (get_mapping_data (tria, mapping) == reference ? "yes" : "no")
+          << std::endl;
+
+  // only leave room for 10 cells
+  mapping.cache_support_points (tria,
+                                10 * Utilities::fixed_power<dim>(4) * sizeof(Point<dim>));
+  deallog << "cached cells with memory budget: "
+          << mapping.n_cells_with_cached_support_points()
+          << ", same data: "
+          << (get_mapping_data (tria, mapping) == reference ? "yes" : "no")
+          << std::endl;
+
+  // the cache must be released when the mesh changes
+  mapping.cache_support_points (tria);
+  tria.refine_global (1);
+  deallog << "cached cells after refinement: "
+          << mapping.n_cells_with_cached_support_points()
+          << std::endl;
+
+  const std::vector<double> refined_reference = get_mapping_data (tria, mapping);
+  mapping.cache_support_points (tria);
+  deallog << "cached all cells: "
+          << (mapping.n_cells_with_cached_support_points() == tria.n_active_cells() ?
+              "yes" : "no")
+          << ", same data: "
+          << (get_mapping_data (tria, mapping) == refined_reference ? "yes" : "no")
+          << std::endl;
+
+  mapping.clear_support_point_cache ();
+  tria.set_manifold (0);
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  deallog.push ("2d");
+  test<2> ();
+  deallog.pop ();
+
+  deallog.push ("3d");
+  test<3> ();
+  deallog.pop ();
+}
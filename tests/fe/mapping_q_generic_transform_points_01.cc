@@ -0,0 +1,117 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check that MappingQGeneric::transform_points_real_to_unit_cell() gives the
+// same result as calling transform_real_to_unit_cell() for each point, on a
+// curved mesh and for points inside and slightly outside of the cells, both
+// with and without cached support points
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/manifold_lib.h>
+#include <deal.II/fe/mapping_q_generic.h>
+
+#include <fstream>
+
+
+template <int dim>
+bool
+check_points (const Triangulation<dim>    &tria,
+              const MappingQGeneric<dim> &mapping)
+{
+  // a number of points that is not a multiple of the vectorization width,
+  // some of them outside of the reference cell
+  std::vector<Point<dim> > unit_points;
+  for (unsigned int i=0; i<11; ++i)
+    {
+      Point<dim> p;
+      for (unsigned int d=0; d<dim; ++d)
+        p[d] = -0.1 + 1.2 * ((i*(d+3)) % 11) / 10.;
+      unit_points.push_back (p);
+    }
+
+  std::vector<Point<dim> > real_points (unit_points.size());
+  std::vector<Point<dim> > batched_unit_points (unit_points.size());
+  double max_error = 0;
+  for (typename Triangulation<dim>::active_cell_iterator cell=tria.begin_active();
+       cell!=tria.end(); ++cell)
+    {
+      for (unsigned int i=0; i<unit_points.size(); ++i)
+        real_points[i] = mapping.transform_unit_to_real_cell (cell, unit_points[i]);
+
+      mapping.transform_points_real_to_unit_cell (cell,
+                                                  make_array_view (real_points),
+                                                  make_array_view (batched_unit_points));
+
+      for (unsigned int i=0; i<unit_points.size(); ++i)
+        max_error = std::max (max_error,
+                              batched_unit_points[i].distance
+                              (mapping.transform_real_to_unit_cell (cell,
+                                                                    real_points[i])));
+    }
+  return (max_error < 1e-10);
+}
+
+
+
+template <int dim>
+void
+test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_shell (tria, Point<dim>(), 0.5, 1.);
+  static const SphericalManifold<dim> manifold;
+  tria.set_all_manifold_ids (0);
+  tria.set_manifold (0, manifold);
+  tria.refine_global (1);
+
+  for (unsigned int degree=1; degree<=3; ++degree)
+    {
+      MappingQGeneric<dim> mapping (degree);
+      deallog << "degree " << degree << ": points agree: "
+              << (check_points (tria, mapping) ? "yes" : "no");
+
+      mapping.cache_support_points (tria);
+      deallog << ", with cache: "
+              << (check_points (tria, mapping) ? "yes" : "no")
+              << std::endl;
+      mapping.clear_support_point_cache ();
+    }
+
+  tria.set_manifold (0);
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  deallog.push ("2d");
+  test<2> ();
+  deallog.pop ();
+
+  deallog.push ("3d");
+  test<3> ();
+  deallog.pop ();
+}
@@ -0,0 +1,168 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check that CellBoundingBoxTree finds the same cells and reference
+// coordinates as GridTools::find_active_cell_around_point, for single and
+// batched queries, for linear and curved mappings, and after the mesh has
+// been refined
+
+#include "../tests.h"
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/manifold_lib.h>
+#include <deal.II/grid/cell_bounding_box_tree.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/mapping_q.h>
+#include <deal.II/base/logstream.h>
+
+#include <fstream>
+
+
+template <int dim>
+void check (const Triangulation<dim>     &tria,
+            const Mapping<dim>           &mapping,
+            const CellBoundingBoxTree<dim> &tree)
+{
+  // points in the ball of radius 1.1 around the origin, some of which are
+  // outside the domain
+  std::vector<Point<dim> > points (200);
+  for (unsigned int i=0; i<points.size(); ++i)
+    for (unsigned int d=0; d<dim; ++d)
+      points[i][d] = 2.2 * (Testing::rand()/(double)RAND_MAX - 0.5);
+
+  std::vector<typename Triangulation<dim>::active_cell_iterator> cells;
+  std::vector<Point<dim> > reference_points;
+  tree.find_active_cells_around_points (points, cells, reference_points);
+
+  unsigned int n_found = 0, n_outside = 0, n_same = 0, n_same_batched = 0;
+  for (unsigned int i=0; i<points.size(); ++i)
+    {
+      std::pair<typename Triangulation<dim>::active_cell_iterator, Point<dim> >
+      expected;
+      try
+        {
+          expected = GridTools::find_active_cell_around_point (mapping, tria,
+                                                               points[i]);
+        }
+      catch (const GridTools::ExcPointNotFound<dim> &)
+        {
+          ++n_outside;
+          bool thrown = false;
+          try
+            {
+              tree.find_active_cell_around_point (points[i]);
+            }
+          catch (const GridTools::ExcPointNotFound<dim> &)
+            {
+              thrown = true;
+            }
+          if (thrown && cells[i] == tria.end())
+            {
+              ++n_same;
+              ++n_same_batched;
+            }
+          continue;
+        }
+
+      ++n_found;
+      const std::pair<typename Triangulation<dim>::active_cell_iterator, Point<dim> >
+      result = tree.find_active_cell_around_point (points[i]);
+      if (result.first == expected.first &&
+          result.second.distance (expected.second) < 1e-12)
+        ++n_same;
+      if (cells[i] == expected.first &&
+          reference_points[i].distance (expected.second) < 1e-12)
+        ++n_same_batched;
+    }
+
+  deallog << "points inside: " << n_found
+          << ", outside: " << n_outside
+          << ", same as GridTools: " << n_same
+          << ", same in batch: " << n_same_batched << std::endl;
+}
+
+
+
+template <int dim>
+void test ()
+{
+  deallog << "dim=" << dim << std::endl;
+
+  Triangulation<dim> tria;
+  GridGenerator::hyper_ball (tria);
+  static const SphericalManifold<dim> manifold;
+  tria.set_all_manifold_ids_on_boundary (0);
+  tria.set_manifold (0, manifold);
+  tria.refine_global (dim == 2 ? 2 : 1);
+  for (unsigned int i=0; i<tria.n_active_cells(); i+=3)
+    {
+      typename Triangulation<dim>::active_cell_iterator cell = tria.begin_active();
+      std::advance (cell, i);
+      cell->set_refine_flag ();
+    }
+  tria.execute_coarsening_and_refinement ();
+
+  // linear mapping, for which the bounding boxes are exact
+  {
+    CellBoundingBoxTree<dim> tree (tria);
+    deallog << "Q1 mapping, " << tria.n_active_cells() << " cells" << std::endl;
+    check (tria, StaticMappingQ1<dim>::mapping, tree);
+
+    // the tree must be rebuilt after refinement
+    tria.begin_active()->set_refine_flag ();
+    tria.execute_coarsening_and_refinement ();
+    deallog << "Q1 mapping after refinement, " << tria.n_active_cells()
+            << " cells" << std::endl;
+    check (tria, StaticMappingQ1<dim>::mapping, tree);
+
+    // cells of a DoFHandler
+    FE_Q<dim> fe (1);
+    DoFHandler<dim> dof_handler (tria);
+    dof_handler.distribute_dofs (fe);
+    const Point<dim> p = Point<dim>() + 0.3 * Point<dim>::unit_vector(0);
+    const typename DoFHandler<dim>::active_cell_iterator dof_cell
+      = tree.find_active_cell_around_point (dof_handler, p).first;
+    deallog << "DoF cell: " << dof_cell << " "
+            << (dof_cell == GridTools::find_active_cell_around_point (dof_handler, p))
+            << std::endl;
+  }
+
+  // curved mapping, for which the bounding boxes are only approximate
+  {
+    MappingQ<dim> mapping (3);
+    CellBoundingBoxTree<dim> tree (tria, mapping);
+    deallog << "Q3 mapping" << std::endl;
+    check (tria, mapping, tree);
+  }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  test<2> ();
+  test<3> ();
+}
@@ -0,0 +1,137 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check GridTools::compute_space_filling_curve_order and
+// GridTools::reorder_cells_along_space_filling_curve: on a lattice of
+// 2^k points per direction, consecutive points along the Hilbert curve must
+// be neighbors, and the Morton curve must give the Z-order. a coarse mesh
+// with randomly ordered cells must be ordered such that consecutive cells
+// share a face
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_tools.h>
+
+#include <fstream>
+
+
+template <int dim>
+void test ()
+{
+  deallog << "dim=" << dim << std::endl;
+
+  // a lattice of 4^dim points, shuffled
+  const unsigned int n = 4;
+  std::vector<Point<dim> > points;
+  for (unsigned int i=0; i<Utilities::fixed_power<dim>(n); ++i)
+    {
+      Point<dim> p;
+      for (unsigned int d=0, index=i; d<dim; ++d, index/=n)
+        p[d] = 0.5 + index%n;
+      points.push_back (p);
+    }
+  for (unsigned int i=points.size()-1; i>0; --i)
+    std::swap (points[i], points[Testing::rand() % (i+1)]);
+
+  // consecutive points along the Hilbert curve are at distance one
+  {
+    const std::vector<unsigned int> order
+      = GridTools::compute_space_filling_curve_order (points);
+    unsigned int n_jumps = 0;
+    for (unsigned int i=1; i<order.size(); ++i)
+      if (std::fabs (points[order[i]].distance (points[order[i-1]]) - 1.) > 1e-12)
+        ++n_jumps;
+    deallog << "Hilbert curve: first point " << points[order[0]]
+            << ", last point " << points[order.back()]
+            << ", jumps " << n_jumps << std::endl;
+  }
+
+  // along the Morton curve, the points are sorted by the interleaved bits of
+  // their coordinates, so the last coordinate varies fastest
+  {
+    const std::vector<unsigned int> order
+      = GridTools::compute_space_filling_curve_order (points, GridTools::morton_curve);
+    deallog << "Morton curve:";
+    for (unsigned int i=0; i<std::min<unsigned int>(order.size(), 16); ++i)
+      deallog << " (" << points[order[i]] << ")";
+    deallog << std::endl;
+  }
+
+  // a coarse mesh of 8^dim cells with shuffled cells
+  const unsigned int n_cells = 8;
+  std::vector<Point<dim> > vertices;
+  for (unsigned int i=0; i<Utilities::fixed_power<dim>(n_cells+1); ++i)
+    {
+      Point<dim> p;
+      for (unsigned int d=0, index=i; d<dim; ++d, index/=(n_cells+1))
+        p[d] = index%(n_cells+1);
+      vertices.push_back (p);
+    }
+  std::vector<CellData<dim> > cells (Utilities::fixed_power<dim>(n_cells));
+  for (unsigned int c=0; c<cells.size(); ++c)
+    {
+      unsigned int base = 0;
+      for (unsigned int d=0, index=c, stride=1; d<dim; ++d, index/=n_cells, stride*=(n_cells+1))
+        base += (index%n_cells) * stride;
+      for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+        {
+          unsigned int offset = 0;
+          for (unsigned int d=0, stride=1; d<dim; ++d, stride*=(n_cells+1))
+            if (v & (1<<d))
+              offset += stride;
+          cells[c].vertices[v] = base + offset;
+        }
+      cells[c].material_id = 0;
+    }
+  for (unsigned int i=cells.size()-1; i>0; --i)
+    std::swap (cells[i], cells[Testing::rand() % (i+1)]);
+
+  GridTools::reorder_cells_along_space_filling_curve (vertices, cells);
+
+  Triangulation<dim> tria;
+  tria.create_triangulation (vertices, cells, SubCellData());
+
+  unsigned int n_non_neighbors = 0;
+  typename Triangulation<dim>::active_cell_iterator previous = tria.begin_active();
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = ++tria.begin_active(); cell != tria.end(); ++cell, ++previous)
+    {
+      bool is_neighbor = false;
+      for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+        if (!cell->at_boundary(f) && cell->neighbor(f) == previous)
+          is_neighbor = true;
+      if (!is_neighbor)
+        ++n_non_neighbors;
+    }
+  deallog << "Reordered " << tria.n_active_cells() << " cells, consecutive cells "
+          << "without common face: " << n_non_neighbors << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+
+  test<1> ();
+  test<2> ();
+  test<3> ();
+}
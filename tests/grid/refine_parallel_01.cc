@@ -0,0 +1,99 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// the new vertices of lines, quads and hexes are computed in parallel during
+// refinement in 3d. check that the mesh is the same as with a single thread,
+// for a curved mesh with isotropic, anisotropic, and adaptive refinement
+
+#include "../tests.h"
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/manifold_lib.h>
+#include <deal.II/base/logstream.h>
+
+#include <fstream>
+
+
+void create_mesh (Triangulation<3> &tria)
+{
+  static const SphericalManifold<3> manifold;
+  GridGenerator::hyper_shell (tria, Point<3>(), 0.5, 1., 6);
+  tria.set_all_manifold_ids (0);
+  tria.set_manifold (0, manifold);
+
+  tria.refine_global (1);
+  for (unsigned int cycle=0; cycle<3; ++cycle)
+    {
+      unsigned int index = 0;
+      for (Triangulation<3>::active_cell_iterator cell = tria.begin_active();
+           cell != tria.end(); ++cell, ++index)
+        if (index % 7 == 0)
+          cell->set_refine_flag ();
+        else if (index % 11 == 0)
+          cell->set_refine_flag (RefinementCase<3>::cut_x);
+        else if (index % 13 == 0 && cell->level() > 1)
+          cell->set_coarsen_flag ();
+      tria.execute_coarsening_and_refinement ();
+    }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  Triangulation<3> tria;
+  create_mesh (tria);
+
+  MultithreadInfo::set_thread_limit (1);
+  Triangulation<3> tria_serial;
+  create_mesh (tria_serial);
+
+  deallog << "Number of active cells: " << tria.n_active_cells()
+          << " " << tria_serial.n_active_cells() << std::endl;
+  deallog << "Number of vertices: " << tria.n_vertices()
+          << " " << tria_serial.n_vertices() << std::endl;
+
+  // the vertices must be the same bit by bit, in the same order
+  bool same = (tria.n_vertices() == tria_serial.n_vertices());
+  for (unsigned int v=0; v<tria.n_vertices() && same; ++v)
+    if (tria.vertex_used(v) != tria_serial.vertex_used(v) ||
+        (tria.vertex_used(v) && tria.get_vertices()[v] != tria_serial.get_vertices()[v]))
+      same = false;
+  deallog << "Same vertices: " << (same ? "yes" : "no") << std::endl;
+
+  // as must the connectivity of the cells
+  Triangulation<3>::cell_iterator cell = tria.begin(),
+                                  cell_serial = tria_serial.begin();
+  for (; cell != tria.end(); ++cell, ++cell_serial)
+    for (unsigned int v=0; v<GeometryInfo<3>::vertices_per_cell; ++v)
+      if (cell->vertex_index(v) != cell_serial->vertex_index(v))
+        same = false;
+  deallog << "Same cells: " << (same ? "yes" : "no") << std::endl;
+
+  double radius_sum = 0;
+  for (unsigned int v=0; v<tria.n_vertices(); ++v)
+    if (tria.vertex_used(v))
+      radius_sum += tria.get_vertices()[v].norm();
+  deallog << "Sum of vertex radii: " << radius_sum << std::endl;
+}
@@ -0,0 +1,159 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check the compact storage of the per-cell data of the triangulation:
+// neighbor levels and indices on adaptively and anisotropically refined
+// meshes, together with the level subdomain ids and user data stored next
+// to them
+
+#include "../tests.h"
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/base/logstream.h>
+
+#include <fstream>
+
+
+template <int dim>
+void check_neighbors (const Triangulation<dim> &tria)
+{
+  unsigned int n_same = 0, n_coarser = 0, n_boundary = 0;
+  bool ok = true;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin();
+       cell != tria.end(); ++cell)
+    for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+      if (cell->at_boundary(f))
+        {
+          ++n_boundary;
+          if (cell->neighbor_level(f) != -1 || cell->neighbor_index(f) != -1)
+            ok = false;
+        }
+      else
+        {
+          const typename Triangulation<dim>::cell_iterator
+          neighbor = cell->neighbor(f);
+          if (neighbor->level() != cell->neighbor_level(f) ||
+              neighbor->index() != cell->neighbor_index(f))
+            ok = false;
+          if (neighbor->level() == cell->level())
+            ++n_same;
+          else
+            ++n_coarser;
+
+          // the center of the face must lie within the bounding box of the
+          // neighbor
+          const Point<dim> center = cell->face(f)->center();
+          for (unsigned int d=0; d<dim; ++d)
+            {
+              double min_coordinate = neighbor->vertex(0)[d],
+                     max_coordinate = neighbor->vertex(0)[d];
+              for (unsigned int v=1; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+                {
+                  min_coordinate = std::min (min_coordinate, neighbor->vertex(v)[d]);
+                  max_coordinate = std::max (max_coordinate, neighbor->vertex(v)[d]);
+                }
+              if (center[d] < min_coordinate - 1e-12 ||
+                  center[d] > max_coordinate + 1e-12)
+                ok = false;
+            }
+        }
+  deallog << "neighbors on same level: " << n_same
+          << ", on coarser level: " << n_coarser
+          << ", boundary faces: " << n_boundary
+          << (ok ? ", ok" : ", wrong") << std::endl;
+}
+
+
+
+template <int dim>
+void test ()
+{
+  deallog << "dim=" << dim << std::endl;
+
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (2);
+  for (unsigned int step=0; step<3; ++step)
+    {
+      tria.begin_active(tria.n_levels()-1)->set_refine_flag();
+      tria.last_active()->set_refine_flag(RefinementCase<dim>::cut_x);
+      tria.execute_coarsening_and_refinement ();
+    }
+  check_neighbors (tria);
+
+  // level subdomain ids are zero unless set otherwise
+  bool all_zero = true;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin();
+       cell != tria.end(); ++cell)
+    if (cell->level_subdomain_id() != 0)
+      all_zero = false;
+  deallog << "level subdomain ids zero: " << all_zero << std::endl;
+  tria.begin(1)->set_level_subdomain_id (3);
+  unsigned int n_three = 0;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin(1);
+       cell != tria.end(1); ++cell)
+    if (cell->level_subdomain_id() == 3)
+      ++n_three;
+  deallog << "cells on level 1 with level subdomain id 3: " << n_three
+          << std::endl;
+
+  // user indices are zero unless set otherwise
+  unsigned int sum = 0;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin();
+       cell != tria.end(); ++cell)
+    sum += cell->user_index();
+  deallog << "sum of user indices: " << sum << std::endl;
+
+  unsigned int counter = 0;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin();
+       cell != tria.end(); ++cell)
+    cell->set_user_index (++counter);
+
+  // refine once more, which must keep the user indices of existing cells
+  // and give zero user indices to the new ones
+  tria.begin_active()->set_refine_flag();
+  tria.execute_coarsening_and_refinement ();
+  check_neighbors (tria);
+  sum = 0;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin();
+       cell != tria.end(); ++cell)
+    sum += cell->user_index();
+  deallog << "sum of user indices: " << sum << " expected: "
+          << counter*(counter+1)/2 << std::endl;
+
+  tria.clear_user_data ();
+  sum = 0;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin();
+       cell != tria.end(); ++cell)
+    sum += cell->user_index();
+  deallog << "sum of user indices after clear: " << sum << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  test<1> ();
+  test<2> ();
+  test<3> ();
+}
@@ -0,0 +1,85 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// the levels of neighbors are stored in a compact form. check that neighbor
+// relations are still correct on meshes with more than 255 levels, obtained
+// by refining the cell in a corner of the domain over and over again
+
+#include "../tests.h"
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/base/logstream.h>
+
+#include <fstream>
+
+
+template <int dim>
+void test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  for (unsigned int step=0; step<300; ++step)
+    {
+      tria.begin_active(tria.n_levels()-1)->set_refine_flag();
+      tria.execute_coarsening_and_refinement ();
+    }
+
+  unsigned int n_same = 0, n_coarser = 0, n_boundary = 0;
+  bool ok = true;
+  for (typename Triangulation<dim>::cell_iterator cell = tria.begin();
+       cell != tria.end(); ++cell)
+    for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+      if (cell->at_boundary(f))
+        {
+          ++n_boundary;
+          if (cell->neighbor_level(f) != -1 || cell->neighbor_index(f) != -1)
+            ok = false;
+        }
+      else
+        {
+          const typename Triangulation<dim>::cell_iterator
+          neighbor = cell->neighbor(f);
+          if (neighbor->level() != cell->neighbor_level(f) ||
+              neighbor->index() != cell->neighbor_index(f))
+            ok = false;
+          if (neighbor->level() == cell->level())
+            ++n_same;
+          else if (neighbor->level() == cell->level()-1)
+            ++n_coarser;
+          else
+            ok = false;
+        }
+
+  deallog << "dim=" << dim << ", levels: " << tria.n_levels()
+          << ", neighbors on same level: " << n_same
+          << ", on coarser level: " << n_coarser
+          << ", boundary faces: " << n_boundary
+          << (ok ? ", ok" : ", wrong") << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  test<1> ();
+  test<2> ();
+}
@@ -0,0 +1,251 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check that the dof indices of cells of an hp::DoFHandler are correct when
+// they are stored in compressed form, that this remains true through
+// renumbering (where some or all cells can no longer be compressed) and
+// refinement, that reading them from the possibly compressed storage of the
+// vertices, lines, quads and hexes gives the same result as reading them from
+// the cache of the cells, and that cell->distribute_local_to_global()
+// produces the same result as adding the local contributions by hand
+
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <fstream>
+
+
+
+template <int dim>
+void
+set_fe_indices (hp::DoFHandler<dim> &dof_handler)
+{
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell=dof_handler.begin_active();
+       cell!=dof_handler.end(); ++cell)
+    cell->set_active_fe_index (cell->active_cell_index() % 3);
+}
+
+
+
+template <int dim>
+std::vector<std::vector<types::global_dof_index> >
+get_all_dof_indices (const hp::DoFHandler<dim> &dof_handler)
+{
+  std::vector<std::vector<types::global_dof_index> >
+  dof_indices (dof_handler.get_triangulation().n_active_cells());
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell=dof_handler.begin_active();
+       cell!=dof_handler.end(); ++cell)
+    {
+      dof_indices[cell->active_cell_index()].resize (cell->get_fe().dofs_per_cell);
+      cell->get_dof_indices (dof_indices[cell->active_cell_index()]);
+    }
+  return dof_indices;
+}
+
+
+
+template <int dim>
+void
+check_dof_indices_without_cache (const hp::DoFHandler<dim> &dof_handler)
+{
+  std::vector<types::global_dof_index> cached_indices, indices;
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell=dof_handler.begin_active();
+       cell!=dof_handler.end(); ++cell)
+    {
+      const FiniteElement<dim> &fe = cell->get_fe();
+      cached_indices.resize (fe.dofs_per_cell);
+      cell->get_dof_indices (cached_indices);
+
+      // the function of the base class collects the indices from the
+      // vertices, lines, quads and hexes of the cell instead of the cache,
+      // and reads the ones in the cell interior from the compressed storage
+      indices.resize (fe.dofs_per_cell);
+      static_cast<const DoFAccessor<dim,hp::DoFHandler<dim>,false> &>(*cell)
+      .get_dof_indices (indices, cell->active_fe_index());
+      AssertThrow (indices == cached_indices, ExcInternalError());
+
+      // the dofs in the cell interior come last in the local numbering
+      const unsigned int n_interior_dofs = fe.template n_dofs_per_object<dim>();
+      for (unsigned int i=0; i<n_interior_dofs; ++i)
+        AssertThrow (cell->dof_index (i, cell->active_fe_index()) ==
+                     cached_indices[fe.dofs_per_cell - n_interior_dofs + i],
+                     ExcInternalError());
+    }
+}
+
+
+
+template <int dim>
+void
+check_distribute_local_to_global (const hp::DoFHandler<dim> &dof_handler)
+{
+  Vector<double> v1 (dof_handler.n_dofs()), v2 (dof_handler.n_dofs());
+  std::vector<types::global_dof_index> local_dof_indices;
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell=dof_handler.begin_active();
+       cell!=dof_handler.end(); ++cell)
+    {
+      const unsigned int dofs_per_cell = cell->get_fe().dofs_per_cell;
+      Vector<double> local_vector (dofs_per_cell);
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        local_vector(i) = cell->active_cell_index() + i + 1;
+
+      cell->distribute_local_to_global (local_vector, v1);
+
+      local_dof_indices.resize (dofs_per_cell);
+      cell->get_dof_indices (local_dof_indices);
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        v2(local_dof_indices[i]) += local_vector(i);
+    }
+
+  v1 -= v2;
+  AssertThrow (v1.l2_norm() == 0, ExcInternalError());
+}
+
+
+
+template <int dim>
+void
+check_renumbering (hp::DoFHandler<dim> &dof_handler)
+{
+  const std::vector<std::vector<types::global_dof_index> >
+  old_indices = get_all_dof_indices (dof_handler);
+
+  // reverse the numbering. this makes none of the sets of dofs on cells
+  // compressible
+  std::vector<types::global_dof_index> new_numbers (dof_handler.n_dofs());
+  for (unsigned int i=0; i<new_numbers.size(); ++i)
+    new_numbers[i] = dof_handler.n_dofs() - 1 - i;
+  dof_handler.renumber_dofs (new_numbers);
+
+  std::vector<std::vector<types::global_dof_index> >
+  new_indices = get_all_dof_indices (dof_handler);
+  for (unsigned int c=0; c<old_indices.size(); ++c)
+    for (unsigned int i=0; i<old_indices[c].size(); ++i)
+      AssertThrow (new_indices[c][i] == new_numbers[old_indices[c][i]],
+                   ExcInternalError());
+  check_dof_indices_without_cache (dof_handler);
+  check_distribute_local_to_global (dof_handler);
+
+  // then go back to the original numbering, where all cells can be
+  // compressed again
+  dof_handler.renumber_dofs (new_numbers);
+  new_indices = get_all_dof_indices (dof_handler);
+  AssertThrow (new_indices == old_indices, ExcInternalError());
+  check_dof_indices_without_cache (dof_handler);
+  check_distribute_local_to_global (dof_handler);
+}
+
+
+
+template <int dim>
+void
+test (const hp::FECollection<dim> &fe_collection)
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (dim == 2 ? 2 : 1);
+
+  hp::DoFHandler<dim> dof_handler (tria);
+  set_fe_indices (dof_handler);
+  dof_handler.distribute_dofs (fe_collection);
+  // the number of dofs is only easy to verify for discontinuous elements
+  if (fe_collection[0].dofs_per_vertex == 0)
+    deallog << "n_dofs=" << dof_handler.n_dofs() << std::endl;
+
+  check_dof_indices_without_cache (dof_handler);
+  check_distribute_local_to_global (dof_handler);
+  check_renumbering (dof_handler);
+
+  // setting the same active_fe_index again must not invalidate the
+  // compressed storage
+  const std::vector<std::vector<types::global_dof_index> >
+  old_indices = get_all_dof_indices (dof_handler);
+  set_fe_indices (dof_handler);
+  AssertThrow (get_all_dof_indices (dof_handler) == old_indices,
+               ExcInternalError());
+  check_dof_indices_without_cache (dof_handler);
+
+  // refine and redistribute
+  tria.refine_global (1);
+  set_fe_indices (dof_handler);
+  dof_handler.distribute_dofs (fe_collection);
+  if (fe_collection[0].dofs_per_vertex == 0)
+    deallog << "n_dofs=" << dof_handler.n_dofs() << std::endl;
+
+  check_dof_indices_without_cache (dof_handler);
+  check_distribute_local_to_global (dof_handler);
+  check_renumbering (dof_handler);
+
+  deallog << "OK" << std::endl;
+}
+
+
+
+template <int dim>
+void
+test ()
+{
+  hp::FECollection<dim> dgq;
+  hp::FECollection<dim> q;
+  for (unsigned int degree=1; degree<=3; ++degree)
+    {
+      dgq.push_back (FE_DGQ<dim>(degree));
+      q.push_back (FE_Q<dim>(degree));
+    }
+
+  deallog.push ("dgq");
+  test (dgq);
+  deallog.pop ();
+
+  deallog.push ("q");
+  test (q);
+  deallog.pop ();
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  deallog.push ("2d");
+  test<2> ();
+  deallog.pop ();
+
+  deallog.push ("3d");
+  test<3> ();
+  deallog.pop ();
+}
@@ -0,0 +1,224 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check the merged vector updates of SolverCG with PreconditionJacobi
+// against the separate vector operations, and classical Gram-Schmidt in
+// SolverGMRES against modified Gram-Schmidt
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/vector_memory.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/solver_gmres.h>
+#include <deal.II/lac/precondition.h>
+
+
+// hides the apply() function of PreconditionJacobi such that SolverCG uses
+// the separate vector operations
+class PreconditionJacobiWrapper
+{
+public:
+  PreconditionJacobiWrapper (const PreconditionJacobi<> &preconditioner)
+    :
+    preconditioner (preconditioner)
+  {}
+
+  template <typename VectorType>
+  void vmult (VectorType &dst, const VectorType &src) const
+  {
+    preconditioner.vmult (dst, src);
+  }
+
+private:
+  const PreconditionJacobi<> &preconditioner;
+};
+
+
+// wrap the sparse matrix for use with LinearAlgebra::distributed::Vector
+class DistributedMatrix : public Subscriptor
+{
+public:
+  typedef unsigned int size_type;
+
+  DistributedMatrix (const SparseMatrix<double> &A)
+    :
+    A (A),
+    src_copy (A.m()),
+    dst_copy (A.m())
+  {}
+
+  void vmult (LinearAlgebra::distributed::Vector<double>       &dst,
+              const LinearAlgebra::distributed::Vector<double> &src) const
+  {
+    for (unsigned int i=0; i<src.local_size(); ++i)
+      src_copy(i) = src.local_element(i);
+    A.vmult (dst_copy, src_copy);
+    for (unsigned int i=0; i<dst.local_size(); ++i)
+      dst.local_element(i) = dst_copy(i);
+  }
+
+  void precondition_Jacobi (LinearAlgebra::distributed::Vector<double>       &dst,
+                            const LinearAlgebra::distributed::Vector<double> &src,
+                            const double                                      omega) const
+  {
+    for (unsigned int i=0; i<src.local_size(); ++i)
+      dst.local_element(i) = omega * src.local_element(i) / A.diag_element(i);
+  }
+
+  double diag_element (const unsigned int i) const
+  {
+    return A.diag_element(i);
+  }
+
+private:
+  const SparseMatrix<double> &A;
+  mutable Vector<double> src_copy, dst_copy;
+};
+
+
+template <typename SolverType, typename MatrixType, typename VectorType,
+          typename PreconditionerType>
+unsigned int
+solve (SolverType               &solver,
+       const SolverControl      &control,
+       const MatrixType         &A,
+       VectorType               &u,
+       const VectorType         &f,
+       const PreconditionerType &P)
+{
+  u = 0.;
+  try
+    {
+      solver.solve(A,u,f,P);
+    }
+  catch (dealii::SolverControl::NoConvergence &e)
+    {
+      deallog << "Exception: " << e.get_exc_name() << std::endl;
+    }
+  return control.last_step();
+}
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  deallog << "Merged updates with PreconditionJacobi: "
+          << (internal::SolverCG::use_merged_updates<Vector<double>,
+              PreconditionJacobi<> >::value ? "true" : "false") << std::endl;
+  deallog << "Merged updates with wrapper: "
+          << (internal::SolverCG::use_merged_updates<Vector<double>,
+              PreconditionJacobiWrapper>::value ? "true" : "false") << std::endl;
+
+  for (unsigned int size=12; size <= 48; size *= 4)
+    {
+      const unsigned int dim = (size-1)*(size-1);
+
+      deallog << "Size " << size << " Unknowns " << dim << std::endl;
+
+      FDMatrix testproblem(size, size);
+      SparsityPattern structure(dim, dim, 5);
+      testproblem.five_point_structure(structure);
+      structure.compress();
+      SparseMatrix<double>  A(structure);
+      testproblem.five_point(A);
+      SparseMatrix<double>  B(structure);
+      testproblem.five_point(B, true);
+
+      Vector<double> f(dim), u(dim), reference(dim);
+      for (unsigned int i=0; i<dim; ++i)
+        f(i) = 1. + 0.1 * (i%7);
+
+      {
+        deallog.push("cg");
+        SolverControl control(500, 1.e-10);
+        SolverCG<> solver(control);
+        PreconditionJacobi<> jacobi;
+        jacobi.initialize(A, 0.8);
+        PreconditionJacobiWrapper wrapper (jacobi);
+        const unsigned int it_ref = solve (solver, control, A, reference, f, wrapper);
+        const unsigned int it = solve (solver, control, A, u, f, jacobi);
+        u -= reference;
+        deallog << "Iterations: " << it_ref << " " << it
+                << ", difference: " << u.linfty_norm() / reference.linfty_norm()
+                << std::endl;
+
+        LinearAlgebra::distributed::Vector<double> fd(dim), ud(dim);
+        for (unsigned int i=0; i<dim; ++i)
+          fd(i) = f(i);
+        DistributedMatrix Ad (A);
+        PreconditionJacobi<DistributedMatrix> jacobi_d;
+        jacobi_d.initialize(Ad, 0.8);
+        SolverCG<LinearAlgebra::distributed::Vector<double> > solver_d(control);
+        const unsigned int it_d = solve (solver_d, control, Ad, ud, fd, jacobi_d);
+        for (unsigned int i=0; i<dim; ++i)
+          ud(i) -= reference(i);
+        deallog << "Distributed iterations: " << it_d
+                << ", difference: " << ud.linfty_norm() / reference.linfty_norm()
+                << std::endl;
+        deallog.pop();
+      }
+
+      {
+        deallog.push("gmres");
+        SolverControl control(500, 1.e-10);
+        SolverGMRES<>::AdditionalData data (20);
+        SolverGMRES<> solver_mgs(control, data);
+        data.orthogonalization_strategy =
+          SolverGMRES<>::AdditionalData::classical_gram_schmidt;
+        SolverGMRES<> solver_cgs(control, data);
+        PreconditionSSOR<> ssor;
+        ssor.initialize(B, 1.2);
+        const unsigned int it_ref = solve (solver_mgs, control, B, reference, f, ssor);
+        const unsigned int it = solve (solver_cgs, control, B, u, f, ssor);
+        u -= reference;
+        deallog << "Iterations: " << it_ref << " " << it
+                << ", difference: " << u.linfty_norm() / reference.linfty_norm()
+                << std::endl;
+
+        LinearAlgebra::distributed::Vector<double> fd(dim), ud(dim);
+        for (unsigned int i=0; i<dim; ++i)
+          fd(i) = f(i);
+        DistributedMatrix Bd (B);
+        SolverGMRES<LinearAlgebra::distributed::Vector<double> >::AdditionalData
+        data_d (20);
+        data_d.orthogonalization_strategy =
+          SolverGMRES<LinearAlgebra::distributed::Vector<double> >::AdditionalData::classical_gram_schmidt;
+        SolverGMRES<LinearAlgebra::distributed::Vector<double> >
+        solver_d(control, data_d);
+        const unsigned int it_d = solve (solver_d, control, Bd, ud, fd, PreconditionIdentity());
+        const unsigned int it_mgs = solve (solver_mgs, control, B, u, f, PreconditionIdentity());
+        for (unsigned int i=0; i<dim; ++i)
+          ud(i) -= u(i);
+        deallog << "Distributed iterations without preconditioner: " << it_mgs
+                << " " << it_d << ", difference: "
+                << ud.linfty_norm() / u.linfty_norm() << std::endl;
+        deallog.pop();
+      }
+    }
+}
@@ -0,0 +1,168 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check SolverPipelinedCG and SolverSStepCG against SolverCG on a
+// five-point matrix with and without preconditioner, and check that the
+// fused inner products of LinearAlgebra::distributed::Vector give the same
+// iteration counts as Vector
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/vector_memory.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/solver_pipelined_cg.h>
+#include <deal.II/lac/solver_s_step_cg.h>
+#include <deal.II/lac/precondition.h>
+
+
+template<typename SolverType, typename MatrixType, typename VectorType, class PRECONDITION>
+void
+check_solve (SolverType         &solver,
+             const MatrixType   &A,
+             VectorType         &u,
+             const VectorType   &f,
+             const PRECONDITION &P,
+             const VectorType   &reference)
+{
+  u = 0.;
+  try
+    {
+      solver.solve(A,u,f,P);
+    }
+  catch (dealii::SolverControl::NoConvergence &e)
+    {
+      deallog << "Exception: " << e.get_exc_name() << std::endl;
+    }
+  u -= reference;
+  deallog << "Difference to CG solution: " << u.linfty_norm() / reference.linfty_norm()
+          << std::endl;
+}
+
+
+// wrap the sparse matrix for use with LinearAlgebra::distributed::Vector to
+// check the fused inner products of that vector type
+class DistributedMatrix
+{
+public:
+  DistributedMatrix (const SparseMatrix<double> &A)
+    :
+    A (A),
+    src_copy (A.m()),
+    dst_copy (A.m())
+  {}
+
+  void vmult (LinearAlgebra::distributed::Vector<double>       &dst,
+              const LinearAlgebra::distributed::Vector<double> &src) const
+  {
+    for (unsigned int i=0; i<src.local_size(); ++i)
+      src_copy(i) = src.local_element(i);
+    A.vmult (dst_copy, src_copy);
+    for (unsigned int i=0; i<dst.local_size(); ++i)
+      dst.local_element(i) = dst_copy(i);
+  }
+
+private:
+  const SparseMatrix<double> &A;
+  mutable Vector<double> src_copy, dst_copy;
+};
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  SolverControl control(200, 1.e-10);
+  SolverCG<> cg(control);
+  SolverPipelinedCG<> pipelined_cg(control);
+  SolverSStepCG<> s_step_cg(control);
+  SolverSStepCG<> s_step_cg_2(control, SolverSStepCG<>::AdditionalData(2));
+
+  for (unsigned int size=12; size <= 36; size *= 3)
+    {
+      unsigned int dim = (size-1)*(size-1);
+
+      deallog << "Size " << size << " Unknowns " << dim << std::endl;
+
+      // Make matrix
+      FDMatrix testproblem(size, size);
+      SparsityPattern structure(dim, dim, 5);
+      testproblem.five_point_structure(structure);
+      structure.compress();
+      SparseMatrix<double>  A(structure);
+      testproblem.five_point(A);
+
+      PreconditionIdentity prec_no;
+      PreconditionSSOR<> prec_ssor;
+      prec_ssor.initialize(A, 1.2);
+
+      Vector<double>  f(dim);
+      Vector<double>  u(dim);
+      Vector<double>  reference(dim);
+      for (unsigned int i=0; i<dim; ++i)
+        f(i) = 1. + 0.1 * (i%7);
+
+      deallog.push("no");
+      cg.solve(A, reference, f, prec_no);
+      check_solve(pipelined_cg,A,u,f,prec_no,reference);
+      const unsigned int pipelined_cg_steps = control.last_step();
+      check_solve(s_step_cg,A,u,f,prec_no,reference);
+      const unsigned int s_step_cg_steps = control.last_step();
+      check_solve(s_step_cg_2,A,u,f,prec_no,reference);
+      deallog.pop();
+
+      deallog.push("ssor");
+      reference = 0;
+      cg.solve(A, reference, f, prec_ssor);
+      check_solve(pipelined_cg,A,u,f,prec_ssor,reference);
+      check_solve(s_step_cg,A,u,f,prec_ssor,reference);
+      check_solve(s_step_cg_2,A,u,f,prec_ssor,reference);
+      deallog.pop();
+
+      deallog.push("distributed");
+      LinearAlgebra::distributed::Vector<double> fd(dim), ud(dim), refd(dim);
+      for (unsigned int i=0; i<dim; ++i)
+        fd(i) = f(i);
+      DistributedMatrix Ad (A);
+      PreconditionIdentity prec_d;
+      SolverPipelinedCG<LinearAlgebra::distributed::Vector<double> >
+      pipelined_cg_d(control);
+      SolverSStepCG<LinearAlgebra::distributed::Vector<double> >
+      s_step_cg_d(control);
+      SolverCG<LinearAlgebra::distributed::Vector<double> > cg_d(control);
+      cg_d.solve(Ad, refd, fd, prec_d);
+      check_solve(pipelined_cg_d,Ad,ud,fd,prec_d,refd);
+      AssertThrow (control.last_step() == pipelined_cg_steps,
+                   ExcMessage("Different iteration counts for serial and "
+                              "distributed vectors"));
+      check_solve(s_step_cg_d,Ad,ud,fd,prec_d,refd);
+      AssertThrow (control.last_step() == s_step_cg_steps,
+                   ExcMessage("Different iteration counts for serial and "
+                              "distributed vectors"));
+      deallog.pop();
+    }
+}
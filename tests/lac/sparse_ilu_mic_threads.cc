@@ -0,0 +1,149 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check that the level-scheduled parallel factorization and substitution
+// of SparseILU and SparseMIC give exactly the same results as the
+// sequential algorithms, also when the sparsity pattern is reused and when
+// the decomposition uses a sparsity pattern that does not contain all
+// entries of the matrix
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparse_ilu.h>
+#include <deal.II/lac/sparse_mic.h>
+#include <deal.II/lac/vector.h>
+
+
+template <typename PreconditionerType>
+void
+test (const SparseMatrix<double> &A,
+      const SparseMatrix<double> &B,
+      const unsigned int          extra_off_diagonals)
+{
+  const unsigned int dim = A.m();
+  Vector<double> v(dim), result_serial(dim), result_parallel(dim);
+  for (unsigned int j=0; j<dim; ++j)
+    v(j) = 1. * Testing::rand()/RAND_MAX;
+
+  typename PreconditionerType::AdditionalData data (0, extra_off_diagonals);
+
+  MultithreadInfo::set_thread_limit (1);
+  PreconditionerType prec_serial;
+  prec_serial.initialize (A, data);
+  prec_serial.vmult (result_serial, v);
+
+  MultithreadInfo::set_thread_limit (4);
+  PreconditionerType prec_parallel;
+  prec_parallel.initialize (A, data);
+  prec_parallel.vmult (result_parallel, v);
+
+  result_parallel -= result_serial;
+  deallog << "Difference: " << result_parallel.linfty_norm()
+          << " relative to " << result_serial.linfty_norm() << std::endl;
+
+  // reinitialize with a different matrix on the same pattern, keeping the
+  // level schedule
+  MultithreadInfo::set_thread_limit (1);
+  prec_serial.initialize (B, data);
+  prec_serial.vmult (result_serial, v);
+
+  MultithreadInfo::set_thread_limit (4);
+  data.use_previous_sparsity = true;
+  prec_parallel.initialize (B, data);
+  prec_parallel.vmult (result_parallel, v);
+
+  result_parallel -= result_serial;
+  deallog << "Difference with previous sparsity: "
+          << result_parallel.linfty_norm()
+          << " relative to " << result_serial.linfty_norm() << std::endl;
+}
+
+
+// the factorization of SparseMIC reads the entries of the given matrix left
+// of the diagonal, which here are not all part of the sparsity pattern of
+// the decomposition the levels are computed from
+template <typename PreconditionerType>
+void
+test_use_this_sparsity (const SparseMatrix<double> &A,
+                        const SparsityPattern      &sparsity)
+{
+  const unsigned int dim = A.m();
+  Vector<double> v(dim), result_serial(dim), result_parallel(dim);
+  for (unsigned int j=0; j<dim; ++j)
+    v(j) = 1. * Testing::rand()/RAND_MAX;
+
+  typename PreconditionerType::AdditionalData data (0, 0, false, &sparsity);
+
+  MultithreadInfo::set_thread_limit (1);
+  PreconditionerType prec_serial;
+  prec_serial.initialize (A, data);
+  prec_serial.vmult (result_serial, v);
+
+  MultithreadInfo::set_thread_limit (4);
+  PreconditionerType prec_parallel;
+  prec_parallel.initialize (A, data);
+  prec_parallel.vmult (result_parallel, v);
+
+  result_parallel -= result_serial;
+  deallog << "Difference with other sparsity: " << result_parallel.linfty_norm()
+          << " relative to " << result_serial.linfty_norm() << std::endl;
+}
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+
+  for (unsigned int size=16; size <= 256; size *= 4)
+    {
+      const unsigned int dim = (size-1)*(size-1);
+
+      deallog << "Size " << size << " Unknowns " << dim << std::endl;
+
+      FDMatrix testproblem(size, size);
+      SparsityPattern structure(dim, dim, 9);
+      testproblem.nine_point_structure(structure);
+      structure.compress();
+      SparsityPattern five_point_structure(dim, dim, 5);
+      testproblem.five_point_structure(five_point_structure);
+      five_point_structure.compress();
+      SparseMatrix<double> A(structure), B(structure);
+      testproblem.nine_point(A);
+      testproblem.five_point(B);
+      // make the second matrix different from the first one
+      for (unsigned int i=0; i<dim; ++i)
+        B.diag_element(i) *= 1.5;
+
+      deallog.push("ilu");
+      test<SparseILU<double> > (A, B, 0);
+      test<SparseILU<double> > (A, B, 2);
+      deallog.pop();
+
+      deallog.push("mic");
+      test<SparseMIC<double> > (A, B, 0);
+      test_use_this_sparsity<SparseMIC<double> > (A, five_point_structure);
+      deallog.pop();
+    }
+}
@@ -0,0 +1,208 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check SparsityPatternBSR and SparseMatrixBSR on the sparsity pattern of
+// an FESystem with hanging node constraints: detection of the chunks,
+// assembly through ConstraintMatrix, copy from SparseMatrix, matrix-vector
+// products, and the Jacobi preconditioner
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparse_matrix_bsr.h>
+#include <deal.II/lac/vector.h>
+#include <fstream>
+#include <iomanip>
+
+
+template <int dim>
+void test (const unsigned int degree)
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (2);
+  tria.begin_active()->set_refine_flag();
+  tria.execute_coarsening_and_refinement();
+
+  FESystem<dim> fe (FE_Q<dim>(degree), dim);
+  DoFHandler<dim> dof (tria);
+  dof.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof, constraints);
+  constraints.close ();
+
+  DynamicSparsityPattern dsp (dof.n_dofs());
+  DoFTools::make_sparsity_pattern (dof, dsp, constraints, false);
+  SparsityPattern sparsity;
+  sparsity.copy_from (dsp);
+
+  SparsityPatternBSR sparsity_bsr;
+  sparsity_bsr.copy_from (dsp);
+
+  deallog << "dim=" << dim << " degree=" << degree
+          << " n_dofs=" << dof.n_dofs()
+          << " n_chunks=" << sparsity_bsr.n_chunks() << std::endl;
+  std::vector<unsigned int> chunk_size_counts (2*dim+1);
+  for (unsigned int c=0; c<sparsity_bsr.n_chunks(); ++c)
+    ++chunk_size_counts[std::min(sparsity_bsr.chunk_size(c), 2U*dim)];
+  for (unsigned int s=1; s<chunk_size_counts.size(); ++s)
+    if (chunk_size_counts[s] > 0)
+      deallog << "chunks of size " << s << ": " << chunk_size_counts[s]
+              << std::endl;
+  deallog << "entries: " << sparsity.n_nonzero_elements() << " "
+          << sparsity_bsr.n_nonzero_elements() << ", chunk entries: "
+          << sparsity_bsr.get_chunk_sparsity_pattern().n_nonzero_elements()
+          << std::endl;
+
+  // assemble a vector-valued mass matrix with some coupling between the
+  // components into both matrix formats
+  SparseMatrix<double> matrix (sparsity);
+  SparseMatrixBSR<double> matrix_bsr (sparsity_bsr);
+
+  QGauss<dim> quadrature (degree+1);
+  FEValues<dim> fe_values (fe, quadrature, update_values | update_JxW_values);
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+  FullMatrix<double> cell_matrix (dofs_per_cell, dofs_per_cell);
+  std::vector<types::global_dof_index> local_dof_indices (dofs_per_cell);
+  for (typename DoFHandler<dim>::active_cell_iterator cell = dof.begin_active();
+       cell != dof.end(); ++cell)
+    {
+      fe_values.reinit (cell);
+      cell_matrix = 0;
+      for (unsigned int q=0; q<quadrature.size(); ++q)
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          for (unsigned int j=0; j<dofs_per_cell; ++j)
+            {
+              const unsigned int ci = fe.system_to_component_index(i).first;
+              const unsigned int cj = fe.system_to_component_index(j).first;
+              cell_matrix(i,j) += (ci == cj ? 2. : (ci < cj ? 0.3 : -0.2)) *
+                                  fe_values.shape_value(i,q) *
+                                  fe_values.shape_value(j,q) *
+                                  fe_values.JxW(q);
+            }
+      cell->get_dof_indices (local_dof_indices);
+      constraints.distribute_local_to_global (cell_matrix, local_dof_indices,
+                                              matrix);
+      constraints.distribute_local_to_global (cell_matrix, local_dof_indices,
+                                              matrix_bsr);
+    }
+
+  double max_diff = 0;
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    for (unsigned int j=0; j<dof.n_dofs(); ++j)
+      max_diff = std::max (max_diff, std::abs(matrix.el(i,j) - matrix_bsr.el(i,j)));
+  deallog << "Difference of entries after assembly: " << max_diff << std::endl;
+
+  SparseMatrixBSR<double> matrix_copy (sparsity_bsr);
+  matrix_copy.copy_from (matrix);
+  max_diff = 0;
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    {
+      max_diff = std::max (max_diff, std::abs(matrix.diag_element(i) -
+                                              matrix_copy.diag_element(i)));
+      for (SparseMatrix<double>::const_iterator entry = matrix.begin(i);
+           entry != matrix.end(i); ++entry)
+        max_diff = std::max (max_diff, std::abs(entry->value() -
+                                                matrix_copy(i,entry->column())));
+    }
+  deallog << "Difference of entries after copy: " << max_diff << std::endl;
+
+  Vector<double> src (dof.n_dofs()), dst (dof.n_dofs()), ref (dof.n_dofs());
+  for (unsigned int i=0; i<src.size(); ++i)
+    src(i) = 1. + 0.1 * (i%7);
+
+  matrix.vmult (ref, src);
+  matrix_bsr.vmult (dst, src);
+  dst -= ref;
+  deallog << "vmult error: " << dst.linfty_norm() / ref.linfty_norm() << std::endl;
+
+  Vector<float> src_float (src.size()), dst_float (src.size());
+  src_float = src;
+  matrix_bsr.vmult (dst_float, src_float);
+  dst = dst_float;
+  dst -= ref;
+  deallog << "vmult error float vectors: "
+          << (dst.linfty_norm() / ref.linfty_norm() < 1e-6 ? "ok" : "wrong")
+          << std::endl;
+
+  matrix.vmult_add (ref, src);
+  matrix_bsr.vmult (dst, src);
+  matrix_bsr.vmult_add (dst, src);
+  dst -= ref;
+  deallog << "vmult_add error: " << dst.linfty_norm() / ref.linfty_norm() << std::endl;
+
+  matrix.Tvmult (ref, src);
+  matrix_bsr.Tvmult (dst, src);
+  dst -= ref;
+  deallog << "Tvmult error: " << dst.linfty_norm() / ref.linfty_norm() << std::endl;
+
+  matrix.Tvmult_add (ref, src);
+  matrix_bsr.Tvmult (dst, src);
+  matrix_bsr.Tvmult_add (dst, src);
+  dst -= ref;
+  deallog << "Tvmult_add error: " << dst.linfty_norm() / ref.linfty_norm() << std::endl;
+
+  matrix.precondition_Jacobi (ref, src, 0.8);
+  matrix_bsr.precondition_Jacobi (dst, src, 0.8);
+  dst -= ref;
+  deallog << "precondition_Jacobi error: " << dst.linfty_norm() / ref.linfty_norm()
+          << std::endl;
+
+  // explicit chunk sizes that do not follow the structure of the pattern
+  std::vector<unsigned int> chunk_sizes (dof.n_dofs()/5, 5);
+  if (dof.n_dofs() % 5 != 0)
+    chunk_sizes.push_back (dof.n_dofs() % 5);
+  SparsityPatternBSR sparsity_five;
+  sparsity_five.copy_from (sparsity, chunk_sizes);
+  SparseMatrixBSR<double> matrix_five (sparsity_five);
+  matrix_five.copy_from (matrix);
+  matrix.vmult (ref, src);
+  matrix_five.vmult (dst, src);
+  dst -= ref;
+  deallog << "vmult error chunk size 5: " << dst.linfty_norm() / ref.linfty_norm()
+          << std::endl;
+  matrix.Tvmult (ref, src);
+  matrix_five.Tvmult (dst, src);
+  dst -= ref;
+  deallog << "Tvmult error chunk size 5: " << dst.linfty_norm() / ref.linfty_norm()
+          << std::endl;
+}
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  test<2> (1);
+  test<2> (2);
+  test<3> (1);
+}
@@ -0,0 +1,170 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check SparseMatrixSELL: compare vmult, Tvmult, vmult_add, residual, el and
+// precondition_Jacobi against SparseMatrix on a five-point matrix for
+// different sorting windows and solve a linear system with it through
+// SolverCG with PreconditionJacobi and PreconditionChebyshev
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparse_matrix_sell.h>
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/precondition.h>
+#include <fstream>
+
+
+template <typename number>
+void test (const unsigned int size,
+           const unsigned int sigma)
+{
+  FDMatrix testproblem (size, size);
+  const unsigned int dim = (size-1) * (size-1);
+
+  SparsityPattern sparsity(dim, dim, size);
+  testproblem.five_point_structure(sparsity);
+  sparsity.compress();
+
+  SparseMatrix<double> A(sparsity);
+  testproblem.five_point(A, true);
+
+  SparseMatrixSELL<number> B(A, sigma);
+  deallog << "Size " << B.m() << "x" << B.n() << ", sigma " << B.get_sigma()
+          << ", nonzeros " << B.n_nonzero_elements() << std::endl;
+  AssertThrow(B.n_stored_elements() >= B.n_nonzero_elements(),
+              ExcInternalError());
+
+  for (unsigned int i=0; i<dim; ++i)
+    for (unsigned int j=0; j<dim; ++j)
+      AssertThrow(B.el(i,j) == number(A.el(i,j)), ExcInternalError());
+
+  Vector<number> src(dim), dst_ref(dim), dst(dim), b(dim);
+  for (unsigned int i=0; i<dim; ++i)
+    {
+      src(i) = Testing::rand() / (number)RAND_MAX;
+      b(i) = Testing::rand() / (number)RAND_MAX;
+    }
+
+  A.vmult(dst_ref, src);
+  B.vmult(dst, src);
+  dst -= dst_ref;
+  deallog << "vmult error: " << (dst.linfty_norm() < 1e-5 ? 0 : dst.linfty_norm())
+          << std::endl;
+
+  B.vmult(dst, src);
+  B.vmult_add(dst, src);
+  dst.add(-2., dst_ref);
+  deallog << "vmult_add error: " << (dst.linfty_norm() < 1e-5 ? 0 : dst.linfty_norm())
+          << std::endl;
+
+  A.Tvmult(dst_ref, src);
+  B.Tvmult(dst, src);
+  dst -= dst_ref;
+  deallog << "Tvmult error: " << (dst.linfty_norm() < 1e-5 ? 0 : dst.linfty_norm())
+          << std::endl;
+
+  const number res_ref = A.residual(dst_ref, src, b);
+  const number res = B.residual(dst, src, b);
+  dst -= dst_ref;
+  deallog << "residual error: " << (dst.linfty_norm() < 1e-5 &&
+                                    std::abs(res-res_ref) < 1e-5 ? 0 :
+                                    dst.linfty_norm()) << std::endl;
+
+  A.precondition_Jacobi(dst_ref, src, 0.8);
+  B.precondition_Jacobi(dst, src, 0.8);
+  dst -= dst_ref;
+  deallog << "Jacobi error: " << (dst.linfty_norm() < 1e-5 ? 0 : dst.linfty_norm())
+          << std::endl;
+}
+
+
+
+void test_solver (const unsigned int size)
+{
+  FDMatrix testproblem (size, size);
+  const unsigned int dim = (size-1) * (size-1);
+
+  SparsityPattern sparsity(dim, dim, size);
+  testproblem.five_point_structure(sparsity);
+  sparsity.compress();
+
+  SparseMatrix<double> A(sparsity);
+  testproblem.five_point(A);
+  SparseMatrixSELL<double> B(A, 8);
+
+  Vector<double> x(dim), rhs(dim);
+  rhs = 1.;
+
+  SolverControl control(200, 1e-10);
+  SolverCG<> solver(control);
+  PreconditionJacobi<SparseMatrixSELL<double> > prec;
+  prec.initialize(B);
+  check_solver_within_range(solver.solve(B, x, rhs, prec),
+                            control.last_step(), 40, 80);
+
+  Vector<double> residual(dim);
+  deallog << "Residual: " << (A.residual(residual, x, rhs) < 1e-9 ?
+                              "OK" : "too large") << std::endl;
+
+  // PreconditionChebyshev only needs vmult() and the diagonal through el(),
+  // so it must take the same number of iterations as with SparseMatrix
+  PreconditionChebyshev<SparseMatrix<double> >::AdditionalData data_ref;
+  PreconditionChebyshev<SparseMatrixSELL<double> >::AdditionalData data;
+  data_ref.degree = data.degree = 4;
+  data_ref.smoothing_range = data.smoothing_range = 20.;
+  // the eigenvalues of the five-point matrix scaled by its diagonal are
+  // bounded by 2, so we can skip the eigenvalue estimation (which needs
+  // LAPACK)
+  data_ref.eig_cg_n_iterations = data.eig_cg_n_iterations = 0;
+  data_ref.max_eigenvalue = data.max_eigenvalue = 2.;
+
+  const unsigned int previous_depth = deallog.depth_file(0);
+  PreconditionChebyshev<SparseMatrix<double> > chebyshev_ref;
+  chebyshev_ref.initialize(A, data_ref);
+  Vector<double> x_ref(dim);
+  solver.solve(A, x_ref, rhs, chebyshev_ref);
+  const unsigned int n_iterations_ref = control.last_step();
+
+  PreconditionChebyshev<SparseMatrixSELL<double> > chebyshev;
+  chebyshev.initialize(B, data);
+  x = 0;
+  solver.solve(B, x, rhs, chebyshev);
+  deallog.depth_file(previous_depth);
+  deallog << "Chebyshev iterations same as with SparseMatrix: "
+          << (control.last_step() == n_iterations_ref ? "yes" : "no")
+          << std::endl;
+  x -= x_ref;
+  deallog << "Chebyshev solution difference: "
+          << (x.linfty_norm() < 1e-8 ? "OK" : "too large") << std::endl;
+}
+
+
+
+int main()
+{
+  initlog();
+
+  test<double>(5, 1);
+  test<double>(19, 1);
+  test<double>(19, 8);
+  test<float>(19, 1);
+  test<float>(19, 16);
+  test_solver(33);
+}
@@ -0,0 +1,113 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// apply SparsityTools::partition_multilevel to the graph of a 5-point stencil
+// on a structured 32x32 grid, with and without node weights, and output the
+// number of cut edges and the smallest and largest weight of a
+// partition. for two and four partitions, the optimal cuts are 32 and 64 edges
+
+#include "../tests.h"
+#include <deal.II/lac/sparsity_tools.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+
+#include <algorithm>
+#include <fstream>
+
+
+const unsigned int N = 32;
+
+
+void check (const SparsityPattern           &sparsity,
+            const std::vector<unsigned int> &node_weights,
+            const unsigned int               n_partitions)
+{
+  std::vector<unsigned int> partition_indices (sparsity.n_rows());
+  SparsityTools::partition_multilevel (sparsity, node_weights, n_partitions,
+                                       partition_indices);
+
+  // the algorithm must not depend on anything but its input
+  std::vector<unsigned int> partition_indices_2 (sparsity.n_rows());
+  SparsityTools::partition_multilevel (sparsity, node_weights, n_partitions,
+                                       partition_indices_2);
+  AssertThrow (partition_indices == partition_indices_2, ExcInternalError());
+
+  std::vector<unsigned int> partition_weights (n_partitions, 0);
+  unsigned int n_cut_edges = 0;
+  for (unsigned int row=0; row<sparsity.n_rows(); ++row)
+    {
+      AssertThrow (partition_indices[row] < n_partitions, ExcInternalError());
+      partition_weights[partition_indices[row]]
+        += (node_weights.size() > 0 ? node_weights[row] : 1);
+      for (SparsityPattern::iterator p=sparsity.begin(row);
+           p != sparsity.end(row); ++p)
+        if (partition_indices[p->column()] != partition_indices[row])
+          ++n_cut_edges;
+    }
+
+  deallog << n_partitions << " partitions: "
+          << n_cut_edges/2 << " cut edges, weights between "
+          << *std::min_element (partition_weights.begin(), partition_weights.end())
+          << " and "
+          << *std::max_element (partition_weights.begin(), partition_weights.end())
+          << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  DynamicSparsityPattern dsp (N*N, N*N);
+  for (unsigned int i=0; i<N; ++i)
+    for (unsigned int j=0; j<N; ++j)
+      {
+        const unsigned int k = i*N+j;
+        dsp.add (k, k);
+        if (i > 0)
+          dsp.add (k, k-N);
+        if (i < N-1)
+          dsp.add (k, k+N);
+        if (j > 0)
+          dsp.add (k, k-1);
+        if (j < N-1)
+          dsp.add (k, k+1);
+      }
+  SparsityPattern sparsity;
+  sparsity.copy_from (dsp);
+
+  const unsigned int n_partitions[] = { 1, 2, 3, 4, 7, 16 };
+
+  deallog.push ("unweighted");
+  for (unsigned int i=0; i<sizeof(n_partitions)/sizeof(n_partitions[0]); ++i)
+    check (sparsity, std::vector<unsigned int>(), n_partitions[i]);
+  deallog.pop ();
+
+  // give the nodes in the right half of the grid three times the weight of
+  // the ones in the left half
+  std::vector<unsigned int> node_weights (N*N);
+  for (unsigned int k=0; k<N*N; ++k)
+    node_weights[k] = (k%N < N/2 ? 1 : 3);
+
+  deallog.push ("weighted");
+  for (unsigned int i=0; i<sizeof(n_partitions)/sizeof(n_partitions[0]); ++i)
+    check (sparsity, node_weights, n_partitions[i]);
+  deallog.pop ();
+}
@@ -0,0 +1,126 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// apply the Fiduccia-Mattheyses refinement used by
+// SparsityTools::partition_multilevel to bisections of the graph of a
+// 5-point stencil on structured grids that start out far from balanced, so
+// that also nodes in the interior of the overweight side are candidates for
+// moving. on the small grid, the queues of candidates run empty in each pass,
+// which used to move nodes twice and made the weights of the sides
+// inconsistent
+
+#include "../tests.h"
+#include <deal.II/lac/sparsity_tools.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+
+#include <fstream>
+
+
+void create_grid (const unsigned int N,
+                  SparsityPattern   &sparsity)
+{
+  DynamicSparsityPattern dsp (N*N, N*N);
+  for (unsigned int i=0; i<N; ++i)
+    for (unsigned int j=0; j<N; ++j)
+      {
+        const unsigned int k = i*N+j;
+        dsp.add (k, k);
+        if (i > 0)
+          dsp.add (k, k-N);
+        if (i < N-1)
+          dsp.add (k, k+N);
+        if (j > 0)
+          dsp.add (k, k-1);
+        if (j < N-1)
+          dsp.add (k, k+1);
+      }
+  sparsity.copy_from (dsp);
+}
+
+
+
+void check (const SparsityPattern           &sparsity,
+            const std::vector<unsigned int> &node_weights,
+            const double                     fraction_0,
+            const unsigned int               n_initially_on_side_1)
+{
+  std::vector<unsigned int> side (sparsity.n_rows(), 0);
+  for (unsigned int row=0; row<n_initially_on_side_1; ++row)
+    side[row] = 1;
+
+  SparsityTools::internal::Partitioning::refine_bisection (sparsity, node_weights,
+                                                           fraction_0, side);
+
+  unsigned int weights[2] = { 0, 0 };
+  unsigned int n_cut_edges = 0;
+  for (unsigned int row=0; row<sparsity.n_rows(); ++row)
+    {
+      AssertThrow (side[row] < 2, ExcInternalError());
+      weights[side[row]] += (node_weights.size() > 0 ? node_weights[row] : 1);
+      for (SparsityPattern::iterator p=sparsity.begin(row);
+           p != sparsity.end(row); ++p)
+        if (side[p->column()] != side[row])
+          ++n_cut_edges;
+    }
+
+  deallog << "fraction " << fraction_0
+          << ", initially " << n_initially_on_side_1 << " nodes on side 1: "
+          << "weights " << weights[0] << " and " << weights[1]
+          << ", " << n_cut_edges/2 << " cut edges" << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.threshold_double(1.e-10);
+
+  const unsigned int N = 32;
+  SparsityPattern sparsity;
+  create_grid (N, sparsity);
+
+  deallog.push ("unweighted");
+  check (sparsity, std::vector<unsigned int>(), 0.5, 0);
+  check (sparsity, std::vector<unsigned int>(), 0.5, 3*N);
+  check (sparsity, std::vector<unsigned int>(), 0.5, N*N-5);
+  check (sparsity, std::vector<unsigned int>(), 0.25, N*N/2);
+  deallog.pop ();
+
+  // give the nodes in the right half of the grid three times the weight of
+  // the ones in the left half
+  std::vector<unsigned int> node_weights (N*N);
+  for (unsigned int k=0; k<N*N; ++k)
+    node_weights[k] = (k%N < N/2 ? 1 : 3);
+
+  deallog.push ("weighted");
+  check (sparsity, node_weights, 0.5, 0);
+  check (sparsity, node_weights, 0.5, 3*N);
+  check (sparsity, node_weights, 0.25, N*N/2);
+  deallog.pop ();
+
+  const unsigned int n = 6;
+  create_grid (n, sparsity);
+
+  deallog.push ("small");
+  check (sparsity, std::vector<unsigned int>(), 0.1, 2*n);
+  check (sparsity, std::vector<unsigned int>(), 0.25, 2*n);
+  check (sparsity, std::vector<unsigned int>(), 1./3, 2*n);
+  deallog.pop ();
+}
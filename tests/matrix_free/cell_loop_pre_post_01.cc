@@ -0,0 +1,290 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// tests the variant of MatrixFree::cell_loop with operations on ranges of
+// vector entries before and after the loop: checks that every locally owned
+// entry is visited exactly once by either operation, that the destination
+// vector is final when the operation after the loop is run, and that
+// PreconditionChebyshev gives the same result when merging its vector updates
+// into the matrix-vector product
+
+#include "../tests.h"
+
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/precondition.h>
+#include <deal.II/fe/fe_q.h>
+
+#include "matrix_vector_mf.h"
+
+
+
+template <int dim, int fe_degree, typename Number>
+class HelmholtzOperator : public Subscriptor
+{
+public:
+  HelmholtzOperator (const MatrixFree<dim,Number> &data)
+    :
+    data (data)
+  {}
+
+  types::global_dof_index m () const
+  {
+    return data.get_vector_partitioner()->size();
+  }
+
+  // the diagonal is handed to PreconditionChebyshev explicitly, so the
+  // matrix entries are never queried
+  Number el (const unsigned int, const unsigned int) const
+  {
+    AssertThrow (false, ExcNotImplemented());
+    return Number();
+  }
+
+  void vmult (Vector<Number>       &dst,
+              const Vector<Number> &src) const
+  {
+    dst = 0;
+    data.cell_loop (&HelmholtzOperator::local_apply, this, dst, src);
+  }
+
+protected:
+  void local_apply (const MatrixFree<dim,Number>               &data,
+                    Vector<Number>                             &dst,
+                    const Vector<Number>                       &src,
+                    const std::pair<unsigned int,unsigned int> &cell_range) const
+  {
+    helmholtz_operator<dim,fe_degree,Vector<Number> > (data, dst, src,
+                                                       cell_range);
+  }
+
+  const MatrixFree<dim,Number> &data;
+};
+
+
+
+// same operator, but exposing the matrix-vector product with operations on
+// ranges of vector entries, which PreconditionChebyshev picks up
+template <int dim, int fe_degree, typename Number>
+class HelmholtzOperatorFused : public HelmholtzOperator<dim,fe_degree,Number>
+{
+public:
+  HelmholtzOperatorFused (const MatrixFree<dim,Number> &data)
+    :
+    HelmholtzOperator<dim,fe_degree,Number> (data)
+  {}
+
+  using HelmholtzOperator<dim,fe_degree,Number>::vmult;
+
+  void vmult (Vector<Number>       &dst,
+              const Vector<Number> &src,
+              const std_cxx11::function<void (const unsigned int,
+                                              const unsigned int)> &operation_before,
+              const std_cxx11::function<void (const unsigned int,
+                                              const unsigned int)> &operation_after) const
+  {
+    const HelmholtzOperator<dim,fe_degree,Number> *base = this;
+    this->data.cell_loop (&HelmholtzOperatorFused::local_apply, base, dst, src,
+                          std_cxx11::bind (&HelmholtzOperatorFused::zero_range,
+                                           &dst, &operation_before,
+                                           std_cxx11::_1, std_cxx11::_2),
+                          operation_after);
+  }
+
+private:
+  static void zero_range (Vector<Number> *dst,
+                          const std_cxx11::function<void (const unsigned int,
+                                                          const unsigned int)> *operation_before,
+                          const unsigned int begin,
+                          const unsigned int end)
+  {
+    for (unsigned int i=begin; i<end; ++i)
+      (*dst)(i) = 0;
+    if (*operation_before)
+      (*operation_before) (begin, end);
+  }
+};
+
+
+
+// records the state of the destination vector at the time the ranges are
+// visited
+template <typename Number>
+struct RangeRecorder
+{
+  void before (const unsigned int begin,
+               const unsigned int end)
+  {
+    for (unsigned int i=begin; i<end; ++i)
+      {
+        ++n_visits_before[i];
+        (*dst)(i) = 0;
+      }
+  }
+
+  void after (const unsigned int begin,
+              const unsigned int end)
+  {
+    for (unsigned int i=begin; i<end; ++i)
+      {
+        ++n_visits_after[i];
+        result(i) = (*dst)(i);
+      }
+  }
+
+  Vector<Number> *dst;
+  Vector<Number> result;
+  std::vector<unsigned int> n_visits_before;
+  std::vector<unsigned int> n_visits_after;
+};
+
+
+
+template <int dim, int fe_degree>
+void test ()
+{
+  typedef double Number;
+
+  Triangulation<dim> tria;
+  GridGenerator::hyper_ball (tria);
+  tria.refine_global (4-dim);
+  tria.begin_active()->set_refine_flag();
+  tria.last_active()->set_refine_flag();
+  tria.execute_coarsening_and_refinement();
+
+  FE_Q<dim> fe (fe_degree);
+  DoFHandler<dim> dof (tria);
+  dof.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof, constraints);
+  constraints.close();
+
+  deallog << "Testing " << fe.get_name() << " with " << dof.n_dofs()
+          << " dofs" << std::endl;
+
+  MatrixFree<dim,Number> mf_data;
+  {
+    const QGauss<1> quad (fe_degree+1);
+    typename MatrixFree<dim,Number>::AdditionalData data;
+    data.tasks_parallel_scheme = MatrixFree<dim,Number>::AdditionalData::none;
+    data.tasks_block_size = 3;
+    mf_data.reinit (dof, constraints, quad, data);
+  }
+
+  Vector<Number> src (dof.n_dofs()), dst (dof.n_dofs()), ref (dof.n_dofs());
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    if (!constraints.is_constrained(i))
+      src(i) = (Number)Testing::rand()/RAND_MAX;
+
+  HelmholtzOperator<dim,fe_degree,Number> mf (mf_data);
+  mf.vmult (ref, src);
+
+  // the destination vector contains garbage that must be overwritten by the
+  // operation before the loop
+  RangeRecorder<Number> recorder;
+  recorder.dst = &dst;
+  recorder.result.reinit (dof.n_dofs());
+  recorder.n_visits_before.resize (dof.n_dofs());
+  recorder.n_visits_after.resize (dof.n_dofs());
+  dst = 1e10;
+  const std_cxx11::function<void (const MatrixFree<dim,Number> &,
+                                  Vector<Number> &,
+                                  const Vector<Number> &,
+                                  const std::pair<unsigned int,unsigned int> &)>
+  wrap = helmholtz_operator<dim,fe_degree,Vector<Number> >;
+  mf_data.cell_loop (wrap, dst, src,
+                     std_cxx11::bind (&RangeRecorder<Number>::before, &recorder,
+                                      std_cxx11::_1, std_cxx11::_2),
+                     std_cxx11::bind (&RangeRecorder<Number>::after, &recorder,
+                                      std_cxx11::_1, std_cxx11::_2));
+
+  bool all_visited_once = true;
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    if (recorder.n_visits_before[i] != 1 || recorder.n_visits_after[i] != 1)
+      all_visited_once = false;
+  deallog << "All entries visited once: "
+          << (all_visited_once ? "yes" : "no") << std::endl;
+
+  dst -= ref;
+  deallog << "Error in matrix-vector product: " << dst.linfty_norm() << std::endl;
+  recorder.result -= ref;
+  deallog << "Error of entries seen after loop: "
+          << recorder.result.linfty_norm() << std::endl;
+
+  // compare Chebyshev iteration with and without merged vector updates
+  typedef PreconditionChebyshev<HelmholtzOperator<dim,fe_degree,Number>,
+          Vector<Number> > Chebyshev;
+  typedef PreconditionChebyshev<HelmholtzOperatorFused<dim,fe_degree,Number>,
+          Vector<Number> > ChebyshevFused;
+  HelmholtzOperatorFused<dim,fe_degree,Number> mf_fused (mf_data);
+  typename Chebyshev::AdditionalData cheby_data;
+  cheby_data.degree = 4;
+  cheby_data.smoothing_range = 20.;
+  cheby_data.eig_cg_n_iterations = 0;
+  cheby_data.max_eigenvalue = 2.;
+  cheby_data.matrix_diagonal_inverse.reinit (dof.n_dofs());
+  {
+    Vector<Number> unit (dof.n_dofs()), column (dof.n_dofs());
+    for (unsigned int i=0; i<dof.n_dofs(); ++i)
+      {
+        unit(i) = 1.;
+        mf.vmult (column, unit);
+        cheby_data.matrix_diagonal_inverse(i) =
+          column(i) != 0. ? 1./column(i) : 1.;
+        unit(i) = 0.;
+      }
+  }
+  typename ChebyshevFused::AdditionalData cheby_data_fused;
+  cheby_data_fused.degree = cheby_data.degree;
+  cheby_data_fused.smoothing_range = cheby_data.smoothing_range;
+  cheby_data_fused.eig_cg_n_iterations = cheby_data.eig_cg_n_iterations;
+  cheby_data_fused.max_eigenvalue = cheby_data.max_eigenvalue;
+  cheby_data_fused.matrix_diagonal_inverse = cheby_data.matrix_diagonal_inverse;
+
+  Chebyshev cheby;
+  cheby.initialize (mf, cheby_data);
+  ChebyshevFused cheby_fused;
+  cheby_fused.initialize (mf_fused, cheby_data_fused);
+
+  cheby.vmult (ref, src);
+  cheby_fused.vmult (dst, src);
+  dst -= ref;
+  deallog << "Difference Chebyshev merged vector updates: "
+          << dst.linfty_norm() / ref.linfty_norm() << std::endl;
+}
+
+
+
+int main ()
+{
+  initlog();
+  deallog << std::setprecision (3);
+
+  deallog.push("2d");
+  test<2,1>();
+  test<2,3>();
+  deallog.pop();
+  deallog.push("3d");
+  test<3,1>();
+  test<3,2>();
+  deallog.pop();
+}
@@ -0,0 +1,191 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// tests MatrixFreeOperators::compute_diagonal and compute_block_diagonal for
+// a Helmholtz operator on a mesh with hanging nodes against the diagonal of
+// the condensed sparse matrix and the cell matrices computed by FEValues
+
+#include "../tests.h"
+
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/matrix_free/matrix_free.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+#include <deal.II/matrix_free/operators.h>
+
+
+
+template <int dim, int fe_degree, typename Number>
+void local_helmholtz (FEEvaluation<dim,fe_degree,fe_degree+1,1,Number> &phi)
+{
+  phi.evaluate (true, true);
+  for (unsigned int q=0; q<phi.n_q_points; ++q)
+    {
+      phi.submit_value (make_vectorized_array<Number>(10.) * phi.get_value(q), q);
+      phi.submit_gradient (phi.get_gradient(q), q);
+    }
+  phi.integrate (true, true);
+}
+
+
+
+template <int dim, int fe_degree>
+void test ()
+{
+  typedef double Number;
+
+  Triangulation<dim> tria;
+  GridGenerator::hyper_ball (tria);
+  tria.refine_global (4-dim);
+  tria.begin_active()->set_refine_flag();
+  tria.last_active()->set_refine_flag();
+  tria.execute_coarsening_and_refinement();
+
+  FE_Q<dim> fe (fe_degree);
+  DoFHandler<dim> dof (tria);
+  dof.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof, constraints);
+  constraints.close();
+
+  deallog << "Testing " << fe.get_name() << " with " << dof.n_dofs()
+          << " dofs and " << constraints.n_constraints() << " constraints"
+          << std::endl;
+
+  MatrixFree<dim,Number> mf_data;
+  const QGauss<1> quad (fe_degree+1);
+  mf_data.reinit (dof, constraints, quad);
+
+  typedef FEEvaluation<dim,fe_degree,fe_degree+1,1,Number> FEEval;
+  Vector<Number> diagonal (dof.n_dofs());
+  MatrixFreeOperators::compute_diagonal<FEEval>
+  (mf_data, diagonal, &local_helmholtz<dim,fe_degree,Number>);
+
+  std::vector<FullMatrix<Number> > block_diagonal;
+  MatrixFreeOperators::compute_block_diagonal<FEEval>
+  (mf_data, block_diagonal, &local_helmholtz<dim,fe_degree,Number>);
+
+  // assemble the sparse matrix and compare
+  DynamicSparsityPattern dsp (dof.n_dofs(), dof.n_dofs());
+  DoFTools::make_sparsity_pattern (dof, dsp, constraints, false);
+  SparsityPattern sparsity;
+  sparsity.copy_from (dsp);
+  SparseMatrix<double> sparse_matrix (sparsity);
+
+  const QGauss<dim> quadrature (fe_degree+1);
+  FEValues<dim> fe_values (fe, quadrature,
+                           update_values | update_gradients | update_JxW_values);
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+  FullMatrix<double> cell_matrix (dofs_per_cell, dofs_per_cell);
+  std::vector<types::global_dof_index> local_dof_indices (dofs_per_cell);
+  for (typename DoFHandler<dim>::active_cell_iterator cell=dof.begin_active();
+       cell != dof.end(); ++cell)
+    {
+      fe_values.reinit (cell);
+      cell_matrix = 0;
+      for (unsigned int q=0; q<quadrature.size(); ++q)
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          for (unsigned int j=0; j<dofs_per_cell; ++j)
+            cell_matrix(i,j) += (10. * fe_values.shape_value(i,q) *
+                                 fe_values.shape_value(j,q) +
+                                 fe_values.shape_grad(i,q) *
+                                 fe_values.shape_grad(j,q)) *
+                                fe_values.JxW(q);
+      cell->get_dof_indices (local_dof_indices);
+      constraints.distribute_local_to_global (cell_matrix, local_dof_indices,
+                                              sparse_matrix);
+    }
+
+  double diagonal_error = 0, diagonal_norm = 0;
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    if (!constraints.is_constrained(i))
+      {
+        diagonal_error = std::max (diagonal_error,
+                                   std::abs(diagonal(i) - sparse_matrix.diag_element(i)));
+        diagonal_norm = std::max (diagonal_norm,
+                                  std::abs(sparse_matrix.diag_element(i)));
+      }
+    else if (diagonal(i) != 0.)
+      deallog << "Constrained entry " << i << " not zero: " << diagonal(i)
+              << std::endl;
+  deallog << "Relative error diagonal: " << diagonal_error / diagonal_norm
+          << std::endl;
+
+  // the matrix-free cell matrices are in lexicographic numbering
+  const std::vector<unsigned int> &lexicographic =
+    mf_data.get_shape_info().lexicographic_numbering;
+  double block_error = 0, block_norm = 0;
+  unsigned int n_blocks = 0;
+  for (unsigned int cell=0; cell<mf_data.n_macro_cells(); ++cell)
+    for (unsigned int v=0; v<mf_data.n_components_filled(cell); ++v)
+      {
+        const FullMatrix<Number> &block =
+          block_diagonal[cell*VectorizedArray<Number>::n_array_elements+v];
+        AssertDimension (block.m(), dofs_per_cell);
+        fe_values.reinit (mf_data.get_cell_iterator(cell, v));
+        cell_matrix = 0;
+        for (unsigned int q=0; q<quadrature.size(); ++q)
+          for (unsigned int i=0; i<dofs_per_cell; ++i)
+            for (unsigned int j=0; j<dofs_per_cell; ++j)
+              cell_matrix(i,j) += (10. * fe_values.shape_value(i,q) *
+                                   fe_values.shape_value(j,q) +
+                                   fe_values.shape_grad(i,q) *
+                                   fe_values.shape_grad(j,q)) *
+                                  fe_values.JxW(q);
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          for (unsigned int j=0; j<dofs_per_cell; ++j)
+            {
+              block_error = std::max (block_error,
+                                      std::abs(block(i,j) -
+                                               cell_matrix(lexicographic[i],
+                                                           lexicographic[j])));
+              block_norm = std::max (block_norm, std::abs(cell_matrix(i,j)));
+            }
+        ++n_blocks;
+      }
+  deallog << "Number of cell blocks: " << n_blocks
+          << ", relative error: " << block_error / block_norm << std::endl;
+}
+
+
+
+int main ()
+{
+  initlog();
+  deallog << std::setprecision (3);
+  deallog.threshold_double(1.e-12);
+
+  deallog.push("2d");
+  test<2,1>();
+  test<2,2>();
+  test<2,3>();
+  deallog.pop();
+  deallog.push("3d");
+  test<3,1>();
+  test<3,2>();
+  deallog.pop();
+}
@@ -0,0 +1,140 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check DoFRenumbering::matrix_free_data_locality: after renumbering and
+// setting up MatrixFree again, the cell batches must be visited in the same
+// order, the degrees of freedom must be numbered in the order in which the
+// batches first access them, and the result of a matrix-vector product must
+// be the same up to the permutation
+
+#include "../tests.h"
+
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/matrix_free/matrix_free.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+
+#include "matrix_vector_mf.h"
+
+#include <fstream>
+
+
+template <int dim, int fe_degree>
+void test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_ball (tria);
+  tria.refine_global (4-dim);
+  tria.begin_active()->set_refine_flag();
+  tria.last_active()->set_refine_flag();
+  tria.execute_coarsening_and_refinement();
+
+  FE_Q<dim> fe (fe_degree);
+  DoFHandler<dim> dof (tria);
+  dof.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof, constraints);
+  constraints.close();
+
+  MatrixFree<dim,double> mf_data;
+  const QGauss<1> quad (fe_degree+1);
+  mf_data.reinit (dof, constraints, quad);
+
+  std::vector<std::pair<int,int> > cells;
+  for (unsigned int c=0; c<mf_data.n_macro_cells(); ++c)
+    for (unsigned int v=0; v<mf_data.n_components_filled(c); ++v)
+      cells.push_back (std::make_pair (mf_data.get_cell_iterator(c,v)->level(),
+                                       mf_data.get_cell_iterator(c,v)->index()));
+
+  Vector<double> in (dof.n_dofs()), out (dof.n_dofs());
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    if (!constraints.is_constrained(i))
+      in(i) = Testing::rand()/(double)RAND_MAX;
+  MatrixFreeTest<dim,fe_degree,double> mf (mf_data);
+  mf.vmult (out, in);
+
+  std::vector<types::global_dof_index> renumbering;
+  DoFRenumbering::compute_matrix_free_data_locality (renumbering, dof, mf_data);
+  dof.renumber_dofs (renumbering);
+
+  constraints.clear();
+  DoFTools::make_hanging_node_constraints (dof, constraints);
+  constraints.close();
+  mf_data.reinit (dof, constraints, quad);
+
+  // the batches are the same
+  unsigned int n_different_cells = 0, index = 0;
+  for (unsigned int c=0; c<mf_data.n_macro_cells(); ++c)
+    for (unsigned int v=0; v<mf_data.n_components_filled(c); ++v, ++index)
+      if (index >= cells.size() ||
+          cells[index] != std::make_pair (mf_data.get_cell_iterator(c,v)->level(),
+                                          mf_data.get_cell_iterator(c,v)->index()))
+        ++n_different_cells;
+
+  // each cell only adds new indices directly after the largest index used
+  // so far
+  types::global_dof_index n_numbered = 0;
+  unsigned int n_violations = 0;
+  std::vector<types::global_dof_index> dof_indices (fe.dofs_per_cell);
+  for (unsigned int c=0; c<mf_data.n_macro_cells(); ++c)
+    for (unsigned int v=0; v<mf_data.n_components_filled(c); ++v)
+      {
+        mf_data.get_cell_iterator(c,v)->get_dof_indices (dof_indices);
+        std::sort (dof_indices.begin(), dof_indices.end());
+        for (unsigned int i=0; i<dof_indices.size(); ++i)
+          if (dof_indices[i] >= n_numbered)
+            {
+              if (dof_indices[i] != n_numbered)
+                ++n_violations;
+              ++n_numbered;
+            }
+      }
+
+  Vector<double> in_renumbered (dof.n_dofs()), out_renumbered (dof.n_dofs());
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    in_renumbered(renumbering[i]) = in(i);
+  mf.vmult (out_renumbered, in_renumbered);
+  double error = 0;
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    error = std::max (error, std::abs (out_renumbered(renumbering[i]) - out(i)));
+
+  deallog << "Testing " << fe.get_name() << " with " << dof.n_dofs()
+          << " dofs: different cells " << n_different_cells
+          << ", numbered in first-touch order " << n_numbered
+          << ", violations " << n_violations
+          << ", matrix-vector product " << (error < 1e-12 * out.linfty_norm() ? "ok" : "wrong")
+          << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+
+  test<2,1>();
+  test<2,3>();
+  test<3,2>();
+}
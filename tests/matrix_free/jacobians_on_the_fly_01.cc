@@ -0,0 +1,129 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// tests MatrixFree::AdditionalData::compute_jacobians_on_the_fly: the
+// matrix-vector product with the Jacobians on curved cells computed from the
+// mapping support points must give the same result as with the stored
+// Jacobians, both for MappingQ and MappingQGeneric of various degrees
+
+#include "../tests.h"
+
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_boundary_lib.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/mapping_q.h>
+
+#include "matrix_vector_mf.h"
+
+
+
+template <int dim, int fe_degree>
+void do_test (const DoFHandler<dim>  &dof,
+              const ConstraintMatrix &constraints,
+              const Mapping<dim>     &mapping)
+{
+  typedef double Number;
+
+  MatrixFree<dim,Number> mf_data, mf_data_on_the_fly;
+  {
+    const QGauss<1> quad (fe_degree+1);
+    typename MatrixFree<dim,Number>::AdditionalData data;
+    data.tasks_parallel_scheme = MatrixFree<dim,Number>::AdditionalData::none;
+    mf_data.reinit (mapping, dof, constraints, quad, data);
+    data.compute_jacobians_on_the_fly = true;
+    mf_data_on_the_fly.reinit (mapping, dof, constraints, quad, data);
+  }
+
+  deallog << "Stored Jacobian entries: "
+          << mf_data.get_mapping_info().mapping_data_gen[0].jacobians.size()
+          << " / "
+          << mf_data_on_the_fly.get_mapping_info().mapping_data_gen[0].jacobians.size()
+          << ", mapping support points: "
+          << mf_data.get_mapping_info().mapping_support_points.size()
+          << " / "
+          << mf_data_on_the_fly.get_mapping_info().mapping_support_points.size()
+          << std::endl;
+
+  Vector<Number> src (dof.n_dofs()), result (dof.n_dofs()), result_on_the_fly (dof.n_dofs());
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    if (!constraints.is_constrained(i))
+      src(i) = (Number)Testing::rand()/RAND_MAX;
+
+  MatrixFreeTest<dim,fe_degree,Number> mf (mf_data);
+  MatrixFreeTest<dim,fe_degree,Number> mf_on_the_fly (mf_data_on_the_fly);
+  mf.vmult (result, src);
+  mf_on_the_fly.vmult (result_on_the_fly, src);
+
+  result_on_the_fly -= result;
+  deallog << "Relative difference: "
+          << result_on_the_fly.linfty_norm() / result.linfty_norm() << std::endl;
+}
+
+
+
+template <int dim, int fe_degree>
+void test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_ball (tria);
+  static const HyperBallBoundary<dim> boundary;
+  tria.set_boundary (0, boundary);
+  tria.begin_active()->set_refine_flag();
+  tria.last()->set_refine_flag();
+  tria.execute_coarsening_and_refinement();
+  tria.refine_global (3-dim);
+
+  FE_Q<dim> fe (fe_degree);
+  DoFHandler<dim> dof (tria);
+  dof.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof, constraints);
+  constraints.close();
+
+  deallog << "Testing " << fe.get_name() << std::endl;
+
+  deallog << "MappingQ(3): ";
+  do_test<dim,fe_degree> (dof, constraints, MappingQ<dim>(3));
+  deallog << "MappingQ(4) on all cells: ";
+  do_test<dim,fe_degree> (dof, constraints, MappingQ<dim>(4, true));
+  deallog << "MappingQGeneric(2): ";
+  do_test<dim,fe_degree> (dof, constraints, MappingQGeneric<dim>(2));
+}
+
+
+
+int main ()
+{
+  initlog();
+  deallog << std::setprecision (3);
+  deallog.threshold_double(1.e-12);
+
+  deallog.push("2d");
+  test<2,1>();
+  test<2,3>();
+  deallog.pop();
+  deallog.push("3d");
+  test<3,1>();
+  test<3,2>();
+  deallog.pop();
+}
@@ -0,0 +1,354 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// this function tests the correctness of the implementation of face
+// integrals in matrix-free operators with FEFaceEvaluation and
+// MatrixFree::loop by comparing the symmetric interior penalty
+// discretization of the Laplacian with FE_DGQ elements against a sparse
+// matrix assembled with FEValues, FEFaceValues and FESubfaceValues. The mesh
+// is a ball with hanging nodes
+
+#include "../tests.h"
+
+std::ofstream logfile("output");
+
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/matrix_free/matrix_free.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+#include <deal.II/matrix_free/fe_face_evaluation.h>
+
+#include <iostream>
+
+
+
+template <int dim, int fe_degree, typename Number>
+class LaplaceOperator
+{
+public:
+  LaplaceOperator (const MatrixFree<dim,Number> &data,
+                   const Number                  penalty)
+    :
+    data (data),
+    penalty (penalty)
+  {}
+
+  void vmult (Vector<Number>       &dst,
+              const Vector<Number> &src) const
+  {
+    dst = 0;
+    data.loop (&LaplaceOperator::local_apply_cell,
+               &LaplaceOperator::local_apply_face,
+               &LaplaceOperator::local_apply_boundary,
+               this, dst, src);
+  }
+
+private:
+  void local_apply_cell (const MatrixFree<dim,Number>               &data,
+                         Vector<Number>                             &dst,
+                         const Vector<Number>                       &src,
+                         const std::pair<unsigned int,unsigned int> &cell_range) const
+  {
+    FEEvaluation<dim,fe_degree,fe_degree+1,1,Number> phi (data);
+    for (unsigned int cell=cell_range.first; cell<cell_range.second; ++cell)
+      {
+        phi.reinit (cell);
+        phi.read_dof_values (src);
+        phi.evaluate (false, true);
+        for (unsigned int q=0; q<phi.n_q_points; ++q)
+          phi.submit_gradient (phi.get_gradient(q), q);
+        phi.integrate (false, true);
+        phi.distribute_local_to_global (dst);
+      }
+  }
+
+  void local_apply_face (const MatrixFree<dim,Number>               &data,
+                         Vector<Number>                             &dst,
+                         const Vector<Number>                       &src,
+                         const std::pair<unsigned int,unsigned int> &face_range) const
+  {
+    FEFaceEvaluation<dim,fe_degree,fe_degree+1,1,Number> phi (data, true);
+    FEFaceEvaluation<dim,fe_degree,fe_degree+1,1,Number> phi_outer (data, false);
+    const VectorizedArray<Number> sigma = make_vectorized_array (penalty);
+    for (unsigned int face=face_range.first; face<face_range.second; ++face)
+      {
+        phi.reinit (face);
+        phi_outer.reinit (face);
+        phi.read_dof_values (src);
+        phi.evaluate (true, true);
+        phi_outer.read_dof_values (src);
+        phi_outer.evaluate (true, true);
+        for (unsigned int q=0; q<phi.n_q_points; ++q)
+          {
+            const VectorizedArray<Number> jump =
+              phi.get_value(q) - phi_outer.get_value(q);
+            const VectorizedArray<Number> average_normal_derivative =
+              Number(0.5) * (phi.get_normal_derivative(q) +
+                             phi_outer.get_normal_derivative(q));
+            const VectorizedArray<Number> flux =
+              sigma * jump - average_normal_derivative;
+            phi.submit_value (flux, q);
+            phi_outer.submit_value (-flux, q);
+            phi.submit_normal_derivative (-Number(0.5) * jump, q);
+            phi_outer.submit_normal_derivative (-Number(0.5) * jump, q);
+          }
+        phi.integrate (true, true);
+        phi.distribute_local_to_global (dst);
+        phi_outer.integrate (true, true);
+        phi_outer.distribute_local_to_global (dst);
+      }
+  }
+
+  void local_apply_boundary (const MatrixFree<dim,Number>               &data,
+                             Vector<Number>                             &dst,
+                             const Vector<Number>                       &src,
+                             const std::pair<unsigned int,unsigned int> &face_range) const
+  {
+    FEFaceEvaluation<dim,fe_degree,fe_degree+1,1,Number> phi (data, true);
+    const VectorizedArray<Number> sigma = make_vectorized_array (penalty);
+    for (unsigned int face=face_range.first; face<face_range.second; ++face)
+      {
+        phi.reinit (face);
+        phi.read_dof_values (src);
+        phi.evaluate (true, true);
+        for (unsigned int q=0; q<phi.n_q_points; ++q)
+          {
+            const VectorizedArray<Number> value = phi.get_value(q);
+            phi.submit_value (sigma * value - phi.get_normal_derivative(q), q);
+            phi.submit_normal_derivative (-value, q);
+          }
+        phi.integrate (true, true);
+        phi.distribute_local_to_global (dst);
+      }
+  }
+
+  const MatrixFree<dim,Number> &data;
+  const Number                  penalty;
+};
+
+
+
+// adds the interior penalty terms of a face between two cells, where the
+// exterior side is given by an FEFaceValues or FESubfaceValues object
+template <int dim>
+void add_face_matrix (const FEValuesBase<dim> &fe_face,
+                      const FEValuesBase<dim> &fe_face_neighbor,
+                      const double             penalty,
+                      FullMatrix<double>      &face_matrix)
+{
+  const unsigned int dofs_per_cell = fe_face.dofs_per_cell;
+  face_matrix = 0;
+  for (unsigned int q=0; q<fe_face.n_quadrature_points; ++q)
+    {
+      AssertThrow (fe_face.quadrature_point(q).distance
+                   (fe_face_neighbor.quadrature_point(q)) < 1e-12,
+                   ExcInternalError());
+      const Tensor<1,dim> normal = fe_face.normal_vector(q);
+      for (unsigned int i=0; i<2*dofs_per_cell; ++i)
+        {
+          const double jump_i = i < dofs_per_cell ?
+                                fe_face.shape_value(i,q) :
+                                -fe_face_neighbor.shape_value(i-dofs_per_cell,q);
+          const double average_i = 0.5 * (i < dofs_per_cell ?
+                                          fe_face.shape_grad(i,q) * normal :
+                                          fe_face_neighbor.shape_grad(i-dofs_per_cell,q) * normal);
+          for (unsigned int j=0; j<2*dofs_per_cell; ++j)
+            {
+              const double jump_j = j < dofs_per_cell ?
+                                    fe_face.shape_value(j,q) :
+                                    -fe_face_neighbor.shape_value(j-dofs_per_cell,q);
+              const double average_j = 0.5 * (j < dofs_per_cell ?
+                                              fe_face.shape_grad(j,q) * normal :
+                                              fe_face_neighbor.shape_grad(j-dofs_per_cell,q) * normal);
+              face_matrix(i,j) += (penalty * jump_i * jump_j - average_j * jump_i -
+                                   jump_j * average_i) * fe_face.JxW(q);
+            }
+        }
+    }
+}
+
+
+
+template <int dim>
+void assemble_matrix (const DoFHandler<dim> &dof,
+                      const double           penalty,
+                      SparseMatrix<double>  &matrix)
+{
+  const FiniteElement<dim> &fe = dof.get_fe();
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+  const QGauss<dim> quadrature (fe.degree+1);
+  const QGauss<dim-1> face_quadrature (fe.degree+1);
+  FEValues<dim> fe_values (fe, quadrature, update_gradients | update_JxW_values);
+  const UpdateFlags face_flags = update_values | update_gradients |
+                                 update_quadrature_points | update_JxW_values |
+                                 update_normal_vectors;
+  FEFaceValues<dim> fe_face (fe, face_quadrature, face_flags);
+  FEFaceValues<dim> fe_face_neighbor (fe, face_quadrature, face_flags);
+  FESubfaceValues<dim> fe_subface_neighbor (fe, face_quadrature, face_flags);
+
+  FullMatrix<double> cell_matrix (dofs_per_cell, dofs_per_cell);
+  FullMatrix<double> face_matrix (2*dofs_per_cell, 2*dofs_per_cell);
+  std::vector<types::global_dof_index> dof_indices (dofs_per_cell);
+  std::vector<types::global_dof_index> face_dof_indices (2*dofs_per_cell);
+
+  for (typename DoFHandler<dim>::active_cell_iterator cell=dof.begin_active();
+       cell != dof.end(); ++cell)
+    {
+      fe_values.reinit (cell);
+      cell->get_dof_indices (dof_indices);
+      cell_matrix = 0;
+      for (unsigned int q=0; q<quadrature.size(); ++q)
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          for (unsigned int j=0; j<dofs_per_cell; ++j)
+            cell_matrix(i,j) += (fe_values.shape_grad(i,q) *
+                                 fe_values.shape_grad(j,q) * fe_values.JxW(q));
+
+      for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+        if (cell->at_boundary(f))
+          {
+            fe_face.reinit (cell, f);
+            for (unsigned int q=0; q<face_quadrature.size(); ++q)
+              for (unsigned int i=0; i<dofs_per_cell; ++i)
+                for (unsigned int j=0; j<dofs_per_cell; ++j)
+                  cell_matrix(i,j) += ((penalty * fe_face.shape_value(i,q) *
+                                        fe_face.shape_value(j,q))
+                                       - (fe_face.shape_grad(j,q) *
+                                          fe_face.normal_vector(q) *
+                                          fe_face.shape_value(i,q))
+                                       - (fe_face.shape_value(j,q) *
+                                          fe_face.shape_grad(i,q) *
+                                          fe_face.normal_vector(q))) * fe_face.JxW(q);
+          }
+        else
+          {
+            const typename DoFHandler<dim>::cell_iterator neighbor = cell->neighbor(f);
+            if (neighbor->has_children())
+              continue;
+            if (neighbor->level() < cell->level())
+              {
+                const std::pair<unsigned int,unsigned int> neighbor_face =
+                  cell->neighbor_of_coarser_neighbor(f);
+                fe_subface_neighbor.reinit (neighbor, neighbor_face.first,
+                                            neighbor_face.second);
+                fe_face.reinit (cell, f);
+                add_face_matrix (fe_face, fe_subface_neighbor, penalty, face_matrix);
+              }
+            else if (neighbor->index() > cell->index())
+              {
+                fe_face_neighbor.reinit (neighbor, cell->neighbor_of_neighbor(f));
+                fe_face.reinit (cell, f);
+                add_face_matrix (fe_face, fe_face_neighbor, penalty, face_matrix);
+              }
+            else
+              continue;
+
+            for (unsigned int i=0; i<dofs_per_cell; ++i)
+              face_dof_indices[i] = dof_indices[i];
+            std::vector<types::global_dof_index> neighbor_dof_indices (dofs_per_cell);
+            neighbor->get_dof_indices (neighbor_dof_indices);
+            for (unsigned int i=0; i<dofs_per_cell; ++i)
+              face_dof_indices[dofs_per_cell+i] = neighbor_dof_indices[i];
+            for (unsigned int i=0; i<2*dofs_per_cell; ++i)
+              for (unsigned int j=0; j<2*dofs_per_cell; ++j)
+                matrix.add (face_dof_indices[i], face_dof_indices[j],
+                            face_matrix(i,j));
+          }
+
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        for (unsigned int j=0; j<dofs_per_cell; ++j)
+          matrix.add (dof_indices[i], dof_indices[j], cell_matrix(i,j));
+    }
+}
+
+
+
+template <int dim, int fe_degree>
+void test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_ball (tria);
+  tria.refine_global (1);
+  tria.begin_active()->set_refine_flag();
+  tria.last_active()->set_refine_flag();
+  tria.execute_coarsening_and_refinement();
+
+  FE_DGQ<dim> fe (fe_degree);
+  DoFHandler<dim> dof (tria);
+  dof.distribute_dofs (fe);
+  deallog << "Testing " << fe.get_name() << " with " << dof.n_dofs()
+          << " dofs" << std::endl;
+
+  MatrixFree<dim,double> mf_data;
+  {
+    const QGauss<1> quad (fe_degree+1);
+    typename MatrixFree<dim,double>::AdditionalData data;
+    data.tasks_parallel_scheme = MatrixFree<dim,double>::AdditionalData::none;
+    data.mapping_update_flags_inner_faces = update_gradients | update_JxW_values;
+    data.mapping_update_flags_boundary_faces = update_gradients | update_JxW_values;
+    ConstraintMatrix constraints;
+    constraints.close();
+    mf_data.reinit (dof, constraints, quad, data);
+  }
+
+  const double penalty = 10. * (fe_degree+1) * (fe_degree+1);
+  DynamicSparsityPattern dsp (dof.n_dofs(), dof.n_dofs());
+  DoFTools::make_flux_sparsity_pattern (dof, dsp);
+  SparsityPattern sparsity;
+  sparsity.copy_from (dsp);
+  SparseMatrix<double> matrix (sparsity);
+  assemble_matrix (dof, penalty, matrix);
+
+  Vector<double> src (dof.n_dofs()), dst (dof.n_dofs()), ref (dof.n_dofs());
+  for (unsigned int i=0; i<dof.n_dofs(); ++i)
+    src(i) = (double)Testing::rand()/RAND_MAX;
+
+  LaplaceOperator<dim,fe_degree,double> mf (mf_data, penalty);
+  mf.vmult (dst, src);
+  matrix.vmult (ref, src);
+  dst -= ref;
+  deallog << "Relative difference to sparse matrix: "
+          << dst.linfty_norm() / ref.linfty_norm() << std::endl;
+}
+
+
+
+int main ()
+{
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog << std::setprecision (3);
+  deallog.threshold_double(1.e-12);
+
+  deallog.push("2d");
+  test<2,1>();
+  test<2,2>();
+  test<2,3>();
+  deallog.pop();
+  deallog.push("3d");
+  test<3,1>();
+  test<3,2>();
+  deallog.pop();
+}
@@ -0,0 +1,169 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2016 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check parallel::RemotePointEvaluation on a serial triangulation, where
+// all cells are locally owned: the values must be the same as the ones
+// computed by Functions::FEFieldFunction, points outside the domain must be
+// reported as not found, and the evaluation must be repeatable with another
+// vector
+
+#include "../tests.h"
+
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/manifold_lib.h>
+#include <deal.II/distributed/remote_point_evaluation.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/fe/mapping_q.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_raviart_thomas.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/numerics/fe_field_function.h>
+
+#include <fstream>
+
+
+template <int dim, typename DoFHandlerType>
+void check (const DoFHandlerType                       &dof_handler,
+            const Mapping<dim>                         &mapping,
+            const parallel::RemotePointEvaluation<dim> &evaluator,
+            const std::vector<Point<dim> >             &points)
+{
+  const unsigned int n_components = dof_handler.get_fe().n_components();
+
+  for (unsigned int run=0; run<2; ++run)
+    {
+      Vector<double> solution (dof_handler.n_dofs());
+      for (unsigned int i=0; i<solution.size(); ++i)
+        solution(i) = Testing::rand()/(double)RAND_MAX;
+
+      std::vector<Vector<double> > values;
+      evaluator.evaluate (dof_handler, solution, values);
+      AssertThrow (values.size() == points.size(), ExcInternalError());
+
+      Functions::FEFieldFunction<dim,DoFHandlerType> fe_function (dof_handler, solution,
+          mapping);
+      double max_error = 0;
+      for (unsigned int i=0; i<points.size(); ++i)
+        if (evaluator.point_found (i))
+          {
+            Vector<double> value (n_components);
+            fe_function.vector_value (points[i], value);
+            for (unsigned int c=0; c<n_components; ++c)
+              max_error = std::max (max_error, std::fabs (values[i](c) - value(c)));
+          }
+        else
+          AssertThrow (values[i].l2_norm() == 0, ExcInternalError());
+
+      deallog << dof_handler.get_fe()[0].get_name()
+              << ": error " << (max_error < 1e-12 ? "ok" : "too large")
+              << std::endl;
+    }
+}
+
+
+
+template <int dim>
+void test ()
+{
+  deallog << "dim=" << dim << std::endl;
+
+  Triangulation<dim> triangulation;
+  GridGenerator::hyper_ball (triangulation);
+  static const SphericalManifold<dim> manifold;
+  triangulation.set_all_manifold_ids_on_boundary (0);
+  triangulation.set_manifold (0, manifold);
+  triangulation.refine_global (dim == 2 ? 3 : 1);
+
+  const MappingQ<dim> mapping (2);
+
+  // random points in the box [-1.1,1.1]^dim, some of which are outside the
+  // ball
+  std::vector<Point<dim> > points (500);
+  for (unsigned int i=0; i<points.size(); ++i)
+    for (unsigned int d=0; d<dim; ++d)
+      points[i][d] = 2.2 * (Testing::rand()/(double)RAND_MAX - 0.5);
+
+  parallel::RemotePointEvaluation<dim> evaluator;
+  evaluator.reinit (points, triangulation, mapping);
+
+  unsigned int n_found = 0, n_correct = 0;
+  for (unsigned int i=0; i<points.size(); ++i)
+    {
+      if (evaluator.point_found (i))
+        {
+          ++n_found;
+          AssertThrow (evaluator.get_point_owner (i) == 0, ExcInternalError());
+        }
+      // points well inside or outside the curved boundary must be classified
+      // correctly
+      if (points[i].norm() < 0.999)
+        n_correct += evaluator.point_found (i);
+      else if (points[i].norm() > 1.001)
+        n_correct += !evaluator.point_found (i);
+      else
+        ++n_correct;
+    }
+  deallog << "points: " << evaluator.n_points()
+          << ", all found: " << evaluator.all_points_found()
+          << ", found points evaluated here: " << (evaluator.n_evaluation_points() == n_found)
+          << ", correctly classified: " << (n_correct == points.size())
+          << std::endl;
+
+  {
+    const FESystem<dim> fe (FE_Q<dim>(2), 2, FE_DGQ<dim>(1), 1);
+    DoFHandler<dim> dof_handler (triangulation);
+    dof_handler.distribute_dofs (fe);
+    check (dof_handler, mapping, evaluator, points);
+  }
+
+  {
+    const FE_RaviartThomas<dim> fe (1);
+    DoFHandler<dim> dof_handler (triangulation);
+    dof_handler.distribute_dofs (fe);
+    check (dof_handler, mapping, evaluator, points);
+  }
+
+  {
+    hp::FECollection<dim> fe_collection;
+    fe_collection.push_back (FE_Q<dim>(1));
+    fe_collection.push_back (FE_Q<dim>(3));
+    hp::DoFHandler<dim> dof_handler (triangulation);
+    unsigned int index = 0;
+    for (typename hp::DoFHandler<dim>::active_cell_iterator
+         cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell, ++index)
+      cell->set_active_fe_index (index % 2);
+    dof_handler.distribute_dofs (fe_collection);
+    check (dof_handler, mapping, evaluator, points);
+  }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+
+  test<2>();
+  test<3>();
+
+  return 0;
+}